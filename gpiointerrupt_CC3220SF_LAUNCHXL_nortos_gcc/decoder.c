@@ -0,0 +1,183 @@
+/*
+ * Robert Murphy
+ * CS 350 Milestone 3
+ */
+
+/*
+ *  ======== decoder.c ========
+ *
+ *  Adaptive Morse receiver. See decoder.h.
+ */
+
+#include "decoder.h"
+#include "morse.h"
+
+// Longest time looked at, so lengths in 1/16 ms stay well inside 32 bits
+#define MAX_LENGTH_MS 60000
+
+/*
+ *  ======== track ========
+ *  Moves the dot length towards x, a measured dot. Far from the current
+ *  value (the sender has changed speed, or this is the start) it moves
+ *  half way at once; otherwise 1/2^shift of the way.
+ */
+static void track(Decoder *d, uint32_t x, unsigned int shift)
+{
+    if (x < d->dot / 2 || x > 2 * d->dot)
+    {
+        shift = 1;
+    }
+    d->dot = d->dot - (d->dot >> shift) + (x >> shift);
+    if (d->dot < 16)
+    {
+        d->dot = 16;
+    }
+}
+
+/*
+ *  ======== elapsed ========
+ *  Time since the last edge, in 1/16 ms.
+ */
+static uint32_t elapsed(const Decoder *d, uint32_t now)
+{
+    uint32_t length = now - d->lastEdge;
+
+    if (length > MAX_LENGTH_MS)
+    {
+        length = MAX_LENGTH_MS;
+    }
+    return length * 16;
+}
+
+/*
+ *  ======== endLetter ========
+ */
+static unsigned int endLetter(Decoder *d, char *out)
+{
+    char c = 0;
+
+    if (d->count == 0)
+    {
+        return 0;
+    }
+    if (d->count < 8)
+    {
+        c = morse_decodeCode((uint8_t)(d->bits | (1u << d->count)));
+    }
+    d->bits = 0;
+    d->count = 0;
+    d->wordOpen = 1;
+    d->lineOpen = 1;
+
+    out[0] = (c != 0) ? c : '#';
+    return 1;
+}
+
+/*
+ *  ======== decoder_init ========
+ */
+void decoder_init(Decoder *d, uint32_t now, uint16_t dotMs)
+{
+    d->lastEdge = now;
+    d->dot = (dotMs > 0) ? (uint32_t)dotMs * 16 : 16;
+    d->pressed = 0;
+    d->bits = 0;
+    d->count = 0;
+    d->wordOpen = 0;
+    d->lineOpen = 0;
+}
+
+/*
+ *  ======== decoder_edge ========
+ */
+unsigned int decoder_edge(Decoder *d, uint32_t now, int pressed, char *out)
+{
+    uint32_t length;
+    uint32_t threshold = 2 * d->dot;
+    unsigned int n = 0;
+
+    pressed = (pressed != 0);
+    if (pressed == d->pressed || now - d->lastEdge < DECODER_DEBOUNCE_MS)
+    {
+        return 0;
+    }
+    length = elapsed(d, now);
+    d->lastEdge = now;
+    d->pressed = (uint8_t)pressed;
+
+    if (!pressed)
+    {
+        // A press ended: a dot or a dash, which is three dots. A key held
+        // down for a long time is still a dash, but counts as no longer
+        // than two of them.
+        if (length < threshold)
+        {
+            track(d, length, 2);
+        }
+        else
+        {
+            if (d->count < 7)
+            {
+                d->bits |= (uint8_t)(1u << d->count);
+            }
+            track(d, (length < 6 * d->dot) ? length / 3 : 2 * d->dot, 2);
+        }
+        if (d->count < 8)
+        {
+            d->count++;
+        }
+    }
+    else if (length < threshold)
+    {
+        // Gap inside a letter, about a dot long
+        track(d, length, 3);
+    }
+    else
+    {
+        n = endLetter(d, out);
+        if (length >= 5 * d->dot && d->wordOpen)
+        {
+            out[n++] = ' ';
+            d->wordOpen = 0;
+        }
+    }
+
+    return n;
+}
+
+/*
+ *  ======== decoder_poll ========
+ */
+unsigned int decoder_poll(Decoder *d, uint32_t now, char *out)
+{
+    uint32_t length;
+    unsigned int n = 0;
+
+    if (d->pressed)
+    {
+        return 0;
+    }
+    length = elapsed(d, now);
+
+    if (length >= 2 * d->dot)
+    {
+        n = endLetter(d, out);
+    }
+    if (d->lineOpen && length >= DECODER_LINE_GAP * d->dot)
+    {
+        out[n++] = '\n';
+        d->wordOpen = 0;
+        d->lineOpen = 0;
+    }
+
+    return n;
+}
+
+/*
+ *  ======== decoder_wpm ========
+ */
+unsigned int decoder_wpm(const Decoder *d)
+{
+    // PARIS is 50 units, so a dot of t ms is 1200 / t words per minute.
+    return (1200 * 16 + d->dot / 2) / d->dot;
+}
@@ -0,0 +1,86 @@
+/*
+ * Robert Murphy
+ * CS 350 Milestone 3
+ */
+
+/*
+ *  ======== decoder.h ========
+ *
+ *  Morse receiver for a hand key (a push button). It is given the time of
+ *  each press and release and turns the presses into dots and dashes and
+ *  the gaps into element, letter and word gaps as they happen:
+ *
+ *      press shorter than two dots      dot, otherwise dash
+ *      gap shorter than two dots        element gap
+ *      gap shorter than five dots       letter gap
+ *      longer gaps                      word gap
+ *
+ *  The dot length is a running average of the dots, a third of each
+ *  dash, and the element gaps received, so the thresholds follow the
+ *  sender as they speed up or slow down. A length far from the current
+ *  dot moves it half way at once, so a sender at 5 or 40 words per minute
+ *  is picked up within the first word.
+ *
+ *  Each call does a fixed amount of work. Edges closer together than
+ *  DECODER_DEBOUNCE_MS, and edges that do not change the key state, are
+ *  switch bounce and are ignored.
+ *
+ *  Plain C with no driver calls, so tools/morsedecode.c can run it on
+ *  the host with recorded and generated timings.
+ */
+
+#ifndef DECODER_H_
+#define DECODER_H_
+
+#include <stdint.h>
+
+#define DECODER_DEBOUNCE_MS     10
+
+/* Silence, in dots, after which the line is ended with '\n' */
+#define DECODER_LINE_GAP        21
+
+/* Starting dot length: 12 words per minute */
+#define DECODER_DEFAULT_DOT_MS  100
+
+/* Most characters one call can produce */
+#define DECODER_MAX_OUT         2
+
+typedef struct {
+    uint32_t lastEdge;          // time of the last edge taken, ms
+    uint32_t dot;               // dot length, 1/16 ms
+    uint8_t pressed;
+    uint8_t bits;               // elements of the letter so far, first in bit 0, 1 = dash
+    uint8_t count;              // how many (up to 8; 8 means too many)
+    uint8_t wordOpen;           // a letter has been sent since the last space
+    uint8_t lineOpen;           // anything has been sent since the last '\n'
+} Decoder;
+
+/*
+ *  ======== decoder_init ========
+ *  Starts with the key up at time now, and a dot of dotMs.
+ */
+void decoder_init(Decoder *d, uint32_t now, uint16_t dotMs);
+
+/*
+ *  ======== decoder_edge ========
+ *  The key went down (pressed != 0) or up at time now, in ms. Writes any
+ *  characters this completes to out[] (letters, '#' for a letter with no
+ *  code, ' ') and returns how many.
+ */
+unsigned int decoder_edge(Decoder *d, uint32_t now, int pressed, char *out);
+
+/*
+ *  ======== decoder_poll ========
+ *  Finishes the last letter, and then the line, once the key has been up
+ *  long enough, since there is no next edge to do it. Call it now and
+ *  then while the key is idle.
+ */
+unsigned int decoder_poll(Decoder *d, uint32_t now, char *out);
+
+/*
+ *  ======== decoder_wpm ========
+ *  The sender's speed as currently tracked (PARIS words per minute).
+ */
+unsigned int decoder_wpm(const Decoder *d);
+
+#endif /* DECODER_H_ */
@@ -1,220 +1,820 @@
-/*
- * Robert Murphy
- * 6/8/2024
- * CS 350 Milestone 3
- */
-
-/*
- * This program is a morse code state machine
- * It will power up to the SOS state by default
- * After initializing, the system listens for user input
- * via the two GPIO push button inputs.
- * This will toggle the machine state from SOS, OK and from OK, to SOS
- * The program is written to ensure messages are complete
- * prior to switching states
- */
-
-/*
- *  ======== gpiointerrupt.c ========
- */
-#include <stdint.h>
-#include <stddef.h>
-
-/* Driver Header files */
-#include <ti/drivers/GPIO.h>
-#include <ti/drivers/Timer.h>
-
-/* Driver configuration */
-#include "ti_drivers_config.h"
-
-/* Morse code message states */
-enum MachineStates {SOS, OK} MachineState, PushButton;
-
-/* LED code states */
-enum CodeStates {DOT, DASH, OFF} CodeState;
-
-/* Morse messages */
-enum CodeStates codeSOS[] = {
-
-    /* S */
-    DOT, OFF,
-    DOT, OFF,
-    DOT, OFF, OFF, OFF,
-
-    /* O */
-    DASH, DASH, DASH, OFF,
-    DASH, DASH, DASH, OFF,
-    DASH, DASH, DASH, OFF, OFF, OFF,
-
-    /* S */
-    DOT, OFF,
-    DOT, OFF,
-    DOT,
-    OFF, OFF, OFF, OFF, OFF, OFF, OFF
-};
-
-enum CodeStates codeOK[] = {
-
-    /* O */
-    DASH, DASH, DASH, OFF,
-    DASH, DASH, DASH, OFF,
-    DASH, DASH, DASH, OFF, OFF, OFF,
-
-    /* K */
-    DASH, DASH, DASH, OFF,
-    DOT, OFF,
-    DASH, DASH, DASH,
-    OFF, OFF, OFF, OFF, OFF, OFF, OFF
-};
-
-/* byte tracker, initialized to zero. */
-unsigned int bytesRead = 0;
-
-/*
- *  ======== updateGPIO ========
- *  Function for the LEDs to represent a dot, dash, or break.
- */
-void updateGPIO() {
-    switch(CodeState) {
-
-        case DOT:  // Red on; Green off
-            GPIO_write(CONFIG_GPIO_LED_0, CONFIG_GPIO_LED_ON);
-            GPIO_write(CONFIG_GPIO_LED_1, CONFIG_GPIO_LED_OFF);
-            break;
-
-        case DASH:   // Green on; Red off
-            GPIO_write(CONFIG_GPIO_LED_0, CONFIG_GPIO_LED_OFF);
-            GPIO_write(CONFIG_GPIO_LED_1, CONFIG_GPIO_LED_ON);
-            break;
-
-        case OFF:   // both off
-            GPIO_write(CONFIG_GPIO_LED_0, CONFIG_GPIO_LED_OFF);
-            GPIO_write(CONFIG_GPIO_LED_1, CONFIG_GPIO_LED_OFF);
-            break;
-    }
-}
-
-/*
- *  ======== timerCallback ========
- *  Callback function for the timer interrupt.
- */
-void timerCallback(Timer_Handle myHandle, int_fast16_t status)
-{
-    switch(MachineState) {
-
-        case SOS:
-            CodeState = codeSOS[bytesRead];
-            updateGPIO();
-            bytesRead++;
-
-            if(bytesRead == (sizeof(codeSOS)/sizeof(codeSOS[0]))) {
-                MachineState = PushButton;
-                bytesRead = 0;
-            }
-            break;
-
-        case OK:
-            CodeState = codeOK[bytesRead];
-            updateGPIO();
-            bytesRead++;
-
-            if(bytesRead == (sizeof(codeOK)/sizeof(codeOK[0]))) {
-                MachineState = PushButton;
-                bytesRead = 0;
-            }
-            break;
-
-    }
-}
-
-/*
- *  ======== timerInit ========
- *  Initialization function for the timer interrupt on timer0.
- */
-void initTimer(void)
-{
-    Timer_Handle timer0;
-    Timer_Params params;
-
-    Timer_init();
-    Timer_Params_init(&params);
-    params.period = 500000;
-    params.periodUnits = Timer_PERIOD_US;
-    params.timerMode = Timer_CONTINUOUS_CALLBACK;
-    params.timerCallback = timerCallback;
-
-    timer0 = Timer_open(CONFIG_TIMER_0, &params);
-
-    if(timer0 == NULL) {
-        /* Failed to initialized timer */
-        while (1) {}
-    }
-
-    if(Timer_start(timer0) == Timer_STATUS_ERROR)
-    {
-        /* Failed to start timer */
-        while (1) {}
-    }
-}
-
-/*
- *  ======== pushButtonCallback ========
- *  Callback function for the GPIO interrupt
- */
-void pushButtonCallback(uint_least8_t index)
-{
-    switch(PushButton) {
-        case SOS:
-            PushButton = OK;
-            break;
-
-        case OK:
-            PushButton = SOS;
-            break;
-
-    }
-}
-
-/*
- *  ======== mainThread ========
- */
-void *mainThread(void *arg0)
-{
-    /* Call driver init functions for GPIO and timer */
-    GPIO_init();
-    initTimer();
-
-    /* Configure the LED and button pins */
-    GPIO_setConfig(CONFIG_GPIO_LED_0, GPIO_CFG_OUT_STD | GPIO_CFG_OUT_LOW);
-    GPIO_setConfig(CONFIG_GPIO_LED_1, GPIO_CFG_OUT_STD | GPIO_CFG_OUT_LOW);
-    GPIO_setConfig(CONFIG_GPIO_BUTTON_0, GPIO_CFG_IN_PU | GPIO_CFG_IN_INT_FALLING);
-
-    /* Start with LEDs off */
-    //GPIO_write(CONFIG_GPIO_LED_0, CONFIG_GPIO_LED_OFF);
-    //GPIO_write(CONFIG_GPIO_LED_1, CONFIG_GPIO_LED_OFF);
-
-    /* Set initial states to SOS_MESSAGE */
-    PushButton = SOS;
-    MachineState = PushButton;
-
-    /* Install Button callback */
-    GPIO_setCallback(CONFIG_GPIO_BUTTON_0, pushButtonCallback);
-
-    /* Enable interrupts */
-    GPIO_enableInt(CONFIG_GPIO_BUTTON_0);
-
-    /*
-     *  If more than one input pin is available for your device, interrupts
-     *  will be enabled on CONFIG_GPIO_BUTTON1.
-     */
-    if (CONFIG_GPIO_BUTTON_0 != CONFIG_GPIO_BUTTON_1) {
-        /* Configure BUTTON1 pin */
-        GPIO_setConfig(CONFIG_GPIO_BUTTON_1, GPIO_CFG_IN_PU | GPIO_CFG_IN_INT_FALLING);
-
-        /* Install Button callback */
-        GPIO_setCallback(CONFIG_GPIO_BUTTON_1, pushButtonCallback);
-        GPIO_enableInt(CONFIG_GPIO_BUTTON_1);
-    }
-
-    return (NULL);
-}
+/*
+ * Robert Murphy
+ * 6/8/2024
+ * CS 350 Milestone 3
+ */
+
+/*
+ * This program is a morse code state machine
+ * It will power up to the SOS state by default
+ * After initializing, the system listens for user input
+ * via the SW2 push button input.
+ * This will toggle the machine state from SOS, OK and from OK, to SOS
+ * The program is written to ensure messages are complete
+ * prior to switching states
+ *
+ * Text sent to the board over the XDS110 UART is played as well. It is
+ * encoded a character at a time as it arrives and handed to the timer in
+ * two small run buffers, so a line of any length plays while the next
+ * part of it is being encoded. A line is ended by CR or LF, or by
+ * nothing more arriving for 10 s; the button messages carry on once it
+ * has been sent.
+ *
+ * The LEDs are driven by a keyframe sequencer (see sequencer.h), and the
+ * Morse player is one of the patterns it plays: red for a dot, green for
+ * a dash. The yellow LED is on PWM and fades. A press of SW2 flashes all
+ * three, over the Morse, and each letter received on SW3 blinks yellow.
+ *
+ * The timer is not a fixed 500 ms tick. The sequencer works out how long
+ * until the next change and a one-shot timer is set for that, so between
+ * changes the CPU sleeps. After each message the number of timer
+ * interrupts it took is written to the UART, next to the number the fixed
+ * tick needed (one per 500 ms unit), e.g. "SOS 18 interrupts, 34 ticks".
+ * Only the Morse LED changes are counted; the steps of a flash or a fade
+ * during the message are not part of it.
+ *
+ * SW3 is a Morse key. Its presses and releases are timed in the GPIO
+ * callback and decoded in the main loop (see decoder.h), which follows
+ * the speed it is keyed at. Each received line is written to the UART as
+ * "RX <text> (<n> WPM)".
+ */
+
+/*
+ *  ======== gpiointerrupt.c ========
+ */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Driver Header files */
+#include <ti/drivers/GPIO.h>
+#include <ti/drivers/Power.h>
+#include <ti/drivers/PWM.h>
+#include <ti/drivers/Timer.h>
+#include <ti/drivers/UART2.h>
+#include <ti/drivers/dpl/HwiP.h>
+
+/* Driver configuration */
+#include "ti_drivers_config.h"
+
+/* Morse run tables generated from messages.def by tools/morsegen.c */
+#include "morse_table.h"
+#include "decoder.h"
+#include "sequencer.h"
+
+/* Morse code message states */
+enum MachineStates {
+#define MESSAGE(name, text) name,
+#include "messages.def"
+#undef MESSAGE
+} MachineState, PushButton;
+
+/* LED code state (see morse.h) */
+enum CodeStates CodeState;
+
+/* Morse messages, kept in flash */
+static const struct {
+    const char *name;
+    const uint8_t *runs;
+    unsigned int length;
+} messages[] = {
+#define MESSAGE(name, text) { #name, morse##name, sizeof(morse##name) },
+#include "messages.def"
+#undef MESSAGE
+};
+
+/* Length of one Morse unit */
+#define UNIT_MS 500
+
+/* Longest single wait, well inside what the 32-bit timer can count */
+#define MAX_WAIT_UNITS 60
+
+/* Sequencer channels */
+enum Channels {CHANNEL_RED, CHANNEL_GREEN, CHANNEL_YELLOW};
+
+/* Pattern priorities, highest wins */
+enum Priorities {PRIORITY_MORSE = 1, PRIORITY_FLASH = 2};
+
+/* LED levels for each code state: red, green */
+static const uint8_t codeLevels[3][2] = {
+    {255, 0},   /* DOT */
+    {0, 255},   /* DASH */
+    {0, 0},     /* OFF */
+};
+
+/* All three LEDs flash twice: SW2 was pressed */
+static const SeqKey flashKeys[] = {
+    SEQ_KEY(CHANNEL_RED, 255, 0, 0),
+    SEQ_KEY(CHANNEL_GREEN, 255, 0, 0),
+    SEQ_KEY(CHANNEL_YELLOW, 255, 0, 80),
+    SEQ_KEY(CHANNEL_RED, 0, 0, 0),
+    SEQ_KEY(CHANNEL_GREEN, 0, 0, 0),
+    SEQ_KEY(CHANNEL_YELLOW, 0, 0, 80),
+    SEQ_KEY(CHANNEL_RED, 255, 0, 0),
+    SEQ_KEY(CHANNEL_GREEN, 255, 0, 0),
+    SEQ_KEY(CHANNEL_YELLOW, 255, 0, 80),
+};
+static const SeqPattern flashPattern = SEQ_PATTERN(flashKeys, 0);
+
+/* Yellow fades out: a letter was received on SW3 */
+static const SeqKey letterKeys[] = {
+    SEQ_KEY(CHANNEL_YELLOW, 255, 0, 0),
+    SEQ_KEY(CHANNEL_YELLOW, 0, 300, 300),
+};
+static const SeqPattern letterPattern = SEQ_PATTERN(letterKeys, 0);
+
+Timer_Handle timer0;
+PWM_Handle pwmYellow;
+uint32_t sequencerCount;
+
+UART2_Handle uart;
+
+/* UART input, a power of two. Filled by the read callback, emptied by mainThread. */
+#define RX_RING_SIZE 256
+#define RX_CHUNK_SIZE 16
+
+static uint8_t rxRing[RX_RING_SIZE];
+static volatile uint16_t rxHead = 0;
+static volatile uint16_t rxTail = 0;
+static uint8_t rxChunk[RX_CHUNK_SIZE];
+uint32_t rxDropped = 0;
+
+/*
+ * Run buffers for text from the UART. mainThread fills one while the
+ * timer plays the other; a buffer belongs to the timer while its length
+ * is non-zero. streamLast marks the buffer that ends a line.
+ */
+#define STREAM_RUNS 32
+
+static uint8_t streamRuns[2][STREAM_RUNS];
+static volatile uint8_t streamLength[2] = {0, 0};
+static volatile uint8_t streamLast[2] = {0, 0};
+
+/* Played while the rest of a line has not been encoded yet */
+static const uint8_t holdRun[1] = { MORSE_RUN(OFF, 1) };
+uint32_t streamUnderruns = 0;
+
+/* Units held in a row; a line with no CR or LF is ended after this many */
+#define HOLD_TIMEOUT_UNITS 20
+static volatile unsigned int holdUnits = 0;
+
+/* What the timer is playing */
+enum PlaySources {PLAY_MESSAGE, PLAY_STREAM, PLAY_HOLD} PlaySource = PLAY_MESSAGE;
+const uint8_t *playRuns;
+unsigned int playLength;
+unsigned int playBuffer = 0;
+unsigned int midLine = 0;
+
+/*
+ * Key edges from SW3: free-running timer count and whether the key is
+ * down. Filled by the GPIO callback, emptied by mainThread.
+ */
+#define KEY_RING_SIZE 32
+#define COUNTS_PER_MS 80000         /* timer clock is the 80 MHz CPU clock */
+
+static struct {
+    uint32_t count;
+    uint8_t pressed;
+} keyRing[KEY_RING_SIZE];
+static volatile uint8_t keyHead = 0;
+static volatile uint8_t keyTail = 0;
+uint32_t keyDropped = 0;
+
+Timer_Handle clockTimer;
+Decoder decoder;
+unsigned int receiving = 0;
+
+/* run tracker, initialized to zero. */
+unsigned int runsRead = 0;
+
+/* Length of the current run, and whether its green keyframe is still to come */
+unsigned int runUnits = 0;
+unsigned int greenPending = 0;
+
+/*
+ * Timer interrupts (LED changes) and time units of the message being
+ * played; a text line counts as one message. When it is done the totals are left in
+ * the report fields, and reportCount is bumped, for mainThread to send.
+ */
+unsigned int messageInterrupts = 0;
+unsigned int messageUnits = 0;
+static volatile unsigned int reportCount = 0;
+static const char *volatile reportName;
+static volatile unsigned int reportInterrupts;
+static volatile unsigned int reportUnits;
+
+/*
+ *  ======== setChannel ========
+ *  Sequencer output. Red and green are plain GPIOs, on from half level.
+ */
+void setChannel(unsigned int channel, uint8_t level) {
+    switch(channel) {
+
+        case CHANNEL_RED:
+            GPIO_write(CONFIG_GPIO_LED_0, (level >= 128) ? CONFIG_GPIO_LED_ON : CONFIG_GPIO_LED_OFF);
+            break;
+
+        case CHANNEL_GREEN:
+            GPIO_write(CONFIG_GPIO_LED_1, (level >= 128) ? CONFIG_GPIO_LED_ON : CONFIG_GPIO_LED_OFF);
+            break;
+
+        case CHANNEL_YELLOW:
+            PWM_setDuty(pwmYellow, level * (PWM_DUTY_FRACTION_MAX / 255));
+            break;
+    }
+}
+
+/*
+ *  ======== nextTable ========
+ *  Picks what to play once the current table is done: text from the UART
+ *  if a buffer is ready, a gap if a line is still coming in, otherwise
+ *  the message the buttons have selected.
+ */
+static void nextTable(void)
+{
+    /* Message or line done: leave its totals for mainThread */
+    if(PlaySource == PLAY_MESSAGE
+       || (PlaySource == PLAY_STREAM && streamLast[playBuffer])) {
+        reportName = (PlaySource == PLAY_MESSAGE) ? messages[MachineState].name : "TEXT";
+        reportInterrupts = messageInterrupts;
+        reportUnits = messageUnits;
+        reportCount++;
+        messageInterrupts = 0;
+        messageUnits = 0;
+    }
+
+    /* Hand a finished buffer back to mainThread */
+    if(PlaySource == PLAY_STREAM) {
+        midLine = !streamLast[playBuffer];
+        streamLength[playBuffer] = 0;
+        playBuffer ^= 1;
+    }
+
+    if(streamLength[playBuffer] != 0) {
+        PlaySource = PLAY_STREAM;
+        playRuns = streamRuns[playBuffer];
+        playLength = streamLength[playBuffer];
+        holdUnits = 0;
+    }
+    else if(midLine) {
+        PlaySource = PLAY_HOLD;
+        playRuns = holdRun;
+        playLength = 1;
+        streamUnderruns++;
+        holdUnits++;
+    }
+    else {
+        MachineState = PushButton;
+        PlaySource = PLAY_MESSAGE;
+        playRuns = messages[MachineState].runs;
+        playLength = messages[MachineState].length;
+    }
+    runsRead = 0;
+}
+
+/*
+ *  ======== morseSource ========
+ *  Sequencer source for the Morse player. Each run becomes a red and a
+ *  green keyframe; runs in a row with the same state are a single wait.
+ */
+int morseSource(void *arg, SeqKey *key)
+{
+    key->fadeMs = 0;
+
+    if(greenPending) {
+        /* Green, then hold both for the run */
+        key->channel = CHANNEL_GREEN;
+        key->level = codeLevels[CodeState][1];
+        key->waitMs = runUnits * UNIT_MS;
+        greenPending = 0;
+        return 1;
+    }
+
+    /* Table complete; pick up a button change or text for the next one */
+    if(runsRead == playLength) {
+        nextTable();
+    }
+
+    CodeState = MORSE_RUN_STATE(playRuns[runsRead]);
+    runUnits = 0;
+    do {
+        runUnits += MORSE_RUN_UNITS(playRuns[runsRead]);
+        runsRead++;
+    } while(runsRead < playLength
+            && MORSE_RUN_STATE(playRuns[runsRead]) == CodeState
+            && runUnits + MORSE_RUN_UNITS(playRuns[runsRead]) <= MAX_WAIT_UNITS);
+    messageUnits += runUnits;
+    messageInterrupts++;
+
+    key->channel = CHANNEL_RED;
+    key->level = codeLevels[CodeState][0];
+    key->waitMs = 0;
+    greenPending = 1;
+    return 1;
+}
+
+/*
+ *  ======== runSequencer ========
+ *  Brings the sequencer up to the time on the clock and sets the one-shot
+ *  timer for its next step. Runs in the timer callback, or elsewhere with
+ *  interrupts disabled.
+ */
+static void runSequencer(void)
+{
+    uint32_t counts = Timer_getCount(clockTimer) - sequencerCount;
+    uint32_t elapsed = counts / COUNTS_PER_MS;
+    uint32_t next;
+
+    /* The part of a millisecond left over counts towards the next step */
+    sequencerCount += elapsed * COUNTS_PER_MS;
+    next = seq_advance(elapsed);
+
+    Timer_stop(timer0);
+    if(next != SEQ_IDLE) {
+        Timer_setPeriod(timer0, Timer_PERIOD_US,
+                        next * 1000 - (counts % COUNTS_PER_MS) / (COUNTS_PER_MS / 1000));
+        Timer_start(timer0);
+    }
+}
+
+/*
+ *  ======== startPattern ========
+ *  Starts a pattern from outside the timer callback.
+ */
+void startPattern(const SeqPattern *pattern, uint8_t priority)
+{
+    uintptr_t key = HwiP_disable();
+
+    /* Bring the sequencer up to now first, so the pattern starts now */
+    runSequencer();
+    seq_play(pattern, priority);
+    runSequencer();
+
+    HwiP_restore(key);
+}
+
+/*
+ *  ======== timerCallback ========
+ *  Callback function for the one-shot timer: the sequencer's next step.
+ */
+void timerCallback(Timer_Handle myHandle, int_fast16_t status)
+{
+    runSequencer();
+}
+
+/*
+ *  ======== timerInit ========
+ *  Initialization function for the timer interrupt on timer0. The
+ *  sequencer starts it.
+ */
+void initTimer(void)
+{
+    Timer_Params params;
+
+    Timer_Params_init(&params);
+    params.period = UNIT_MS * 1000;
+    params.periodUnits = Timer_PERIOD_US;
+    params.timerMode = Timer_ONESHOT_CALLBACK;
+    params.timerCallback = timerCallback;
+
+    timer0 = Timer_open(CONFIG_TIMER_0, &params);
+
+    if(timer0 == NULL) {
+        /* Failed to initialized timer */
+        while (1) {}
+    }
+}
+
+/*
+ *  ======== initPWM ========
+ *  The yellow LED, so it can fade.
+ */
+void initPWM(void)
+{
+    PWM_Params params;
+
+    PWM_init();
+    PWM_Params_init(&params);
+    params.dutyUnits = PWM_DUTY_FRACTION;
+    params.dutyValue = 0;
+    params.periodUnits = PWM_PERIOD_US;
+    params.periodValue = 1000;
+
+    pwmYellow = PWM_open(CONFIG_PWM_0, &params);
+
+    if(pwmYellow == NULL || PWM_start(pwmYellow) != PWM_STATUS_SUCCESS) {
+        /* Failed to start PWM */
+        while (1) {}
+    }
+}
+
+/*
+ *  ======== uartReadCallback ========
+ *  Moves whatever has arrived into the ring and starts the next read.
+ */
+void uartReadCallback(UART2_Handle handle, void *buf, size_t count,
+                      void *userArg, int_fast16_t status)
+{
+    uint16_t head = rxHead;
+    size_t i;
+
+    for(i = 0; i < count; i++) {
+        if((uint16_t)(head - rxTail) == RX_RING_SIZE) {
+            rxDropped += count - i;
+            break;
+        }
+        rxRing[head++ & (RX_RING_SIZE - 1)] = ((const uint8_t *)buf)[i];
+    }
+    rxHead = head;
+
+    UART2_read(handle, rxChunk, sizeof(rxChunk), NULL);
+}
+
+/*
+ *  ======== initUART ========
+ *  Opens the XDS110 UART for text input in callback mode.
+ */
+void initUART(void)
+{
+    UART2_Params params;
+
+    UART2_Params_init(&params);
+    params.baudRate = 115200;
+    params.readMode = UART2_Mode_CALLBACK;
+    params.readReturnMode = UART2_ReadReturnMode_PARTIAL;
+    params.readCallback = uartReadCallback;
+
+    uart = UART2_open(CONFIG_UART2_0, &params);
+
+    if(uart == NULL) {
+        /* Failed to open the UART */
+        while (1) {}
+    }
+
+    UART2_read(uart, rxChunk, sizeof(rxChunk), NULL);
+}
+
+/*
+ *  ======== streamText ========
+ *  Encodes text from the ring into the free run buffer, and hands the
+ *  buffer to the timer when it is full, at the end of a line, or when
+ *  there is nothing more to encode for now. Spaces at the start of a line
+ *  and repeated spaces are dropped, as are characters with no code. A
+ *  line the timer has held for HOLD_TIMEOUT_UNITS with nothing more in
+ *  the ring is ended as if CR had arrived.
+ */
+void streamText(void)
+{
+    static unsigned int fillBuffer = 0;
+    static unsigned int fillLength = 0;
+    static unsigned int lineOpen = 0;
+    static unsigned int spacePending = 0;
+    uint8_t *runs = streamRuns[fillBuffer];
+    unsigned int last = 0;
+
+    if(streamLength[fillBuffer] != 0) {
+        /* Both buffers are with the timer */
+        return;
+    }
+
+    while(rxTail != rxHead) {
+        char c = (char)rxRing[rxTail & (RX_RING_SIZE - 1)];
+        uint8_t letter[MORSE_CHAR_RUNS];
+        unsigned int count;
+
+        if(c == '\r' || c == '\n') {
+            if(!lineOpen) {
+                rxTail++;
+                continue;
+            }
+            /* End of the line: make the last gap up to a word gap */
+            if(fillLength + 1 > STREAM_RUNS) {
+                break;
+            }
+            rxTail++;
+            fillLength += morse_encodeChar(' ', runs + fillLength);
+            lineOpen = 0;
+            spacePending = 0;
+            last = 1;
+            break;
+        }
+
+        if(c == ' ') {
+            spacePending = lineOpen;
+            rxTail++;
+            continue;
+        }
+
+        count = morse_encodeChar(c, letter);
+        if(count == 0) {
+            rxTail++;
+            continue;
+        }
+        if(fillLength + spacePending + count > STREAM_RUNS) {
+            break;
+        }
+        rxTail++;
+        if(spacePending) {
+            fillLength += morse_encodeChar(' ', runs + fillLength);
+            spacePending = 0;
+        }
+        memcpy(runs + fillLength, letter, count);
+        fillLength += count;
+        lineOpen = 1;
+    }
+
+    /* The sender has gone quiet without ending the line */
+    if(lineOpen && !last && rxTail == rxHead && holdUnits >= HOLD_TIMEOUT_UNITS
+       && fillLength + 1 <= STREAM_RUNS) {
+        fillLength += morse_encodeChar(' ', runs + fillLength);
+        lineOpen = 0;
+        spacePending = 0;
+        last = 1;
+    }
+
+    if(fillLength > 0) {
+        /* streamLast first: the timer takes the buffer once it has a length */
+        streamLast[fillBuffer] = last;
+        streamLength[fillBuffer] = fillLength;
+        fillBuffer ^= 1;
+        fillLength = 0;
+    }
+}
+
+/*
+ *  ======== putNumber ========
+ */
+static char *putNumber(char *p, unsigned int value)
+{
+    char digits[10];
+    unsigned int count = 0;
+
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while(value != 0);
+
+    while(count > 0) {
+        *p++ = digits[--count];
+    }
+    return p;
+}
+
+/*
+ *  ======== sendReport ========
+ *  Writes "NAME n interrupts, m ticks" for the last message played.
+ */
+void sendReport(void)
+{
+    static unsigned int reportsSent = 0;
+    char line[48];
+    char *p = line;
+    const char *name;
+    unsigned int count, interrupts, units;
+
+    /* Not in the middle of a received line */
+    if(receiving) {
+        return;
+    }
+
+    /* Copy again if the timer finished another message meanwhile */
+    do {
+        count = reportCount;
+        name = reportName;
+        interrupts = reportInterrupts;
+        units = reportUnits;
+    } while(count != reportCount);
+
+    if(count == reportsSent) {
+        return;
+    }
+    reportsSent = count;
+
+    while(*name != '\0') {
+        *p++ = *name++;
+    }
+    *p++ = ' ';
+    p = putNumber(p, interrupts);
+    memcpy(p, " interrupts, ", 13);
+    p += 13;
+    p = putNumber(p, units);
+    memcpy(p, " ticks\r\n", 8);
+    p += 8;
+
+    UART2_write(uart, line, (size_t)(p - line), NULL);
+}
+
+/*
+ *  ======== initClock ========
+ *  Free-running timer on timer1 that time-stamps the key edges and keeps
+ *  time for the sequencer.
+ */
+void initClock(void)
+{
+    Timer_Params params;
+
+    Timer_Params_init(&params);
+    params.period = 0xFFFFFFFF;
+    params.periodUnits = Timer_PERIOD_COUNTS;
+    params.timerMode = Timer_FREE_RUNNING;
+
+    clockTimer = Timer_open(CONFIG_TIMER_1, &params);
+
+    if(clockTimer == NULL || Timer_start(clockTimer) == Timer_STATUS_ERROR) {
+        /* Failed to start the clock */
+        while (1) {}
+    }
+}
+
+/*
+ *  ======== clockMs ========
+ *  Milliseconds since start for a count of clockTimer, which wraps every
+ *  53 s; mainThread wakes far more often than that. A count from just
+ *  before the last one (an edge that came in while the key was being
+ *  polled) gives the same time again.
+ */
+static uint32_t clockMs(uint32_t count)
+{
+    static uint32_t lastCount = 0;
+    static uint32_t ms = 0;
+    static uint32_t remainder = 0;
+    uint32_t delta = count - lastCount;
+
+    if(delta > 0xFF000000) {
+        return ms;
+    }
+    delta += remainder;
+    ms += delta / COUNTS_PER_MS;
+    remainder = delta % COUNTS_PER_MS;
+    lastCount = count;
+    return ms;
+}
+
+/*
+ *  ======== keyCallback ========
+ *  Time-stamps an SW3 edge; the button pulls the pin low.
+ */
+void keyCallback(uint_least8_t index)
+{
+    uint8_t head = keyHead;
+
+    if((uint8_t)(head - keyTail) == KEY_RING_SIZE) {
+        keyDropped++;
+        return;
+    }
+    keyRing[head & (KEY_RING_SIZE - 1)].count = Timer_getCount(clockTimer);
+    keyRing[head & (KEY_RING_SIZE - 1)].pressed = (GPIO_read(index) == 0);
+    keyHead = head + 1;
+}
+
+/*
+ *  ======== sendReceived ========
+ *  Writes decoded characters, starting a line with "RX " and ending it
+ *  with the speed.
+ */
+static void sendReceived(const char *text, unsigned int count)
+{
+    char line[16];
+    char *p;
+    unsigned int i;
+
+    for(i = 0; i < count; i++) {
+        p = line;
+        if(!receiving) {
+            memcpy(p, "RX ", 3);
+            p += 3;
+            receiving = 1;
+        }
+        if(text[i] == '\n') {
+            memcpy(p, " (", 2);
+            p = putNumber(p + 2, decoder_wpm(&decoder));
+            memcpy(p, " WPM)\r\n", 7);
+            p += 7;
+            receiving = 0;
+        }
+        else {
+            *p++ = text[i];
+            if(text[i] != ' ') {
+                startPattern(&letterPattern, PRIORITY_MORSE);
+            }
+        }
+        UART2_write(uart, line, (size_t)(p - line), NULL);
+    }
+}
+
+/*
+ *  ======== receiveKey ========
+ *  Decodes the key edges that have come in, then checks whether the key
+ *  has been up long enough to end the letter or the line.
+ */
+void receiveKey(void)
+{
+    char out[DECODER_MAX_OUT];
+    unsigned int n;
+
+    while(keyTail != keyHead) {
+        uint8_t tail = keyTail;
+
+        n = decoder_edge(&decoder, clockMs(keyRing[tail & (KEY_RING_SIZE - 1)].count),
+                         keyRing[tail & (KEY_RING_SIZE - 1)].pressed, out);
+        keyTail = tail + 1;
+        sendReceived(out, n);
+    }
+
+    n = decoder_poll(&decoder, clockMs(Timer_getCount(clockTimer)), out);
+    sendReceived(out, n);
+}
+
+/*
+ *  ======== pushButtonCallback ========
+ *  Callback function for the GPIO interrupt
+ */
+void pushButtonCallback(uint_least8_t index)
+{
+    switch(PushButton) {
+        case SOS:
+            PushButton = OK;
+            break;
+
+        case OK:
+            PushButton = SOS;
+            break;
+
+    }
+
+    startPattern(&flashPattern, PRIORITY_FLASH);
+}
+
+/*
+ *  ======== mainThread ========
+ */
+void *mainThread(void *arg0)
+{
+    uintptr_t key;
+
+    /* Start on the SOS message */
+    playRuns = messages[SOS].runs;
+    playLength = messages[SOS].length;
+
+    /* Call driver init functions for GPIO, timers, PWM and UART */
+    GPIO_init();
+    Timer_init();
+    initTimer();
+    initClock();
+    initPWM();
+    initUART();
+    decoder_init(&decoder, clockMs(Timer_getCount(clockTimer)), DECODER_DEFAULT_DOT_MS);
+
+    /* Configure the LED and button pins */
+    GPIO_setConfig(CONFIG_GPIO_LED_0, GPIO_CFG_OUT_STD | GPIO_CFG_OUT_LOW);
+    GPIO_setConfig(CONFIG_GPIO_LED_1, GPIO_CFG_OUT_STD | GPIO_CFG_OUT_LOW);
+    GPIO_setConfig(CONFIG_GPIO_BUTTON_0, GPIO_CFG_IN_PU | GPIO_CFG_IN_INT_FALLING);
+
+    /* Start with LEDs off */
+    //GPIO_write(CONFIG_GPIO_LED_0, CONFIG_GPIO_LED_OFF);
+    //GPIO_write(CONFIG_GPIO_LED_1, CONFIG_GPIO_LED_OFF);
+
+    /* Set initial states to SOS_MESSAGE */
+    PushButton = SOS;
+    MachineState = PushButton;
+
+    /* LEDs off, then start the Morse player */
+    key = HwiP_disable();
+    seq_init(setChannel);
+    sequencerCount = Timer_getCount(clockTimer);
+    seq_playSource(morseSource, NULL, PRIORITY_MORSE);
+    runSequencer();
+    HwiP_restore(key);
+
+    /* Install Button callback */
+    GPIO_setCallback(CONFIG_GPIO_BUTTON_0, pushButtonCallback);
+
+    /* Enable interrupts */
+    GPIO_enableInt(CONFIG_GPIO_BUTTON_0);
+
+    /*
+     *  If more than one input pin is available for your device, BUTTON1
+     *  is the Morse key, interrupting on press and release.
+     */
+    if (CONFIG_GPIO_BUTTON_0 != CONFIG_GPIO_BUTTON_1) {
+        /* Configure BUTTON1 pin */
+        GPIO_setConfig(CONFIG_GPIO_BUTTON_1, GPIO_CFG_IN_PU | GPIO_CFG_IN_INT_BOTH_EDGES);
+
+        /* Install key callback */
+        GPIO_setCallback(CONFIG_GPIO_BUTTON_1, keyCallback);
+        GPIO_enableInt(CONFIG_GPIO_BUTTON_1);
+    }
+
+    /*
+     * Encode text from the UART as it arrives, then sleep until the next
+     * interrupt. Something arriving just before the sleep waits for the
+     * next sequencer step at the latest, and so does the end of a letter
+     * keyed on SW3.
+     */
+    while(1) {
+        streamText();
+        receiveKey();
+        sendReport();
+        Power_idleFunc();
+    }
+}
@@ -0,0 +1,93 @@
+/*
+ * Robert Murphy
+ * CS 350 Milestone 3
+ */
+
+/*
+ *  ======== morse.c ========
+ *
+ *  Run-time Morse encoder and decoder. See morse.h.
+ */
+
+#include "morse.h"
+
+/*
+ * Codes for ' ' to '_', one byte each. The elements are read from bit 0
+ * up (0 = dot, 1 = dash) until only the leading 1 is left; 0 means no
+ * code. tools/morsegen.c checks this table against its own.
+ */
+static const uint8_t codes[64] = {
+    0x00, 0x75, 0x52, 0x00,   /*    ! -.-.--  " .-..-.  # */
+    0x00, 0x00, 0x22, 0x5E,   /* $  %  & .-...  ' .----. */
+    0x2D, 0x6D, 0x00, 0x2A,   /* ( -.--.  ) -.--.-  *  + .-.-. */
+    0x73, 0x61, 0x6A, 0x29,   /* , --..--  - -....-  . .-.-.-  / -..-. */
+    0x3F, 0x3E, 0x3C, 0x38,   /* 0 -----  1 .----  2 ..---  3 ...-- */
+    0x30, 0x20, 0x21, 0x23,   /* 4 ....-  5 .....  6 -....  7 --... */
+    0x27, 0x2F, 0x47, 0x55,   /* 8 ---..  9 ----.  : ---...  ; -.-.-. */
+    0x00, 0x31, 0x00, 0x4C,   /* <  = -...-  >  ? ..--.. */
+    0x56, 0x06, 0x11, 0x15,   /* @ .--.-.  A .-  B -...  C -.-. */
+    0x09, 0x02, 0x14, 0x0B,   /* D -..  E .  F ..-.  G --. */
+    0x10, 0x04, 0x1E, 0x0D,   /* H ....  I ..  J .---  K -.- */
+    0x12, 0x07, 0x05, 0x0F,   /* L .-..  M --  N -.  O --- */
+    0x16, 0x1B, 0x0A, 0x08,   /* P .--.  Q --.-  R .-.  S ... */
+    0x03, 0x0C, 0x18, 0x0E,   /* T -  U ..-  V ...-  W .-- */
+    0x19, 0x1D, 0x13, 0x00,   /* X -..-  Y -.--  Z --..  [ */
+    0x00, 0x00, 0x00, 0x6C,   /* \  ]  ^  _ ..--.- */
+};
+
+/*
+ *  ======== morse_encodeChar ========
+ */
+unsigned int morse_encodeChar(char c, uint8_t *runs)
+{
+    unsigned int count = 0;
+    uint8_t code;
+
+    if (c == ' ')
+    {
+        runs[0] = MORSE_RUN(OFF, MORSE_WORD_GAP - MORSE_LETTER_GAP);
+        return 1;
+    }
+    if (c >= 'a' && c <= 'z')
+    {
+        c -= 'a' - 'A';
+    }
+    if (c < ' ' || c > '_' || (code = codes[c - ' ']) == 0)
+    {
+        return 0;
+    }
+
+    for (; code > 1; code >>= 1)
+    {
+        if (count > 0)
+        {
+            runs[count++] = MORSE_RUN(OFF, MORSE_ELEMENT_GAP);
+        }
+        runs[count++] = (code & 1) ? MORSE_RUN(DASH, MORSE_DASH_UNITS)
+                                   : MORSE_RUN(DOT, MORSE_DOT_UNITS);
+    }
+    runs[count++] = MORSE_RUN(OFF, MORSE_LETTER_GAP);
+
+    return count;
+}
+
+/*
+ *  ======== morse_decodeCode ========
+ */
+char morse_decodeCode(uint8_t code)
+{
+    unsigned int i;
+
+    if (code <= 1)
+    {
+        return 0;
+    }
+    for (i = 0; i < sizeof(codes); i++)
+    {
+        if (codes[i] == code)
+        {
+            return (char)(' ' + i);
+        }
+    }
+    return 0;
+}
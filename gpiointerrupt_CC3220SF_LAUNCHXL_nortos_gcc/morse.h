@@ -0,0 +1,65 @@
+/*
+ * Robert Murphy
+ * CS 350 Milestone 3
+ */
+
+/*
+ *  ======== morse.h ========
+ *
+ *  Morse messages are stored in flash as runs: one byte for each stretch
+ *  of time the LEDs stay in one state,
+ *
+ *      bits 7-6  CodeState (DOT = red on, DASH = green on, OFF = both off)
+ *      bits 5-0  length in time units (1 - 63)
+ *
+ *  with the standard (ITU) timing: a dot is one unit, a dash three, the
+ *  gap inside a letter one unit, between letters three and between words
+ *  (and after the end of the message) seven.
+ *
+ *  The run tables for the built-in messages are generated from
+ *  messages.def by tools/morsegen.c into morse_table.h; other text is
+ *  encoded as it arrives with morse_encodeChar().
+ */
+
+#ifndef MORSE_H_
+#define MORSE_H_
+
+#include <stdint.h>
+
+/* LED code states */
+enum CodeStates {DOT, DASH, OFF};
+
+/* Timing, in units */
+#define MORSE_DOT_UNITS     1
+#define MORSE_DASH_UNITS    3
+#define MORSE_ELEMENT_GAP   1
+#define MORSE_LETTER_GAP    3
+#define MORSE_WORD_GAP      7
+#define MORSE_MAX_UNITS     63
+
+#define MORSE_RUN(state, units)   ((uint8_t)(((state) << 6) | (units)))
+#define MORSE_RUN_STATE(run)      ((enum CodeStates)((run) >> 6))
+#define MORSE_RUN_UNITS(run)      ((run) & 0x3F)
+
+/* Most runs morse_encodeChar() can produce for one character */
+#define MORSE_CHAR_RUNS     12
+
+/*
+ *  ======== morse_encodeChar ========
+ *  Run-time encoder for text that is not known at build time. Writes the
+ *  runs for c to runs[] and returns how many there are, 0 if c has no
+ *  Morse code. A letter is followed by the three unit letter gap; a space
+ *  adds the four units that make that up to a word gap. Lower case is
+ *  sent as upper case.
+ */
+unsigned int morse_encodeChar(char c, uint8_t *runs);
+
+/*
+ *  ======== morse_decodeCode ========
+ *  The other direction, for received Morse. code holds the elements of
+ *  one letter, the first in bit 0 (0 = dot, 1 = dash), with a 1 above the
+ *  last: ".-" is 0x06. Returns the character, or 0 if there is none.
+ */
+char morse_decodeCode(uint8_t code);
+
+#endif /* MORSE_H_ */
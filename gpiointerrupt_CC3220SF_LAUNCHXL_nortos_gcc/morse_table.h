@@ -0,0 +1,26 @@
+/*
+ *  ======== morse_table.h ========
+ *
+ *  DO NOT EDIT - generated by tools/morsegen.c from messages.def.
+ *  Run format and timing: see morse.h.
+ */
+
+#ifndef MORSE_TABLE_H_
+#define MORSE_TABLE_H_
+
+#include "morse.h"
+
+/* "SOS": 18 runs, 34 units */
+static const uint8_t morseSOS[18] = {
+    MORSE_RUN(DOT, 1), MORSE_RUN(OFF, 1), MORSE_RUN(DOT, 1), MORSE_RUN(OFF, 1), MORSE_RUN(DOT, 1), MORSE_RUN(OFF, 3),
+    MORSE_RUN(DASH, 3), MORSE_RUN(OFF, 1), MORSE_RUN(DASH, 3), MORSE_RUN(OFF, 1), MORSE_RUN(DASH, 3), MORSE_RUN(OFF, 3),
+    MORSE_RUN(DOT, 1), MORSE_RUN(OFF, 1), MORSE_RUN(DOT, 1), MORSE_RUN(OFF, 1), MORSE_RUN(DOT, 1), MORSE_RUN(OFF, 7),
+};
+
+/* "OK": 12 runs, 30 units */
+static const uint8_t morseOK[12] = {
+    MORSE_RUN(DASH, 3), MORSE_RUN(OFF, 1), MORSE_RUN(DASH, 3), MORSE_RUN(OFF, 1), MORSE_RUN(DASH, 3), MORSE_RUN(OFF, 3),
+    MORSE_RUN(DASH, 3), MORSE_RUN(OFF, 1), MORSE_RUN(DOT, 1), MORSE_RUN(OFF, 1), MORSE_RUN(DASH, 3), MORSE_RUN(OFF, 7),
+};
+
+#endif /* MORSE_TABLE_H_ */
@@ -0,0 +1,302 @@
+/*
+ * Robert Murphy
+ * CS 350 Milestone 3
+ */
+
+/*
+ *  ======== sequencer.c ========
+ *
+ *  Keyframe LED sequencer. See sequencer.h.
+ */
+
+#include <stddef.h>
+
+#include "sequencer.h"
+
+typedef struct {
+    const SeqPattern *pattern;
+    SeqSource source;
+    void *arg;
+    uint32_t nextKey;           // time the next keyframe is due
+    uint16_t index;             // next keyframe of pattern
+    uint8_t active;
+    uint8_t priority;
+    uint8_t owned;              // channels this track has set
+    uint8_t fading;             // channels fading
+    uint8_t level[SEQ_MAX_CHANNELS];
+    uint8_t from[SEQ_MAX_CHANNELS];
+    uint8_t to[SEQ_MAX_CHANNELS];
+    uint16_t fadeMs[SEQ_MAX_CHANNELS];
+    uint32_t fadeStart[SEQ_MAX_CHANNELS];
+} Track;
+
+static Track tracks[SEQ_MAX_TRACKS];
+static SeqOutput output;
+static uint32_t now = 0;
+static uint8_t shown[SEQ_MAX_CHANNELS];
+
+/*
+ *  ======== start ========
+ */
+static int start(const SeqPattern *pattern, SeqSource source, void *arg, uint8_t priority)
+{
+    int i;
+
+    for (i = 0; i < SEQ_MAX_TRACKS; i++)
+    {
+        Track *t = &tracks[i];
+
+        if (!t->active)
+        {
+            t->pattern = pattern;
+            t->source = source;
+            t->arg = arg;
+            t->nextKey = now;
+            t->index = 0;
+            t->priority = priority;
+            t->owned = 0;
+            t->fading = 0;
+            t->active = 1;
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ *  ======== fetch ========
+ */
+static int fetch(Track *t, SeqKey *key)
+{
+    if (t->source != NULL)
+    {
+        return t->source(t->arg, key);
+    }
+    if (t->index == t->pattern->length)
+    {
+        if (!t->pattern->repeat || t->pattern->length == 0)
+        {
+            return 0;
+        }
+        t->index = 0;
+    }
+    *key = t->pattern->keys[t->index++];
+    return 1;
+}
+
+/*
+ *  ======== startKey ========
+ *  A fade starts from what the channel shows if the track has not set
+ *  it before.
+ */
+static void startKey(Track *t, const SeqKey *key)
+{
+    unsigned int channel = key->channel;
+    uint8_t bit;
+
+    if (channel >= SEQ_MAX_CHANNELS)
+    {
+        return;
+    }
+    bit = (uint8_t)(1u << channel);
+    if (!(t->owned & bit))
+    {
+        t->level[channel] = shown[channel];
+        t->owned |= bit;
+    }
+
+    if (key->fadeMs == 0)
+    {
+        t->level[channel] = key->level;
+        t->fading &= (uint8_t)~bit;
+    }
+    else
+    {
+        t->from[channel] = t->level[channel];
+        t->to[channel] = key->level;
+        t->fadeMs[channel] = key->fadeMs;
+        t->fadeStart[channel] = t->nextKey;
+        t->fading |= bit;
+    }
+}
+
+/*
+ *  ======== stepFades ========
+ *  Returns the ms until the next fade step is due, or SEQ_MAX_WAIT_MS.
+ */
+static uint32_t stepFades(Track *t)
+{
+    uint32_t wait = SEQ_MAX_WAIT_MS;
+    unsigned int channel;
+
+    for (channel = 0; channel < SEQ_MAX_CHANNELS; channel++)
+    {
+        uint32_t done;
+
+        if (!(t->fading & (1u << channel)))
+        {
+            continue;
+        }
+        done = now - t->fadeStart[channel];
+        if (done >= t->fadeMs[channel])
+        {
+            t->level[channel] = t->to[channel];
+            t->fading &= (uint8_t)~(1u << channel);
+            continue;
+        }
+        t->level[channel] = (uint8_t)(t->from[channel]
+            + ((int32_t)t->to[channel] - t->from[channel]) * (int32_t)done / t->fadeMs[channel]);
+
+        // Land exactly on the end of the fade
+        done = t->fadeMs[channel] - done;
+        if (done > SEQ_FADE_STEP_MS)
+        {
+            done = SEQ_FADE_STEP_MS;
+        }
+        if (done < wait)
+        {
+            wait = done;
+        }
+    }
+    return wait;
+}
+
+/*
+ *  ======== show ========
+ */
+static void show(void)
+{
+    unsigned int channel;
+
+    for (channel = 0; channel < SEQ_MAX_CHANNELS; channel++)
+    {
+        const Track *top = NULL;
+        uint8_t level = 0;
+        int i;
+
+        for (i = 0; i < SEQ_MAX_TRACKS; i++)
+        {
+            const Track *t = &tracks[i];
+
+            if (t->active && (t->owned & (1u << channel))
+                && (top == NULL || t->priority > top->priority))
+            {
+                top = t;
+            }
+        }
+        if (top != NULL)
+        {
+            level = top->level[channel];
+        }
+        if (level != shown[channel])
+        {
+            shown[channel] = level;
+            output(channel, level);
+        }
+    }
+}
+
+/*
+ *  ======== seq_init ========
+ */
+void seq_init(SeqOutput fxn)
+{
+    unsigned int channel;
+    int i;
+
+    output = fxn;
+    for (i = 0; i < SEQ_MAX_TRACKS; i++)
+    {
+        tracks[i].active = 0;
+    }
+    for (channel = 0; channel < SEQ_MAX_CHANNELS; channel++)
+    {
+        shown[channel] = 0;
+        output(channel, 0);
+    }
+}
+
+/*
+ *  ======== seq_play ========
+ */
+int seq_play(const SeqPattern *pattern, uint8_t priority)
+{
+    return start(pattern, NULL, NULL, priority);
+}
+
+/*
+ *  ======== seq_playSource ========
+ */
+int seq_playSource(SeqSource source, void *arg, uint8_t priority)
+{
+    return start(NULL, source, arg, priority);
+}
+
+/*
+ *  ======== seq_stop ========
+ */
+void seq_stop(int track)
+{
+    if (track >= 0 && track < SEQ_MAX_TRACKS)
+    {
+        tracks[track].active = 0;
+    }
+}
+
+/*
+ *  ======== seq_advance ========
+ */
+uint32_t seq_advance(uint32_t elapsedMs)
+{
+    uint32_t wait = SEQ_MAX_WAIT_MS;
+    int playing = 0;
+    int i;
+
+    now += elapsedMs;
+
+    for (i = 0; i < SEQ_MAX_TRACKS; i++)
+    {
+        Track *t = &tracks[i];
+        unsigned int keys = 0;
+        uint32_t due;
+
+        // Start what is due; keyframes with no wait go together
+        while (t->active && (int32_t)(now - t->nextKey) >= 0 && keys < SEQ_KEYS_PER_STEP)
+        {
+            SeqKey key;
+
+            if (!fetch(t, &key))
+            {
+                t->active = 0;
+                break;
+            }
+            startKey(t, &key);
+            t->nextKey += key.waitMs;
+            keys++;
+        }
+        if (!t->active)
+        {
+            continue;
+        }
+        playing = 1;
+
+        due = stepFades(t);
+        if (due < wait)
+        {
+            wait = due;
+        }
+        due = ((int32_t)(t->nextKey - now) > 0) ? t->nextKey - now : 0;
+        if (due < wait)
+        {
+            wait = due;
+        }
+    }
+
+    show();
+
+    if (!playing)
+    {
+        return SEQ_IDLE;
+    }
+    return (wait > 0) ? wait : 1;
+}
@@ -0,0 +1,105 @@
+/*
+ * Robert Murphy
+ * CS 350 Milestone 3
+ */
+
+/*
+ *  ======== sequencer.h ========
+ *
+ *  LED pattern sequencer. A pattern is a list of keyframes. Each one
+ *  sets one output channel to a level (0 - 255), at once or fading there
+ *  over fadeMs, and then waits waitMs before the next keyframe starts:
+ *
+ *      SEQ_KEY(channel, level, fadeMs, waitMs)
+ *
+ *  A wait of 0 starts the next keyframe at the same time, so several
+ *  channels can change together. A pattern is either a const table in
+ *  flash or a source function that makes its keyframes as they are
+ *  needed (the Morse player is one).
+ *
+ *  Up to SEQ_MAX_TRACKS patterns play at once, each with a priority. A
+ *  channel shows the level from the highest priority pattern that has
+ *  set it. When that pattern ends, the channel goes back to the next one
+ *  down, or to 0.
+ *
+ *  The engine has no timer of its own. seq_advance() is given the time
+ *  that has passed and returns how long until it has to run again: the
+ *  next keyframe, or SEQ_FADE_STEP_MS while something is fading. Outputs
+ *  are only written when their level changes. Each call starts at most
+ *  SEQ_KEYS_PER_STEP keyframes per pattern, so its run time is bounded.
+ *
+ *  Not reentrant: call it from one context, or with interrupts disabled.
+ */
+
+#ifndef SEQUENCER_H_
+#define SEQUENCER_H_
+
+#include <stdint.h>
+
+#define SEQ_MAX_CHANNELS    4
+#define SEQ_MAX_TRACKS      4
+#define SEQ_FADE_STEP_MS    20
+#define SEQ_MAX_WAIT_MS     30000
+#define SEQ_KEYS_PER_STEP   16
+
+/* From seq_advance(): nothing is playing */
+#define SEQ_IDLE            0
+
+typedef struct {
+    uint8_t channel;
+    uint8_t level;
+    uint16_t fadeMs;            // 0: set the level at once
+    uint16_t waitMs;            // until the next keyframe starts
+} SeqKey;
+
+#define SEQ_KEY(channel, level, fadeMs, waitMs) { (channel), (level), (fadeMs), (waitMs) }
+
+typedef struct {
+    const SeqKey *keys;
+    uint16_t length;
+    uint8_t repeat;             // start over at the end instead of stopping
+} SeqPattern;
+
+#define SEQ_PATTERN(keys, repeat) { (keys), sizeof(keys) / sizeof((keys)[0]), (repeat) }
+
+/* Makes the next keyframe in *key; returns 0 when the pattern is over */
+typedef int (*SeqSource)(void *arg, SeqKey *key);
+
+/* Sets a channel's output */
+typedef void (*SeqOutput)(unsigned int channel, uint8_t level);
+
+/*
+ *  ======== seq_init ========
+ *  Stops everything and sets every channel to 0.
+ */
+void seq_init(SeqOutput output);
+
+/*
+ *  ======== seq_play ========
+ *  Starts a pattern. Its first keyframe is due at the time of the last
+ *  seq_advance(), so call that first if time has passed since. Returns
+ *  the track it plays on, or -1 if all tracks are busy. The higher the
+ *  priority, the more it takes precedence.
+ */
+int seq_play(const SeqPattern *pattern, uint8_t priority);
+
+/*
+ *  ======== seq_playSource ========
+ */
+int seq_playSource(SeqSource source, void *arg, uint8_t priority);
+
+/*
+ *  ======== seq_stop ========
+ *  Its channels are given back at the next seq_advance().
+ */
+void seq_stop(int track);
+
+/*
+ *  ======== seq_advance ========
+ *  Moves time on by elapsedMs: starts the keyframes that are due, steps
+ *  fades and updates the outputs. Returns the ms until the next call is
+ *  needed, or SEQ_IDLE.
+ */
+uint32_t seq_advance(uint32_t elapsedMs);
+
+#endif /* SEQUENCER_H_ */
@@ -0,0 +1,30 @@
+/*
+ *  ======== cycles.h ========
+ *
+ *  Cortex-M4 debug cycle counter, for timing code to the CPU cycle. It
+ *  counts at the CPU clock and wraps every 2^32 cycles (53 s at 80 MHz);
+ *  differences of two readings are right across one wrap.
+ */
+
+#ifndef CYCLES_H_
+#define CYCLES_H_
+
+#include <stdint.h>
+
+#define CYCLES_DEMCR          (*(volatile uint32_t *)0xE000EDFC)
+#define CYCLES_DEMCR_TRCENA   (1u << 24)
+#define CYCLES_DWT_CTRL       (*(volatile uint32_t *)0xE0001000)
+#define CYCLES_DWT_CYCCNTENA  (1u << 0)
+#define CYCLES_DWT_CYCCNT     (*(volatile uint32_t *)0xE0001004)
+
+/* Starts the counter; harmless if it is already running */
+#define CYCLES_ENABLE()                                 \
+    do                                                  \
+    {                                                   \
+        CYCLES_DEMCR |= CYCLES_DEMCR_TRCENA;            \
+        CYCLES_DWT_CTRL |= CYCLES_DWT_CYCCNTENA;        \
+    } while (0)
+
+#define CYCLES_NOW() CYCLES_DWT_CYCCNT
+
+#endif /* CYCLES_H_ */
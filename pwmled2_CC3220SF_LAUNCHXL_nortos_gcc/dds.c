@@ -0,0 +1,80 @@
+/*
+ *  ======== dds.c ========
+ *
+ *  Phase accumulator tone synthesis. See dds.h.
+ */
+
+#include "dds.h"
+
+/*
+ *  ======== dds_init ========
+ */
+void dds_init(DdsVoice *v, const int16_t *table, uint8_t tableBits)
+{
+    v->table = table;
+    v->tableBits = tableBits;
+    v->phase = 0;
+    v->increment = 0;
+    v->amplitude = 32767;
+}
+
+/*
+ *  ======== dds_setFrequency ========
+ *  increment = frequency * 2^32 / sampleRate, rounded.
+ */
+void dds_setFrequency(DdsVoice *v, uint32_t milliHz, uint32_t sampleRate)
+{
+    uint64_t rate = (uint64_t)sampleRate * 1000;
+
+    v->increment = (uint32_t)((((uint64_t)milliHz << 32) + rate / 2) / rate);
+}
+
+/*
+ *  ======== dds_setAmplitude ========
+ */
+void dds_setAmplitude(DdsVoice *v, int16_t amplitude)
+{
+    v->amplitude = amplitude;
+}
+
+/*
+ *  ======== dds_next ========
+ *  The top tableBits of the phase pick the entry, the next 15 bits say
+ *  how far to go towards the one after it.
+ */
+int16_t dds_next(DdsVoice *v)
+{
+    uint32_t phase = v->phase;
+    int32_t sample;
+
+    v->phase = phase + v->increment;
+
+    if (v->table == NULL)
+    {
+        sample = (phase & 0x80000000u) ? -32767 : 32767;
+    }
+    else
+    {
+        unsigned int shift = 32u - v->tableBits;
+        uint32_t mask = (1u << v->tableBits) - 1;
+        uint32_t index = phase >> shift;
+        int32_t fraction = (int32_t)((phase << v->tableBits) >> 17);
+        int32_t a = v->table[index];
+        int32_t b = v->table[(index + 1) & mask];
+
+        sample = a + (((b - a) * fraction) >> 15);
+    }
+
+    return (int16_t)((sample * v->amplitude) >> 15);
+}
+
+/*
+ *  ======== dds_fill ========
+ */
+void dds_fill(DdsVoice *v, int16_t *out, size_t count)
+{
+    while (count-- > 0)
+    {
+        *out++ = dds_next(v);
+    }
+}
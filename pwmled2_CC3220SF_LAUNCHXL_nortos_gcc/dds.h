@@ -0,0 +1,66 @@
+/*
+ *  ======== dds.h ========
+ *
+ *  Direct digital synthesis of tones. A 32-bit phase accumulator steps
+ *  through one cycle of a wavetable every 2^32 / increment samples, so
+ *  any frequency up to half the sample rate comes out with a resolution
+ *  of sampleRate / 2^32 (under 4 uHz at 16 kHz), and the table is read
+ *  at whatever speed that needs.
+ *
+ *  Tables hold one cycle of 2^tableBits (2 to 2^16) signed Q15 samples,
+ *  const so they stay in flash; dds_tables.h has a sine. Samples between table entries
+ *  are interpolated linearly. A NULL table gives a square wave straight
+ *  from the top bit of the phase (not band limited: expect aliases of the
+ *  harmonics above half the sample rate).
+ *
+ *  Pure integer C with no driver calls, so the same code runs on the
+ *  host (tools/ddsspectrum.c checks its spectrum and speed); tone.c plays
+ *  it on a PWM output.
+ */
+
+#ifndef DDS_H_
+#define DDS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    const int16_t *table;       // NULL: square wave
+    uint32_t phase;
+    uint32_t increment;         // phase step per sample
+    uint8_t tableBits;
+    int16_t amplitude;          // Q15 gain
+} DdsVoice;
+
+/*
+ *  ======== dds_init ========
+ *  Full amplitude, 0 Hz, phase 0.
+ */
+void dds_init(DdsVoice *v, const int16_t *table, uint8_t tableBits);
+
+/*
+ *  ======== dds_setFrequency ========
+ *  frequency is in milli-Hz, below half of sampleRate (Hz). The phase
+ *  carries on, so a change of frequency does not click.
+ */
+void dds_setFrequency(DdsVoice *v, uint32_t milliHz, uint32_t sampleRate);
+
+/*
+ *  ======== dds_setAmplitude ========
+ *  Q15: 32767 is full scale.
+ */
+void dds_setAmplitude(DdsVoice *v, int16_t amplitude);
+
+/*
+ *  ======== dds_next ========
+ *  Returns the next sample, Q15.
+ */
+int16_t dds_next(DdsVoice *v);
+
+/*
+ *  ======== dds_fill ========
+ *  Writes the next count samples to out.
+ */
+void dds_fill(DdsVoice *v, int16_t *out, size_t count);
+
+#endif /* DDS_H_ */
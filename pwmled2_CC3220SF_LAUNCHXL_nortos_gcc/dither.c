@@ -0,0 +1,27 @@
+/*
+ *  ======== dither.c ========
+ *
+ *  Sigma-delta duty dithering. See dither.h.
+ */
+
+#include "dither.h"
+
+/*
+ *  ======== dither_init ========
+ */
+void dither_init(Dither *d, uint8_t fractionBits)
+{
+    d->residual = 0;
+    d->bits = fractionBits;
+}
+
+/*
+ *  ======== dither_next ========
+ */
+uint32_t dither_next(Dither *d, uint32_t target)
+{
+    uint32_t sum = d->residual + target;
+
+    d->residual = sum & ((1u << d->bits) - 1);
+    return sum >> d->bits;
+}
@@ -0,0 +1,50 @@
+/*
+ *  ======== dither.h ========
+ *
+ *  Temporal dithering for finer PWM duty than the timer can set. The
+ *  target duty carries fractionBits extra bits below the PWM's own duty
+ *  unit, and dither_next() gives the whole-unit duty for each PWM period
+ *  in turn. It is a first order sigma-delta modulator: the part of the
+ *  target that a period could not show is carried into the next one, so
+ *  the outputs never stray more than one unit from the running total of
+ *  the targets and their average converges on the target.
+ *
+ *  With a 3000 us period in PWM_DUTY_COUNTS (240000 counts, 17.9 bits), 4
+ *  fraction bits give 1/1280 us steps, 21.9 bits on average. The average
+ *  is only exact over whole dither cycles, 2^fractionBits periods at
+ *  most, so keep that well under the eye's flicker limit, and only if
+ *  dither_next() is called exactly once per PWM period.
+ *
+ *  pwmled2 calls it from a timer that counts the same 80 MHz clock as the
+ *  PWM but is not locked to the PWM period, so a tick that is held off
+ *  across a period boundary shows one duty twice and drops the next.
+ *  tools/dithermodel.c -d models that as a rate error between the two;
+ *  with -p 240000 -f 4 and -d 1000 to 10000 (a slip every 1000 to 100
+ *  periods) the worst average over 16 periods is 1/16 count (0.8 ns, 20.9
+ *  bits) off rather than exact, over 64 periods 1/64 count, and the sweep
+ *  steps are unaffected. Between slips it is exact again.
+ */
+
+#ifndef DITHER_H_
+#define DITHER_H_
+
+#include <stdint.h>
+
+typedef struct {
+    uint32_t residual;          // fraction carried into the next period
+    uint8_t bits;
+} Dither;
+
+/*
+ *  ======== dither_init ========
+ */
+void dither_init(Dither *d, uint8_t fractionBits);
+
+/*
+ *  ======== dither_next ========
+ *  Returns the duty for the next PWM period. target is in 1/2^bits of a
+ *  duty unit and must leave room for one more unit below 2^32.
+ */
+uint32_t dither_next(Dither *d, uint32_t target);
+
+#endif /* DITHER_H_ */
@@ -0,0 +1,60 @@
+/*
+ *  ======== lightness.h ========
+ *
+ *  Perceptual brightness curve for PWM LEDs. The eye does not see duty
+ *  linearly: a linear ramp seems to reach full brightness early and then
+ *  stall. LIGHTNESS_TABLE(levels, full) expands to the initializer of a
+ *  table that maps an evenly spaced perceptual level 0 - levels-1 to the
+ *  duty (0 - full) that gives that CIE 1976 lightness:
+ *
+ *      L = 100 * level / (levels - 1)
+ *      Y = ((L + 16) / 116)^3     L > 8
+ *      Y = L * 27 / 24389         L <= 8
+ *      duty = Y * full, rounded
+ *
+ *  The curve is worked out by the compiler, so the table costs nothing at
+ *  run time, sits in flash when declared const, and follows any change
+ *  to the period or duty units:
+ *
+ *      static const uint32_t curve[] = { LIGHTNESS_TABLE(64, 3000) };
+ *
+ *  levels must be a power of two from 2 to 1024 (it may be a macro that
+ *  expands to one). tools/lightness.c checks the tables against the curve
+ *  computed at run time on the host.
+ */
+
+#ifndef LIGHTNESS_H_
+#define LIGHTNESS_H_
+
+#include <stdint.h>
+
+#define LIGHTNESS_L(level, levels)  ((level) * 100.0 / ((levels) - 1))
+#define LIGHTNESS_CUBE(x)           ((x) * (x) * (x))
+
+/* Relative luminance, 0.0 - 1.0 */
+#define LIGHTNESS_Y(level, levels)                                          \
+    (LIGHTNESS_L(level, levels) > 8.0                                       \
+         ? LIGHTNESS_CUBE((LIGHTNESS_L(level, levels) + 16.0) / 116.0)      \
+         : LIGHTNESS_L(level, levels) * 27.0 / 24389.0)
+
+#define LIGHTNESS_DUTY(level, levels, full) \
+    ((uint32_t)((full) * LIGHTNESS_Y(level, levels) + 0.5))
+
+/* LIGHTNESS_Rn(level, ...) gives the entries for level to level + n - 1 */
+#define LIGHTNESS_R1(k, n, f)    LIGHTNESS_DUTY(k, n, f),
+#define LIGHTNESS_R2(k, n, f)    LIGHTNESS_R1(k, n, f)   LIGHTNESS_R1((k) + 1, n, f)
+#define LIGHTNESS_R4(k, n, f)    LIGHTNESS_R2(k, n, f)   LIGHTNESS_R2((k) + 2, n, f)
+#define LIGHTNESS_R8(k, n, f)    LIGHTNESS_R4(k, n, f)   LIGHTNESS_R4((k) + 4, n, f)
+#define LIGHTNESS_R16(k, n, f)   LIGHTNESS_R8(k, n, f)   LIGHTNESS_R8((k) + 8, n, f)
+#define LIGHTNESS_R32(k, n, f)   LIGHTNESS_R16(k, n, f)  LIGHTNESS_R16((k) + 16, n, f)
+#define LIGHTNESS_R64(k, n, f)   LIGHTNESS_R32(k, n, f)  LIGHTNESS_R32((k) + 32, n, f)
+#define LIGHTNESS_R128(k, n, f)  LIGHTNESS_R64(k, n, f)  LIGHTNESS_R64((k) + 64, n, f)
+#define LIGHTNESS_R256(k, n, f)  LIGHTNESS_R128(k, n, f) LIGHTNESS_R128((k) + 128, n, f)
+#define LIGHTNESS_R512(k, n, f)  LIGHTNESS_R256(k, n, f) LIGHTNESS_R256((k) + 256, n, f)
+#define LIGHTNESS_R1024(k, n, f) LIGHTNESS_R512(k, n, f) LIGHTNESS_R512((k) + 512, n, f)
+
+/* The extra level of expansion lets levels be a macro */
+#define LIGHTNESS_TABLE_(levels, full)  LIGHTNESS_R##levels(0, levels, full)
+#define LIGHTNESS_TABLE(levels, full)   LIGHTNESS_TABLE_(levels, full)
+
+#endif /* LIGHTNESS_H_ */
@@ -0,0 +1,168 @@
+/*
+ *  ======== pwmgroup.c ========
+ *
+ *  Synchronized multi-channel PWM updates. See pwmgroup.h.
+ */
+
+#include <ti/drivers/dpl/HwiP.h>
+
+#include "pwmgroup.h"
+
+/* General purpose timer registers; tools/pwmgroupcheck.c points them at
+ * a model of the timers */
+#ifndef GPT_REG
+#define GPT_REG(base, offset) (*(volatile uint32_t *)(uintptr_t)((base) + (offset)))
+#endif
+#define GPT_O_TAMR   0x04
+#define GPT_O_TBMR   0x08
+#define GPT_O_CTL    0x0C
+#define GPT_O_TAV    0x50
+#define GPT_O_TBV    0x54
+
+#define GPT_TNMR_TNILD   (1u << 8)      // load the period at timeout
+#define GPT_TNMR_TNMRSU  (1u << 10)     // load the match value at timeout
+#define GPT_CTL_TAEN     (1u << 0)
+#define GPT_CTL_TBEN     (1u << 8)
+
+/* In PWM mode the prescaler extends the counter to 24 bits */
+#define GPT_VALUE_MASK   0x00FFFFFF
+
+#define MODE_REG(o)   GPT_REG((o)->timerBase, ((o)->half == PWMGROUP_HALF_A) ? GPT_O_TAMR : GPT_O_TBMR)
+#define VALUE_REG(o)  GPT_REG((o)->timerBase, ((o)->half == PWMGROUP_HALF_A) ? GPT_O_TAV : GPT_O_TBV)
+#define ENABLE_BIT(o) (((o)->half == PWMGROUP_HALF_A) ? GPT_CTL_TAEN : GPT_CTL_TBEN)
+
+/*
+ *  ======== hasRoom ========
+ *  Member 0's counter runs down to 0 over each period; there is room if
+ *  enough of the period is left for the writes to land in it.
+ */
+static int hasRoom(const PwmGroup *g)
+{
+    return (VALUE_REG(&g->outputs[0]) & GPT_VALUE_MASK)
+           >= PWMGROUP_GUARD_US * PWMGROUP_COUNTS_PER_US;
+}
+
+/*
+ *  ======== realign ========
+ *  Restarts the members' counters with their phase offsets. Each counter
+ *  is set to what is left of its period when member 0's starts.
+ */
+static void realign(const PwmGroup *g)
+{
+    unsigned int i, j;
+
+    for (i = 0; i < g->count; i++)
+    {
+        const PwmGroupOutput *o = &g->outputs[i];
+
+        GPT_REG(o->timerBase, GPT_O_CTL) &= ~ENABLE_BIT(o);
+    }
+
+    for (i = 0; i < g->count; i++)
+    {
+        VALUE_REG(&g->outputs[i]) = (g->phase[i] == 0) ? g->periodCounts - 1
+                                                        : g->phase[i] - 1;
+    }
+
+    // One write per timer module, so both halves of a module start together
+    for (i = 0; i < g->count; i++)
+    {
+        uint32_t base = g->outputs[i].timerBase;
+        uint32_t enable = 0;
+
+        for (j = 0; j < i && g->outputs[j].timerBase != base; j++)
+        {
+        }
+        if (j < i)
+        {
+            continue;           // module already started
+        }
+        for (j = i; j < g->count; j++)
+        {
+            if (g->outputs[j].timerBase == base)
+            {
+                enable |= ENABLE_BIT(&g->outputs[j]);
+            }
+        }
+        GPT_REG(base, GPT_O_CTL) |= enable;
+    }
+}
+
+/*
+ *  ======== pwmgroup_init ========
+ */
+void pwmgroup_init(PwmGroup *g, const PwmGroupOutput *outputs, uint8_t count,
+                   uint32_t periodUs)
+{
+    unsigned int i;
+
+    g->outputs = outputs;
+    g->count = count;
+    g->stagedDuty = 0;
+    g->stagedPhase = 0;
+    g->periodCounts = periodUs * PWMGROUP_COUNTS_PER_US;
+
+    for (i = 0; i < count; i++)
+    {
+        g->phase[i] = 0;
+        MODE_REG(&outputs[i]) |= GPT_TNMR_TNILD | GPT_TNMR_TNMRSU;
+    }
+}
+
+/*
+ *  ======== pwmgroup_stageDuty ========
+ */
+void pwmgroup_stageDuty(PwmGroup *g, unsigned int member, uint32_t duty)
+{
+    g->duty[member] = duty;
+    g->stagedDuty |= 1u << member;
+}
+
+/*
+ *  ======== pwmgroup_stagePhase ========
+ */
+void pwmgroup_stagePhase(PwmGroup *g, unsigned int member, uint32_t offsetUs)
+{
+    g->phase[member] = offsetUs * PWMGROUP_COUNTS_PER_US;
+    g->stagedPhase = 1;
+}
+
+/*
+ *  ======== pwmgroup_commit ========
+ */
+void pwmgroup_commit(PwmGroup *g)
+{
+    uintptr_t key;
+    unsigned int i;
+
+    // Wait for room with interrupts on, then check again with them off:
+    // an interrupt in between may have used it up.
+    while (1)
+    {
+        while (!g->stagedPhase && g->stagedDuty != 0 && !hasRoom(g))
+        {
+        }
+        key = HwiP_disable();
+        if (g->stagedPhase || g->stagedDuty == 0 || hasRoom(g))
+        {
+            break;
+        }
+        HwiP_restore(key);
+    }
+
+    if (g->stagedPhase)
+    {
+        realign(g);
+        g->stagedPhase = 0;
+    }
+
+    for (i = 0; i < g->count; i++)
+    {
+        if (g->stagedDuty & (1u << i))
+        {
+            PWM_setDuty(g->outputs[i].pwm, g->duty[i]);
+        }
+    }
+    g->stagedDuty = 0;
+    HwiP_restore(key);
+}
@@ -0,0 +1,102 @@
+/*
+ *  ======== pwmgroup.h ========
+ *
+ *  Synchronized updates for PWM outputs that drive related loads (the
+ *  colours of one LED, paired heaters). Duty and phase changes for the
+ *  members of a group are staged, then pwmgroup_commit() makes them all
+ *  take effect at the same period boundary, so no period ever shows a
+ *  mix of old and new values.
+ *
+ *  The outputs are opened and started with the PWM driver as usual, all
+ *  with the same period. pwmgroup_init() then sets their general purpose
+ *  timers to load new match values only at the end of a period, and a
+ *  commit writes every staged duty inside one period, waiting for the
+ *  next one first if this one is too close to its end.
+ *
+ *  Members can be given phase offsets, so their pulses start at
+ *  different points of the period and the current they draw is spread
+ *  out. Committing a phase change stops the members' timers, sets each
+ *  counter to its offset and starts them again together; members on the
+ *  same timer module start in the same cycle, members on different
+ *  modules a few cycles apart. The outputs glitch once while that
+ *  happens, so change phases rarely.
+ *
+ *  The driver does not say which timer half is behind a PWM output, so
+ *  the group is told (PwmGroupOutput); assign the pins and timers in the
+ *  .syscfg so the two agree. On the CC3220SF LaunchPad:
+ *
+ *      pin 01  LED D9 (yellow)  GT_PWM06  TIMERA3 A
+ *      pin 02  LED D8 (green)   GT_PWM07  TIMERA3 B
+ *      pin 64  LED D10 (red)    GT_PWM05  TIMERA2 B
+ */
+
+#ifndef PWMGROUP_H_
+#define PWMGROUP_H_
+
+#include <stdint.h>
+
+#include <ti/drivers/PWM.h>
+
+#define PWMGROUP_MAX_MEMBERS 4
+
+/* General purpose timer modules */
+#define PWMGROUP_TIMERA0 0x40030000
+#define PWMGROUP_TIMERA1 0x40031000
+#define PWMGROUP_TIMERA2 0x40032000
+#define PWMGROUP_TIMERA3 0x40033000
+
+/* Timer clock */
+#define PWMGROUP_COUNTS_PER_US 80
+
+/* A commit needs this much of the period left to write every member */
+#define PWMGROUP_GUARD_US 25
+
+enum PWMGROUP_HALVES {PWMGROUP_HALF_A, PWMGROUP_HALF_B};
+
+typedef struct {
+    PWM_Handle pwm;
+    uint32_t timerBase;         // PWMGROUP_TIMERAn
+    uint8_t half;               // PWMGROUP_HALF_A or PWMGROUP_HALF_B
+} PwmGroupOutput;
+
+typedef struct {
+    const PwmGroupOutput *outputs;
+    uint8_t count;
+    uint8_t stagedDuty;         // bit per member
+    uint8_t stagedPhase;
+    uint32_t periodCounts;
+    uint32_t duty[PWMGROUP_MAX_MEMBERS];
+    uint32_t phase[PWMGROUP_MAX_MEMBERS];     // counts after member 0
+} PwmGroup;
+
+/*
+ *  ======== pwmgroup_init ========
+ *  outputs (count of them, at most PWMGROUP_MAX_MEMBERS) must stay in
+ *  place, be open and started, and share periodUs. Member 0 is the phase
+ *  reference. Phases start at 0 but take effect at the first commit.
+ */
+void pwmgroup_init(PwmGroup *g, const PwmGroupOutput *outputs, uint8_t count,
+                   uint32_t periodUs);
+
+/*
+ *  ======== pwmgroup_stageDuty ========
+ *  duty is in the units the member's output was opened with.
+ */
+void pwmgroup_stageDuty(PwmGroup *g, unsigned int member, uint32_t duty);
+
+/*
+ *  ======== pwmgroup_stagePhase ========
+ *  Delays member's period by offsetUs (less than the period) from member
+ *  0's.
+ */
+void pwmgroup_stagePhase(PwmGroup *g, unsigned int member, uint32_t offsetUs);
+
+/*
+ *  ======== pwmgroup_commit ========
+ *  Applies everything staged at the next period boundary. Safe from an
+ *  interrupt; it may spin for up to PWMGROUP_GUARD_US waiting for room
+ *  in the current period, but interrupts are only off for the writes.
+ */
+void pwmgroup_commit(PwmGroup *g);
+
+#endif /* PWMGROUP_H_ */
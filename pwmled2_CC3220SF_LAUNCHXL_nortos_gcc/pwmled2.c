@@ -36,6 +36,7 @@
 /* For usleep() */
 #include <unistd.h>
 #include <stddef.h>
+#include <stdint.h>
 
 /* Driver Header files */
 #include <ti/drivers/PWM.h>
@@ -43,20 +44,145 @@
 /* Driver configuration */
 #include "ti_drivers_config.h"
 
+/* Timer driven duty sweeps */
+#include "waveform.h"
+
+/* Compile-time perceptual brightness curve */
+#include "lightness.h"
+
+/* Updates that land on both LEDs at the same period boundary */
+#include "pwmgroup.h"
+
+/* DDS tone output and its sine table */
+#include "tone.h"
+#include "dds_tables.h"
+
+/* Set to 1 to step the sweep from mainThread with usleep() instead of
+ * from the waveform engine, to compare the update timing. */
+#ifndef SWEEP_USLEEP
+#define SWEEP_USLEEP 0
+#endif
+
+/* Set to 1 to play a sine tone on the first LED's pin instead of the
+ * sweep. 16 kHz samples on a 78.125 kHz, 10 bit PWM carrier. */
+#ifndef TONE_OUTPUT
+#define TONE_OUTPUT 0
+#endif
+
+#define TONE_SAMPLE_RATE   16000
+#define TONE_PERIOD_COUNTS 1024
+#define TONE_MILLIHZ       440000   // A4
+
+/* Period in microseconds; duty is set in timer counts, 1/80 us */
+#define PWM_PERIOD_US     3000
+#define PWM_PERIOD_COUNTS (PWM_PERIOD_US * PWMGROUP_COUNTS_PER_US)
+#define STEADY_DUTY_US    2700  // 90% of 3000 uS = 2700 uS
+
+/* One sweep step every 25 ms */
+#define SWEEP_STEP_US  25000
+#define SWEEP_RATE_HZ  (1000000 / SWEEP_STEP_US)
+
+/* Brightness levels the sweep steps through, evenly spaced to the eye */
+#define SWEEP_LEVELS   64
+
+/* The sweep's duty has this many bits below a timer count, shown on
+ * average by dithering across PWM periods: 1/1280 us, 21.9 bits over the
+ * period instead of the counts' 17.9. 0 sets whole counts only. */
+#define SWEEP_FRACTION_BITS 4
+
+/* Duty in 1/2^SWEEP_FRACTION_BITS counts for each level, worked out by
+ * the compiler */
+static const uint32_t lightness[] = {
+    LIGHTNESS_TABLE(SWEEP_LEVELS, PWM_PERIOD_COUNTS << SWEEP_FRACTION_BITS)
+};
+
+/* Fade in and out, in levels: about 3 seconds up and down */
+static const uint32_t sweep[] = {
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13,
+    14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27,
+    28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41,
+    42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55,
+    56, 57, 58, 59, 60, 61, 62, 63, 62, 61, 60, 59, 58, 57,
+    56, 55, 54, 53, 52, 51, 50, 49, 48, 47, 46, 45, 44, 43,
+    42, 41, 40, 39, 38, 37, 36, 35, 34, 33, 32, 31, 30, 29,
+    28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15,
+    14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1,
+};
+#define SWEEP_LENGTH (uint16_t)(sizeof(sweep) / sizeof(sweep[0]))
+
+/* Intervals between sweep updates, in CPU cycles; watch it from the
+ * debugger. At 80 MHz a 25 ms step is 2000000 cycles, a dithered update
+ * every 3000 us PWM period 240000. With the waveform engine it is a copy
+ * taken every TIMING_COPY_US. */
+WaveformTiming sweepTiming;
+#define TIMING_COPY_US 500000  // usleep() takes less than a second
+
+/* Both LEDs are driven by TIMERA3, as assigned in pwmled2.syscfg; the
+ * second LED's pulses start half a period after the first's so their
+ * edges do not line up. */
+static PwmGroupOutput ledOutputs[] = {
+    { NULL, PWMGROUP_TIMERA3, PWMGROUP_HALF_A },    /* CONFIG_PWM_0, pin 01 */
+    { NULL, PWMGROUP_TIMERA3, PWMGROUP_HALF_B },    /* CONFIG_PWM_1, pin 02 */
+};
+#define LED_PHASE_US (PWM_PERIOD_US / 2)
+
+static PwmGroup leds;
+
+#if TONE_OUTPUT
+/* Interrupt cycles per tone sample; watch it from the debugger. A copy
+ * taken every TIMING_COPY_US, like sweepTiming. */
+ToneStats toneStats;
+
+/*
+ *  ======== playTone ========
+ *  Does not return.
+ */
+static void playTone(void)
+{
+    PWM_Handle pwm = NULL;
+    PWM_Params params;
+
+    PWM_Params_init(&params);
+    params.dutyUnits   = PWM_DUTY_COUNTS;
+    params.dutyValue   = TONE_PERIOD_COUNTS / 2;
+    params.periodUnits = PWM_PERIOD_COUNTS;
+    params.periodValue = TONE_PERIOD_COUNTS;
+    pwm                = PWM_open(CONFIG_PWM_0, &params);
+    if (pwm == NULL)
+    {
+        /* CONFIG_PWM_0 did not open */
+        while (1) {}
+    }
+
+    PWM_start(pwm);
+
+    if (!tone_init(CONFIG_TIMER_0, pwm, TONE_PERIOD_COUNTS, TONE_SAMPLE_RATE))
+    {
+        /* CONFIG_TIMER_0 did not open */
+        while (1) {}
+    }
+
+    tone_start(ddsSine, DDS_SINE_BITS, TONE_MILLIHZ);
+
+    /* The copy holds off the 16 kHz sample interrupt, so only now and then */
+    while (1)
+    {
+        usleep(TIMING_COPY_US);
+        tone_getStats(&toneStats);
+    }
+}
+#endif
+
 /*
  *  ======== mainThread ========
- *  Task periodically increments the PWM duty for the on board LED.
+ *  Starts the sweep on the first LED and holds the second at a steady
+ *  duty, half a period out of phase. The waveform engine steps the sweep
+ *  from a timer interrupt, so the loop here only sleeps and keeps a copy
+ *  of the update timing, taken twice a second so that it seldom holds off
+ *  the timer interrupt.
  */
 void *mainThread(void *arg0)
 {
-    /* Period and duty in microseconds */
-    uint16_t pwmPeriod = 3000;
-    uint16_t duty      = 0;
-    uint16_t dutyInc   = 100;
-
-    /* Sleep time in microseconds */
-     // uint32_t time   = 1e6;
-    uint32_t time   = 50000;
     PWM_Handle pwm1 = NULL;
     PWM_Handle pwm2 = NULL;
     PWM_Params params;
@@ -64,11 +190,15 @@ void *mainThread(void *arg0)
     /* Call driver init functions. */
     PWM_init();
 
+#if TONE_OUTPUT
+    playTone();
+#endif
+
     PWM_Params_init(&params);
-    params.dutyUnits   = PWM_DUTY_US;
+    params.dutyUnits   = PWM_DUTY_COUNTS;
     params.dutyValue   = 0;
     params.periodUnits = PWM_PERIOD_US;
-    params.periodValue = pwmPeriod;
+    params.periodValue = PWM_PERIOD_US;
     pwm1               = PWM_open(CONFIG_PWM_0, &params);
     if (pwm1 == NULL)
     {
@@ -81,26 +211,64 @@ void *mainThread(void *arg0)
     pwm2 = PWM_open(CONFIG_PWM_1, &params);
     if (pwm2 == NULL)
     {
-        /* CONFIG_PWM_0 did not open */
+        /* CONFIG_PWM_1 did not open */
         while (1) {}
     }
 
     PWM_start(pwm2);
 
-    /* Loop forever incrementing the PWM duty */
-    while (1)
-    {
-        PWM_setDuty(pwm1, duty); // defaults to zero
+    ledOutputs[0].pwm = pwm1;
+    ledOutputs[1].pwm = pwm2;
+    pwmgroup_init(&leds, ledOutputs, 2, PWM_PERIOD_US);
+    pwmgroup_stageDuty(&leds, 1, STEADY_DUTY_US * PWMGROUP_COUNTS_PER_US);
+    pwmgroup_stagePhase(&leds, 1, LED_PHASE_US);
+    pwmgroup_commit(&leds);
 
-        PWM_setDuty(pwm2, 2700); // 90% of 3000 uS = 2700 uS
+#if SWEEP_USLEEP
+    {
+        uint16_t step = 0;
 
-        duty = (duty + dutyInc);
+        waveform_timingStart(&sweepTiming);
 
-        if (duty == pwmPeriod || (!duty))
+        /* Loop forever stepping the PWM duty */
+        while (1)
         {
-            dutyInc = -dutyInc;
+            waveform_timingMark(&sweepTiming);
+            /* No dithering here: nearest whole count */
+            PWM_setDuty(pwm1, (lightness[sweep[step]] + (1 << SWEEP_FRACTION_BITS) / 2)
+                                  >> SWEEP_FRACTION_BITS);
+
+            if (++step == SWEEP_LENGTH)
+            {
+                step = 0;
+            }
+
+            usleep(SWEEP_STEP_US);
         }
+    }
+#else
+    if (!waveform_init(CONFIG_TIMER_0, SWEEP_RATE_HZ))
+    {
+        /* CONFIG_TIMER_0 did not open */
+        while (1) {}
+    }
 
-        usleep(time);
+    /* Dithering needs a new duty every PWM period */
+    if (SWEEP_FRACTION_BITS > 0 && !waveform_setUpdatePeriod(PWM_PERIOD_US))
+    {
+        while (1) {}
+    }
+
+    waveform_setGroup(&leds);
+    waveform_setCurve(0, lightness);
+    waveform_setDither(0, SWEEP_FRACTION_BITS);
+    waveform_play(0, pwm1, sweep, SWEEP_LENGTH, WAVEFORM_LOOP);
+
+    /* The main thread is free for other work */
+    while (1)
+    {
+        usleep(TIMING_COPY_US);
+        waveform_getTiming(&sweepTiming);
     }
+#endif
 }
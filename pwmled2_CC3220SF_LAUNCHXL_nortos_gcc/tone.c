@@ -0,0 +1,115 @@
+/*
+ *  ======== tone.c ========
+ *
+ *  Timer driven DDS output on a PWM pin. See tone.h.
+ */
+
+#include <stddef.h>
+
+#include <ti/drivers/Timer.h>
+#include <ti/drivers/dpl/HwiP.h>
+
+#include "cycles.h"
+#include "tone.h"
+
+static DdsVoice voice;
+static PWM_Handle tonePwm = NULL;
+static Timer_Handle sampleTimer = NULL;
+static uint32_t toneRate;
+static uint32_t period;
+static ToneStats stats;
+
+/*
+ *  ======== dutyOf ========
+ *  Q15 sample to PWM counts, 0 at half the period.
+ */
+static inline uint32_t dutyOf(int16_t sample)
+{
+    return ((uint32_t)((int32_t)sample + 32768) * period) >> 16;
+}
+
+/*
+ *  ======== sampleCallback ========
+ */
+static void sampleCallback(Timer_Handle handle, int_fast16_t status)
+{
+    uint32_t start = CYCLES_NOW();
+    uint32_t cycles;
+
+    PWM_setDuty(tonePwm, dutyOf(dds_next(&voice)));
+
+    cycles = CYCLES_NOW() - start;
+    stats.samples++;
+    stats.totalCycles += cycles;
+    if (cycles > stats.maxCycles)
+    {
+        stats.maxCycles = cycles;
+    }
+}
+
+/*
+ *  ======== tone_init ========
+ */
+int tone_init(uint_least8_t timerIndex, PWM_Handle pwm, uint32_t periodCounts,
+              uint32_t sampleRate)
+{
+    Timer_Params params;
+
+    tonePwm = pwm;
+    period = periodCounts;
+    toneRate = sampleRate;
+    dds_init(&voice, NULL, 0);
+    CYCLES_ENABLE();
+
+    Timer_init();
+    Timer_Params_init(&params);
+    params.period        = sampleRate;
+    params.periodUnits   = Timer_PERIOD_HZ;
+    params.timerMode     = Timer_CONTINUOUS_CALLBACK;
+    params.timerCallback = sampleCallback;
+
+    sampleTimer = Timer_open(timerIndex, &params);
+    PWM_setDuty(pwm, dutyOf(0));
+    return sampleTimer != NULL;
+}
+
+/*
+ *  ======== tone_voice ========
+ */
+DdsVoice *tone_voice(void)
+{
+    return &voice;
+}
+
+/*
+ *  ======== tone_start ========
+ */
+void tone_start(const int16_t *table, uint8_t tableBits, uint32_t milliHz)
+{
+    uintptr_t key = HwiP_disable();
+
+    dds_init(&voice, table, tableBits);
+    dds_setFrequency(&voice, milliHz, toneRate);
+    HwiP_restore(key);
+    Timer_start(sampleTimer);
+}
+
+/*
+ *  ======== tone_stop ========
+ */
+void tone_stop(void)
+{
+    Timer_stop(sampleTimer);
+    PWM_setDuty(tonePwm, dutyOf(0));
+}
+
+/*
+ *  ======== tone_getStats ========
+ */
+void tone_getStats(ToneStats *current)
+{
+    uintptr_t key = HwiP_disable();
+
+    *current = stats;
+    HwiP_restore(key);
+}
@@ -0,0 +1,64 @@
+/*
+ *  ======== tone.h ========
+ *
+ *  Plays a DDS voice (dds.h) on a PWM output: a timer interrupt at the
+ *  sample rate takes the next sample and sets it as the duty, centred on
+ *  half the period. The PWM carrier has to be well above the audio, so
+ *  open the output in counts with a short period, e.g. 1024 counts
+ *  (78 kHz at 80 MHz, 10 bits), and filter it (an RC low pass, or the
+ *  speaker itself) to hear the tone.
+ *
+ *  The interrupt times itself with the cycle counter; see ToneStats.
+ */
+
+#ifndef TONE_H_
+#define TONE_H_
+
+#include <stdint.h>
+
+#include <ti/drivers/PWM.h>
+
+#include "dds.h"
+
+/* Cycles spent in the sample interrupt, per sample */
+typedef struct {
+    uint32_t samples;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+} ToneStats;
+
+/*
+ *  ======== tone_init ========
+ *  pwm must be open with PWM_DUTY_COUNTS and a period of periodCounts
+ *  (at most 65536), and started. Opens the sample timer (a CONFIG_TIMER_ index) at
+ *  sampleRate but does not start it. Returns 0 if it could not be
+ *  opened, otherwise 1.
+ */
+int tone_init(uint_least8_t timerIndex, PWM_Handle pwm, uint32_t periodCounts,
+              uint32_t sampleRate);
+
+/*
+ *  ======== tone_voice ========
+ *  The voice being played, to change its frequency or amplitude (with
+ *  dds_setFrequency() and dds_setAmplitude()) at any time.
+ */
+DdsVoice *tone_voice(void);
+
+/*
+ *  ======== tone_start ========
+ *  Plays table (NULL for a square wave) at milliHz.
+ */
+void tone_start(const int16_t *table, uint8_t tableBits, uint32_t milliHz);
+
+/*
+ *  ======== tone_stop ========
+ *  Stops the samples and leaves the output at half duty (silence).
+ */
+void tone_stop(void);
+
+/*
+ *  ======== tone_getStats ========
+ */
+void tone_getStats(ToneStats *current);
+
+#endif /* TONE_H_ */
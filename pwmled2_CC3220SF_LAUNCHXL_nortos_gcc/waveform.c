@@ -0,0 +1,350 @@
+/*
+ *  ======== waveform.c ========
+ *
+ *  Timer driven PWM waveform engine. See waveform.h.
+ */
+
+#include <stddef.h>
+
+#include <ti/drivers/Timer.h>
+#include <ti/drivers/dpl/HwiP.h>
+
+#include "cycles.h"
+#include "waveform.h"
+
+/* A whole step, in the millionths that tickAdvance and stepPhase count:
+ * a tick of updatePeriod us moves a step at stepRate on by their product */
+#define STEP_WHOLE 1000000u
+
+typedef struct {
+    PWM_Handle pwm;
+    const uint32_t *table;
+    const uint32_t *curve;      // NULL: the table holds duties
+    uint16_t length;
+    uint16_t next;              // entry written at the next step
+    uint8_t mode;
+    uint8_t playing;            // stepping through the table
+    uint8_t active;             // from play to stop
+    uint8_t dithered;           // needs a tick every PWM period
+    uint32_t target;            // duty of the current step
+    Dither dither;
+} Channel;
+
+static Channel channels[WAVEFORM_MAX_CHANNELS];
+static Timer_Handle stepTimer = NULL;
+static int timerRunning = 0;
+static WaveformTiming timing;
+
+static uint32_t stepRate;               // steps per second
+static uint32_t updatePeriod = 0;       // us between ticks; 0: a tick per step
+static uint32_t tickAdvance = STEP_WHOLE;  // millionths of a step per tick
+static uint32_t stepPhase = 0;          // millionths since the last step
+static PwmGroup *group = NULL;
+
+/*
+ *  ======== dutyOf ========
+ */
+static inline uint32_t dutyOf(const Channel *c, uint16_t index)
+{
+    uint32_t entry = c->table[index];
+
+    return (c->curve != NULL) ? c->curve[entry] : entry;
+}
+
+/*
+ *  ======== output ========
+ */
+static void output(Channel *c)
+{
+    uint32_t duty = c->dithered ? dither_next(&c->dither, c->target) : c->target;
+
+    if (group != NULL)
+    {
+        pwmgroup_stageDuty(group, (unsigned int)(c - channels), duty);
+    }
+    else
+    {
+        PWM_setDuty(c->pwm, duty);
+    }
+}
+
+/*
+ *  ======== stepCallback ========
+ *  Takes the next entry of every playing channel at each step, writes
+ *  what has changed, and stops the timer once nothing needs it.
+ */
+static void stepCallback(Timer_Handle handle, int_fast16_t status)
+{
+    unsigned int i;
+    int step;
+    int busy = 0;
+
+    waveform_timingMark(&timing);
+    stepPhase += tickAdvance;
+    step = (stepPhase >= STEP_WHOLE);
+    if (step)
+    {
+        stepPhase -= STEP_WHOLE;
+    }
+
+    for (i = 0; i < WAVEFORM_MAX_CHANNELS; i++)
+    {
+        Channel *c = &channels[i];
+
+        if (step && c->playing)
+        {
+            c->target = dutyOf(c, c->next);
+            if (++c->next == c->length)
+            {
+                if (c->mode == WAVEFORM_LOOP)
+                {
+                    c->next = 0;
+                }
+                else
+                {
+                    c->playing = 0;
+                }
+            }
+            if (!c->dithered)
+            {
+                output(c);
+            }
+        }
+        if (c->dithered && c->active)
+        {
+            output(c);
+        }
+        busy |= c->playing | (c->dithered & c->active);
+    }
+    if (group != NULL)
+    {
+        pwmgroup_commit(group);
+    }
+
+    if (!busy)
+    {
+        Timer_stop(handle);
+        timerRunning = 0;
+    }
+}
+
+/*
+ *  ======== applyRates ========
+ *  A step is taken at the first tick at or after its time, so steps that
+ *  are not a whole number of ticks apart still come at stepRate on
+ *  average (25 ms steps on 3 ms ticks are 24 or 27 ms apart). Call with
+ *  interrupts disabled.
+ */
+static int applyRates(void)
+{
+    int32_t status;
+
+    if (updatePeriod == 0)
+    {
+        tickAdvance = STEP_WHOLE;
+        status = Timer_setPeriod(stepTimer, Timer_PERIOD_HZ, stepRate);
+    }
+    else
+    {
+        uint64_t advance = (uint64_t)updatePeriod * stepRate;
+
+        tickAdvance = (advance < STEP_WHOLE) ? (uint32_t)advance : STEP_WHOLE;
+        status = Timer_setPeriod(stepTimer, Timer_PERIOD_US, updatePeriod);
+    }
+    stepPhase = 0;
+
+    // The timing so far is for the old rate, so it starts again.
+    waveform_timingStart(&timing);
+    return status == Timer_STATUS_SUCCESS;
+}
+
+/*
+ *  ======== waveform_init ========
+ */
+int waveform_init(uint_least8_t timerIndex, uint32_t stepsPerSecond)
+{
+    Timer_Params params;
+
+    Timer_init();
+    Timer_Params_init(&params);
+    params.period        = stepsPerSecond;
+    params.periodUnits   = Timer_PERIOD_HZ;
+    params.timerMode     = Timer_CONTINUOUS_CALLBACK;
+    params.timerCallback = stepCallback;
+
+    stepTimer = Timer_open(timerIndex, &params);
+    stepRate = stepsPerSecond;
+    waveform_timingStart(&timing);
+    return stepTimer != NULL;
+}
+
+/*
+ *  ======== waveform_setRate ========
+ */
+int waveform_setRate(uint32_t stepsPerSecond)
+{
+    uintptr_t key = HwiP_disable();
+    int ok;
+
+    stepRate = stepsPerSecond;
+    ok = applyRates();
+    HwiP_restore(key);
+    return ok;
+}
+
+/*
+ *  ======== waveform_setUpdatePeriod ========
+ */
+int waveform_setUpdatePeriod(uint32_t periodUs)
+{
+    uintptr_t key = HwiP_disable();
+    int ok;
+
+    updatePeriod = periodUs;
+    ok = applyRates();
+    HwiP_restore(key);
+    return ok;
+}
+
+/*
+ *  ======== waveform_play ========
+ */
+void waveform_play(unsigned int channel, PWM_Handle pwm, const uint32_t *table,
+                   uint16_t length, enum WAVEFORM_MODES mode)
+{
+    Channel *c = &channels[channel];
+    uintptr_t key;
+
+    if (length == 0)
+    {
+        return;
+    }
+
+    key = HwiP_disable();
+    c->pwm     = pwm;
+    c->table   = table;
+    c->target  = dutyOf(c, 0);
+    c->length  = length;
+    c->next    = (length > 1) ? 1 : 0;
+    c->mode    = (uint8_t)mode;
+    c->playing = (length > 1 || mode == WAVEFORM_LOOP);
+    c->active  = 1;
+    output(c);
+    if (group != NULL)
+    {
+        pwmgroup_commit(group);
+    }
+
+    if ((c->playing || c->dithered) && !timerRunning)
+    {
+        // The time the timer was stopped is not an update interval.
+        timing.last = 0;
+        timerRunning = (Timer_start(stepTimer) == Timer_STATUS_SUCCESS);
+    }
+    HwiP_restore(key);
+}
+
+/*
+ *  ======== waveform_setCurve ========
+ */
+void waveform_setCurve(unsigned int channel, const uint32_t *curve)
+{
+    channels[channel].curve = curve;
+}
+
+/*
+ *  ======== waveform_setGroup ========
+ */
+void waveform_setGroup(PwmGroup *outputs)
+{
+    uintptr_t key = HwiP_disable();
+
+    group = outputs;
+    HwiP_restore(key);
+}
+
+/*
+ *  ======== waveform_setDither ========
+ */
+void waveform_setDither(unsigned int channel, uint8_t fractionBits)
+{
+    Channel *c = &channels[channel];
+    uintptr_t key = HwiP_disable();
+
+    dither_init(&c->dither, fractionBits);
+    c->dithered = (fractionBits > 0);
+    HwiP_restore(key);
+}
+
+/*
+ *  ======== waveform_stop ========
+ *  The timer stops itself at the next tick if nothing else needs it.
+ */
+void waveform_stop(unsigned int channel)
+{
+    uintptr_t key = HwiP_disable();
+
+    channels[channel].playing = 0;
+    channels[channel].active = 0;
+    HwiP_restore(key);
+}
+
+/*
+ *  ======== waveform_isDone ========
+ */
+int waveform_isDone(unsigned int channel)
+{
+    return !channels[channel].playing;
+}
+
+/*
+ *  ======== waveform_getTiming ========
+ */
+void waveform_getTiming(WaveformTiming *current)
+{
+    uintptr_t key = HwiP_disable();
+
+    *current = timing;
+    HwiP_restore(key);
+}
+
+/*
+ *  ======== waveform_timingStart ========
+ */
+void waveform_timingStart(WaveformTiming *t)
+{
+    CYCLES_ENABLE();
+
+    t->intervals   = 0;
+    t->minCycles   = UINT32_MAX;
+    t->maxCycles   = 0;
+    t->totalCycles = 0;
+    t->last        = 0;
+}
+
+/*
+ *  ======== waveform_timingMark ========
+ *  last is 0 before the first update; a counter that really reads 0 just
+ *  loses one interval.
+ */
+void waveform_timingMark(WaveformTiming *t)
+{
+    uint32_t now = CYCLES_NOW();
+
+    if (t->last != 0)
+    {
+        uint32_t interval = now - t->last;
+
+        t->intervals++;
+        t->totalCycles += interval;
+        if (interval < t->minCycles)
+        {
+            t->minCycles = interval;
+        }
+        if (interval > t->maxCycles)
+        {
+            t->maxCycles = interval;
+        }
+    }
+    t->last = now;
+}
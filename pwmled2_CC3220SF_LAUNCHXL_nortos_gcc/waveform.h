@@ -0,0 +1,148 @@
+/*
+ *  ======== waveform.h ========
+ *
+ *  PWM waveform engine. Each channel plays a precomputed table of duty
+ *  values, one entry per step, written to its PWM instance from a
+ *  periodic timer interrupt, so the steps land on time whatever the main
+ *  thread is doing and it never has to wait for them.
+ *
+ *  Table entries are in the duty units the PWM instance was opened with,
+ *  or, once a channel has a curve (waveform_setCurve()), indexes into
+ *  that curve, such as the perceptual levels of a LIGHTNESS_TABLE().
+ *  All channels step together at the rate set by waveform_init() or
+ *  waveform_setRate(). A WAVEFORM_LOOP table starts over after its last
+ *  entry; a WAVEFORM_ONESHOT table stops there and leaves the last entry
+ *  on the output. The timer only runs while some channel is playing.
+ *
+ *  A dithered channel (waveform_setDither()) takes duties with extra
+ *  fraction bits and gets a new whole-unit duty every PWM period (see
+ *  dither.h), so the timer then ticks once per PWM period as set by
+ *  waveform_setUpdatePeriod() and the table steps at the first tick at or
+ *  after each step time.
+ *  A dithered channel keeps the timer running after a one-shot table
+ *  ends, to hold its last duty exactly, until it is stopped.
+ *
+ *  With a PWM group (waveform_setGroup()) every channel that changes at a
+ *  tick is staged in the group and they are committed together, so they
+ *  all change at the same PWM period boundary.
+ *
+ *  The engine also times its own updates with the Cortex-M cycle counter
+ *  (see WaveformTiming), and the same counters can time any other way of
+ *  stepping a PWM for comparison.
+ */
+
+#ifndef WAVEFORM_H_
+#define WAVEFORM_H_
+
+#include <stdint.h>
+
+#include <ti/drivers/PWM.h>
+
+#include "dither.h"
+#include "pwmgroup.h"
+
+#define WAVEFORM_MAX_CHANNELS 2
+
+enum WAVEFORM_MODES {WAVEFORM_LOOP, WAVEFORM_ONESHOT};
+
+/* Intervals between successive updates (timer ticks), in CPU cycles. The jitter is
+ * maxCycles - minCycles, the mean interval totalCycles / intervals. */
+typedef struct {
+    uint32_t intervals;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    uint32_t last;              // cycle count at the previous update
+} WaveformTiming;
+
+/*
+ *  ======== waveform_init ========
+ *  Opens the step timer (a CONFIG_TIMER_ index) at stepsPerSecond.
+ *  Returns 0 if it could not be opened, otherwise 1.
+ */
+int waveform_init(uint_least8_t timerIndex, uint32_t stepsPerSecond);
+
+/*
+ *  ======== waveform_setRate ========
+ *  Changes the step rate; a sweep in progress carries on at the new rate.
+ *  Returns 0 if the timer cannot run at that rate, otherwise 1.
+ */
+int waveform_setRate(uint32_t stepsPerSecond);
+
+/*
+ *  ======== waveform_setUpdatePeriod ========
+ *  Makes the timer tick every periodUs microseconds, the PWM period, for
+ *  dithered channels. Each step then comes at the first tick at or after
+ *  its time, up to periodUs late but on time on average, and at most one
+ *  per tick. 0 goes back to one tick per step. Returns 0 if the timer
+ *  cannot run at that period, otherwise 1.
+ */
+int waveform_setUpdatePeriod(uint32_t periodUs);
+
+/*
+ *  ======== waveform_play ========
+ *  Starts table on channel, replacing whatever it was playing. The first
+ *  entry is written straight away and the next one a step later. table
+ *  must stay in place until the channel is stopped or has finished.
+ */
+void waveform_play(unsigned int channel, PWM_Handle pwm, const uint32_t *table,
+                   uint16_t length, enum WAVEFORM_MODES mode);
+
+/*
+ *  ======== waveform_setCurve ========
+ *  With a curve, channel writes curve[entry] for each table entry instead
+ *  of the entry itself; NULL (the default) goes back to plain duties.
+ *  Every entry of the tables played must be inside the curve. Takes
+ *  effect from the next step.
+ */
+void waveform_setCurve(unsigned int channel, const uint32_t *curve);
+
+/*
+ *  ======== waveform_setGroup ========
+ *  Sends channel n's duties to member n of outputs instead of straight to
+ *  the PWM passed to waveform_play(), which must be that member's. NULL
+ *  goes back to separate writes.
+ */
+void waveform_setGroup(PwmGroup *outputs);
+
+/*
+ *  ======== waveform_setDither ========
+ *  With fractionBits above 0, channel's duties (after any curve) are in
+ *  1/2^fractionBits of a duty unit and are dithered across PWM periods.
+ *  Call it before waveform_play(), and set an update period first.
+ */
+void waveform_setDither(unsigned int channel, uint8_t fractionBits);
+
+/*
+ *  ======== waveform_stop ========
+ *  Stops channel; its output keeps the last duty written, without any
+ *  further dithering.
+ */
+void waveform_stop(unsigned int channel);
+
+/*
+ *  ======== waveform_isDone ========
+ *  Returns 1 if channel is not playing (a one-shot table has finished),
+ *  otherwise 0.
+ */
+int waveform_isDone(unsigned int channel);
+
+/*
+ *  ======== waveform_getTiming ========
+ *  Copies the timing of the engine's updates so far.
+ */
+void waveform_getTiming(WaveformTiming *current);
+
+/*
+ *  ======== waveform_timingStart ========
+ *  Enables the cycle counter and clears t.
+ */
+void waveform_timingStart(WaveformTiming *t);
+
+/*
+ *  ======== waveform_timingMark ========
+ *  Records an update at the current cycle count.
+ */
+void waveform_timingMark(WaveformTiming *t);
+
+#endif /* WAVEFORM_H_ */
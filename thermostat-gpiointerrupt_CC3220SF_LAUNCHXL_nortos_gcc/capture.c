@@ -0,0 +1,225 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== capture.c ========
+ *
+ *  Input capture. See capture.h.
+ *
+ *  head and tail run freely and are masked on use, like the mux queues.
+ *  capture_edge() fills the slot before it moves head on, and
+ *  capture_poll() reads the slot before it moves tail on, so each side
+ *  only ever touches slots the other has finished with.
+ */
+
+#include "capture.h"
+
+#if (CAPTURE_RING_SIZE & (CAPTURE_RING_SIZE - 1)) || CAPTURE_RING_SIZE > 32768
+#error "CAPTURE_RING_SIZE must be a power of two up to 32768"
+#endif
+
+/*
+ * Orders the ring accesses against the head and tail updates. On the
+ * single core M4 only the compiler could move them; on the host, where
+ * tools/capturecheck.c runs the two sides as separate threads, the CPU
+ * can as well.
+ */
+#if defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_7M__)
+#define CAPTURE_BARRIER() __asm__ volatile ("" ::: "memory")
+#else
+#define CAPTURE_BARRIER() __sync_synchronize()
+#endif
+
+// Longest window in counts. A window can run one period over, and a
+// period up to two windows, so every sum stays within 32 bits.
+#define MAX_WINDOW 0x40000000u
+
+/*
+ *  ======== divRound ========
+ *  n / d to the nearest, d non-zero, saturated to 32 bits.
+ */
+static inline uint32_t divRound(uint64_t n, uint64_t d)
+{
+    uint64_t q = (n + d / 2) / d;
+
+    return (q > UINT32_MAX) ? UINT32_MAX : (uint32_t)q;
+}
+
+/*
+ *  ======== restart ========
+ *  Starts the next window at count start.
+ */
+static void restart(Capture *c, uint32_t start)
+{
+    c->windowStart = start;
+    c->periodSum = 0;
+    c->periods = 0;
+    c->highSum = 0;
+    c->pulses = 0;
+}
+
+/*
+ *  ======== finish ========
+ *  Averages the window so far into result and starts the next one at
+ *  start.
+ */
+static void finish(Capture *c, uint32_t start, CaptureResult *result)
+{
+    result->milliHz = 0;
+    result->periodNs = 0;
+    result->widthNs = 0;
+    result->duty = c->level ? 1000 : 0;
+    result->level = c->level;
+    result->periods = c->periods;
+    result->dropped = c->dropped;
+
+    if (c->periods != 0)
+    {
+        uint64_t periodCounts = (uint64_t)c->periods * c->clockHz;
+
+        result->milliHz = divRound(periodCounts * 1000, c->periodSum);
+        result->periodNs = divRound((uint64_t)c->periodSum * 1000000000u, periodCounts);
+        result->duty = 0;
+        if (c->pulses != 0)
+        {
+            // Both averages in 1/65536 counts, so the ratio keeps its
+            // precision without overflowing.
+            uint64_t period = ((uint64_t)c->periodSum << 16) / c->periods;
+            uint64_t width = ((uint64_t)c->highSum << 16) / c->pulses;
+            uint32_t duty = divRound(width * 1000, period);
+
+            result->widthNs = divRound((uint64_t)c->highSum * 1000000000u,
+                                       (uint64_t)c->pulses * c->clockHz);
+            result->duty = (duty > 1000) ? 1000 : (uint16_t)duty;
+        }
+    }
+    restart(c, start);
+}
+
+/*
+ *  ======== capture_init ========
+ */
+int capture_init(Capture *c, uint32_t clockHz, uint32_t windowMs, uint32_t now, int level)
+{
+    uint64_t window = (uint64_t)clockHz * windowMs / 1000;
+
+    if (windowMs == 0 || windowMs > CAPTURE_MAX_WINDOW_MS || window == 0 || window > MAX_WINDOW)
+    {
+        return 0;
+    }
+
+    c->head = 0;
+    c->tail = 0;
+    c->dropped = 0;
+    c->lost = 0;
+
+    c->clockHz = clockHz;
+    c->window = (uint32_t)window;
+    c->lastEdge = now;
+    c->lastRise = now;
+    c->level = (level != 0);
+    c->haveRise = 0;
+    restart(c, now);
+    return 1;
+}
+
+/*
+ *  ======== capture_edge ========
+ */
+void capture_edge(Capture *c, uint32_t count, int level)
+{
+    uint16_t head = c->head;
+    CaptureEdge *edge;
+
+    if ((uint16_t)(head - c->tail) == CAPTURE_RING_SIZE)
+    {
+        c->dropped++;
+        c->lost = 1;
+        return;
+    }
+    CAPTURE_BARRIER();
+
+    edge = &c->ring[head & (CAPTURE_RING_SIZE - 1)];
+    edge->count = count;
+    edge->level = (uint8_t)((level != 0) | (c->lost ? CAPTURE_LOST : 0));
+    c->lost = 0;
+
+    CAPTURE_BARRIER();
+    c->head = head + 1;
+}
+
+/*
+ *  ======== capture_poll ========
+ *  An edge that leaves the pin where it was, or follows dropped edges,
+ *  means edges are missing; the period and pulse it would close are
+ *  thrown away and the next rising edge starts afresh.
+ */
+int capture_poll(Capture *c, uint32_t now, CaptureResult *result)
+{
+    uint16_t head = c->head;
+
+    CAPTURE_BARRIER();
+    while (c->tail != head)
+    {
+        uint16_t tail = c->tail;
+        CaptureEdge edge = c->ring[tail & (CAPTURE_RING_SIZE - 1)];
+        uint8_t level = edge.level & 1;
+
+        CAPTURE_BARRIER();
+        c->tail = tail + 1;
+
+        c->lastEdge = edge.count;
+        if ((edge.level & CAPTURE_LOST) || level == c->level)
+        {
+            c->level = level;
+            c->haveRise = 0;
+            continue;
+        }
+        c->level = level;
+
+        if (!level)
+        {
+            if (c->haveRise)
+            {
+                c->highSum += edge.count - c->lastRise;
+                c->pulses++;
+            }
+            continue;
+        }
+
+        if (c->haveRise)
+        {
+            c->periodSum += edge.count - c->lastRise;
+            c->periods++;
+        }
+        else if (c->periods == 0)
+        {
+            // The first rising edge after a quiet spell starts the window.
+            restart(c, edge.count);
+        }
+        c->lastRise = edge.count;
+        c->haveRise = 1;
+
+        if (c->periods != 0 && (int32_t)(edge.count - c->windowStart) >= (int32_t)c->window)
+        {
+            finish(c, edge.count, result);
+            return 1;
+        }
+    }
+
+    // No edges for a whole window: the signal has stopped (or is slower
+    // than the window). Report what there is, up to the last rising edge.
+    // lastEdge moves on with the window, so the difference never gets
+    // old enough to wrap however long the pin stays quiet.
+    if ((int32_t)(now - c->lastEdge) >= (int32_t)c->window
+        && (int32_t)(now - c->windowStart) >= (int32_t)c->window)
+    {
+        finish(c, now, result);
+        c->lastEdge = now;
+        c->haveRise = 0;
+        return 1;
+    }
+    return 0;
+}
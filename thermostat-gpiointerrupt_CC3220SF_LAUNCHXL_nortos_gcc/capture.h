@@ -0,0 +1,119 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== capture.h ========
+ *
+ *  Input capture: measures the frequency, period, pulse width and duty
+ *  cycle of a digital signal on a GPIO pin from the times of its edges.
+ *
+ *  The GPIO interrupt hands each edge to capture_edge() with a count
+ *  from a free-running timer and the pin level after the edge. That is
+ *  all the interrupt does: the edge goes into a ring that only the
+ *  interrupt writes the head of and only capture_poll() writes the tail
+ *  of, so neither side ever turns interrupts off. A full ring drops the
+ *  edge and marks the next one, so no measurement spans the gap.
+ *
+ *  capture_poll(), called from the main loop, takes the edges and adds up
+ *  whole periods (rising edge to rising edge) and pulses (rising to
+ *  falling) until a window has gone by, then averages them over the
+ *  window. Timing over many periods at once (reciprocal counting) makes
+ *  the resolution one timer count over the whole window, rather than one
+ *  count per period, and averages out interrupt latency. Each window
+ *  ends on a rising edge, so it always holds whole periods.
+ *
+ *  The signal goes on CONFIG_GPIO_CAPTURE, BoosterPack header pin 19
+ *  (GPIO28), and the free-running count comes from CONFIG_TIMER_1; both
+ *  are pinned down in gpiointerrupt.syscfg.
+ *
+ *  A window with no edges reports a frequency of 0 and a duty cycle of 0
+ *  or 100% from the pin level, so a stuck signal is seen as such. The
+ *  period has to be shorter than the window to be measured at all.
+ *
+ *  Plain C with no driver calls, so tools/capturecheck.c can feed it
+ *  synthetic edges on the host, check the results against the signal it
+ *  made up, and find the highest edge rate the ring keeps up with.
+ */
+
+#ifndef CAPTURE_H_
+#define CAPTURE_H_
+
+#include <stdint.h>
+
+/* Edges the ring holds, a power of two. At 8 bytes each this is 512
+ * bytes, enough for 64 edges while the main loop is busy elsewhere. */
+#ifndef CAPTURE_RING_SIZE
+#define CAPTURE_RING_SIZE 64
+#endif
+
+/* Longest window, which keeps the sums within 32 bits at 80 MHz */
+#define CAPTURE_MAX_WINDOW_MS 10000
+
+/* Set in CaptureEdge.level when edges were dropped before this one */
+#define CAPTURE_LOST 0x80
+
+typedef struct {
+    uint32_t count;             // timer count at the edge
+    uint8_t level;              // pin level after it, plus CAPTURE_LOST
+} CaptureEdge;
+
+typedef struct {
+    uint32_t milliHz;           // frequency
+    uint32_t periodNs;          // average period
+    uint32_t widthNs;           // average high time
+    uint16_t duty;              // high time, tenths of a percent
+    uint16_t level;             // pin level at the end of the window
+    uint32_t periods;           // whole periods averaged, 0 if none
+    uint32_t dropped;           // edges dropped since capture_init()
+} CaptureResult;
+
+typedef struct {
+    // Shared between capture_edge() and capture_poll()
+    CaptureEdge ring[CAPTURE_RING_SIZE];
+    volatile uint16_t head;     // next edge to write, capture_edge() only
+    volatile uint16_t tail;     // next edge to read, capture_poll() only
+    volatile uint32_t dropped;  // capture_edge() only
+    uint8_t lost;               // capture_edge() only
+
+    // capture_poll() only
+    uint32_t clockHz;           // timer counts per second
+    uint32_t window;            // counts
+    uint32_t windowStart;       // count at the start of this window
+    uint32_t lastEdge;
+    uint32_t lastRise;
+    uint32_t periodSum;         // counts over whole periods this window
+    uint32_t periods;
+    uint32_t highSum;           // counts high over whole pulses this window
+    uint32_t pulses;
+    uint8_t level;              // pin level after the last edge
+    uint8_t haveRise;           // lastRise starts a period
+} Capture;
+
+/*
+ *  ======== capture_init ========
+ *  Starts at timer count now with the pin at level, averaging over
+ *  windowMs (1 to CAPTURE_MAX_WINDOW_MS) of a timer counting at clockHz.
+ *  Returns 0 if windowMs is out of range, otherwise 1. Call it before
+ *  the interrupt is enabled.
+ */
+int capture_init(Capture *c, uint32_t clockHz, uint32_t windowMs, uint32_t now, int level);
+
+/*
+ *  ======== capture_edge ========
+ *  Called from the GPIO interrupt with the timer count and the pin level
+ *  after the edge.
+ */
+void capture_edge(Capture *c, uint32_t count, int level);
+
+/*
+ *  ======== capture_poll ========
+ *  Takes the edges that have come in, up to the end of a window. Returns
+ *  1 and fills in result when a window ends, so call it until it returns
+ *  0. now is the timer count, read before the call; it ends windows with
+ *  no edges in them.
+ */
+int capture_poll(Capture *c, uint32_t now, CaptureResult *result);
+
+#endif /* CAPTURE_H_ */
@@ -0,0 +1,184 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== command.c ========
+ *
+ *  Non-blocking command parser for the thermostat UART. See command.h.
+ */
+
+#include <string.h>
+
+#include "command.h"
+#include "mux.h"
+
+static UART2_Handle commandUart = NULL;
+
+// Bytes read from the driver but not parsed yet
+static uint8_t rxBuffer[32];
+static size_t rxCount = 0;
+static size_t rxIndex = 0;
+
+// Current line
+static char line[COMMAND_MAX_LEN];
+static uint8_t lineLength = 0;
+static uint8_t lineOverflow = 0;
+
+static const struct
+{
+    const char *name;
+    enum COMMANDS command;
+    uint8_t hasArg;
+}
+commands[] = {
+    { "SET",    CMD_SET,    1 },
+    { "GET",    CMD_GET,    0 },
+    { "RATE",   CMD_RATE,   1 },
+    { "CHANGE", CMD_CHANGE, 1 },
+    { "AGG",    CMD_AGG,    1 },
+    { "DUMP",   CMD_DUMP,   0 },
+};
+
+/*
+ *  ======== parseLine ========
+ *  Splits line[] into keyword and optional decimal argument.
+ */
+static void parseLine(Command *cmd)
+{
+    uint8_t i = 0;
+    uint8_t nameLength;
+    uint8_t digits = 0;
+    int32_t value = 0;
+    unsigned c;
+
+    cmd->command = CMD_ERROR;
+    cmd->arg = 0;
+
+    while (i < lineLength && line[i] != ' ')
+    {
+        i++;
+    }
+    nameLength = i;
+    while (i < lineLength && line[i] == ' ')
+    {
+        i++;
+    }
+    for (; i < lineLength; i++)
+    {
+        if (line[i] < '0' || line[i] > '9' || ++digits > 4)
+        {
+            return;                 // not a number, or far out of range
+        }
+        value = value * 10 + (line[i] - '0');
+    }
+
+    for (c = 0; c < sizeof(commands) / sizeof(commands[0]); c++)
+    {
+        const char *name = commands[c].name;
+        uint8_t j = 0;
+
+        while (j < nameLength && name[j] == line[j])
+        {
+            j++;
+        }
+        if (j == nameLength && name[j] == '\0')
+        {
+            if (commands[c].hasArg != (digits > 0))
+            {
+                return;             // missing or unexpected argument
+            }
+            cmd->command = commands[c].command;
+            cmd->arg = value;
+            return;
+        }
+    }
+}
+
+/*
+ *  ======== command_init ========
+ */
+void command_init(UART2_Handle uart)
+{
+    commandUart = uart;
+}
+
+/*
+ *  ======== command_poll ========
+ */
+int command_poll(Command *cmd)
+{
+    if (commandUart == NULL)
+    {
+        return 0;
+    }
+
+    while (1)
+    {
+        char c;
+
+        if (rxIndex == rxCount)
+        {
+            // Take everything the driver has; returns at once if empty.
+            rxCount = 0;
+            rxIndex = 0;
+            UART2_read(commandUart, rxBuffer, sizeof(rxBuffer), &rxCount);
+            if (rxCount == 0)
+            {
+                return 0;
+            }
+        }
+
+        c = (char)rxBuffer[rxIndex++];
+
+        if (c == '\r' || c == '\n')
+        {
+            if (lineLength == 0 && !lineOverflow)
+            {
+                continue;           // blank line, or the LF of a CR LF
+            }
+            if (lineOverflow)
+            {
+                cmd->command = CMD_ERROR;
+                cmd->arg = 0;
+            }
+            else
+            {
+                parseLine(cmd);
+            }
+            lineLength = 0;
+            lineOverflow = 0;
+            return 1;
+        }
+
+        if (lineLength == COMMAND_MAX_LEN)
+        {
+            lineOverflow = 1;       // drop the rest of the line
+            continue;
+        }
+        if (c >= 'a' && c <= 'z')
+        {
+            c -= 'a' - 'A';
+        }
+        line[lineLength++] = c;
+    }
+}
+
+/*
+ *  ======== command_reply ========
+ */
+void command_reply(const char *text, size_t length)
+{
+    char reply[96];
+
+    // One write, so the line ending cannot be dropped on its own.
+    if (length > sizeof(reply) - 2)
+    {
+        length = sizeof(reply) - 2;
+    }
+    memcpy(reply, text, length);
+    reply[length++] = '\r';
+    reply[length++] = '\n';
+    mux_write(MUX_REPLY, reply, length);
+}
@@ -0,0 +1,66 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== command.h ========
+ *
+ *  Line based command channel on the thermostat UART. Commands end in CR
+ *  and/or LF and are not case sensitive:
+ *
+ *      SET nn      set-point to nn degrees C (0 - 99)
+ *      GET         report <AA,BB,S,CCCC> right away
+ *      RATE n      report every n seconds (1 = every second)
+ *      CHANGE n    report when the temperature moves by n degrees (0 = 1)
+ *      AGG n       report [MIN,MAX,MEAN,BB,H,CCCC] every n seconds
+ *      DUMP        print the telemetry, scheduler and dropped output and
+ *                  capture edge counters, and the capture bytes sent
+ *
+ *  Numbers are unsigned decimal of at most 4 digits. Each command is
+ *  answered with OK, ERR or the data asked for.
+ *
+ *  command_poll() never waits: it takes whatever the UART driver has
+ *  buffered and returns as soon as that runs out.
+ */
+
+#ifndef COMMAND_H_
+#define COMMAND_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <ti/drivers/UART2.h>
+
+/* Longest command line accepted, without the line ending */
+#define COMMAND_MAX_LEN 16
+
+enum COMMANDS {CMD_SET, CMD_GET, CMD_RATE, CMD_CHANGE, CMD_AGG, CMD_DUMP, CMD_ERROR};
+
+typedef struct {
+    enum COMMANDS command;
+    int32_t arg;
+} Command;
+
+/*
+ *  ======== command_init ========
+ *  uart must have been opened with readMode = UART2_Mode_NONBLOCKING.
+ */
+void command_init(UART2_Handle uart);
+
+/*
+ *  ======== command_poll ========
+ *  Returns 1 and fills in cmd when a complete line has been received,
+ *  0 once no more input is available. Call until it returns 0 to drain
+ *  everything received since the last tick.
+ */
+int command_poll(Command *cmd);
+
+/*
+ *  ======== command_reply ========
+ *  Queues a reply line (length bytes, line ending added) on the reply
+ *  channel (see mux.h).
+ */
+void command_reply(const char *text, size_t length);
+
+#endif /* COMMAND_H_ */
@@ -0,0 +1,205 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== dsp.h ========
+ *
+ *  The Cortex-M4 DSP instructions the fixed point filters (filter.h) and
+ *  the FFT (fft.h) are built on, and C models of them that give the same
+ *  results bit for bit on any other machine:
+ *
+ *  dsp_smlald()  SMLALD: two signed 16 x 16 multiplies, both halves of a
+ *                pair at once, added to a 64 bit accumulator
+ *  dsp_smuad()   SMUAD: the same two products added, to 32 bits
+ *  dsp_smusdx()  SMUSDX: low x high minus high x low (with x = (re, im)
+ *                and y = (c, s), c im - s re)
+ *  dsp_shadd16() SHADD16, SHSUB16: halves added or subtracted, each
+ *  dsp_shsub16() halved (the low bit dropped)
+ *  dsp_shasx()   SHASX, SHSAX: the low half of one with the high half of
+ *  dsp_shsax()   the other and the other way round, one added and one
+ *                subtracted, halved; with complex pairs, x + j y and
+ *                x - j y over 2
+ *  dsp_ssat16()  SSAT #16: saturates to the int16_t range
+ *
+ *  On the target (the compiler defines __ARM_FEATURE_DSP for
+ *  -march=armv7e-m) they are the instructions, written as inline
+ *  assembly since GCC 9 has no intrinsics for them. Anywhere else, or
+ *  with DSP_PORTABLE defined, they are the models. The models are always
+ *  there as dsp_smlaldModel() and so on, so a build for an ARM host can
+ *  check the instructions against them (tools/filterbench.c,
+ *  tools/fftcheck.c).
+ *
+ *  A pair is two adjacent int16_t samples read as one uint32_t, the first
+ *  in the low half (both the target and x86 are little endian).
+ */
+
+#ifndef DSP_H_
+#define DSP_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__ARM_FEATURE_DSP) && !defined(DSP_PORTABLE)
+#define DSP_INSTRUCTIONS 1
+#else
+#define DSP_INSTRUCTIONS 0
+#endif
+
+/*
+ *  ======== dsp_pair ========
+ *  p need not be 4 byte aligned; the M4 reads unaligned words.
+ */
+static inline uint32_t dsp_pair(const int16_t *p)
+{
+    uint32_t pair;
+
+    memcpy(&pair, p, sizeof(pair));
+    return pair;
+}
+
+/*
+ *  ======== dsp_setPair ========
+ */
+static inline void dsp_setPair(int16_t *p, uint32_t pair)
+{
+    memcpy(p, &pair, sizeof(pair));
+}
+
+/*
+ *  ======== dsp_pack ========
+ */
+static inline uint32_t dsp_pack(int32_t low, int32_t high)
+{
+    return (uint32_t)(uint16_t)low | ((uint32_t)(uint16_t)high << 16);
+}
+
+/*
+ *  ======== dsp_smlaldModel ========
+ *  The accumulator wraps at 64 bits, as the instruction's does.
+ */
+static inline int64_t dsp_smlaldModel(uint32_t x, uint32_t y, int64_t acc)
+{
+    int64_t sum = (int64_t)(int16_t)x * (int16_t)y
+                  + (int64_t)(int16_t)(x >> 16) * (int16_t)(y >> 16);
+
+    return (int64_t)((uint64_t)acc + (uint64_t)sum);
+}
+
+/*
+ *  ======== dsp_smuadModel ========
+ *  Wraps at 32 bits, which only -32768 x -32768 twice can make it do.
+ */
+static inline int32_t dsp_smuadModel(uint32_t x, uint32_t y)
+{
+    return (int32_t)((uint32_t)((int32_t)(int16_t)x * (int16_t)y)
+                     + (uint32_t)((int32_t)(int16_t)(x >> 16) * (int16_t)(y >> 16)));
+}
+
+/*
+ *  ======== dsp_smusdxModel ========
+ */
+static inline int32_t dsp_smusdxModel(uint32_t x, uint32_t y)
+{
+    return (int32_t)((uint32_t)((int32_t)(int16_t)x * (int16_t)(y >> 16))
+                     - (uint32_t)((int32_t)(int16_t)(x >> 16) * (int16_t)y));
+}
+
+/*
+ *  ======== dsp_shadd16Model ========
+ */
+static inline uint32_t dsp_shadd16Model(uint32_t x, uint32_t y)
+{
+    return dsp_pack(((int32_t)(int16_t)x + (int16_t)y) >> 1,
+                    ((int32_t)(int16_t)(x >> 16) + (int16_t)(y >> 16)) >> 1);
+}
+
+/*
+ *  ======== dsp_shsub16Model ========
+ */
+static inline uint32_t dsp_shsub16Model(uint32_t x, uint32_t y)
+{
+    return dsp_pack(((int32_t)(int16_t)x - (int16_t)y) >> 1,
+                    ((int32_t)(int16_t)(x >> 16) - (int16_t)(y >> 16)) >> 1);
+}
+
+/*
+ *  ======== dsp_shasxModel ========
+ */
+static inline uint32_t dsp_shasxModel(uint32_t x, uint32_t y)
+{
+    return dsp_pack(((int32_t)(int16_t)x - (int16_t)(y >> 16)) >> 1,
+                    ((int32_t)(int16_t)(x >> 16) + (int16_t)y) >> 1);
+}
+
+/*
+ *  ======== dsp_shsaxModel ========
+ */
+static inline uint32_t dsp_shsaxModel(uint32_t x, uint32_t y)
+{
+    return dsp_pack(((int32_t)(int16_t)x + (int16_t)(y >> 16)) >> 1,
+                    ((int32_t)(int16_t)(x >> 16) - (int16_t)y) >> 1);
+}
+
+/*
+ *  ======== dsp_ssat16Model ========
+ */
+static inline int16_t dsp_ssat16Model(int32_t x)
+{
+    return (int16_t)((x > INT16_MAX) ? INT16_MAX : (x < INT16_MIN) ? INT16_MIN : x);
+}
+
+#if DSP_INSTRUCTIONS
+
+/*
+ *  ======== dsp_smlald ========
+ */
+static inline int64_t dsp_smlald(uint32_t x, uint32_t y, int64_t acc)
+{
+    __asm__ ("smlald %Q0, %R0, %1, %2" : "+r" (acc) : "r" (x), "r" (y));
+    return acc;
+}
+
+/*
+ *  ======== dsp_ssat16 ========
+ */
+static inline int16_t dsp_ssat16(int32_t x)
+{
+    int32_t result;
+
+    __asm__ ("ssat %0, #16, %1" : "=r" (result) : "r" (x));
+    return (int16_t)result;
+}
+
+/* The rest take two registers and give one */
+#define DSP_BINARY(name, type)                                      \
+    static inline type dsp_##name(uint32_t x, uint32_t y)           \
+    {                                                               \
+        type r;                                                     \
+                                                                    \
+        __asm__ (#name " %0, %1, %2" : "=r" (r) : "r" (x), "r" (y)); \
+        return r;                                                   \
+    }
+
+DSP_BINARY(smuad, int32_t)
+DSP_BINARY(smusdx, int32_t)
+DSP_BINARY(shadd16, uint32_t)
+DSP_BINARY(shsub16, uint32_t)
+DSP_BINARY(shasx, uint32_t)
+DSP_BINARY(shsax, uint32_t)
+
+#else
+
+#define dsp_smlald  dsp_smlaldModel
+#define dsp_smuad   dsp_smuadModel
+#define dsp_smusdx  dsp_smusdxModel
+#define dsp_shadd16 dsp_shadd16Model
+#define dsp_shsub16 dsp_shsub16Model
+#define dsp_shasx   dsp_shasxModel
+#define dsp_shsax   dsp_shsaxModel
+#define dsp_ssat16  dsp_ssat16Model
+
+#endif /* DSP_INSTRUCTIONS */
+
+#endif /* DSP_H_ */
@@ -0,0 +1,175 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== fft.c ========
+ *
+ *  Fixed point FFT. See fft.h.
+ *
+ *  Decimation in frequency. A radix 4 butterfly over x0..x3, a quarter
+ *  of the span apart, is two radix 2 stages done at once:
+ *
+ *      y0 = (x0 + x1 + x2 + x3) / 4
+ *      y1 = (x0 - x1 + x2 - x3) / 4 W^2k
+ *      y2 = (x0 - j x1 - x2 + j x3) / 4 W^k
+ *      y3 = (x0 + j x1 - x2 - j x3) / 4 W^3k
+ *
+ *  with W for the span. Writing y1 and y2 in each other's places from
+ *  the usual radix 4 order keeps the output in bit reversed order, so
+ *  radix 4 and radix 2 stages mix freely. Each /2 is a halving add or
+ *  subtract, which drops the low bit.
+ */
+
+#include "dsp.h"
+#include "fft.h"
+#include "fft_tables.h"
+
+#if FFT_TWIDDLE_BITS != FFT_MAX_BITS
+#error "fft_tables.h is for another FFT_MAX_BITS; run tools/fftgen.c"
+#endif
+
+/*
+ *  ======== rotate ========
+ *  z W^m, m in steps of the largest size, rounded. Components can only
+ *  round past full scale (and saturate) if z is over 1 in magnitude.
+ */
+static inline uint32_t rotate(uint32_t z, unsigned int m)
+{
+    uint32_t w = dsp_pair(&fftTwiddle[2 * m]);
+    int32_t re = (dsp_smuad(z, w) + (1 << 14)) >> 15;
+    int32_t im = (dsp_smusdx(w, z) + (1 << 14)) >> 15;
+
+    return dsp_pack(dsp_ssat16(re), dsp_ssat16(im));
+}
+
+/*
+ *  ======== radix4 ========
+ *  One stage over every group of span samples. step is the twiddle
+ *  stride for this span.
+ */
+static void radix4(int16_t *data, unsigned int n, unsigned int span, unsigned int step)
+{
+    unsigned int quarter = span / 4;
+    unsigned int group, k;
+
+    for (group = 0; group < n; group += span)
+    {
+        int16_t *p = &data[2 * group];
+
+        for (k = 0; k < quarter; k++, p += 2)
+        {
+            uint32_t x0 = dsp_pair(p);
+            uint32_t x1 = dsp_pair(p + 2 * quarter);
+            uint32_t x2 = dsp_pair(p + 4 * quarter);
+            uint32_t x3 = dsp_pair(p + 6 * quarter);
+            uint32_t s02 = dsp_shadd16(x0, x2);
+            uint32_t d02 = dsp_shsub16(x0, x2);
+            uint32_t s13 = dsp_shadd16(x1, x3);
+            uint32_t d13 = dsp_shsub16(x1, x3);
+            uint32_t y1 = dsp_shsub16(s02, s13);
+            uint32_t y2 = dsp_shsax(d02, d13);
+            uint32_t y3 = dsp_shasx(d02, d13);
+
+            // W^0 is exactly 1, which the table can only come close to.
+            if (k != 0)
+            {
+                y1 = rotate(y1, 2 * k * step);
+                y2 = rotate(y2, k * step);
+                y3 = rotate(y3, 3 * k * step);
+            }
+            dsp_setPair(p, dsp_shadd16(s02, s13));
+            dsp_setPair(p + 2 * quarter, y1);
+            dsp_setPair(p + 4 * quarter, y2);
+            dsp_setPair(p + 6 * quarter, y3);
+        }
+    }
+}
+
+/*
+ *  ======== radix2Last ========
+ *  The last stage, span 2, where every twiddle is W^0.
+ */
+static void radix2Last(int16_t *data, unsigned int n)
+{
+    unsigned int i;
+
+    for (i = 0; i < n; i += 2)
+    {
+        uint32_t a = dsp_pair(&data[2 * i]);
+        uint32_t b = dsp_pair(&data[2 * i + 2]);
+
+        dsp_setPair(&data[2 * i], dsp_shadd16(a, b));
+        dsp_setPair(&data[2 * i + 2], dsp_shsub16(a, b));
+    }
+}
+
+/*
+ *  ======== unscramble ========
+ *  Swaps each sample with the one at its bit reversed index.
+ */
+static void unscramble(int16_t *data, unsigned int n)
+{
+    unsigned int i, j = 0;
+
+    for (i = 1; i < n; i++)
+    {
+        unsigned int bit = n >> 1;
+
+        for (; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j)
+        {
+            uint32_t t = dsp_pair(&data[2 * i]);
+
+            dsp_setPair(&data[2 * i], dsp_pair(&data[2 * j]));
+            dsp_setPair(&data[2 * j], t);
+        }
+    }
+}
+
+/*
+ *  ======== fft_q15 ========
+ */
+int fft_q15(int16_t *data, unsigned int bits)
+{
+    unsigned int n = 1u << bits;
+    unsigned int span;
+
+    if (bits < FFT_MIN_BITS || bits > FFT_MAX_BITS)
+    {
+        return 0;
+    }
+
+    for (span = n; span >= 4; span /= 4)
+    {
+        radix4(data, n, span, FFT_MAX_SIZE / span);
+    }
+    if (span == 2)
+    {
+        radix2Last(data, n);
+    }
+    unscramble(data, n);
+    return 1;
+}
+
+/*
+ *  ======== fft_power ========
+ *  Only -1 - j can reach 2 and wrap the product; as unsigned it is still
+ *  right.
+ */
+void fft_power(const int16_t *data, unsigned int count, uint32_t *power)
+{
+    unsigned int k;
+
+    for (k = 0; k < count; k++)
+    {
+        uint32_t z = dsp_pair(&data[2 * k]);
+
+        power[k] = (uint32_t)dsp_smuad(z, z);
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== fft.h ========
+ *
+ *  Fixed point FFT for spectra of sampled signals, in integer arithmetic
+ *  only (the M4 has no FPU). Sizes are powers of 2 from FFT_MIN_SIZE to
+ *  FFT_MAX_SIZE.
+ *
+ *  The transform works in place on N complex Q15 samples, each a real
+ *  and an imaginary int16_t side by side (4N bytes); a real signal goes
+ *  in with the imaginary parts 0. It needs no other memory. The
+ *  stages are radix 4, with one radix 2 stage at the end for sizes that
+ *  are an odd power of 2, each radix 4 butterfly ordered so the results
+ *  come out in plain bit reversed order, which a final pass of swaps
+ *  undoes. The twiddle factors are a constant table in flash
+ *  (fft_tables.h, 3 KB, generated by tools/fftgen.c) shared by every
+ *  size.
+ *
+ *  Each radix 2 step halves, so the output is X[k] / N and nothing can
+ *  overflow as long as the inputs are within 1 in magnitude (real and
+ *  imaginary parts together). A full scale sine on a bin comes out at
+ *  1/2 in that bin. The butterflies use the M4's dual 16 bit halving
+ *  add/subtract and multiply instructions (dsp.h); the host build gives
+ *  the same output bit for bit. tools/fftcheck.c compares the output
+ *  with a double precision transform and times it, and fftbench.c times
+ *  it on the target.
+ */
+
+#ifndef FFT_H_
+#define FFT_H_
+
+#include <stdint.h>
+
+#define FFT_MIN_BITS 6
+#define FFT_MAX_BITS 10
+#define FFT_MIN_SIZE (1 << FFT_MIN_BITS)
+#define FFT_MAX_SIZE (1 << FFT_MAX_BITS)
+
+/*
+ *  ======== fft_q15 ========
+ *  data holds 2 << bits int16_t: real, imaginary, real, ... It is
+ *  replaced by the spectrum, bin 0 first. Returns 0 if bits is outside
+ *  FFT_MIN_BITS to FFT_MAX_BITS (data is left alone), otherwise 1.
+ */
+int fft_q15(int16_t *data, unsigned int bits);
+
+/*
+ *  ======== fft_power ========
+ *  power[k] = re^2 + im^2 of the first count bins of data, Q30.
+ */
+void fft_power(const int16_t *data, unsigned int count, uint32_t *power);
+
+#endif /* FFT_H_ */
@@ -0,0 +1,210 @@
+/*
+ *  ======== fft_tables.h ========
+ *
+ *  DO NOT EDIT - generated by tools/fftgen.c.
+ *  Twiddle factors, Q15 (cos, sin) pairs; see fft.h.
+ */
+
+#ifndef FFT_TABLES_H_
+#define FFT_TABLES_H_
+
+#include <stdint.h>
+
+#define FFT_TWIDDLE_BITS 10
+
+static const int16_t fftTwiddle[2 * 768] = {
+   32767,      0,  32766,    201,  32765,    402,  32761,    603,
+   32757,    804,  32752,   1005,  32745,   1206,  32737,   1407,
+   32728,   1608,  32717,   1809,  32705,   2009,  32692,   2210,
+   32678,   2410,  32663,   2611,  32646,   2811,  32628,   3012,
+   32609,   3212,  32589,   3412,  32567,   3612,  32545,   3811,
+   32521,   4011,  32495,   4210,  32469,   4410,  32441,   4609,
+   32412,   4808,  32382,   5007,  32351,   5205,  32318,   5404,
+   32285,   5602,  32250,   5800,  32213,   5998,  32176,   6195,
+   32137,   6393,  32098,   6590,  32057,   6786,  32014,   6983,
+   31971,   7179,  31926,   7375,  31880,   7571,  31833,   7767,
+   31785,   7962,  31736,   8157,  31685,   8351,  31633,   8545,
+   31580,   8739,  31526,   8933,  31470,   9126,  31414,   9319,
+   31356,   9512,  31297,   9704,  31237,   9896,  31176,  10087,
+   31113,  10278,  31050,  10469,  30985,  10659,  30919,  10849,
+   30852,  11039,  30783,  11228,  30714,  11417,  30643,  11605,
+   30571,  11793,  30498,  11980,  30424,  12167,  30349,  12353,
+   30273,  12539,  30195,  12725,  30117,  12910,  30037,  13094,
+   29956,  13279,  29874,  13462,  29791,  13645,  29706,  13828,
+   29621,  14010,  29534,  14191,  29447,  14372,  29358,  14553,
+   29268,  14732,  29177,  14912,  29085,  15090,  28992,  15269,
+   28898,  15446,  28803,  15623,  28706,  15800,  28609,  15976,
+   28510,  16151,  28411,  16325,  28310,  16499,  28208,  16673,
+   28105,  16846,  28001,  17018,  27896,  17189,  27790,  17360,
+   27683,  17530,  27575,  17700,  27466,  17869,  27356,  18037,
+   27245,  18204,  27133,  18371,  27019,  18537,  26905,  18703,
+   26790,  18868,  26674,  19032,  26556,  19195,  26438,  19357,
+   26319,  19519,  26198,  19680,  26077,  19841,  25955,  20000,
+   25832,  20159,  25708,  20317,  25582,  20475,  25456,  20631,
+   25329,  20787,  25201,  20942,  25072,  21096,  24942,  21250,
+   24811,  21403,  24680,  21554,  24547,  21705,  24413,  21856,
+   24279,  22005,  24143,  22154,  24007,  22301,  23870,  22448,
+   23731,  22594,  23592,  22739,  23452,  22884,  23311,  23027,
+   23170,  23170,  23027,  23311,  22884,  23452,  22739,  23592,
+   22594,  23731,  22448,  23870,  22301,  24007,  22154,  24143,
+   22005,  24279,  21856,  24413,  21705,  24547,  21554,  24680,
+   21403,  24811,  21250,  24942,  21096,  25072,  20942,  25201,
+   20787,  25329,  20631,  25456,  20475,  25582,  20317,  25708,
+   20159,  25832,  20000,  25955,  19841,  26077,  19680,  26198,
+   19519,  26319,  19357,  26438,  19195,  26556,  19032,  26674,
+   18868,  26790,  18703,  26905,  18537,  27019,  18371,  27133,
+   18204,  27245,  18037,  27356,  17869,  27466,  17700,  27575,
+   17530,  27683,  17360,  27790,  17189,  27896,  17018,  28001,
+   16846,  28105,  16673,  28208,  16499,  28310,  16325,  28411,
+   16151,  28510,  15976,  28609,  15800,  28706,  15623,  28803,
+   15446,  28898,  15269,  28992,  15090,  29085,  14912,  29177,
+   14732,  29268,  14553,  29358,  14372,  29447,  14191,  29534,
+   14010,  29621,  13828,  29706,  13645,  29791,  13462,  29874,
+   13279,  29956,  13094,  30037,  12910,  30117,  12725,  30195,
+   12539,  30273,  12353,  30349,  12167,  30424,  11980,  30498,
+   11793,  30571,  11605,  30643,  11417,  30714,  11228,  30783,
+   11039,  30852,  10849,  30919,  10659,  30985,  10469,  31050,
+   10278,  31113,  10087,  31176,   9896,  31237,   9704,  31297,
+    9512,  31356,   9319,  31414,   9126,  31470,   8933,  31526,
+    8739,  31580,   8545,  31633,   8351,  31685,   8157,  31736,
+    7962,  31785,   7767,  31833,   7571,  31880,   7375,  31926,
+    7179,  31971,   6983,  32014,   6786,  32057,   6590,  32098,
+    6393,  32137,   6195,  32176,   5998,  32213,   5800,  32250,
+    5602,  32285,   5404,  32318,   5205,  32351,   5007,  32382,
+    4808,  32412,   4609,  32441,   4410,  32469,   4210,  32495,
+    4011,  32521,   3811,  32545,   3612,  32567,   3412,  32589,
+    3212,  32609,   3012,  32628,   2811,  32646,   2611,  32663,
+    2410,  32678,   2210,  32692,   2009,  32705,   1809,  32717,
+    1608,  32728,   1407,  32737,   1206,  32745,   1005,  32752,
+     804,  32757,    603,  32761,    402,  32765,    201,  32766,
+       0,  32767,   -201,  32766,   -402,  32765,   -603,  32761,
+    -804,  32757,  -1005,  32752,  -1206,  32745,  -1407,  32737,
+   -1608,  32728,  -1809,  32717,  -2009,  32705,  -2210,  32692,
+   -2410,  32678,  -2611,  32663,  -2811,  32646,  -3012,  32628,
+   -3212,  32609,  -3412,  32589,  -3612,  32567,  -3811,  32545,
+   -4011,  32521,  -4210,  32495,  -4410,  32469,  -4609,  32441,
+   -4808,  32412,  -5007,  32382,  -5205,  32351,  -5404,  32318,
+   -5602,  32285,  -5800,  32250,  -5998,  32213,  -6195,  32176,
+   -6393,  32137,  -6590,  32098,  -6786,  32057,  -6983,  32014,
+   -7179,  31971,  -7375,  31926,  -7571,  31880,  -7767,  31833,
+   -7962,  31785,  -8157,  31736,  -8351,  31685,  -8545,  31633,
+   -8739,  31580,  -8933,  31526,  -9126,  31470,  -9319,  31414,
+   -9512,  31356,  -9704,  31297,  -9896,  31237, -10087,  31176,
+  -10278,  31113, -10469,  31050, -10659,  30985, -10849,  30919,
+  -11039,  30852, -11228,  30783, -11417,  30714, -11605,  30643,
+  -11793,  30571, -11980,  30498, -12167,  30424, -12353,  30349,
+  -12539,  30273, -12725,  30195, -12910,  30117, -13094,  30037,
+  -13279,  29956, -13462,  29874, -13645,  29791, -13828,  29706,
+  -14010,  29621, -14191,  29534, -14372,  29447, -14553,  29358,
+  -14732,  29268, -14912,  29177, -15090,  29085, -15269,  28992,
+  -15446,  28898, -15623,  28803, -15800,  28706, -15976,  28609,
+  -16151,  28510, -16325,  28411, -16499,  28310, -16673,  28208,
+  -16846,  28105, -17018,  28001, -17189,  27896, -17360,  27790,
+  -17530,  27683, -17700,  27575, -17869,  27466, -18037,  27356,
+  -18204,  27245, -18371,  27133, -18537,  27019, -18703,  26905,
+  -18868,  26790, -19032,  26674, -19195,  26556, -19357,  26438,
+  -19519,  26319, -19680,  26198, -19841,  26077, -20000,  25955,
+  -20159,  25832, -20317,  25708, -20475,  25582, -20631,  25456,
+  -20787,  25329, -20942,  25201, -21096,  25072, -21250,  24942,
+  -21403,  24811, -21554,  24680, -21705,  24547, -21856,  24413,
+  -22005,  24279, -22154,  24143, -22301,  24007, -22448,  23870,
+  -22594,  23731, -22739,  23592, -22884,  23452, -23027,  23311,
+  -23170,  23170, -23311,  23027, -23452,  22884, -23592,  22739,
+  -23731,  22594, -23870,  22448, -24007,  22301, -24143,  22154,
+  -24279,  22005, -24413,  21856, -24547,  21705, -24680,  21554,
+  -24811,  21403, -24942,  21250, -25072,  21096, -25201,  20942,
+  -25329,  20787, -25456,  20631, -25582,  20475, -25708,  20317,
+  -25832,  20159, -25955,  20000, -26077,  19841, -26198,  19680,
+  -26319,  19519, -26438,  19357, -26556,  19195, -26674,  19032,
+  -26790,  18868, -26905,  18703, -27019,  18537, -27133,  18371,
+  -27245,  18204, -27356,  18037, -27466,  17869, -27575,  17700,
+  -27683,  17530, -27790,  17360, -27896,  17189, -28001,  17018,
+  -28105,  16846, -28208,  16673, -28310,  16499, -28411,  16325,
+  -28510,  16151, -28609,  15976, -28706,  15800, -28803,  15623,
+  -28898,  15446, -28992,  15269, -29085,  15090, -29177,  14912,
+  -29268,  14732, -29358,  14553, -29447,  14372, -29534,  14191,
+  -29621,  14010, -29706,  13828, -29791,  13645, -29874,  13462,
+  -29956,  13279, -30037,  13094, -30117,  12910, -30195,  12725,
+  -30273,  12539, -30349,  12353, -30424,  12167, -30498,  11980,
+  -30571,  11793, -30643,  11605, -30714,  11417, -30783,  11228,
+  -30852,  11039, -30919,  10849, -30985,  10659, -31050,  10469,
+  -31113,  10278, -31176,  10087, -31237,   9896, -31297,   9704,
+  -31356,   9512, -31414,   9319, -31470,   9126, -31526,   8933,
+  -31580,   8739, -31633,   8545, -31685,   8351, -31736,   8157,
+  -31785,   7962, -31833,   7767, -31880,   7571, -31926,   7375,
+  -31971,   7179, -32014,   6983, -32057,   6786, -32098,   6590,
+  -32137,   6393, -32176,   6195, -32213,   5998, -32250,   5800,
+  -32285,   5602, -32318,   5404, -32351,   5205, -32382,   5007,
+  -32412,   4808, -32441,   4609, -32469,   4410, -32495,   4210,
+  -32521,   4011, -32545,   3811, -32567,   3612, -32589,   3412,
+  -32609,   3212, -32628,   3012, -32646,   2811, -32663,   2611,
+  -32678,   2410, -32692,   2210, -32705,   2009, -32717,   1809,
+  -32728,   1608, -32737,   1407, -32745,   1206, -32752,   1005,
+  -32757,    804, -32761,    603, -32765,    402, -32766,    201,
+  -32767,      0, -32766,   -201, -32765,   -402, -32761,   -603,
+  -32757,   -804, -32752,  -1005, -32745,  -1206, -32737,  -1407,
+  -32728,  -1608, -32717,  -1809, -32705,  -2009, -32692,  -2210,
+  -32678,  -2410, -32663,  -2611, -32646,  -2811, -32628,  -3012,
+  -32609,  -3212, -32589,  -3412, -32567,  -3612, -32545,  -3811,
+  -32521,  -4011, -32495,  -4210, -32469,  -4410, -32441,  -4609,
+  -32412,  -4808, -32382,  -5007, -32351,  -5205, -32318,  -5404,
+  -32285,  -5602, -32250,  -5800, -32213,  -5998, -32176,  -6195,
+  -32137,  -6393, -32098,  -6590, -32057,  -6786, -32014,  -6983,
+  -31971,  -7179, -31926,  -7375, -31880,  -7571, -31833,  -7767,
+  -31785,  -7962, -31736,  -8157, -31685,  -8351, -31633,  -8545,
+  -31580,  -8739, -31526,  -8933, -31470,  -9126, -31414,  -9319,
+  -31356,  -9512, -31297,  -9704, -31237,  -9896, -31176, -10087,
+  -31113, -10278, -31050, -10469, -30985, -10659, -30919, -10849,
+  -30852, -11039, -30783, -11228, -30714, -11417, -30643, -11605,
+  -30571, -11793, -30498, -11980, -30424, -12167, -30349, -12353,
+  -30273, -12539, -30195, -12725, -30117, -12910, -30037, -13094,
+  -29956, -13279, -29874, -13462, -29791, -13645, -29706, -13828,
+  -29621, -14010, -29534, -14191, -29447, -14372, -29358, -14553,
+  -29268, -14732, -29177, -14912, -29085, -15090, -28992, -15269,
+  -28898, -15446, -28803, -15623, -28706, -15800, -28609, -15976,
+  -28510, -16151, -28411, -16325, -28310, -16499, -28208, -16673,
+  -28105, -16846, -28001, -17018, -27896, -17189, -27790, -17360,
+  -27683, -17530, -27575, -17700, -27466, -17869, -27356, -18037,
+  -27245, -18204, -27133, -18371, -27019, -18537, -26905, -18703,
+  -26790, -18868, -26674, -19032, -26556, -19195, -26438, -19357,
+  -26319, -19519, -26198, -19680, -26077, -19841, -25955, -20000,
+  -25832, -20159, -25708, -20317, -25582, -20475, -25456, -20631,
+  -25329, -20787, -25201, -20942, -25072, -21096, -24942, -21250,
+  -24811, -21403, -24680, -21554, -24547, -21705, -24413, -21856,
+  -24279, -22005, -24143, -22154, -24007, -22301, -23870, -22448,
+  -23731, -22594, -23592, -22739, -23452, -22884, -23311, -23027,
+  -23170, -23170, -23027, -23311, -22884, -23452, -22739, -23592,
+  -22594, -23731, -22448, -23870, -22301, -24007, -22154, -24143,
+  -22005, -24279, -21856, -24413, -21705, -24547, -21554, -24680,
+  -21403, -24811, -21250, -24942, -21096, -25072, -20942, -25201,
+  -20787, -25329, -20631, -25456, -20475, -25582, -20317, -25708,
+  -20159, -25832, -20000, -25955, -19841, -26077, -19680, -26198,
+  -19519, -26319, -19357, -26438, -19195, -26556, -19032, -26674,
+  -18868, -26790, -18703, -26905, -18537, -27019, -18371, -27133,
+  -18204, -27245, -18037, -27356, -17869, -27466, -17700, -27575,
+  -17530, -27683, -17360, -27790, -17189, -27896, -17018, -28001,
+  -16846, -28105, -16673, -28208, -16499, -28310, -16325, -28411,
+  -16151, -28510, -15976, -28609, -15800, -28706, -15623, -28803,
+  -15446, -28898, -15269, -28992, -15090, -29085, -14912, -29177,
+  -14732, -29268, -14553, -29358, -14372, -29447, -14191, -29534,
+  -14010, -29621, -13828, -29706, -13645, -29791, -13462, -29874,
+  -13279, -29956, -13094, -30037, -12910, -30117, -12725, -30195,
+  -12539, -30273, -12353, -30349, -12167, -30424, -11980, -30498,
+  -11793, -30571, -11605, -30643, -11417, -30714, -11228, -30783,
+  -11039, -30852, -10849, -30919, -10659, -30985, -10469, -31050,
+  -10278, -31113, -10087, -31176,  -9896, -31237,  -9704, -31297,
+   -9512, -31356,  -9319, -31414,  -9126, -31470,  -8933, -31526,
+   -8739, -31580,  -8545, -31633,  -8351, -31685,  -8157, -31736,
+   -7962, -31785,  -7767, -31833,  -7571, -31880,  -7375, -31926,
+   -7179, -31971,  -6983, -32014,  -6786, -32057,  -6590, -32098,
+   -6393, -32137,  -6195, -32176,  -5998, -32213,  -5800, -32250,
+   -5602, -32285,  -5404, -32318,  -5205, -32351,  -5007, -32382,
+   -4808, -32412,  -4609, -32441,  -4410, -32469,  -4210, -32495,
+   -4011, -32521,  -3811, -32545,  -3612, -32567,  -3412, -32589,
+   -3212, -32609,  -3012, -32628,  -2811, -32646,  -2611, -32663,
+   -2410, -32678,  -2210, -32692,  -2009, -32705,  -1809, -32717,
+   -1608, -32728,  -1407, -32737,  -1206, -32745,  -1005, -32752,
+    -804, -32757,   -603, -32761,   -402, -32765,   -201, -32766,
+};
+
+#endif /* FFT_TABLES_H_ */
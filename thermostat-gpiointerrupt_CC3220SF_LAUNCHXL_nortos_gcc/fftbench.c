@@ -0,0 +1,96 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== fftbench.c ========
+ *
+ *  FFT and Goertzel timings and checksums. See fftbench.h.
+ */
+
+#include <stddef.h>
+
+#include "fftbench.h"
+#include "goertzel.h"
+
+static int16_t data[2 * FFT_MAX_SIZE];
+static int16_t samples[FFT_MAX_SIZE];
+
+static const char *const names[FFTBENCH_CASES] = {
+    "fft 64", "fft 128", "fft 256", "fft 512", "fft 1024", "goertzel 205",
+};
+
+/*
+ *  ======== nextRandom ========
+ */
+static uint32_t nextRandom(uint32_t *seed)
+{
+    *seed = *seed * 1664525u + 1013904223u;
+    return *seed;
+}
+
+/*
+ *  ======== checksum ========
+ */
+static uint32_t checksum(const void *bytes, size_t length)
+{
+    const uint8_t *p = bytes;
+    uint32_t hash = 2166136261u;
+
+    while (length-- > 0)
+    {
+        hash = (hash ^ *p++) * 16777619u;
+    }
+    return hash;
+}
+
+/*
+ *  ======== fftbench_run ========
+ *  The signal is a triangle wave plus noise, up to about half of full
+ *  scale, so the complex samples (two stretches of it) stay within 1.
+ */
+void fftbench_run(FftBenchResult *results, uint32_t (*now)(void))
+{
+    Goertzel g;
+    uint32_t seed = 350;
+    uint32_t start, power;
+    unsigned int bits, i;
+
+    for (i = 0; i < FFT_MAX_SIZE; i++)
+    {
+        int32_t triangle = (int32_t)((i * 1311u) & 0xFFFF) - 32768;
+
+        triangle = (triangle < 0) ? -triangle : triangle;
+        samples[i] = (int16_t)((triangle - 16384) + ((int16_t)(nextRandom(&seed) >> 16) >> 2));
+        samples[i] = (int16_t)(samples[i] * 7 / 10);
+    }
+
+    for (bits = FFT_MIN_BITS; bits <= FFT_MAX_BITS; bits++)
+    {
+        FftBenchResult *r = &results[bits - FFT_MIN_BITS];
+        unsigned int n = 1u << bits;
+
+        for (i = 0; i < n; i++)
+        {
+            data[2 * i] = samples[i];
+            data[2 * i + 1] = samples[FFT_MAX_SIZE - 1 - i];
+        }
+        start = now();
+        fft_q15(data, bits);
+        r->ticks    = now() - start;
+        r->name     = names[bits - FFT_MIN_BITS];
+        r->size     = (uint16_t)n;
+        r->checksum = checksum(data, 4 * n);
+    }
+
+    // 1209 Hz, a DTMF column tone, at 8 kHz
+    goertzel_init(&g, 1209000, 8000, FFTBENCH_GOERTZEL);
+    start = now();
+    goertzel_update(&g, samples, FFTBENCH_GOERTZEL);
+    power = goertzel_power(&g);
+    results[FFTBENCH_CASES - 1].ticks    = now() - start;
+    results[FFTBENCH_CASES - 1].name     = names[FFTBENCH_CASES - 1];
+    results[FFTBENCH_CASES - 1].size     = FFTBENCH_GOERTZEL;
+    results[FFTBENCH_CASES - 1].checksum = checksum(&power, sizeof(power));
+}
@@ -0,0 +1,41 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== fftbench.h ========
+ *
+ *  Runs the FFT (fft.h) at every size and the Goertzel detector
+ *  (goertzel.h) over the same pseudo random signal, timing each with a
+ *  clock the caller supplies and summing up the output in a checksum.
+ *  The firmware runs it with the cycle counter when built with FFT_BENCH
+ *  set to 1 and logs the results; tools/fftcheck.c runs it on the host.
+ *  The checksums must match.
+ */
+
+#ifndef FFTBENCH_H_
+#define FFTBENCH_H_
+
+#include <stdint.h>
+
+#include "fft.h"
+
+#define FFTBENCH_CASES    (FFT_MAX_BITS - FFT_MIN_BITS + 2)
+#define FFTBENCH_GOERTZEL 205       // samples, as for DTMF at 8 kHz
+
+typedef struct {
+    const char *name;           // constant string
+    uint16_t size;              // points or samples
+    uint32_t checksum;          // FNV-1a over the output
+    uint32_t ticks;             // clock ticks for one run
+} FftBenchResult;
+
+/*
+ *  ======== fftbench_run ========
+ *  Fills results[0 .. FFTBENCH_CASES - 1], the FFT sizes in order and
+ *  then the detector. now() is read before and after each run.
+ */
+void fftbench_run(FftBenchResult *results, uint32_t (*now)(void));
+
+#endif /* FFTBENCH_H_ */
@@ -0,0 +1,320 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== filter.c ========
+ *
+ *  Fixed point FIR and IIR filters. See filter.h.
+ *
+ *  A FIR's delay line holds every sample twice, taps apart, so the last
+ *  taps samples are always in one run from the newest back, however far
+ *  round the line has come, and the sum over them needs no wrap check.
+ */
+
+#include <string.h>
+
+#include "dsp.h"
+#include "filter.h"
+
+/*
+ *  ======== sat32 ========
+ */
+static inline int32_t sat32(int64_t x)
+{
+    return (int32_t)((x > INT32_MAX) ? INT32_MAX : (x < INT32_MIN) ? INT32_MIN : x);
+}
+
+/*
+ *  ======== divRound ========
+ *  n / d to the nearest, d positive.
+ */
+static inline int64_t divRound(int64_t n, int64_t d)
+{
+    return (n >= 0) ? (n + d / 2) / d : (n - d / 2) / d;
+}
+
+/*
+ *  ======== dotQ15 ========
+ *  h[0] x[0] + ... + h[taps-1] x[taps-1], rounded to Q15. Two taps per
+ *  SMLALD, four per pass.
+ */
+static int16_t dotQ15(const int16_t *h, const int16_t *x, uint16_t taps)
+{
+    int64_t acc = 1 << 14;
+    unsigned int k = 0;
+
+    for (; k + 4 <= taps; k += 4)
+    {
+        acc = dsp_smlald(dsp_pair(h + k), dsp_pair(x + k), acc);
+        acc = dsp_smlald(dsp_pair(h + k + 2), dsp_pair(x + k + 2), acc);
+    }
+    if (k + 2 <= taps)
+    {
+        acc = dsp_smlald(dsp_pair(h + k), dsp_pair(x + k), acc);
+        k += 2;
+    }
+    if (k < taps)
+    {
+        acc += (int32_t)h[k] * x[k];
+    }
+
+    // At most 65535 taps of 2^30 each, so this fits before saturating.
+    return dsp_ssat16((int32_t)(acc >> 15));
+}
+
+/*
+ *  ======== dotQ31 ========
+ */
+static int32_t dotQ31(const int32_t *h, const int32_t *x, uint16_t taps)
+{
+    int64_t acc = (int64_t)1 << 30;
+    unsigned int k;
+
+    for (k = 0; k < taps; k++)
+    {
+        acc += (int64_t)h[k] * x[k];
+    }
+    return sat32(acc >> 31);
+}
+
+/*
+ *  ======== filter_firInitQ15 ========
+ */
+int filter_firInitQ15(FilterFirQ15 *f, const int16_t *coeffs, uint16_t taps, int16_t *state,
+                      uint16_t factor)
+{
+    if (taps == 0 || factor == 0)
+    {
+        return 0;
+    }
+    f->coeffs = coeffs;
+    f->state  = state;
+    f->taps   = taps;
+    f->newest = 0;
+    f->factor = factor;
+    f->phase  = 0;
+    memset(state, 0, FILTER_FIR_STATE(taps) * sizeof(state[0]));
+    return 1;
+}
+
+/*
+ *  ======== filter_firQ15 ========
+ */
+size_t filter_firQ15(FilterFirQ15 *f, const int16_t *in, int16_t *out, size_t count)
+{
+    size_t written = 0;
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        f->newest = ((f->newest == 0) ? f->taps : f->newest) - 1;
+        f->state[f->newest] = in[i];
+        f->state[f->newest + f->taps] = in[i];
+
+        if (f->phase == 0)
+        {
+            out[written++] = dotQ15(f->coeffs, &f->state[f->newest], f->taps);
+            f->phase = f->factor;
+        }
+        f->phase--;
+    }
+    return written;
+}
+
+/*
+ *  ======== filter_firInitQ31 ========
+ */
+int filter_firInitQ31(FilterFirQ31 *f, const int32_t *coeffs, uint16_t taps, int32_t *state,
+                      uint16_t factor)
+{
+    if (taps == 0 || factor == 0)
+    {
+        return 0;
+    }
+    f->coeffs = coeffs;
+    f->state  = state;
+    f->taps   = taps;
+    f->newest = 0;
+    f->factor = factor;
+    f->phase  = 0;
+    memset(state, 0, FILTER_FIR_STATE(taps) * sizeof(state[0]));
+    return 1;
+}
+
+/*
+ *  ======== filter_firQ31 ========
+ */
+size_t filter_firQ31(FilterFirQ31 *f, const int32_t *in, int32_t *out, size_t count)
+{
+    size_t written = 0;
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        f->newest = ((f->newest == 0) ? f->taps : f->newest) - 1;
+        f->state[f->newest] = in[i];
+        f->state[f->newest + f->taps] = in[i];
+
+        if (f->phase == 0)
+        {
+            out[written++] = dotQ31(f->coeffs, &f->state[f->newest], f->taps);
+            f->phase = f->factor;
+        }
+        f->phase--;
+    }
+    return written;
+}
+
+/*
+ *  ======== filter_biquadInitQ15 ========
+ */
+void filter_biquadInitQ15(FilterBiquadQ15 *f, const int16_t *coeffs, uint8_t stages,
+                          int16_t *state)
+{
+    f->coeffs = coeffs;
+    f->state  = state;
+    f->stages = stages;
+    memset(state, 0, FILTER_BIQUAD_STATE(stages) * sizeof(state[0]));
+}
+
+/*
+ *  ======== filter_biquadSettleQ15 ========
+ *  Each section settles at its DC gain, (b0 + b1 + b2) / (1 - a1 - a2),
+ *  give or take the rounding of its output. A section that does not
+ *  settle (1 - a1 - a2 not above 0) passes the value on.
+ */
+void filter_biquadSettleQ15(FilterBiquadQ15 *f, int16_t value)
+{
+    const int16_t *c = f->coeffs;
+    int16_t *s = f->state;
+    uint8_t stage;
+
+    for (stage = 0; stage < f->stages; stage++, c += FILTER_BIQUAD_Q15_COEFFS, s += 4)
+    {
+        int32_t b = (int32_t)c[0] + c[2] + c[3];
+        int32_t a = (1 << 14) - c[4] - c[5];
+        int16_t y = (a > 0) ? dsp_ssat16Model((int32_t)divRound(value * b, a)) : value;
+
+        s[0] = value;
+        s[1] = value;
+        s[2] = y;
+        s[3] = y;
+        value = y;
+    }
+}
+
+/*
+ *  ======== filter_biquadQ15 ========
+ *  One section at a time over the whole block, the later ones working in
+ *  out. Each keeps x[n-1], x[n-2] and y[n-1], y[n-2] as pairs, so the
+ *  feedforward and the feedback are one SMLALD each.
+ */
+void filter_biquadQ15(FilterBiquadQ15 *f, const int16_t *in, int16_t *out, size_t count)
+{
+    const int16_t *c = f->coeffs;
+    int16_t *s = f->state;
+    const int16_t *src = in;
+    uint8_t stage;
+
+    for (stage = 0; stage < f->stages; stage++, c += FILTER_BIQUAD_Q15_COEFFS, s += 4)
+    {
+        int32_t b0 = c[0];
+        uint32_t b12 = dsp_pair(&c[2]);
+        uint32_t a12 = dsp_pair(&c[4]);
+        uint32_t xs = dsp_pair(&s[0]);
+        uint32_t ys = dsp_pair(&s[2]);
+        size_t i;
+
+        for (i = 0; i < count; i++)
+        {
+            int16_t x = src[i];
+            int64_t acc = (1 << 13) + b0 * x;
+            int16_t y;
+
+            acc = dsp_smlald(b12, xs, acc);
+            acc = dsp_smlald(a12, ys, acc);
+            y = dsp_ssat16((int32_t)(acc >> 14));
+
+            xs = (xs << 16) | (uint16_t)x;
+            ys = (ys << 16) | (uint16_t)y;
+            out[i] = y;
+        }
+        memcpy(&s[0], &xs, sizeof(xs));
+        memcpy(&s[2], &ys, sizeof(ys));
+        src = out;
+    }
+}
+
+/*
+ *  ======== filter_biquadInitQ31 ========
+ */
+void filter_biquadInitQ31(FilterBiquadQ31 *f, const int32_t *coeffs, uint8_t stages,
+                          int32_t *state)
+{
+    f->coeffs = coeffs;
+    f->state  = state;
+    f->stages = stages;
+    memset(state, 0, FILTER_BIQUAD_STATE(stages) * sizeof(state[0]));
+}
+
+/*
+ *  ======== filter_biquadSettleQ31 ========
+ *  For sections whose b coefficients add up to less than 2.
+ */
+void filter_biquadSettleQ31(FilterBiquadQ31 *f, int32_t value)
+{
+    const int32_t *c = f->coeffs;
+    int32_t *s = f->state;
+    uint8_t stage;
+
+    for (stage = 0; stage < f->stages; stage++, c += FILTER_BIQUAD_Q31_COEFFS, s += 4)
+    {
+        int64_t b = (int64_t)c[0] + c[1] + c[2];
+        int64_t a = ((int64_t)1 << 30) - c[3] - c[4];
+        int32_t y = (a > 0) ? sat32(divRound(value * b, a)) : value;
+
+        s[0] = value;
+        s[1] = value;
+        s[2] = y;
+        s[3] = y;
+        value = y;
+    }
+}
+
+/*
+ *  ======== filter_biquadQ31 ========
+ */
+void filter_biquadQ31(FilterBiquadQ31 *f, const int32_t *in, int32_t *out, size_t count)
+{
+    const int32_t *c = f->coeffs;
+    int32_t *s = f->state;
+    const int32_t *src = in;
+    uint8_t stage;
+
+    for (stage = 0; stage < f->stages; stage++, c += FILTER_BIQUAD_Q31_COEFFS, s += 4)
+    {
+        int32_t x1 = s[0], x2 = s[1], y1 = s[2], y2 = s[3];
+        size_t i;
+
+        for (i = 0; i < count; i++)
+        {
+            int32_t x = src[i];
+            int64_t acc = ((int64_t)1 << 29) + (int64_t)c[0] * x + (int64_t)c[1] * x1
+                          + (int64_t)c[2] * x2 + (int64_t)c[3] * y1 + (int64_t)c[4] * y2;
+            int32_t y = sat32(acc >> 30);
+
+            x2 = x1;
+            x1 = x;
+            y2 = y1;
+            y1 = y;
+            out[i] = y;
+        }
+        s[0] = x1;
+        s[1] = x2;
+        s[2] = y1;
+        s[3] = y2;
+        src = out;
+    }
+}
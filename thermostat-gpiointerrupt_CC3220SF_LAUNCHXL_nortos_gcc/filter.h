@@ -0,0 +1,154 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== filter.h ========
+ *
+ *  Fixed point FIR and IIR filters, for smoothing the temperature sensor
+ *  and for signals sampled from GPIO inputs, without the software
+ *  floating point the M4 would otherwise need (there is no FPU).
+ *
+ *  Q15 samples are int16_t with 15 fraction bits (-1 to 1 - 2^-15), Q31
+ *  samples int32_t with 31. The filters do not care what the samples
+ *  stand for; a raw sensor reading can go in as it is.
+ *
+ *  FIR        y[n] = h[0] x[n] + h[1] x[n-1] + ... + h[N-1] x[n-N+1]
+ *             with Q15 or Q31 coefficients h. Given a decimation factor
+ *             M the filter keeps every Mth output and works out only
+ *             those, so it decimates at 1/M of the cost.
+ *  Biquad     a cascade of second order sections, each
+ *             y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2]
+ *             in direct form I, the a coefficients with the sign that
+ *             adds them (the negatives of the usual a1, a2). Coefficients
+ *             have one integer bit more than the samples (Q14 or Q30),
+ *             since a1 is up to 2.
+ *
+ *  Sums are kept to 64 bits and rounded once, to the nearest, at the
+ *  output; outputs beyond the sample range saturate. A FIR whose
+ *  coefficients add up to at most 1 in magnitude cannot overflow, and
+ *  neither can a Q15 FIR of any coefficients, or a biquad section whose
+ *  coefficients add up to less than 4 in magnitude. The Q15 kernels use
+ *  the M4's dual 16 bit multiply-accumulate (dsp.h) and give the same
+ *  outputs, bit for bit, built for the host; the Q31 kernels are plain C
+ *  the compiler turns into SMLAL. tools/filterbench.c checks them against a
+ *  straightforward reference and times them, and filterbench.c times
+ *  them on the target.
+ *
+ *  Filters keep their state between calls, so a signal can go through in
+ *  blocks of any size. The caller provides the state arrays, sized with
+ *  the FILTER_*_STATE() macros, and they and the coefficients must stay
+ *  in place.
+ */
+
+#ifndef FILTER_H_
+#define FILTER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* State array entries */
+#define FILTER_FIR_STATE(taps)        (2 * (taps))
+#define FILTER_BIQUAD_STATE(stages)   (4 * (stages))
+
+/* Coefficient array entries per biquad section:
+ *     Q15  b0, 0, b1, b2, a1, a2   (the 0 keeps the pairs aligned)
+ *     Q31  b0, b1, b2, a1, a2 */
+#define FILTER_BIQUAD_Q15_COEFFS 6
+#define FILTER_BIQUAD_Q31_COEFFS 5
+
+typedef struct {
+    const int16_t *coeffs;      // h[0] first
+    int16_t *state;             // delay line, kept twice over
+    uint16_t taps;
+    uint16_t newest;            // index of x[n] in state
+    uint16_t factor;            // decimation, 1: none
+    uint16_t phase;             // inputs to skip before the next output
+} FilterFirQ15;
+
+typedef struct {
+    const int32_t *coeffs;
+    int32_t *state;
+    uint16_t taps;
+    uint16_t newest;
+    uint16_t factor;
+    uint16_t phase;
+} FilterFirQ31;
+
+typedef struct {
+    const int16_t *coeffs;      // FILTER_BIQUAD_Q15_COEFFS per section
+    int16_t *state;             // x[n-1], x[n-2], y[n-1], y[n-2] per section
+    uint8_t stages;
+} FilterBiquadQ15;
+
+typedef struct {
+    const int32_t *coeffs;      // FILTER_BIQUAD_Q31_COEFFS per section
+    int32_t *state;
+    uint8_t stages;
+} FilterBiquadQ31;
+
+/*
+ *  ======== filter_firInitQ15 ========
+ *  state has FILTER_FIR_STATE(taps) entries. factor (at least 1) is the
+ *  decimation; the first output is for the first input. Returns 0 if taps
+ *  or factor is 0, otherwise 1.
+ */
+int filter_firInitQ15(FilterFirQ15 *f, const int16_t *coeffs, uint16_t taps, int16_t *state,
+                      uint16_t factor);
+
+/*
+ *  ======== filter_firQ15 ========
+ *  Filters count inputs and returns the number of outputs written (count
+ *  without decimation). out may be in.
+ */
+size_t filter_firQ15(FilterFirQ15 *f, const int16_t *in, int16_t *out, size_t count);
+
+/*
+ *  ======== filter_firInitQ31 ========
+ */
+int filter_firInitQ31(FilterFirQ31 *f, const int32_t *coeffs, uint16_t taps, int32_t *state,
+                      uint16_t factor);
+
+/*
+ *  ======== filter_firQ31 ========
+ */
+size_t filter_firQ31(FilterFirQ31 *f, const int32_t *in, int32_t *out, size_t count);
+
+/*
+ *  ======== filter_biquadInitQ15 ========
+ *  state has FILTER_BIQUAD_STATE(stages) entries and starts at 0.
+ */
+void filter_biquadInitQ15(FilterBiquadQ15 *f, const int16_t *coeffs, uint8_t stages,
+                          int16_t *state);
+
+/*
+ *  ======== filter_biquadSettleQ15 ========
+ *  Sets the state to where a constant input of value would have left it,
+ *  so the output starts at the steady level rather than rising from 0.
+ */
+void filter_biquadSettleQ15(FilterBiquadQ15 *f, int16_t value);
+
+/*
+ *  ======== filter_biquadQ15 ========
+ *  out may be in.
+ */
+void filter_biquadQ15(FilterBiquadQ15 *f, const int16_t *in, int16_t *out, size_t count);
+
+/*
+ *  ======== filter_biquadInitQ31 ========
+ */
+void filter_biquadInitQ31(FilterBiquadQ31 *f, const int32_t *coeffs, uint8_t stages,
+                          int32_t *state);
+
+/*
+ *  ======== filter_biquadSettleQ31 ========
+ */
+void filter_biquadSettleQ31(FilterBiquadQ31 *f, int32_t value);
+
+/*
+ *  ======== filter_biquadQ31 ========
+ */
+void filter_biquadQ31(FilterBiquadQ31 *f, const int32_t *in, int32_t *out, size_t count);
+
+#endif /* FILTER_H_ */
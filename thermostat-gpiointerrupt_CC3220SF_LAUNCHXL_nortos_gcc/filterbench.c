@@ -0,0 +1,166 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== filterbench.c ========
+ *
+ *  Filter timings and checksums. See filterbench.h.
+ */
+
+#include <stddef.h>
+
+#include "filter.h"
+#include "filterbench.h"
+
+#define FIR_TAPS     32
+#define SAT_TAPS     31
+#define DECIM_TAPS   64
+#define DECIM_FACTOR 4
+#define STAGES       2
+
+/* Fourth order Butterworth low pass at a tenth of the sample rate */
+static const int16_t lowpassQ15[STAGES * FILTER_BIQUAD_Q15_COEFFS] = {
+    1014, 0, 2028, 1014, 17180, -4852,
+    1277, 0, 2554, 1277, 21642, -10367,
+};
+static const int32_t lowpassQ31[STAGES * FILTER_BIQUAD_Q31_COEFFS] = {
+    66448722, 132897445, 66448722, 1125925222, -317978288,
+    83704984, 167409967, 83704984, 1418320004, -679398114,
+};
+
+static int16_t in16[FILTERBENCH_INPUTS];
+static int16_t out16[FILTERBENCH_INPUTS];
+static int32_t in32[FILTERBENCH_INPUTS];
+static int32_t out32[FILTERBENCH_INPUTS];
+static int16_t coeffs16[DECIM_TAPS];
+static int32_t coeffs32[FIR_TAPS];
+static int16_t state16[FILTER_FIR_STATE(DECIM_TAPS)];
+static int32_t state32[FILTER_FIR_STATE(FIR_TAPS)];
+
+/*
+ *  ======== nextRandom ========
+ */
+static uint32_t nextRandom(uint32_t *seed)
+{
+    *seed = *seed * 1664525u + 1013904223u;
+    return *seed;
+}
+
+/*
+ *  ======== checksum ========
+ */
+static uint32_t checksum(const void *data, size_t length)
+{
+    const uint8_t *p = data;
+    uint32_t hash = 2166136261u;
+
+    while (length-- > 0)
+    {
+        hash = (hash ^ *p++) * 16777619u;
+    }
+    return hash;
+}
+
+/*
+ *  ======== firCoeffsQ15 ========
+ *  Random coefficients, scaled so their magnitudes add up to at most 1
+ *  unless full is set.
+ */
+static void firCoeffsQ15(uint32_t seed, uint16_t taps, int full)
+{
+    uint16_t k;
+
+    for (k = 0; k < taps; k++)
+    {
+        int16_t h = (int16_t)(nextRandom(&seed) >> 16);
+
+        coeffs16[k] = full ? h : (int16_t)(h / taps);
+    }
+}
+
+/*
+ *  ======== firCoeffsQ31 ========
+ */
+static void firCoeffsQ31(uint32_t seed, uint16_t taps)
+{
+    uint16_t k;
+
+    for (k = 0; k < taps; k++)
+    {
+        coeffs32[k] = (int32_t)nextRandom(&seed) / taps;
+    }
+}
+
+/*
+ *  ======== record ========
+ */
+static void record(FilterBenchResult *r, const char *name, uint16_t macs, size_t outputs,
+                   const void *out, size_t size, uint32_t ticks)
+{
+    r->name     = name;
+    r->macs     = macs;
+    r->outputs  = (uint16_t)outputs;
+    r->checksum = checksum(out, outputs * size);
+    r->ticks    = ticks;
+}
+
+/*
+ *  ======== filterbench_run ========
+ */
+void filterbench_run(FilterBenchResult *results, uint32_t (*now)(void))
+{
+    FilterFirQ15 fir16;
+    FilterFirQ31 fir32;
+    FilterBiquadQ15 biquad16;
+    FilterBiquadQ31 biquad32;
+    uint32_t seed = 350;
+    uint32_t start;
+    size_t n;
+    int i;
+
+    for (i = 0; i < FILTERBENCH_INPUTS; i++)
+    {
+        in32[i] = (int32_t)nextRandom(&seed);
+        in16[i] = (int16_t)(in32[i] >> 16);
+    }
+
+    firCoeffsQ15(1, FIR_TAPS, 0);
+    filter_firInitQ15(&fir16, coeffs16, FIR_TAPS, state16, 1);
+    start = now();
+    n = filter_firQ15(&fir16, in16, out16, FILTERBENCH_INPUTS);
+    record(&results[0], "fir q15", FIR_TAPS, n, out16, sizeof(out16[0]), now() - start);
+
+    firCoeffsQ15(2, SAT_TAPS, 1);
+    filter_firInitQ15(&fir16, coeffs16, SAT_TAPS, state16, 1);
+    start = now();
+    n = filter_firQ15(&fir16, in16, out16, FILTERBENCH_INPUTS);
+    record(&results[1], "fir q15 odd, saturating", SAT_TAPS, n, out16, sizeof(out16[0]),
+           now() - start);
+
+    firCoeffsQ15(3, DECIM_TAPS, 0);
+    filter_firInitQ15(&fir16, coeffs16, DECIM_TAPS, state16, DECIM_FACTOR);
+    start = now();
+    n = filter_firQ15(&fir16, in16, out16, FILTERBENCH_INPUTS);
+    record(&results[2], "fir q15 decimating", DECIM_TAPS, n, out16, sizeof(out16[0]),
+           now() - start);
+
+    firCoeffsQ31(4, FIR_TAPS);
+    filter_firInitQ31(&fir32, coeffs32, FIR_TAPS, state32, 1);
+    start = now();
+    n = filter_firQ31(&fir32, in32, out32, FILTERBENCH_INPUTS);
+    record(&results[3], "fir q31", FIR_TAPS, n, out32, sizeof(out32[0]), now() - start);
+
+    filter_biquadInitQ15(&biquad16, lowpassQ15, STAGES, state16);
+    start = now();
+    filter_biquadQ15(&biquad16, in16, out16, FILTERBENCH_INPUTS);
+    record(&results[4], "biquad q15", 5 * STAGES, FILTERBENCH_INPUTS, out16,
+           sizeof(out16[0]), now() - start);
+
+    filter_biquadInitQ31(&biquad32, lowpassQ31, STAGES, state32);
+    start = now();
+    filter_biquadQ31(&biquad32, in32, out32, FILTERBENCH_INPUTS);
+    record(&results[5], "biquad q31", 5 * STAGES, FILTERBENCH_INPUTS, out32,
+           sizeof(out32[0]), now() - start);
+}
@@ -0,0 +1,40 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== filterbench.h ========
+ *
+ *  Runs each kind of filter in filter.h over the same block of pseudo
+ *  random samples, timing it with a clock the caller supplies, and sums
+ *  up its outputs in a checksum. The firmware runs it with the cycle
+ *  counter when built with FILTER_BENCH set to 1 and logs the results;
+ *  tools/filterbench.c runs it on the host. The checksums must match, or
+ *  the target's DSP instructions and the host's C models disagree.
+ */
+
+#ifndef FILTERBENCH_H_
+#define FILTERBENCH_H_
+
+#include <stdint.h>
+
+#define FILTERBENCH_CASES  6
+#define FILTERBENCH_INPUTS 256
+
+typedef struct {
+    const char *name;           // constant string
+    uint16_t macs;              // multiply-accumulates per output
+    uint16_t outputs;
+    uint32_t checksum;          // FNV-1a over the outputs
+    uint32_t ticks;             // clock ticks for the whole block
+} FilterBenchResult;
+
+/*
+ *  ======== filterbench_run ========
+ *  Fills results[0 .. FILTERBENCH_CASES - 1]. now() is read before and
+ *  after each block.
+ */
+void filterbench_run(FilterBenchResult *results, uint32_t (*now)(void));
+
+#endif /* FILTERBENCH_H_ */
@@ -0,0 +1,178 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== goertzel.c ========
+ *
+ *  Goertzel detector. See goertzel.h.
+ *
+ *  s[n] = x[n] + 2 cos(w) s[n-1] - s[n-2] over the block, then
+ *  |X(w)|^2 = s1^2 + s2^2 - 2 cos(w) s1 s2 from the last two.
+ */
+
+#include "goertzel.h"
+
+#define ONE_Q30     (1 << 30)
+#define HALF_PI_Q30 1686629713      // pi / 2, Q30
+
+/*
+ *  ======== mulQ30 ========
+ */
+static inline int32_t mulQ30(int32_t a, int32_t b)
+{
+    return (int32_t)(((int64_t)a * b + (1 << 29)) >> 30);
+}
+
+/*
+ *  ======== magnitude ========
+ */
+static inline uint32_t magnitude(int32_t x)
+{
+    return (x < 0) ? 0u - (uint32_t)x : (uint32_t)x;
+}
+
+/*
+ *  ======== cosTurn ========
+ *  cos(2 pi turn / 2^32), Q30. Folded into the first eighth of a turn,
+ *  then a Taylor series to the x^10 or x^11 term, whose next term is
+ *  below 2^-30 there.
+ */
+static int32_t cosTurn(uint32_t turn)
+{
+    static const int32_t cosDivisors[] = {90, 56, 30, 12, 2};
+    static const int32_t sinDivisors[] = {110, 72, 42, 20, 6};
+    const int32_t *divisors = cosDivisors;
+    int negate = 0;
+    int32_t x, x2, r;
+    int i;
+
+    if (turn > 0x80000000u)
+    {
+        turn = 0u - turn;               // cos(-a) = cos(a)
+    }
+    if (turn > 0x40000000u)
+    {
+        turn = 0x80000000u - turn;      // cos(pi - a) = -cos(a)
+        negate = 1;
+    }
+    if (turn > 0x20000000u)
+    {
+        turn = 0x40000000u - turn;      // cos(pi/2 - a) = sin(a)
+        divisors = sinDivisors;
+    }
+
+    // turn is at most 2^29 here, so x (radians) is at most pi/4.
+    x = (int32_t)(((uint64_t)turn * HALF_PI_Q30) >> 30);
+    x2 = mulQ30(x, x);
+    r = ONE_Q30;
+    for (i = 0; i < 5; i++)
+    {
+        r = ONE_Q30 - mulQ30(x2, r) / divisors[i];
+    }
+    if (divisors == sinDivisors)
+    {
+        r = mulQ30(x, r);
+    }
+    return negate ? -r : r;
+}
+
+/*
+ *  ======== goertzel_init ========
+ */
+int goertzel_init(Goertzel *g, uint32_t milliHz, uint32_t sampleRate, uint16_t length)
+{
+    uint64_t rate = (uint64_t)sampleRate * 1000;
+    int32_t c;
+
+    if (milliHz == 0 || 2 * (uint64_t)milliHz >= rate || length == 0)
+    {
+        return 0;
+    }
+
+    c = cosTurn((uint32_t)(((uint64_t)milliHz << 32) / rate));
+    g->coeff  = (c >= ONE_Q30) ? INT32_MAX : 2 * c;
+    g->s1     = 0;
+    g->s2     = 0;
+    g->length = length;
+    g->count  = 0;
+    return 1;
+}
+
+/*
+ *  ======== goertzel_update ========
+ */
+size_t goertzel_update(Goertzel *g, const int16_t *samples, size_t count)
+{
+    int32_t coeff = g->coeff;
+    int32_t s1 = g->s1;
+    int32_t s2 = g->s2;
+    size_t room = g->length - g->count;
+    size_t i;
+
+    if (count > room)
+    {
+        count = room;
+    }
+    for (i = 0; i < count; i++)
+    {
+        int32_t s = samples[i] + mulQ30(coeff, s1) - s2;
+
+        s2 = s1;
+        s1 = s;
+    }
+
+    g->s1 = s1;
+    g->s2 = s2;
+    g->count += (uint16_t)count;
+    return count;
+}
+
+/*
+ *  ======== goertzel_done ========
+ */
+int goertzel_done(const Goertzel *g)
+{
+    return g->count == g->length;
+}
+
+/*
+ *  ======== goertzel_power ========
+ *  The amplitude of a sine that fits the block is 2 |X| / N. Large states
+ *  are scaled down first so the squares fit in 64 bits.
+ */
+uint32_t goertzel_power(Goertzel *g)
+{
+    int32_t s1 = g->s1;
+    int32_t s2 = g->s2;
+    uint32_t big = magnitude(s1) | magnitude(s2);
+    uint64_t n2 = (uint64_t)g->count * g->count;
+    unsigned int shift = 0;
+    int64_t p;
+    uint64_t power;
+
+    g->s1 = 0;
+    g->s2 = 0;
+    g->count = 0;
+    if (n2 == 0)
+    {
+        return 0;
+    }
+
+    while ((big >> shift) >= ONE_Q30)
+    {
+        shift++;
+    }
+    s1 >>= shift;
+    s2 >>= shift;
+    p = (int64_t)s1 * s1 + (int64_t)s2 * s2 - (int64_t)mulQ30(g->coeff, s1) * s2;
+    if (p <= 0)
+    {
+        return 0;
+    }
+
+    power = (uint64_t)p / n2;
+    shift = 2 * shift + 2;
+    return (power > (UINT32_MAX >> shift)) ? UINT32_MAX : (uint32_t)(power << shift);
+}
@@ -0,0 +1,69 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== goertzel.h ========
+ *
+ *  Goertzel detector: the power at one frequency over a block of
+ *  samples, for checking whether a tone is present without a whole FFT.
+ *  Each sample costs one multiply-accumulate, and the detector keeps
+ *  three words of state.
+ *
+ *  Samples are Q15 (int16_t); the result is the amplitude squared of the
+ *  sine at the frequency, Q30, so a full scale sine reads about 2^30 and
+ *  one at half scale 2^28 (6 dB down). The response is a bin of an FFT
+ *  of length samples: a tone 1 / length of the sample rate away falls on
+ *  its first zero, one between two detectors shows in both.
+ *
+ *  Everything is integer arithmetic, including working out the cosine
+ *  in goertzel_init(). The state grows over the block by up to
+ *  length / sin(2 pi f / rate) times the input, which must stay within
+ *  32 bits: frequencies closer to 0 or half the sample rate than about
+ *  length / 2^16 of the sample rate need shorter blocks.
+ *  tools/fftcheck.c compares the results with double precision.
+ */
+
+#ifndef GOERTZEL_H_
+#define GOERTZEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    int32_t coeff;              // 2 cos(2 pi f / rate), Q30
+    int32_t s1;                 // s[n-1]
+    int32_t s2;                 // s[n-2]
+    uint16_t length;            // samples per block
+    uint16_t count;             // samples so far in this block
+} Goertzel;
+
+/*
+ *  ======== goertzel_init ========
+ *  Detects milliHz (below half of sampleRate) over blocks of length
+ *  samples. Returns 0 if the frequency or length is out of range,
+ *  otherwise 1.
+ */
+int goertzel_init(Goertzel *g, uint32_t milliHz, uint32_t sampleRate, uint16_t length);
+
+/*
+ *  ======== goertzel_update ========
+ *  Takes up to count samples, stopping at the end of the block. Returns
+ *  the number taken; the block is complete when goertzel_done() says so.
+ */
+size_t goertzel_update(Goertzel *g, const int16_t *samples, size_t count);
+
+/*
+ *  ======== goertzel_done ========
+ */
+int goertzel_done(const Goertzel *g);
+
+/*
+ *  ======== goertzel_power ========
+ *  The power over the block so far (normally a complete one), and starts
+ *  the next block.
+ */
+uint32_t goertzel_power(Goertzel *g);
+
+#endif /* GOERTZEL_H_ */
@@ -1,510 +1,818 @@
-/*
- * Robert Murphy
- * 6/16/2024
- * CS 350 Final Project
- */
-
-/*
- * This program will control a thermostat located on the TI CC3220SF
- * LAUNCH development board. This program will check the buttons
- * every 200ms, check the temperature every 500ms, and update the LED
- * and report to the server every second (via the UART). If the
- * right-side button is pushed, it will increase the temp set-point
- * by 1 degree. If the left-side button is pushed, it will decrease
- * the temp set-point by 1 degree. If the temperature is greater than
- * the set-point, the LED will turn off. If the temperature is less
- * than the set-point, the LED will turn on (the LED controls a
- * heater). You can simulate a heating or cooling room by putting
- * your finger on the temperature sensor. The output to the server
- * (via UART) will be formatted as <AA,BB,S,CCCC>.
- */
-
- /* Where:
-
-   AA = ASCII decimal value of room temperature (00 - 99) degrees Celsius
-   BB = ASCII decimal value of set-point temperature (00-99) degrees Celsius
-   S = 0 if heat is off, 1 if heat is on
-   CCCC = decimal count of seconds since board has been reset
-   <%02d,%02d,%d,%04d> = temperature, set-point, heat, seconds
- */
-
-
-#include <stddef.h>
-#include <stdint.h>
-#include <unistd.h>
-
-/* Driver Header files */
-#include <ti/drivers/GPIO.h>
-#include <ti/drivers/I2C.h>
-#include <ti/drivers/Timer.h>
-//#include <ti/drivers/UART.h>
-#include <ti/display/Display.h>
-
-/* Driver configuration */
-#include "ti_drivers_config.h"
-
-// global time constants per function
-#define timer_period_gcd 100
-#define timer_period_buttons 200
-#define timer_period_sensor_read 500
-#define timer_period_output 1000
-
-#define num_tasks 3
-/*
- *  ======== Task Type ========
- *
- *  Defines structure for the task type.
- */
-typedef struct task {
-    int state;                    // Current state of the task
-    unsigned long period;         // Rate at which the task should tick
-    unsigned long elapsedTime;    // Time since task's previous tick
-    int (*tickFunction)(int);     // Function to call for task's tick
-} task;
-
-
-
-/*
- *  ======== Driver Handles ========
- */
-I2C_Handle i2c;         // I2C driver handle
-Timer_Handle timer0;    // Timer driver handle
-Display_Handle display;       // Display driver handle
-static void i2cErrorHandler(I2C_Transaction *transaction, Display_Handle display);
-
-/*
- *  ======== Global Variables ========
- */
-// UART global variables
-//char output[64];
-//int bytesToSend;
-
-// I2C global variables
-static const struct
-{
-    uint8_t address;
-    uint8_t resultReg;
-    char *id;
-}
-sensors[3] = {
-    { 0x48, 0x0000, "11X" },
-    { 0x49, 0x0000, "116" },
-    { 0x41, 0x0000, "006" }
-};
-uint8_t txBuffer[1];
-uint8_t rxBuffer[2];
-I2C_Transaction i2cTransaction;
-uint8_t targetAddress;
-
-// Timer global variables
-volatile unsigned char TimerFlag = 0;
-
-// Thermostat global variables
-enum BUTTON_STATES {INCREASE_SETPOINT, DECREASE_SETPOINT, BUTTONS_INIT} BUTTON_STATE;   // States for setting which button was pressed.
-enum SENSOR_STATES {READ_SENSOR, SENSOR_INIT};                                          // States for the temperature sensor.
-enum HEAT_STATES {HEAT_OFF, HEAT_ON, HEAT_INIT};                                        // States for the heating (heat/led off or on).
-int16_t amb_temp = 0;      // Initialize temperature to 0 (will be updated by sensor reading).
-int16_t user_temp_setpoint = 20;               // Initialize set-point for thermostat at 20C (68F).
-int seconds = 0;                     // Initialize seconds to 0 (will be updated by timer).
-
-/*
- *  ======== Callback ========
- */
-// GPIO button callback function to increase the thermostat set-point.
-void button_raise_setpoint(uint_least8_t index)
-{
-    BUTTON_STATE = INCREASE_SETPOINT;
-}
-
-// GPIO button callback function to decrease the thermostat set-point.
-void button_lower_setpoint(uint_least8_t index)
-{
-    BUTTON_STATE = DECREASE_SETPOINT;
-}
-
-// Timer callback
-void timerCallback(Timer_Handle myHandle, int_fast16_t status)
-{
-    TimerFlag = 1;  // Set flag to 1 to indicate timer is running.
-}
-
-/*
- *  ======== Initializations ========
- */
-// initiialize the display UART (server)
-/* Open the UART display for output */
-void init_Display(){
-
-    Display_init();
-    display = Display_open(Display_Type_UART, NULL);
-    if (display == NULL)
-    {
-        while (1) {}
-    }
-}
-
-// Initialize I2C
-// initiialize I2C
-void init_I2C(void){
-
-    I2C_init();
-    I2C_Params i2cParams;
-    Display_printf(display, 0, 0, "Initializing I2C Driver - \n");
-
-    /* Create I2C for usage */
-    I2C_Params_init(&i2cParams);
-    i2cParams.bitRate = I2C_400kHz;
-    i2c               = I2C_open(CONFIG_I2C_0, &i2cParams);
-    if (i2c == NULL)
-    {
-        Display_printf(display, 0, 0, "Error Initializing I2C\n");
-        while (1) {}
-    }
-    else
-    {
-        Display_printf(display, 0, 0, "I2C Initialized!\n");
-    }
-
-    /* Common I2C transaction setup */
-    i2cTransaction.writeBuf   = txBuffer;
-    i2cTransaction.writeCount = 1;
-    i2cTransaction.readBuf    = rxBuffer;
-    i2cTransaction.readCount  = 0;
-}
-
-// initialize TMP116
-void init_Sensor(void){
-
-    int8_t i;
-    for (i = 0; i < 3; i++)
-    {
-        i2cTransaction.targetAddress = sensors[i].address;
-        txBuffer[0]                  = sensors[i].resultReg;
-
-        if (I2C_transfer(i2c, &i2cTransaction))
-        {
-            targetAddress = sensors[i].address;
-            Display_printf(display,
-                           0,
-                           0,
-                           "Detected TMP%s sensor with target"
-                           " address 0x%x",
-                           sensors[i].id,
-                           sensors[i].address);
-        }
-        else
-        {
-            i2cErrorHandler(&i2cTransaction, display);
-        }
-    }
-
-    /* If we never assigned a target address */
-    if (targetAddress == 0)
-    {
-        Display_printf(display, 0, 0, "Failed to detect a sensor!");
-        I2C_close(i2c);
-        while (1) {}
-    }
-
-    //Display_printf(display, 0, 0, "\nUsing last known sensor for samples.");
-    i2cTransaction.targetAddress = targetAddress;
-}
-
-
-
-// initialize GPIO
-void init_GPIO(){
-
-    /* Call driver init functions for GPIO */
-    GPIO_init();
-
-    /* Configure the LED and button pins */
-    GPIO_setConfig(CONFIG_GPIO_LED_0, GPIO_CFG_OUT_STD | GPIO_CFG_OUT_LOW);
-    GPIO_setConfig(CONFIG_GPIO_BUTTON_0, GPIO_CFG_IN_PU | GPIO_CFG_IN_INT_FALLING);
-
-    /* Start with LED off */
-    GPIO_write(CONFIG_GPIO_LED_0, CONFIG_GPIO_LED_OFF);
-
-    /* Install Button callback */
-    GPIO_setCallback(CONFIG_GPIO_BUTTON_0, button_raise_setpoint);
-
-    /* Enable interrupts */
-    GPIO_enableInt(CONFIG_GPIO_BUTTON_0);
-
-    /*
-     *  If more than one input pin is available for your device, interrupts
-     *  will be enabled on CONFIG_GPIO_BUTTON1.
-     */
-    if (CONFIG_GPIO_BUTTON_0 != CONFIG_GPIO_BUTTON_1) {
-        /* Configure BUTTON1 pin */
-        GPIO_setConfig(CONFIG_GPIO_BUTTON_1, GPIO_CFG_IN_PU | GPIO_CFG_IN_INT_FALLING);
-
-        /* Install Button callback */
-        GPIO_setCallback(CONFIG_GPIO_BUTTON_1, button_lower_setpoint);
-        GPIO_enableInt(CONFIG_GPIO_BUTTON_1);
-    }
-
-    BUTTON_STATE = BUTTONS_INIT;
-}
-
-// Initialize Timer
-void init_Timer(void)
-{
-    Timer_Params params;
-
-    // Init the driver
-    Timer_init();
-
-    // Configure the driver
-    Timer_Params_init(&params);
-    params.period = 100000;                         // Set period to 1/10th of 1 second.
-    params.periodUnits = Timer_PERIOD_US;           // Period specified in micro seconds
-    params.timerMode = Timer_CONTINUOUS_CALLBACK;   // Timer runs continuously.
-    params.timerCallback = timerCallback;           // Calls timerCallback method for timer callback.
-
-    // Open the driver
-    timer0 = Timer_open(CONFIG_TIMER_0, &params);
-    if (timer0 == NULL)
-    {
-        /* Failed to initialized timer */
-        while (1) {}
-    }
-    if (Timer_start(timer0) == Timer_STATUS_ERROR)
-    {
-        /* Failed to start timer */
-        while (1) {}
-    }
-}
-
-/*
- *  ======== adjust_setpoint ========
- *
- *  Check the current state of GPIO buttons
-    CCS32200SF LAUNCH Board oriented with USB connector facing away from user
-    left will increase
-    Right will decrease
- */
-int adjust_setpoint(int state)
-{
-    // Checks if desired temperature has been adjusted.
-    switch (state)
-    {
-        case INCREASE_SETPOINT:
-            if (user_temp_setpoint < 99)      // Ensure temperature is not set to above 99C.
-            {
-                user_temp_setpoint++;
-            }
-            BUTTON_STATE = BUTTONS_INIT;
-            break;
-        case DECREASE_SETPOINT:
-            if (user_temp_setpoint > 0)       // Ensure temperature is not set lower than 0C.
-            {
-                user_temp_setpoint--;
-            }
-            BUTTON_STATE = BUTTONS_INIT;
-            break;
-    }
-    state = BUTTON_STATE;           // Reset the state of GPIO buttons after reading.
-
-    return state;
-}
-
-/*
- *  ======== readTemp ========
- *
- *  Read in the current temperature from the sensor and return the reading.
- */
-int16_t readTemp(void)
-{
-    int16_t temperature = 0;
-    i2cTransaction.readCount = 2;
-    if (I2C_transfer(i2c, &i2cTransaction))
-    {
-        /*
-        * Extract degrees C from the received data;
-        * see TMP sensor datasheet
-        */
-        temperature = (rxBuffer[0] << 8) | (rxBuffer[1]); temperature *= 0.0078125;
-        /*
-        * If the MSB is set '1', then we have a 2's complement * negative value which needs to be sign extended
-        */
-        if (rxBuffer[0] & 0x80)
-        {
-            temperature |= 0xF000;
-        }
-    }
-    else
-    {
-        Display_printf(display, 0, 0, "Error reading temperature sensor (%d)\n\r",i2cTransaction.status);
-        Display_printf(display, 0, 0, "Please power cycle your board by unplugging USB and plugging back in.\n\r");
-    }
-    return temperature;
-}
-
-/*
- *  ======== getTemp ========
- *
- * reads sensor data for current temperature
- */
-int getTemp(int state)
-{
-    switch (state)
-    {
-        case SENSOR_INIT:
-            state = READ_SENSOR;
-            break;
-
-        case READ_SENSOR:
-            amb_temp = readTemp();
-            break;
-    }
-
-    return state;
-}
-
-/*
- *  ======== heatController ========
- *
- *  Compares the ambient temperature to the set-point.
- *  Turns on the heat (Led on) if ambient temperature is lower than the set-point.
- *  Turns off the heat (Led off) if ambient temperature is higher than the set-point.
- */
-int heatController(int state)
-{
-    if (seconds != 0)
-    {
-
-        if (amb_temp < user_temp_setpoint)  // Turn on the heat.
-        {
-            GPIO_write(CONFIG_GPIO_LED_0, CONFIG_GPIO_LED_ON);
-            state = HEAT_ON;
-        }
-        else                                // Turn off the heat.
-        {
-            GPIO_write(CONFIG_GPIO_LED_0, CONFIG_GPIO_LED_OFF);
-            state = HEAT_OFF;
-        }
-
-        // Report status to the server.
-        Display_printf(display, 0, 0,
-                             "<%02d,%02d,%d,%04d>\n\r",
-                             amb_temp,
-                             user_temp_setpoint,
-                             state,
-                             seconds);
-    }
-
-    seconds++;
-
-    return state;
-}
-
-
-
-/*
- *  ======== mainThread ========
- */
-void *mainThread(void *arg0)
-{
-    // Create task list with tasks.
-    task tasks[num_tasks] = {
-        // Task 1 - Check button state and update set point.
-        {
-            .state = BUTTONS_INIT,
-            .period = timer_period_buttons,
-            .elapsedTime = timer_period_buttons,
-            .tickFunction = &adjust_setpoint
-        },
-        // Task 2 - Get temperature from sensor.
-        {
-            .state = SENSOR_INIT,
-            .period = timer_period_sensor_read,
-            .elapsedTime = timer_period_sensor_read,
-            .tickFunction = &getTemp
-        },
-        // Task 3 - Update heat mode and server.
-        {
-            .state = HEAT_INIT,
-            .period = timer_period_output,
-            .elapsedTime = timer_period_output,
-            .tickFunction = &heatController
-        }
-    };
-
-    // Call init functions for the drivers.
-    //initUART();
-    init_Display();
-    init_I2C();
-    init_GPIO();
-    init_Sensor();
-    init_Timer();
-
-    // Loop forever.
-    while (1)
-    {
-        unsigned int i = 0;
-        for (i = 0; i < num_tasks; ++i)
-        {
-            if ( tasks[i].elapsedTime >= tasks[i].period )
-            {
-                tasks[i].state = tasks[i].tickFunction(tasks[i].state);
-                tasks[i].elapsedTime = 0;
-             }
-             tasks[i].elapsedTime += timer_period_gcd;
-        }
-
-        // Wait for timer period.
-        while(!TimerFlag){}
-        // Set the timer flag variable to FALSE.
-        TimerFlag = 0;
-    }
-
-    return (NULL);
-}
-
-// error handling for I2C
-static void i2cErrorHandler(I2C_Transaction *transaction, Display_Handle display)
-{
-    switch (transaction->status)
-    {
-        case I2C_STATUS_TIMEOUT:
-            Display_printf(display, 0, 0, "I2C transaction timed out!");
-            break;
-        case I2C_STATUS_CLOCK_TIMEOUT:
-            Display_printf(display, 0, 0, "I2C serial clock line timed out!");
-            break;
-        case I2C_STATUS_ADDR_NACK:
-            Display_printf(display,
-                           0,
-                           0,
-                           "I2C extraneous target address 0x%x not"
-                           " acknowledged!",
-                           transaction->targetAddress);
-            break;
-        case I2C_STATUS_DATA_NACK:
-            Display_printf(display, 0, 0, "I2C data byte not acknowledged!");
-            break;
-        case I2C_STATUS_ARB_LOST:
-            Display_printf(display, 0, 0, "I2C arbitration to another controller!");
-            break;
-        case I2C_STATUS_INCOMPLETE:
-            Display_printf(display, 0, 0, "I2C transaction returned before completion!");
-            break;
-        case I2C_STATUS_BUS_BUSY:
-            Display_printf(display, 0, 0, "I2C bus is already in use!");
-            break;
-        case I2C_STATUS_CANCEL:
-            Display_printf(display, 0, 0, "I2C transaction cancelled!");
-            break;
-        case I2C_STATUS_INVALID_TRANS:
-            Display_printf(display, 0, 0, "I2C transaction invalid!");
-            break;
-        case I2C_STATUS_ERROR:
-            Display_printf(display, 0, 0, "I2C generic error!");
-            break;
-        default:
-            Display_printf(display, 0, 0, "I2C undefined error case!");
-            break;
-    }
-}
-
+/*
+ * Robert Murphy
+ * 6/16/2024
+ * CS 350 Final Project
+ */
+
+/*
+ * This program will control a thermostat located on the TI CC3220SF
+ * LAUNCH development board. This program will check the buttons
+ * every 200ms, check the temperature every 500ms, and update the LED
+ * and report to the server every second (via the UART). If the
+ * right-side button is pushed, it will increase the temp set-point
+ * by 1 degree. If the left-side button is pushed, it will decrease
+ * the temp set-point by 1 degree. If the temperature is greater than
+ * the set-point, the LED will turn off. If the temperature is less
+ * than the set-point, the LED will turn on (the LED controls a
+ * heater). You can simulate a heating or cooling room by putting
+ * your finger on the temperature sensor. The output to the server
+ * (via UART) will be formatted as <AA,BB,S,CCCC>.
+ */
+
+ /* Where:
+
+   AA = ASCII decimal value of room temperature (00 - 99) degrees Celsius
+   BB = ASCII decimal value of set-point temperature (00-99) degrees Celsius
+   S = 0 if heat is off, 1 if heat is on
+   CCCC = decimal count of seconds since board has been reset
+   <%02d,%02d,%d,%04d> = temperature, set-point, heat, seconds
+ */
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <unistd.h>
+
+/* Driver Header files */
+#include <ti/drivers/GPIO.h>
+#include <ti/drivers/I2C.h>
+#include <ti/drivers/Timer.h>
+#include <ti/drivers/UART2.h>
+
+/* Driver configuration */
+#include "ti_drivers_config.h"
+
+/* Status reports, diagnostic log and UART commands, sharing the UART
+ * through the channel multiplexer */
+#include "report.h"
+#include "telemetry.h"
+#include "log.h"
+#include "command.h"
+#include "mux.h"
+
+/* Fixed point smoothing of the sensor readings */
+#include "filter.h"
+
+/* Frequency and duty cycle of the signal on the capture pin */
+#include "capture.h"
+
+/* With FILTER_BENCH set to 1 the filters are timed at start up and the
+ * results logged (see filterbench.h) */
+#ifndef FILTER_BENCH
+#define FILTER_BENCH 0
+#endif
+
+/* With FFT_BENCH set to 1 the FFT and the Goertzel detector are timed at
+ * start up and the results logged (see fftbench.h) */
+#ifndef FFT_BENCH
+#define FFT_BENCH 0
+#endif
+
+#if FILTER_BENCH || FFT_BENCH
+#include "cycles.h"
+#endif
+#if FILTER_BENCH
+#include "filterbench.h"
+#endif
+#if FFT_BENCH
+#include "fftbench.h"
+#endif
+
+// global time constants per function
+#define timer_period_gcd 100
+#define timer_period_buttons 200
+#define timer_period_sensor_read 500
+#define timer_period_output 1000
+#define timer_period_commands 100
+
+// Input capture: edges on CONFIG_GPIO_CAPTURE are timed by CONFIG_TIMER_1,
+// which runs free at the 80 MHz CPU clock, and averaged over each window.
+#define capture_clock_hz 80000000
+#define capture_window_ms 1000
+
+#define num_tasks 4
+/*
+ *  ======== Task Type ========
+ *
+ *  Defines structure for the task type.
+ */
+typedef struct task {
+    int state;                    // Current state of the task
+    unsigned long period;         // Rate at which the task should tick
+    unsigned long elapsedTime;    // Time since task's previous tick
+    int (*tickFunction)(int);     // Function to call for task's tick
+} task;
+
+
+
+/*
+ *  ======== Driver Handles ========
+ */
+I2C_Handle i2c;         // I2C driver handle
+Timer_Handle timer0;    // Timer driver handle
+UART2_Handle uart;      // UART driver handle (XDS110 UART, was the Display)
+Timer_Handle clockTimer;    // Free-running timer that time-stamps capture edges
+static void i2cErrorHandler(I2C_Transaction *transaction);
+
+/*
+ *  ======== Global Variables ========
+ */
+// I2C global variables
+static const struct
+{
+    uint8_t address;
+    uint8_t resultReg;
+    char *id;
+}
+sensors[3] = {
+    { 0x48, 0x0000, "11X" },
+    { 0x49, 0x0000, "116" },
+    { 0x41, 0x0000, "006" }
+};
+uint8_t txBuffer[1];
+uint8_t rxBuffer[2];
+I2C_Transaction i2cTransaction;
+uint8_t targetAddress;
+
+// Timer global variables
+volatile unsigned char TimerFlag = 0;
+
+// Thermostat global variables
+enum BUTTON_STATES {INCREASE_SETPOINT, DECREASE_SETPOINT, BUTTONS_INIT} BUTTON_STATE;   // States for setting which button was pressed.
+enum SENSOR_STATES {READ_SENSOR, SENSOR_INIT};                                          // States for the temperature sensor.
+enum HEAT_STATES {HEAT_OFF, HEAT_ON, HEAT_INIT} HEAT_STATE = HEAT_OFF;                  // States for the heating (heat/led off or on).
+enum COMMAND_STATES {READ_COMMANDS, COMMANDS_INIT};                                     // States for the UART command channel.
+int16_t amb_temp = 0;      // Initialize temperature to 0 (will be updated by sensor reading).
+int16_t user_temp_setpoint = 20;               // Initialize set-point for thermostat at 20C (68F).
+int seconds = 0;                     // Initialize seconds to 0 (will be updated by timer).
+unsigned long tick_overruns = 0;     // Scheduler ticks where the tasks ran past the timer period.
+
+// Sensor smoothing: a second order Butterworth low pass at 0.1 Hz on the
+// 2 Hz readings, in Q14 (see filter.h). The b coefficients add up to
+// 1 - a1 - a2, so a steady temperature comes through unchanged.
+static const int16_t temp_filter_coeffs[FILTER_BIQUAD_Q15_COEFFS] = {329, 0, 658, 329, 25576, -10508};
+static int16_t temp_filter_state[FILTER_BIQUAD_STATE(1)];
+static FilterBiquadQ15 temp_filter;
+static int temp_filter_settled = 0;  // Set by the first good reading.
+
+// Input capture, filled by its GPIO callback and read in the idle loop.
+static Capture capture;
+
+/*
+ *  ======== Callback ========
+ */
+// GPIO button callback function to increase the thermostat set-point.
+void button_raise_setpoint(uint_least8_t index)
+{
+    BUTTON_STATE = INCREASE_SETPOINT;
+}
+
+// GPIO button callback function to decrease the thermostat set-point.
+void button_lower_setpoint(uint_least8_t index)
+{
+    BUTTON_STATE = DECREASE_SETPOINT;
+}
+
+// GPIO callback for the capture pin: time-stamps the edge, nothing more.
+void capture_input_edge(uint_least8_t index)
+{
+    capture_edge(&capture, Timer_getCount(clockTimer), GPIO_read(index));
+}
+
+// Timer callback
+void timerCallback(Timer_Handle myHandle, int_fast16_t status)
+{
+    TimerFlag = 1;  // Set flag to 1 to indicate timer is running.
+}
+
+/*
+ *  ======== Initializations ========
+ */
+// initiialize the UART (server)
+/* Open the XDS110 UART for output. This used to be opened through the
+ * Display driver, which formats every line through its own printf engine
+ * and 1024 byte buffer; the UART2 driver is now used directly instead. */
+void init_UART(void)
+{
+    UART2_Params uartParams;
+
+    UART2_Params_init(&uartParams);
+    uartParams.baudRate = 115200;
+    // Reads return right away with whatever has arrived so the command
+    // task never holds up the scheduler. Writes only fill the driver's
+    // TX ring; the multiplexer feeds it from the idle loop.
+    uartParams.readMode = UART2_Mode_NONBLOCKING;
+    uartParams.readReturnMode = UART2_ReadReturnMode_PARTIAL;
+    uartParams.writeMode = UART2_Mode_NONBLOCKING;
+
+    uart = UART2_open(CONFIG_UART2_1, &uartParams);
+    if (uart == NULL)
+    {
+        /* UART2_open() failed */
+        while (1) {}
+    }
+
+    // Reports, command replies and diagnostics share the same UART as
+    // separate channels (see mux.h, and log.h for the log record format).
+    mux_init(uart);
+    command_init(uart);
+}
+
+// Initialize I2C
+// initiialize I2C
+void init_I2C(void){
+
+    I2C_init();
+    I2C_Params i2cParams;
+    LOG0("Initializing I2C Driver - ");
+
+    /* Create I2C for usage */
+    I2C_Params_init(&i2cParams);
+    i2cParams.bitRate = I2C_400kHz;
+    i2c               = I2C_open(CONFIG_I2C_0, &i2cParams);
+    if (i2c == NULL)
+    {
+        LOG0("Error Initializing I2C");
+        mux_flush();
+        while (1) {}
+    }
+    else
+    {
+        LOG0("I2C Initialized!");
+    }
+
+    /* Common I2C transaction setup */
+    i2cTransaction.writeBuf   = txBuffer;
+    i2cTransaction.writeCount = 1;
+    i2cTransaction.readBuf    = rxBuffer;
+    i2cTransaction.readCount  = 0;
+}
+
+// initialize TMP116
+void init_Sensor(void){
+
+    int8_t i;
+    for (i = 0; i < 3; i++)
+    {
+        i2cTransaction.targetAddress = sensors[i].address;
+        txBuffer[0]                  = sensors[i].resultReg;
+
+        if (I2C_transfer(i2c, &i2cTransaction))
+        {
+            targetAddress = sensors[i].address;
+            LOG2("Detected TMP%s sensor with target"
+                 " address 0x%x",
+                 sensors[i].id,
+                 sensors[i].address);
+        }
+        else
+        {
+            i2cErrorHandler(&i2cTransaction);
+        }
+    }
+
+    /* If we never assigned a target address */
+    if (targetAddress == 0)
+    {
+        LOG0("Failed to detect a sensor!");
+        mux_flush();
+        I2C_close(i2c);
+        while (1) {}
+    }
+
+    //Display_printf(display, 0, 0, "\nUsing last known sensor for samples.");
+    i2cTransaction.targetAddress = targetAddress;
+}
+
+
+
+// initialize GPIO
+void init_GPIO(){
+
+    /* Call driver init functions for GPIO */
+    GPIO_init();
+
+    /* Configure the LED and button pins */
+    GPIO_setConfig(CONFIG_GPIO_LED_0, GPIO_CFG_OUT_STD | GPIO_CFG_OUT_LOW);
+    GPIO_setConfig(CONFIG_GPIO_BUTTON_0, GPIO_CFG_IN_PU | GPIO_CFG_IN_INT_FALLING);
+
+    /* Start with LED off */
+    GPIO_write(CONFIG_GPIO_LED_0, CONFIG_GPIO_LED_OFF);
+
+    /* Install Button callback */
+    GPIO_setCallback(CONFIG_GPIO_BUTTON_0, button_raise_setpoint);
+
+    /* Enable interrupts */
+    GPIO_enableInt(CONFIG_GPIO_BUTTON_0);
+
+    /*
+     *  If more than one input pin is available for your device, interrupts
+     *  will be enabled on CONFIG_GPIO_BUTTON1.
+     */
+    if (CONFIG_GPIO_BUTTON_0 != CONFIG_GPIO_BUTTON_1) {
+        /* Configure BUTTON1 pin */
+        GPIO_setConfig(CONFIG_GPIO_BUTTON_1, GPIO_CFG_IN_PU | GPIO_CFG_IN_INT_FALLING);
+
+        /* Install Button callback */
+        GPIO_setCallback(CONFIG_GPIO_BUTTON_1, button_lower_setpoint);
+        GPIO_enableInt(CONFIG_GPIO_BUTTON_1);
+    }
+
+    BUTTON_STATE = BUTTONS_INIT;
+}
+
+// Initialize Timer
+void init_Timer(void)
+{
+    Timer_Params params;
+
+    // Init the driver
+    Timer_init();
+
+    // Configure the driver
+    Timer_Params_init(&params);
+    params.period = 100000;                         // Set period to 1/10th of 1 second.
+    params.periodUnits = Timer_PERIOD_US;           // Period specified in micro seconds
+    params.timerMode = Timer_CONTINUOUS_CALLBACK;   // Timer runs continuously.
+    params.timerCallback = timerCallback;           // Calls timerCallback method for timer callback.
+
+    // Open the driver
+    timer0 = Timer_open(CONFIG_TIMER_0, &params);
+    if (timer0 == NULL)
+    {
+        /* Failed to initialized timer */
+        while (1) {}
+    }
+    if (Timer_start(timer0) == Timer_STATUS_ERROR)
+    {
+        /* Failed to start timer */
+        while (1) {}
+    }
+}
+
+// Initialize the input capture
+void init_Capture(void)
+{
+    Timer_Params params;
+
+    // Timer_init() has been called by init_Timer().
+    Timer_Params_init(&params);
+    params.period = 0xFFFFFFFF;
+    params.periodUnits = Timer_PERIOD_COUNTS;
+    params.timerMode = Timer_FREE_RUNNING;     // Wraps every 53 s.
+
+    clockTimer = Timer_open(CONFIG_TIMER_1, &params);
+    if (clockTimer == NULL || Timer_start(clockTimer) == Timer_STATUS_ERROR)
+    {
+        /* Failed to start the capture clock */
+        while (1) {}
+    }
+
+    // Both edges; the pull-down keeps a pin with nothing on it low.
+    GPIO_setConfig(CONFIG_GPIO_CAPTURE, GPIO_CFG_IN_PD | GPIO_CFG_IN_INT_BOTH_EDGES);
+    capture_init(&capture, capture_clock_hz, capture_window_ms,
+                 Timer_getCount(clockTimer), GPIO_read(CONFIG_GPIO_CAPTURE));
+    GPIO_setCallback(CONFIG_GPIO_CAPTURE, capture_input_edge);
+    GPIO_enableInt(CONFIG_GPIO_CAPTURE);
+}
+
+/*
+ *  ======== adjust_setpoint ========
+ *
+ *  Check the current state of GPIO buttons
+    CCS32200SF LAUNCH Board oriented with USB connector facing away from user
+    left will increase
+    Right will decrease
+ */
+int adjust_setpoint(int state)
+{
+    // Checks if desired temperature has been adjusted.
+    switch (state)
+    {
+        case INCREASE_SETPOINT:
+            if (user_temp_setpoint < 99)      // Ensure temperature is not set to above 99C.
+            {
+                user_temp_setpoint++;
+            }
+            BUTTON_STATE = BUTTONS_INIT;
+            break;
+        case DECREASE_SETPOINT:
+            if (user_temp_setpoint > 0)       // Ensure temperature is not set lower than 0C.
+            {
+                user_temp_setpoint--;
+            }
+            BUTTON_STATE = BUTTONS_INIT;
+            break;
+    }
+    state = BUTTON_STATE;           // Reset the state of GPIO buttons after reading.
+
+    return state;
+}
+
+/*
+ *  ======== readTemp ========
+ *
+ *  Read in the current temperature from the sensor, in 1/128 degree C
+ *  steps. Returns 0 if the sensor did not answer, otherwise 1.
+ */
+int readTemp(int16_t *reading)
+{
+    i2cTransaction.readCount = 2;
+    if (I2C_transfer(i2c, &i2cTransaction))
+    {
+        /*
+        * The received data is the temperature in 1/128 degree steps, as
+        * a 2's complement number, so negative values come out sign
+        * extended already; see TMP sensor datasheet
+        */
+        *reading = (int16_t)((rxBuffer[0] << 8) | rxBuffer[1]);
+        return 1;
+    }
+
+    LOG1("Error reading temperature sensor (%d)", (int)i2cTransaction.status);
+    LOG0("Please power cycle your board by unplugging USB and plugging back in.");
+    return 0;
+}
+
+/*
+ *  ======== getTemp ========
+ *
+ * reads sensor data for current temperature
+ */
+int getTemp(int state)
+{
+    int16_t reading;
+
+    switch (state)
+    {
+        case SENSOR_INIT:
+            filter_biquadInitQ15(&temp_filter, temp_filter_coeffs, 1, temp_filter_state);
+            state = READ_SENSOR;
+            break;
+
+        case READ_SENSOR:
+            // A failed reading leaves the temperature as it was.
+            if (readTemp(&reading))
+            {
+                // Start the filter at the first reading rather than at 0.
+                if (!temp_filter_settled)
+                {
+                    filter_biquadSettleQ15(&temp_filter, reading);
+                    temp_filter_settled = 1;
+                }
+                // Smooth in 1/128 degree steps, then round to whole degrees.
+                filter_biquadQ15(&temp_filter, &reading, &reading, 1);
+                amb_temp = (reading + 64) >> 7;
+            }
+            break;
+    }
+
+    return state;
+}
+
+/*
+ *  ======== heatController ========
+ *
+ *  Compares the ambient temperature to the set-point.
+ *  Turns on the heat (Led on) if ambient temperature is lower than the set-point.
+ *  Turns off the heat (Led off) if ambient temperature is higher than the set-point.
+ */
+int heatController(int state)
+{
+    if (seconds != 0)
+    {
+
+        if (amb_temp < user_temp_setpoint)  // Turn on the heat.
+        {
+            GPIO_write(CONFIG_GPIO_LED_0, CONFIG_GPIO_LED_ON);
+            state = HEAT_ON;
+        }
+        else                                // Turn off the heat.
+        {
+            GPIO_write(CONFIG_GPIO_LED_0, CONFIG_GPIO_LED_OFF);
+            state = HEAT_OFF;
+        }
+        HEAT_STATE = (enum HEAT_STATES)state;   // Kept for the GET command.
+
+        // Report status to the server; the telemetry policy decides
+        // whether this second is sent (see telemetry.h).
+        telemetry_sample(amb_temp,
+                         user_temp_setpoint,
+                         state,
+                         seconds);
+    }
+
+    seconds++;
+
+    return state;
+}
+
+/*
+ *  ======== readCommands ========
+ *
+ *  Runs every command received on the UART since the last tick.
+ *  See command.h for the command set.
+ */
+int readCommands(int state)
+{
+    TelemetryConfig config;
+    TelemetryStats stats;
+    MuxStats muxStats;
+    Command cmd;
+    char reply[112];
+    char *p;
+    unsigned i;
+
+    switch (state)
+    {
+        case COMMANDS_INIT:
+            state = READ_COMMANDS;
+            break;
+
+        case READ_COMMANDS:
+            while (command_poll(&cmd))
+            {
+                telemetry_getConfig(&config);
+
+                switch (cmd.command)
+                {
+                    case CMD_SET:
+                        if (cmd.arg > 99)       // Same limits as the buttons.
+                        {
+                            command_reply("ERR", 3);
+                            continue;
+                        }
+                        user_temp_setpoint = cmd.arg;
+                        break;
+
+                    case CMD_GET:
+                        command_reply(reply,
+                                      report_format(reply, amb_temp, user_temp_setpoint,
+                                                    HEAT_STATE, seconds) - 2);
+                        continue;
+
+                    case CMD_RATE:
+                        config.policy = (cmd.arg <= 1) ? TELEMETRY_FIXED : TELEMETRY_HEARTBEAT;
+                        config.heartbeat = cmd.arg;
+                        telemetry_setConfig(&config);
+                        break;
+
+                    case CMD_CHANGE:
+                        config.policy = TELEMETRY_ON_CHANGE;
+                        config.threshold = cmd.arg;
+                        telemetry_setConfig(&config);
+                        break;
+
+                    case CMD_AGG:
+                        config.policy = TELEMETRY_AGGREGATE;
+                        config.window = cmd.arg;
+                        telemetry_setConfig(&config);
+                        break;
+
+                    case CMD_DUMP:
+                        // STAT <bytes sent>,<bytes at 1 Hz>,<reports>,<tick overruns>,
+                        //      <dropped telemetry>,<dropped replies>,<dropped log>,
+                        //      <dropped capture edges>,<capture bytes sent>
+                        telemetry_getStats(&stats);
+                        mux_getStats(&muxStats);
+                        p = reply;
+                        *p++ = 'S'; *p++ = 'T'; *p++ = 'A'; *p++ = 'T'; *p++ = ' ';
+                        p = report_putInt(p, stats.bytesSent, 1);
+                        *p++ = ',';
+                        p = report_putInt(p, stats.bytesFixed, 1);
+                        *p++ = ',';
+                        p = report_putInt(p, stats.reports, 1);
+                        *p++ = ',';
+                        p = report_putInt(p, tick_overruns, 1);
+                        for (i = 0; i < MUX_NUM_CHANNELS; i++)
+                        {
+                            *p++ = ',';
+                            p = report_putInt(p, muxStats.dropped[i], 1);
+                        }
+                        *p++ = ',';
+                        p = report_putInt(p, capture.dropped, 1);
+                        *p++ = ',';
+                        p = report_putInt(p, stats.bytesCapture, 1);
+                        command_reply(reply, p - reply);
+                        continue;
+
+                    default:
+                        command_reply("ERR", 3);
+                        continue;
+                }
+                command_reply("OK", 2);
+            }
+            break;
+    }
+
+    return state;
+}
+
+
+/*
+ *  ======== readCapture ========
+ *
+ *  Takes the edges the capture pin has seen and passes each finished
+ *  window on to telemetry. Called from the idle loop, so the ring is
+ *  emptied all through the tick, not only once per tick.
+ */
+void readCapture(void)
+{
+    CaptureResult result;
+
+    while (capture_poll(&capture, Timer_getCount(clockTimer), &result))
+    {
+        telemetry_capture(&result, seconds);
+    }
+}
+
+#if FILTER_BENCH || FFT_BENCH
+/*
+ *  ======== cycleCount ========
+ */
+static uint32_t cycleCount(void)
+{
+    return CYCLES_NOW();
+}
+#endif
+
+#if FILTER_BENCH
+
+/*
+ *  ======== benchFilters ========
+ *
+ *  Times the filters with the cycle counter and logs, for each case, the
+ *  checksum tools/filterbench.c prints for it on the host and the cost in
+ *  cycles per 100 taps.
+ */
+static void benchFilters(void)
+{
+    FilterBenchResult results[FILTERBENCH_CASES];
+    int i;
+
+    CYCLES_ENABLE();
+    filterbench_run(results, cycleCount);
+    for (i = 0; i < FILTERBENCH_CASES; i++)
+    {
+        uint32_t taps = (uint32_t)results[i].outputs * results[i].macs;
+
+        LOG2("%s: checksum %08x", results[i].name, results[i].checksum);
+        LOG2("%s: %d cycles per 100 taps", results[i].name,
+             (int)(100ull * results[i].ticks / taps));
+        mux_flush();
+    }
+}
+#endif
+
+#if FFT_BENCH
+/*
+ *  ======== benchFft ========
+ *
+ *  Times each FFT size and the Goertzel detector with the cycle counter
+ *  and logs the checksum tools/fftcheck.c prints for it on the host and
+ *  the cycles it took.
+ */
+static void benchFft(void)
+{
+    FftBenchResult results[FFTBENCH_CASES];
+    int i;
+
+    CYCLES_ENABLE();
+    fftbench_run(results, cycleCount);
+    for (i = 0; i < FFTBENCH_CASES; i++)
+    {
+        LOG2("%s: checksum %08x", results[i].name, results[i].checksum);
+        LOG2("%s: %d cycles", results[i].name, (int)results[i].ticks);
+        mux_flush();
+    }
+}
+#endif
+
+/*
+ *  ======== mainThread ========
+ */
+void *mainThread(void *arg0)
+{
+    // Create task list with tasks.
+    task tasks[num_tasks] = {
+        // Task 1 - Check button state and update set point.
+        {
+            .state = BUTTONS_INIT,
+            .period = timer_period_buttons,
+            .elapsedTime = timer_period_buttons,
+            .tickFunction = &adjust_setpoint
+        },
+        // Task 2 - Get temperature from sensor.
+        {
+            .state = SENSOR_INIT,
+            .period = timer_period_sensor_read,
+            .elapsedTime = timer_period_sensor_read,
+            .tickFunction = &getTemp
+        },
+        // Task 3 - Update heat mode and server.
+        {
+            .state = HEAT_INIT,
+            .period = timer_period_output,
+            .elapsedTime = timer_period_output,
+            .tickFunction = &heatController
+        },
+        // Task 4 - Handle commands from the server.
+        {
+            .state = COMMANDS_INIT,
+            .period = timer_period_commands,
+            .elapsedTime = timer_period_commands,
+            .tickFunction = &readCommands
+        }
+    };
+
+    // Call init functions for the drivers.
+    init_UART();
+    init_I2C();
+    init_GPIO();
+    init_Sensor();
+    init_Timer();
+    init_Capture();
+#if FILTER_BENCH
+    benchFilters();
+#endif
+#if FFT_BENCH
+    benchFft();
+#endif
+
+    // Loop forever.
+    while (1)
+    {
+        unsigned int i = 0;
+        for (i = 0; i < num_tasks; ++i)
+        {
+            if ( tasks[i].elapsedTime >= tasks[i].period )
+            {
+                tasks[i].state = tasks[i].tickFunction(tasks[i].state);
+                tasks[i].elapsedTime = 0;
+             }
+             tasks[i].elapsedTime += timer_period_gcd;
+        }
+
+        // Count ticks where the tasks took longer than the timer period.
+        if (TimerFlag)
+        {
+            tick_overruns++;
+        }
+
+        // Wait for timer period, sending queued output and taking
+        // capture edges meanwhile.
+        while(!TimerFlag)
+        {
+            mux_service();
+            readCapture();
+        }
+        // Set the timer flag variable to FALSE.
+        TimerFlag = 0;
+    }
+
+    return (NULL);
+}
+
+// error handling for I2C
+static void i2cErrorHandler(I2C_Transaction *transaction)
+{
+    switch (transaction->status)
+    {
+        case I2C_STATUS_TIMEOUT:
+            LOG0("I2C transaction timed out!");
+            break;
+        case I2C_STATUS_CLOCK_TIMEOUT:
+            LOG0("I2C serial clock line timed out!");
+            break;
+        case I2C_STATUS_ADDR_NACK:
+            LOG1("I2C extraneous target address 0x%x not"
+                 " acknowledged!",
+                 transaction->targetAddress);
+            break;
+        case I2C_STATUS_DATA_NACK:
+            LOG0("I2C data byte not acknowledged!");
+            break;
+        case I2C_STATUS_ARB_LOST:
+            LOG0("I2C arbitration to another controller!");
+            break;
+        case I2C_STATUS_INCOMPLETE:
+            LOG0("I2C transaction returned before completion!");
+            break;
+        case I2C_STATUS_BUS_BUSY:
+            LOG0("I2C bus is already in use!");
+            break;
+        case I2C_STATUS_CANCEL:
+            LOG0("I2C transaction cancelled!");
+            break;
+        case I2C_STATUS_INVALID_TRANS:
+            LOG0("I2C transaction invalid!");
+            break;
+        case I2C_STATUS_ERROR:
+            LOG0("I2C generic error!");
+            break;
+        default:
+            LOG0("I2C undefined error case!");
+            break;
+    }
+}
+
@@ -0,0 +1,76 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== log.c ========
+ *
+ *  Deferred (host formatted) and text diagnostic logging. See log.h.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "log.h"
+#include "mux.h"
+
+/*
+ *  ======== log_record ========
+ */
+void log_record(const char *fmt, uint8_t nargs, uint32_t a0, uint32_t a1)
+{
+    uint8_t record[4 + 2 * 4];
+    uint16_t id = (uint16_t)(((uintptr_t)fmt - LOG_DATA_BASE) >> 2);
+    uint8_t length = 0;
+
+    record[length++] = LOG_RECORD_START;
+    record[length++] = (uint8_t)id;
+    record[length++] = (uint8_t)(id >> 8);
+    record[length++] = nargs;
+
+    if (nargs > 0)
+    {
+        record[length++] = (uint8_t)a0;
+        record[length++] = (uint8_t)(a0 >> 8);
+        record[length++] = (uint8_t)(a0 >> 16);
+        record[length++] = (uint8_t)(a0 >> 24);
+    }
+    if (nargs > 1)
+    {
+        record[length++] = (uint8_t)a1;
+        record[length++] = (uint8_t)(a1 >> 8);
+        record[length++] = (uint8_t)(a1 >> 16);
+        record[length++] = (uint8_t)(a1 >> 24);
+    }
+
+    mux_write(MUX_LOG, record, length);
+}
+
+/*
+ *  ======== log_printf ========
+ */
+void log_printf(const char *fmt, ...)
+{
+    char line[96];
+    va_list args;
+    int length;
+
+    va_start(args, fmt);
+    length = vsnprintf(line, sizeof(line) - 2, fmt, args);
+    va_end(args);
+
+    if (length < 0)
+    {
+        return;
+    }
+    if (length > (int)sizeof(line) - 3)
+    {
+        length = sizeof(line) - 3;      // message was truncated
+    }
+    line[length++] = '\r';
+    line[length++] = '\n';
+
+    mux_write(MUX_LOG, line, length);
+}
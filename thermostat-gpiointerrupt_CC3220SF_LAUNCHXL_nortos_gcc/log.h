@@ -0,0 +1,80 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== log.h ========
+ *
+ *  Diagnostic logging for the thermostat.
+ *
+ *  With LOG_DEFERRED set to 1 (the default) the format strings are placed
+ *  in the .log_data section, which the linker script keeps in the .out file
+ *  but never loads onto the target. At run time only a small binary record
+ *  goes out on the log channel (see mux.h):
+ *
+ *      0xFE, id (2 bytes LE), argument count, arguments (4 bytes LE each)
+ *
+ *  where id is the string's offset into .log_data divided by 4. The host
+ *  tool tools/logdecode.c reads the strings back out of the .out file and
+ *  rebuilds the messages. Arguments for %s must point at constant strings
+ *  (they are looked up in the .out file as well).
+ *
+ *  With LOG_DEFERRED set to 0 the messages are formatted on the target, as
+ *  before, and written to the log channel as text.
+ */
+
+#ifndef LOG_H_
+#define LOG_H_
+
+#include <stdint.h>
+
+#ifndef LOG_DEFERRED
+#define LOG_DEFERRED 1
+#endif
+
+/* Marks the start of a deferred log record; never part of the text output */
+#define LOG_RECORD_START 0xFE
+
+/* Base address of the .log_data region in cc32xxsf_nortos.lds */
+#define LOG_DATA_BASE 0x90000000
+
+#if LOG_DEFERRED
+
+/* Each format string gets its own aligned, off-target copy. */
+#define LOG_STRING(name, fmt) \
+    static const char name[] \
+    __attribute__((section(".log_data"), aligned(4), used)) = fmt
+
+#define LOG0(fmt) \
+    do { LOG_STRING(logFmt, fmt); \
+         log_record(logFmt, 0, 0, 0); } while (0)
+#define LOG1(fmt, a0) \
+    do { LOG_STRING(logFmt, fmt); \
+         log_record(logFmt, 1, (uint32_t)(uintptr_t)(a0), 0); } while (0)
+#define LOG2(fmt, a0, a1) \
+    do { LOG_STRING(logFmt, fmt); \
+         log_record(logFmt, 2, (uint32_t)(uintptr_t)(a0), \
+                    (uint32_t)(uintptr_t)(a1)); } while (0)
+
+#else
+
+#define LOG0(fmt)           log_printf(fmt)
+#define LOG1(fmt, a0)       log_printf(fmt, a0)
+#define LOG2(fmt, a0, a1)   log_printf(fmt, a0, a1)
+
+#endif
+
+/*
+ *  ======== log_record ========
+ *  Writes one deferred log record. Use the LOGn() macros instead.
+ */
+void log_record(const char *fmt, uint8_t nargs, uint32_t a0, uint32_t a1);
+
+/*
+ *  ======== log_printf ========
+ *  Formats the message on the target and writes it as a line of text.
+ */
+void log_printf(const char *fmt, ...);
+
+#endif /* LOG_H_ */
@@ -0,0 +1,204 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== mux.c ========
+ *
+ *  Prioritized channel multiplexer for the thermostat UART. See mux.h.
+ */
+
+#include "mux.h"
+
+// Queue sizes, powers of two. The log gets the most room since the
+// I2C errors and start-up messages can come in bursts.
+#define TELEMETRY_QUEUE_SIZE 128
+#define REPLY_QUEUE_SIZE     128
+#define LOG_QUEUE_SIZE       512
+
+/*
+ * Each queue is a ring of packets, each stored as a length byte followed
+ * by the payload. head and tail run freely and are masked on use.
+ */
+typedef struct {
+    uint8_t *data;
+    uint16_t size;
+    uint16_t head;              // next byte to write
+    uint16_t tail;              // next byte to send
+} Queue;
+
+static uint8_t telemetryQueue[TELEMETRY_QUEUE_SIZE];
+static uint8_t replyQueue[REPLY_QUEUE_SIZE];
+static uint8_t logQueue[LOG_QUEUE_SIZE];
+
+static Queue queues[MUX_NUM_CHANNELS] = {
+    { telemetryQueue, TELEMETRY_QUEUE_SIZE, 0, 0 },
+    { replyQueue,     REPLY_QUEUE_SIZE,     0, 0 },
+    { logQueue,       LOG_QUEUE_SIZE,       0, 0 },
+};
+
+static UART2_Handle muxUart = NULL;
+static MuxStats stats;
+
+// Frame being written to the driver
+#if MUX_FRAMED
+static uint8_t frame[2 + 2 * (1 + MUX_MAX_PAYLOAD)];
+#else
+static uint8_t frame[MUX_MAX_PAYLOAD];
+#endif
+static size_t frameLength = 0;
+static size_t frameSent = 0;
+
+#if MUX_FRAMED
+/*
+ *  ======== putByte ========
+ */
+static size_t putByte(size_t n, uint8_t byte)
+{
+    if (byte == MUX_FLAG || byte == MUX_ESCAPE)
+    {
+        frame[n++] = MUX_ESCAPE;
+        byte ^= 0x20;
+    }
+    frame[n++] = byte;
+    return n;
+}
+#endif
+
+/*
+ *  ======== nextFrame ========
+ *  Takes the next packet from the highest priority queue that has one
+ *  and builds its frame. Returns 0 if every queue is empty.
+ */
+static int nextFrame(void)
+{
+    unsigned channel;
+
+    for (channel = 0; channel < MUX_NUM_CHANNELS; channel++)
+    {
+        Queue *q = &queues[channel];
+        uint16_t mask = q->size - 1;
+        uint8_t length;
+        uint8_t i;
+        size_t n = 0;
+
+        if (q->head == q->tail)
+        {
+            continue;
+        }
+
+        length = q->data[q->tail++ & mask];
+#if MUX_FRAMED
+        frame[n++] = MUX_FLAG;
+        n = putByte(n, (uint8_t)channel);
+        for (i = 0; i < length; i++)
+        {
+            n = putByte(n, q->data[q->tail++ & mask]);
+        }
+        frame[n++] = MUX_FLAG;
+#else
+        for (i = 0; i < length; i++)
+        {
+            frame[n++] = q->data[q->tail++ & mask];
+        }
+#endif
+        stats.bytes[channel] += length;
+        frameLength = n;
+        frameSent = 0;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ *  ======== mux_init ========
+ */
+void mux_init(UART2_Handle uart)
+{
+    muxUart = uart;
+}
+
+/*
+ *  ======== mux_write ========
+ */
+int mux_write(enum MUX_CHANNELS channel, const void *data, size_t length)
+{
+    const uint8_t *bytes = data;
+    Queue *q = &queues[channel];
+    uint16_t mask = q->size - 1;
+    size_t packets = (length + MUX_MAX_PAYLOAD - 1) / MUX_MAX_PAYLOAD;
+
+    if (length + packets > (size_t)(q->size - (uint16_t)(q->head - q->tail)))
+    {
+        stats.dropped[channel]++;
+        return 0;
+    }
+
+    while (length > 0)
+    {
+        uint8_t chunk = (length > MUX_MAX_PAYLOAD) ? MUX_MAX_PAYLOAD : (uint8_t)length;
+
+        q->data[q->head++ & mask] = chunk;
+        length -= chunk;
+        while (chunk-- > 0)
+        {
+            q->data[q->head++ & mask] = *bytes++;
+        }
+    }
+    return 1;
+}
+
+/*
+ *  ======== mux_service ========
+ */
+void mux_service(void)
+{
+    if (muxUart == NULL)
+    {
+        return;
+    }
+
+    while (frameSent < frameLength || nextFrame())
+    {
+        size_t written = 0;
+
+        // Non-blocking: takes what fits in the TX ring buffer.
+        UART2_write(muxUart, frame + frameSent, frameLength - frameSent, &written);
+        frameSent += written;
+        if (frameSent < frameLength)
+        {
+            return;
+        }
+    }
+}
+
+/*
+ *  ======== mux_flush ========
+ */
+void mux_flush(void)
+{
+    unsigned channel;
+
+    if (muxUart == NULL)
+    {
+        return;
+    }
+
+    for (channel = 0; channel < MUX_NUM_CHANNELS; channel++)
+    {
+        while (queues[channel].head != queues[channel].tail || frameSent < frameLength)
+        {
+            mux_service();
+        }
+    }
+}
+
+/*
+ *  ======== mux_getStats ========
+ */
+void mux_getStats(MuxStats *current)
+{
+    *current = stats;
+}
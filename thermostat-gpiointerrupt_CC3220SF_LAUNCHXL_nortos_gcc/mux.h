@@ -0,0 +1,88 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== mux.h ========
+ *
+ *  Logical channels over the single XDS110 UART. Status reports, command
+ *  replies and diagnostic log output each go into their own queue, and
+ *  mux_service() sends the queued packets, always taking the next packet
+ *  from the highest priority channel that has one. A report queued while
+ *  a long run of log output is going out is sent after the packet that is
+ *  on the wire at the time, not after the whole backlog.
+ *
+ *  With MUX_FRAMED set to 1 (the default) every packet is framed so the
+ *  host can split the stream again (tools/muxdemux.c):
+ *
+ *      0x7E  channel  payload (1 - MUX_MAX_PAYLOAD bytes)  0x7E
+ *
+ *  0x7E and 0x7D inside a frame are sent as 0x7D followed by the byte
+ *  XOR 0x20. With MUX_FRAMED set to 0 the payloads are written as they
+ *  are, still in priority order, and the output looks as it did before.
+ *
+ *  Each channel is a byte stream; the framing does not have to line up
+ *  with reports or log records. A write that does not fit in its queue is
+ *  dropped whole and counted.
+ *
+ *  All calls must come from the main loop (not from callbacks).
+ */
+
+#ifndef MUX_H_
+#define MUX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <ti/drivers/UART2.h>
+
+#ifndef MUX_FRAMED
+#define MUX_FRAMED 1
+#endif
+
+#define MUX_FLAG        0x7E
+#define MUX_ESCAPE      0x7D
+#define MUX_MAX_PAYLOAD 32
+
+/* Channel numbers, highest priority first */
+enum MUX_CHANNELS {MUX_TELEMETRY, MUX_REPLY, MUX_LOG, MUX_NUM_CHANNELS};
+
+typedef struct {
+    uint32_t bytes[MUX_NUM_CHANNELS];       // payload bytes sent
+    uint32_t dropped[MUX_NUM_CHANNELS];     // writes that did not fit
+} MuxStats;
+
+/*
+ *  ======== mux_init ========
+ *  uart must have been opened with writeMode = UART2_Mode_NONBLOCKING.
+ *  Output queued before this is held until then.
+ */
+void mux_init(UART2_Handle uart);
+
+/*
+ *  ======== mux_write ========
+ *  Queues length bytes on channel. Returns 0 if they did not fit (nothing
+ *  is queued), otherwise 1.
+ */
+int mux_write(enum MUX_CHANNELS channel, const void *data, size_t length);
+
+/*
+ *  ======== mux_service ========
+ *  Moves as much queued output into the UART driver as it has room for,
+ *  then returns. Call it whenever the main loop is idle.
+ */
+void mux_service(void);
+
+/*
+ *  ======== mux_flush ========
+ *  Waits until everything queued has been handed to the driver.
+ */
+void mux_flush(void);
+
+/*
+ *  ======== mux_getStats ========
+ */
+void mux_getStats(MuxStats *current);
+
+#endif /* MUX_H_ */
@@ -0,0 +1,79 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== report.c ========
+ *
+ *  Allocation-free formatter for the <AA,BB,S,CCCC> status report.
+ */
+
+#include "report.h"
+
+/*
+ *  ======== report_putInt ========
+ */
+char *report_putInt(char *p, int32_t value, uint8_t minDigits)
+{
+    char digits[10];            // 2^32 has 10 decimal digits
+    uint32_t magnitude;
+    uint8_t count = 0;
+
+    if (value < 0)
+    {
+        *p++ = '-';
+        magnitude = (uint32_t)0 - (uint32_t)value;  // safe for INT32_MIN
+        if (minDigits > 0)
+        {
+            minDigits--;        // the sign counts towards the field width
+        }
+    }
+    else
+    {
+        magnitude = (uint32_t)value;
+    }
+
+    // Collect digits least significant first.
+    do
+    {
+        digits[count++] = (char)('0' + (magnitude % 10));
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    // Zero pad, then copy the digits out in the right order.
+    while (minDigits > count)
+    {
+        *p++ = '0';
+        minDigits--;
+    }
+    while (count > 0)
+    {
+        *p++ = digits[--count];
+    }
+
+    return p;
+}
+
+/*
+ *  ======== report_format ========
+ */
+size_t report_format(char *buf, int16_t temperature, int16_t setpoint,
+                     int heat, int seconds)
+{
+    char *p = buf;
+
+    *p++ = '<';
+    p = report_putInt(p, temperature, 2);
+    *p++ = ',';
+    p = report_putInt(p, setpoint, 2);
+    *p++ = ',';
+    *p++ = heat ? '1' : '0';
+    *p++ = ',';
+    p = report_putInt(p, seconds, 4);
+    *p++ = '>';
+    *p++ = '\r';
+    *p++ = '\n';
+
+    return (size_t)(p - buf);
+}
@@ -0,0 +1,41 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== report.h ========
+ *
+ *  Fixed-field formatter for the thermostat status report <AA,BB,S,CCCC>.
+ *  Each field is written straight into a caller supplied buffer, so the
+ *  once-per-second report no longer goes through a printf engine.
+ */
+
+#ifndef REPORT_H_
+#define REPORT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Worst case "<-32768,-32768,1,-2147483648>\r\n", 31 bytes, rounded up;
+ * heat is always written as a single digit */
+#define REPORT_MAX_LEN 32
+
+/*
+ *  ======== report_putInt ========
+ *  Writes value in decimal, zero padded to at least minDigits characters
+ *  (sign included, same as "%0Nd"). Returns the position after the last
+ *  character written. No terminating NUL is added.
+ */
+char *report_putInt(char *p, int32_t value, uint8_t minDigits);
+
+/*
+ *  ======== report_format ========
+ *  Formats "<%02d,%02d,%d,%04d>\r\n" into buf (at least REPORT_MAX_LEN
+ *  bytes) and returns the number of bytes written. No terminating NUL.
+ *  Any non-zero heat is written as 1.
+ */
+size_t report_format(char *buf, int16_t temperature, int16_t setpoint,
+                     int heat, int seconds);
+
+#endif /* REPORT_H_ */
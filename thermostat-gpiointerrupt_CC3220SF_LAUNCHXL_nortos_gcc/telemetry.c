@@ -0,0 +1,256 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== telemetry.c ========
+ *
+ *  Report-on-change, heartbeat and aggregated telemetry. See telemetry.h.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "mux.h"
+#include "report.h"
+#include "telemetry.h"
+
+static TelemetryConfig config = { TELEMETRY_FIXED, 1, 60, 60 };
+static TelemetryStats stats;
+
+// Last report sent (TELEMETRY_ON_CHANGE)
+static int16_t lastTemp;
+static int16_t lastSetpoint;
+static int lastHeat;
+static uint16_t sinceReport;
+static uint8_t reported = 0;
+
+// Current aggregation window (TELEMETRY_AGGREGATE)
+static int16_t minTemp;
+static int16_t maxTemp;
+static int32_t sumTemp;
+static uint16_t count = 0;
+static uint16_t heatOn;
+
+// Last input capture record sent
+static uint16_t lastCaptureLevel;
+static uint8_t captureIdle = 1;
+
+/*
+ *  ======== send ========
+ *  A report. Input capture records are counted apart, so bytesSent can
+ *  still be set against bytesFixed. Returns 0 if the mux dropped it.
+ */
+static int send(const char *buf, size_t length)
+{
+    if (!mux_write(MUX_TELEMETRY, buf, length))
+    {
+        return 0;               // counted as dropped by the mux
+    }
+    stats.bytesSent += length;
+    stats.reports++;
+    return 1;
+}
+
+/*
+ *  ======== sendWindow ========
+ *  [MIN,MAX,MEAN,BB,H,CCCC]
+ */
+static void sendWindow(int16_t setpoint, int seconds)
+{
+    char buf[REPORT_MAX_LEN + 16];
+    char *p = buf;
+    // Round the mean half away from zero.
+    int32_t mean = (sumTemp >= 0) ? (sumTemp + count / 2) / count
+                                  : (sumTemp - count / 2) / count;
+
+    *p++ = '[';
+    p = report_putInt(p, minTemp, 2);
+    *p++ = ',';
+    p = report_putInt(p, maxTemp, 2);
+    *p++ = ',';
+    p = report_putInt(p, mean, 2);
+    *p++ = ',';
+    p = report_putInt(p, setpoint, 2);
+    *p++ = ',';
+    p = report_putInt(p, heatOn, 1);
+    *p++ = ',';
+    p = report_putInt(p, seconds, 4);
+    *p++ = ']';
+    *p++ = '\r';
+    *p++ = '\n';
+
+    send(buf, (size_t)(p - buf));
+    count = 0;
+}
+
+/*
+ *  ======== putNs ========
+ */
+static char *putNs(char *p, uint32_t ns)
+{
+    return report_putInt(p, (ns > INT32_MAX) ? INT32_MAX : (int32_t)ns, 1);
+}
+
+/*
+ *  ======== telemetry_capture ========
+ *  {F,P,W,D,CCCC}
+ */
+void telemetry_capture(const CaptureResult *result, int seconds)
+{
+    char buf[REPORT_MAX_LEN + 24];
+    char *p = buf;
+    uint8_t idle = (result->periods == 0);
+
+    // A pin with nothing on it is only reported when its level changes.
+    if (idle && captureIdle && result->level == lastCaptureLevel)
+    {
+        return;
+    }
+
+    *p++ = '{';
+    p = report_putInt(p, (int32_t)(result->milliHz / 1000), 1);
+    *p++ = '.';
+    p = report_putInt(p, (int32_t)(result->milliHz % 1000), 3);
+    *p++ = ',';
+    p = putNs(p, result->periodNs);
+    *p++ = ',';
+    p = putNs(p, result->widthNs);
+    *p++ = ',';
+    p = report_putInt(p, result->duty / 10, 1);
+    *p++ = '.';
+    p = report_putInt(p, result->duty % 10, 1);
+    *p++ = ',';
+    p = report_putInt(p, seconds, 4);
+    *p++ = '}';
+    *p++ = '\r';
+    *p++ = '\n';
+
+    // The idle state only moves on once the record is out, so a quiet pin
+    // whose record the mux dropped is reported again next window.
+    if (mux_write(MUX_TELEMETRY, buf, (size_t)(p - buf)))
+    {
+        stats.bytesCapture += (uint32_t)(p - buf);
+        stats.captures++;
+        captureIdle = idle;
+        lastCaptureLevel = result->level;
+    }
+}
+
+/*
+ *  ======== telemetry_setConfig ========
+ */
+void telemetry_setConfig(const TelemetryConfig *newConfig)
+{
+    config = *newConfig;
+    if (config.threshold == 0)
+    {
+        config.threshold = 1;
+    }
+    if (config.heartbeat == 0)
+    {
+        config.heartbeat = 1;
+    }
+    if (config.window == 0)
+    {
+        config.window = 1;
+    }
+
+    // Start the new policy from a clean state.
+    reported = 0;
+    sinceReport = 0;
+    count = 0;
+}
+
+/*
+ *  ======== telemetry_getConfig ========
+ */
+void telemetry_getConfig(TelemetryConfig *current)
+{
+    *current = config;
+}
+
+/*
+ *  ======== telemetry_getStats ========
+ */
+void telemetry_getStats(TelemetryStats *current)
+{
+    *current = stats;
+}
+
+/*
+ *  ======== telemetry_sample ========
+ */
+void telemetry_sample(int16_t temperature, int16_t setpoint, int heat, int seconds)
+{
+    char buf[REPORT_MAX_LEN];
+    size_t length = report_format(buf, temperature, setpoint, heat, seconds);
+    uint8_t sendReport = 0;
+
+    // What the original once a second stream would have cost.
+    stats.bytesFixed += length;
+    sinceReport++;
+
+    switch (config.policy)
+    {
+        case TELEMETRY_FIXED:
+            sendReport = 1;
+            break;
+
+        case TELEMETRY_ON_CHANGE:
+            if (!reported
+                || abs(temperature - lastTemp) >= config.threshold
+                || setpoint != lastSetpoint
+                || heat != lastHeat
+                || sinceReport >= config.heartbeat)
+            {
+                sendReport = 1;
+            }
+            break;
+
+        case TELEMETRY_HEARTBEAT:
+            if (!reported || sinceReport >= config.heartbeat)
+            {
+                sendReport = 1;
+            }
+            break;
+
+        case TELEMETRY_AGGREGATE:
+            if (count == 0)
+            {
+                minTemp = temperature;
+                maxTemp = temperature;
+                sumTemp = 0;
+                heatOn = 0;
+            }
+            if (temperature < minTemp)
+            {
+                minTemp = temperature;
+            }
+            if (temperature > maxTemp)
+            {
+                maxTemp = temperature;
+            }
+            sumTemp += temperature;
+            heatOn += (heat != 0);
+            count++;
+
+            if (count >= config.window)
+            {
+                sendWindow(setpoint, seconds);
+            }
+            break;
+    }
+
+    // A report the mux dropped is not the last one sent; the next sample
+    // tries again.
+    if (sendReport && send(buf, length))
+    {
+        lastTemp = temperature;
+        lastSetpoint = setpoint;
+        lastHeat = heat;
+        sinceReport = 0;
+        reported = 1;
+    }
+}
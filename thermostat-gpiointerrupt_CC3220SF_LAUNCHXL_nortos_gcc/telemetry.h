@@ -0,0 +1,86 @@
+/*
+ * Robert Murphy
+ * CS 350 Final Project
+ */
+
+/*
+ *  ======== telemetry.h ========
+ *
+ *  Decides when the thermostat reports to the server. heatController()
+ *  hands every 1 second sample to telemetry_sample() and the selected
+ *  policy decides what, if anything, goes out on the telemetry channel
+ *  (see mux.h):
+ *
+ *  TELEMETRY_FIXED      <AA,BB,S,CCCC> every second (the original stream)
+ *  TELEMETRY_ON_CHANGE  <AA,BB,S,CCCC> when the temperature moves by at
+ *                       least threshold degrees since the last report, or
+ *                       the set-point or heater changes, and at least
+ *                       every heartbeat seconds
+ *  TELEMETRY_HEARTBEAT  <AA,BB,S,CCCC> every heartbeat seconds
+ *  TELEMETRY_AGGREGATE  [MIN,MAX,MEAN,BB,H,CCCC] every window seconds, with
+ *                       the temperature range and mean over the window, the
+ *                       current set-point and H = seconds the heat was on
+ *
+ *  Whatever the policy, the input capture (see capture.h) adds
+ *  {F,P,W,D,CCCC} at the end of each of its windows while a signal is
+ *  there, and once when it stops or the pin changes level: F = frequency
+ *  in Hz to 3 decimals, P = period and W = pulse width in ns, D = duty
+ *  cycle in % to 1 decimal.
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+
+#include "capture.h"
+
+enum TELEMETRY_POLICIES {TELEMETRY_FIXED, TELEMETRY_ON_CHANGE, TELEMETRY_HEARTBEAT, TELEMETRY_AGGREGATE};
+
+typedef struct {
+    enum TELEMETRY_POLICIES policy;
+    uint16_t threshold;         // degrees, TELEMETRY_ON_CHANGE
+    uint16_t heartbeat;         // seconds, TELEMETRY_ON_CHANGE/HEARTBEAT
+    uint16_t window;            // seconds, TELEMETRY_AGGREGATE
+} TelemetryConfig;
+
+typedef struct {
+    uint32_t bytesSent;         // report bytes actually queued for the UART
+    uint32_t bytesFixed;        // bytes the fixed 1 Hz stream would have sent
+    uint32_t reports;           // reports (or windows) sent
+    uint32_t bytesCapture;      // input capture bytes queued, not in bytesSent
+    uint32_t captures;          // input capture records sent
+} TelemetryStats;
+
+/*
+ *  ======== telemetry_setConfig ========
+ *  Changes the policy at run time. Zero intervals are raised to 1 second
+ *  and a zero threshold to 1 degree, since 0 would report every sample.
+ *  Any partly collected aggregation window is dropped.
+ */
+void telemetry_setConfig(const TelemetryConfig *config);
+
+/*
+ *  ======== telemetry_getConfig ========
+ */
+void telemetry_getConfig(TelemetryConfig *config);
+
+/*
+ *  ======== telemetry_sample ========
+ *  Called once per second with the current state.
+ */
+void telemetry_sample(int16_t temperature, int16_t setpoint, int heat, int seconds);
+
+/*
+ *  ======== telemetry_capture ========
+ *  Called with each input capture result.
+ */
+void telemetry_capture(const CaptureResult *result, int seconds);
+
+/*
+ *  ======== telemetry_getStats ========
+ *  Bytes saved against the fixed stream = bytesFixed - bytesSent.
+ */
+void telemetry_getStats(TelemetryStats *stats);
+
+#endif /* TELEMETRY_H_ */
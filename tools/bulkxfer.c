@@ -0,0 +1,466 @@
+/*
+ *  ======== bulkxfer.c ========
+ *
+ *  Host end of the uart2echo BULK transfer (protocol in bulk.h, which
+ *  this tool compiles from the firmware directory).
+ *
+ *  send      sends a file to the board: types BULK, waits for the echo,
+ *            runs the transfer and prints the board's summary line
+ *            ("BULK n CRC=xxxx ERR=n") next to the CRC of the file.
+ *
+ *  loopback  runs both ends over a pseudo-terminal pair, the receiver in a
+ *            child process, optionally corrupting bytes in both directions
+ *            and pacing each direction at a simulated line rate. Reports
+ *            goodput, retransmissions and whether the data arrived intact.
+ *
+ *  Build:  cc -O2 -I uart2echo_CC3220SF_LAUNCHXL_nortos_gcc -o bulkxfer \
+ *              tools/bulkxfer.c uart2echo_CC3220SF_LAUNCHXL_nortos_gcc/bulk.c
+ *  Usage:  bulkxfer send [-b baud] [--rtscts] device file
+ *          bulkxfer loopback [-b baud] [-n bytes] [-e errors per million]
+ */
+
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bulk.h"
+
+#define RECEIVER_IDLE_MS 1000   /* matches BULK_IDLE_TICKS in uart2echo.c */
+
+/* One direction of the line */
+typedef struct {
+    int fd;
+    long baud;                  /* 0: no pacing */
+    long errorsPerMillion;
+    unsigned long corrupted;
+} Wire;
+
+/* What the loopback receiver reports back to the parent */
+typedef struct {
+    BulkStats stats;
+    uint16_t crc;
+    int finished;
+} ReceiverResult;
+
+static uint16_t receivedCrc;
+
+/*
+ *  ======== nowMs ========
+ */
+static uint32_t nowMs(void *arg)
+{
+    struct timespec ts;
+
+    (void)arg;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+/*
+ *  ======== wireWrite ========
+ *  Writes a frame, corrupting bytes at the configured rate, then waits
+ *  as long as the frame would take on the line (10 bits per byte).
+ */
+static void wireWrite(void *arg, const uint8_t *data, size_t length)
+{
+    Wire *w = arg;
+    uint8_t copy[BULK_MAX_ENCODED];
+    size_t done = 0;
+    size_t i;
+
+    memcpy(copy, data, length);
+    for (i = 0; i < length && w->errorsPerMillion > 0; i++)
+    {
+        if (rand() % 1000000 < w->errorsPerMillion)
+        {
+            copy[i] ^= (uint8_t)(1 << (rand() % 8));
+            w->corrupted++;
+        }
+    }
+
+    while (done < length)
+    {
+        ssize_t n = write(w->fd, copy + done, length - done);
+        if (n < 0 && errno != EINTR)
+        {
+            perror("bulkxfer: write");
+            exit(1);
+        }
+        done += (n > 0) ? (size_t)n : 0;
+    }
+
+    if (w->baud > 0)
+    {
+        long long ns = (long long)length * 10 * 1000000000LL / w->baud;
+        struct timespec ts = { (time_t)(ns / 1000000000LL), (long)(ns % 1000000000LL) };
+        nanosleep(&ts, NULL);
+    }
+}
+
+/*
+ *  ======== deliver ========
+ */
+static void deliver(void *arg, const uint8_t *data, size_t length)
+{
+    (void)arg;
+    receivedCrc = bulk_crc16(receivedCrc, data, length);
+}
+
+/*
+ *  ======== setRaw ========
+ */
+static int setRaw(int fd, long baud, int rtscts)
+{
+    static const struct { long baud; speed_t speed; } speeds[] = {
+        { 9600, B9600 }, { 19200, B19200 }, { 38400, B38400 }, { 57600, B57600 },
+        { 115200, B115200 }, { 230400, B230400 }, { 460800, B460800 },
+        { 921600, B921600 }
+    };
+    struct termios tio;
+    size_t i;
+
+    if (tcgetattr(fd, &tio) != 0)
+    {
+        return -1;
+    }
+    cfmakeraw(&tio);
+    for (i = 0; baud > 0 && i < sizeof(speeds) / sizeof(speeds[0]); i++)
+    {
+        if (speeds[i].baud == baud)
+        {
+            cfsetspeed(&tio, speeds[i].speed);
+        }
+    }
+    if (rtscts)
+    {
+        tio.c_cflag |= CRTSCTS;
+    }
+    else
+    {
+        tio.c_cflag &= ~CRTSCTS;
+    }
+    return tcsetattr(fd, TCSANOW, &tio);
+}
+
+/*
+ *  ======== runSender ========
+ *  Returns 1 when the whole transfer was acknowledged, -1 if the sender
+ *  gave up.
+ */
+static int runSender(Wire *w, const uint8_t *data, size_t length, BulkStats *stats)
+{
+    BulkSender tx;
+    BulkPort port = { wireWrite, nowMs, NULL };
+    size_t offered = 0;
+    int rc = 0;
+
+    port.arg = w;
+    bulk_senderInit(&tx, &port);
+
+    while (rc == 0)
+    {
+        struct pollfd pfd = { w->fd, POLLIN, 0 };
+        uint8_t input[256];
+
+        offered += bulk_senderOffer(&tx, data + offered, length - offered, 1);
+
+        if (poll(&pfd, 1, 10) > 0)
+        {
+            ssize_t n = read(w->fd, input, sizeof(input));
+            if (n > 0)
+            {
+                bulk_senderInput(&tx, input, (size_t)n);
+            }
+        }
+        rc = bulk_senderPoll(&tx);
+    }
+
+    *stats = tx.stats;
+    return rc;
+}
+
+/*
+ *  ======== runReceiver ========
+ *  Like the board: receive until the line has been idle for
+ *  RECEIVER_IDLE_MS.
+ */
+static void runReceiver(Wire *w, ReceiverResult *result)
+{
+    BulkReceiver rx;
+    BulkPort port = { wireWrite, NULL, NULL };
+
+    port.arg = w;
+    receivedCrc = 0xFFFF;
+    bulk_receiverInit(&rx, &port, deliver);
+
+    for (;;)
+    {
+        struct pollfd pfd = { w->fd, POLLIN, 0 };
+        uint8_t input[256];
+        ssize_t n;
+
+        if (poll(&pfd, 1, RECEIVER_IDLE_MS) <= 0)
+        {
+            break;
+        }
+        n = read(w->fd, input, sizeof(input));
+        if (n <= 0)
+        {
+            break;
+        }
+        bulk_receiverInput(&rx, input, (size_t)n);
+    }
+
+    result->stats = rx.stats;
+    result->crc = receivedCrc;
+    result->finished = rx.finished;
+}
+
+/*
+ *  ======== printSummary ========
+ */
+static void printSummary(size_t length, double seconds, long baud, const BulkStats *tx)
+{
+    double goodput = (seconds > 0) ? length / seconds : 0;
+
+    printf("%zu bytes in %.3f s: goodput %.0f B/s", length, seconds, goodput);
+    if (baud > 0)
+    {
+        printf(" (%.1f%% of the %ld baud line)", 100.0 * goodput * 10 / baud, baud);
+    }
+    printf("\nsender: %u frames, %u retransmitted (%.2f%%), %u damaged ACKs\n",
+           tx->framesSent, tx->retransmits,
+           tx->framesSent ? 100.0 * tx->retransmits / tx->framesSent : 0.0, tx->crcErrors);
+}
+
+/*
+ *  ======== loopback ========
+ */
+static int loopback(size_t length, long baud, long errorsPerMillion)
+{
+    uint8_t *data = malloc(length ? length : 1);
+    ReceiverResult result;
+    BulkStats txStats;
+    Wire master = { -1, 0, 0, 0 };
+    Wire slave = { -1, 0, 0, 0 };
+    int results[2];
+    uint32_t t0;
+    double seconds;
+    uint16_t crc;
+    pid_t child;
+    size_t i;
+    int status;
+    int rc;
+
+    master.fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (data == NULL || master.fd < 0 || grantpt(master.fd) != 0 || unlockpt(master.fd) != 0
+        || (slave.fd = open(ptsname(master.fd), O_RDWR | O_NOCTTY)) < 0
+        || setRaw(slave.fd, 0, 0) != 0 || pipe(results) != 0)
+    {
+        perror("bulkxfer: pseudo-terminal");
+        return 1;
+    }
+    master.baud = slave.baud = baud;
+    master.errorsPerMillion = slave.errorsPerMillion = errorsPerMillion;
+
+    srand(1);
+    for (i = 0; i < length; i++)
+    {
+        data[i] = (uint8_t)rand();
+    }
+    crc = bulk_crc16(0xFFFF, data, length);
+
+    child = fork();
+    if (child < 0)
+    {
+        perror("bulkxfer: fork");
+        return 1;
+    }
+    if (child == 0)
+    {
+        srand(2);
+        close(master.fd);
+        runReceiver(&slave, &result);
+        if (write(results[1], &result, sizeof(result)) != (ssize_t)sizeof(result))
+        {
+            _exit(1);
+        }
+        _exit(0);
+    }
+    close(slave.fd);
+
+    t0 = nowMs(NULL);
+    rc = runSender(&master, data, length, &txStats);
+    seconds = (nowMs(NULL) - t0) / 1000.0;
+
+    if (read(results[0], &result, sizeof(result)) != (ssize_t)sizeof(result))
+    {
+        memset(&result, 0, sizeof(result));
+    }
+    waitpid(child, &status, 0);
+
+    printSummary(length, seconds, baud, &txStats);
+    printf("receiver: %u frames, %u damaged, %u bytes delivered\n",
+           result.stats.framesReceived, result.stats.crcErrors, result.stats.bytesDelivered);
+    printf("line: %lu bytes corrupted sender to receiver\n", master.corrupted);
+
+    if (rc < 0 || !result.finished || result.stats.bytesDelivered != length || result.crc != crc)
+    {
+        printf("FAILED: %s\n", rc < 0 ? "sender gave up" : "data does not match");
+        return 1;
+    }
+    printf("data intact (CRC %04X)\n", crc);
+    return 0;
+}
+
+/*
+ *  ======== sendFile ========
+ */
+static int sendFile(const char *device, const char *file, long baud, int rtscts)
+{
+    Wire w = { -1, 0, 0, 0 };
+    BulkStats stats;
+    FILE *f = fopen(file, "rb");
+    uint8_t *data = NULL;
+    size_t length = 0;
+    size_t capacity = 0;
+    char reply[64];
+    size_t replyLength = 0;
+    uint32_t t0;
+    double seconds;
+    int rc;
+
+    while (f != NULL && !feof(f))
+    {
+        if (length == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 65536;
+            data = realloc(data, capacity);
+            if (data == NULL)
+            {
+                return 1;
+            }
+        }
+        length += fread(data + length, 1, capacity - length, f);
+    }
+    if (f == NULL || ferror(f))
+    {
+        fprintf(stderr, "bulkxfer: cannot read %s\n", file);
+        return 1;
+    }
+    fclose(f);
+
+    w.fd = open(device, O_RDWR | O_NOCTTY);
+    if (w.fd < 0 || setRaw(w.fd, baud, rtscts) != 0)
+    {
+        fprintf(stderr, "bulkxfer: cannot open %s\n", device);
+        return 1;
+    }
+
+    // Start BULK mode and throw away the echo of the keyword.
+    if (write(w.fd, "BULK", 4) != 4)
+    {
+        perror("bulkxfer: write");
+        return 1;
+    }
+    usleep(100000);
+    tcflush(w.fd, TCIFLUSH);
+
+    t0 = nowMs(NULL);
+    rc = runSender(&w, data, length, &stats);
+    seconds = (nowMs(NULL) - t0) / 1000.0;
+    printSummary(length, seconds, baud, &stats);
+
+    // The board reports once the line has gone idle.
+    for (;;)
+    {
+        struct pollfd pfd = { w.fd, POLLIN, 0 };
+        ssize_t n;
+
+        if (replyLength == sizeof(reply) - 1 || poll(&pfd, 1, 3 * RECEIVER_IDLE_MS) <= 0)
+        {
+            break;
+        }
+        n = read(w.fd, reply + replyLength, sizeof(reply) - 1 - replyLength);
+        if (n <= 0)
+        {
+            break;
+        }
+        replyLength += (size_t)n;
+        reply[replyLength] = '\0';
+        if (replyLength > 2 && strstr(reply + 2, "\r\n") != NULL)
+        {
+            break;
+        }
+    }
+    reply[replyLength] = '\0';
+    printf("board: %s", replyLength ? reply + strspn(reply, "\r\n") : "(no reply)\n");
+    printf("file:  %zu bytes CRC=%04X\n", length, bulk_crc16(0xFFFF, data, length));
+
+    free(data);
+    close(w.fd);
+    return rc < 0;
+}
+
+/*
+ *  ======== main ========
+ */
+int main(int argc, char *argv[])
+{
+    const char *args[2];
+    int count = 0;
+    long baud = 0;
+    long length = 1 << 20;
+    long errorsPerMillion = 0;
+    int rtscts = 0;
+    int i;
+
+    for (i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+        {
+            baud = atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            length = atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+        {
+            errorsPerMillion = atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--rtscts") == 0)
+        {
+            rtscts = 1;
+        }
+        else if (count < 2)
+        {
+            args[count++] = argv[i];
+        }
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "loopback") == 0 && count == 0 && length >= 0)
+    {
+        return loopback((size_t)length, baud, errorsPerMillion);
+    }
+    if (argc >= 2 && strcmp(argv[1], "send") == 0 && count == 2)
+    {
+        return sendFile(args[0], args[1], baud ? baud : 115200, rtscts);
+    }
+
+    fprintf(stderr, "usage: %s send [-b baud] [--rtscts] device file\n"
+                    "       %s loopback [-b baud] [-n bytes] [-e errors per million]\n",
+            argv[0], argv[0]);
+    return 2;
+}
@@ -0,0 +1,466 @@
+/*
+ *  ======== capturecheck.c ========
+ *
+ *  Checks the thermostat's input capture (capture.c) on the host with
+ *  synthetic edge streams. Each stream is a square wave of known
+ *  frequency and duty cycle on the firmware's 80 MHz timer, starting
+ *  just before the 32 bit count wraps. Every edge is time-stamped late by
+ *  a random interrupt latency, as capture_edge() would see it. The main
+ *  loop is modelled as polling every few microseconds, except for a
+ *  stall once per 100 ms scheduler tick while the tasks run.
+ *
+ *      accuracy    frequencies from 1 Hz to 20 kHz and duty cycles from
+ *                  1% to 99%; every window's frequency, period, pulse
+ *                  width and duty cycle must be within what the latency
+ *                  and rounding allow
+ *      missed      the same with 1 edge in 50 never reaching the
+ *                  interrupt; the periods around it are dropped, and
+ *                  the rest must still be within bounds
+ *      stopped     a signal that stops high and then goes low reads as
+ *                  no periods with 100% and then 0% duty
+ *      quiet       a pin with no edges for 200 s, past where the count
+ *                  wraps, still reports once every window
+ *      threads     capture_edge() and capture_poll() on two threads at
+ *                  full speed, to exercise the ring without locks; with
+ *                  no latency every window must be exact, however many
+ *                  edges the ring had to drop
+ *
+ *  Then it raises the edge rate until the ring overflows during the
+ *  stall, and prints the highest rate with no dropped edges. That rate
+ *  depends on the ring size and the stall, not on the host. The
+ *  interrupt itself has to be shorter than the time between edges too,
+ *  which only the target can tell.
+ *
+ *  Build:  cc -O2 -pthread -I thermostat-gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc -o capturecheck \
+ *              tools/capturecheck.c thermostat-gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc/capture.c
+ *  Usage:  ./capturecheck [latency_us [stall_us]]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "capture.h"
+
+#define CLOCK_HZ   80000000u    // the CC3220SF timer runs at the CPU clock
+#define WINDOW_MS  1000
+#define POLL_US    20           // main loop idle pass
+#define TICK_US    100000       // scheduler tick
+
+static uint64_t seed = 88172645463325252ull;
+
+static uint32_t latency = 160;  // worst interrupt latency, counts
+static uint32_t stall = 1000;   // main loop stall per tick, us
+
+static Capture capture;
+
+typedef struct {
+    double hz;
+    double duty;                // high fraction
+    uint32_t missEvery;         // 1 edge in this many is lost, 0 for none
+    double seconds;
+} Signal;
+
+typedef struct {
+    uint32_t breaks;            // edges lost since the last window
+    uint32_t windows;           // results with periods
+    uint32_t bad;               // results out of bounds
+    uint32_t dropped;
+    double worstPpm;            // frequency
+    double worstDuty;           // tenths of a percent
+    double worstWidthNs;
+} Outcome;
+
+/*
+ *  ======== rnd ========
+ *  xorshift64
+ */
+static uint32_t rnd(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (uint32_t)(seed >> 32);
+}
+
+/*
+ *  ======== check ========
+ *  One window's result against the signal. Each time stamp is up to
+ *  latency + 1 counts out (latency, then truncation to whole counts),
+ *  and each result is rounded once more. Every lost edge starts a new
+ *  run of periods, with two more time stamps in the sums.
+ */
+static void check(const Signal *s, const CaptureResult *r, Outcome *out)
+{
+    double counts = CLOCK_HZ / s->hz;
+    double slack = (latency + 1.0) * (1 + out->breaks);
+    double span = r->periods * counts;
+    double hzError = fabs(r->milliHz / 1000.0 - s->hz);
+    double periodError = fabs(r->periodNs - 1e9 / s->hz);
+    double widthError = fabs(r->widthNs - 1e9 * s->duty / s->hz);
+    double dutyError = fabs(r->duty - 1000.0 * s->duty);
+    double ppm = 1e6 * hzError / s->hz;
+
+    out->windows++;
+    if (hzError > s->hz * slack / (span - slack) + 0.0005 + 1e-9 * s->hz
+        || periodError > 1e9 * slack / ((double)r->periods * CLOCK_HZ) + 1.0
+        || widthError > 1e9 * slack / CLOCK_HZ + 1.0
+        || dutyError > 1000.0 * 2 * slack / counts + 0.5)
+    {
+        if (out->bad++ == 0)
+        {
+            printf("  %.3f Hz %.1f%%: %u.%03u Hz, %u ns, %u ns high, %u.%u%%, %u periods\n",
+                   s->hz, 100 * s->duty, (unsigned)(r->milliHz / 1000),
+                   (unsigned)(r->milliHz % 1000), (unsigned)r->periodNs,
+                   (unsigned)r->widthNs, r->duty / 10, r->duty % 10, (unsigned)r->periods);
+        }
+    }
+    if (ppm > out->worstPpm)
+    {
+        out->worstPpm = ppm;
+    }
+    if (dutyError > out->worstDuty)
+    {
+        out->worstDuty = dutyError;
+    }
+    if (widthError > out->worstWidthNs)
+    {
+        out->worstWidthNs = widthError;
+    }
+}
+
+/*
+ *  ======== simulate ========
+ *  Runs the signal through capture.c with the interrupt and main loop
+ *  interleaved on one timeline, in timer counts from start (the true
+ *  time; the counts capture.c sees wrap at 32 bits).
+ */
+static void simulate(const Signal *s, Outcome *out)
+{
+    const uint32_t start = 0u - CLOCK_HZ / 3;
+    double counts = CLOCK_HZ / s->hz;
+    double phase = counts * (rnd() % 1000) / 1000.0;
+    uint64_t end = (uint64_t)(s->seconds * CLOCK_HZ);
+    uint64_t poll = 0;
+    uint64_t nextTick = (uint64_t)TICK_US * (CLOCK_HZ / 1000000);
+    uint64_t edges = 0;
+    uint32_t dropped = 0;
+    int missed = 0;
+    CaptureResult r;
+
+    capture_init(&capture, CLOCK_HZ, WINDOW_MS, start, 0);
+
+    for (;;)
+    {
+        // Edge 2k rises at phase + k periods, edge 2k+1 falls a width later.
+        double t = phase + (double)(edges / 2) * counts + ((edges & 1) ? s->duty * counts : 0.0);
+        uint64_t edge = (uint64_t)t + rnd() % (latency + 1);
+
+        if (edge >= end && poll >= end)
+        {
+            break;
+        }
+        if (edge < poll)
+        {
+            // Two in a row would look like a slower signal, even to the
+            // interrupt, so a lost edge is always followed by one that
+            // gets through.
+            if (s->missEvery != 0 && !missed && rnd() % s->missEvery == 0)
+            {
+                missed = 1;
+                out->breaks++;
+            }
+            else
+            {
+                capture_edge(&capture, start + (uint32_t)edge, !(edges & 1));
+                missed = 0;
+            }
+            edges++;
+            continue;
+        }
+
+        while (capture_poll(&capture, start + (uint32_t)poll, &r))
+        {
+            out->breaks += r.dropped - dropped;
+            dropped = r.dropped;
+            if (r.periods != 0)
+            {
+                check(s, &r, out);
+            }
+            out->breaks = 0;
+        }
+        poll += (uint64_t)POLL_US * (CLOCK_HZ / 1000000);
+        if (poll >= nextTick)
+        {
+            poll += (uint64_t)stall * (CLOCK_HZ / 1000000);
+            nextTick += (uint64_t)TICK_US * (CLOCK_HZ / 1000000);
+        }
+    }
+    out->dropped += capture.dropped;
+}
+
+/*
+ *  ======== testAccuracy ========
+ */
+static int testAccuracy(uint32_t missEvery)
+{
+    static const double hz[] = {1.0, 7.3, 50.0, 440.0, 1000.0, 2718.28, 12345.6, 20000.0};
+    static const double duty[] = {0.01, 0.1, 0.333, 0.5, 0.9, 0.99};
+    Outcome out = {0, 0, 0, 0, 0.0, 0.0, 0.0};
+    unsigned int i, j, runs = 0;
+
+    for (i = 0; i < sizeof(hz) / sizeof(hz[0]); i++)
+    {
+        for (j = 0; j < sizeof(duty) / sizeof(duty[0]); j++)
+        {
+            Signal s = {hz[i], duty[j], missEvery, 3.5 * WINDOW_MS / 1000.0};
+            double counts = CLOCK_HZ / s.hz;
+
+            // The edges must come in order after the latency.
+            if (duty[j] * counts < 2.0 * (latency + 1) || (1 - duty[j]) * counts < 2.0 * (latency + 1))
+            {
+                continue;
+            }
+            simulate(&s, &out);
+            runs++;
+        }
+    }
+
+    printf("%-9s %3u signals, %4u windows, worst %.3f ppm, %.2f ns high, %.2f/1000 duty %s\n",
+           missEvery ? "missed" : "accuracy", runs, out.windows, out.worstPpm,
+           out.worstWidthNs, out.worstDuty, (out.bad == 0 && out.windows >= 2 * runs) ? "ok" : "FAILED");
+    return out.bad == 0 && out.windows >= 2 * runs;
+}
+
+/*
+ *  ======== testStopped ========
+ *  1 kHz at 50% for 2.5 windows, ending on a rising edge, then high for
+ *  3.5 windows, then low. The last periods are reported a window after
+ *  the last edge; every window with periods must be exact, and the
+ *  windows after that must read high and then low.
+ */
+static int testStopped(void)
+{
+    const uint32_t start = 12345;
+    const uint32_t half = CLOCK_HZ / 2000;
+    const uint32_t window = CLOCK_HZ / 1000 * WINDOW_MS;
+    uint32_t k, edges = 5 * window / 2 / half + 1;
+    CaptureResult r;
+    int high = 0, low = 0, ok = 1;
+
+    capture_init(&capture, CLOCK_HZ, WINDOW_MS, start, 0);
+    for (k = 0; k < 14 * window / half; k++)
+    {
+        uint32_t t = start + k * half;
+
+        if (k < edges)
+        {
+            capture_edge(&capture, t, !(k & 1));
+        }
+        else if (k == 6 * window / half)
+        {
+            capture_edge(&capture, t, 0);
+        }
+        while (capture_poll(&capture, t, &r))
+        {
+            if (r.periods != 0)
+            {
+                ok &= (r.milliHz == 1000000 && r.duty == 500 && !high && !low);
+            }
+            else if (r.level)
+            {
+                ok &= (r.duty == 1000 && !low);
+                high++;
+            }
+            else
+            {
+                ok &= (r.duty == 0 && r.milliHz == 0 && high);
+                low++;
+            }
+        }
+    }
+    ok &= (high >= 1 && low >= 1);
+
+    printf("stopped   high then low reads 100%% then 0%%, no periods  %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/*
+ *  ======== testQuiet ========
+ *  No edges at all, polled every 10 ms.
+ */
+static int testQuiet(void)
+{
+    const uint32_t start = 12345;
+    const uint32_t poll = CLOCK_HZ / 100;
+    const uint32_t windows = 200000 / WINDOW_MS;
+    CaptureResult r;
+    uint32_t k, reports = 0;
+    int ok = 1;
+
+    capture_init(&capture, CLOCK_HZ, WINDOW_MS, start, 1);
+    for (k = 1; k <= windows * WINDOW_MS / 10; k++)
+    {
+        while (capture_poll(&capture, start + k * poll, &r))
+        {
+            ok &= (r.periods == 0 && r.duty == 1000);
+            reports++;
+        }
+    }
+    ok &= (reports == windows);
+
+    printf("quiet     %u windows with no edges, %u reports        %s\n", windows, reports,
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/*
+ *  ======== Threads ========
+ *  100 kHz at 50%, no latency, so every window is exact. The producer
+ *  waits a little between edges, except for a burst now and then that
+ *  overflows the ring.
+ */
+#define THREAD_EDGES  4000000u
+#define THREAD_PERIOD 800u
+#define THREAD_BURST  (4 * CAPTURE_RING_SIZE)
+
+static volatile uint32_t producerCount;
+static volatile int producerDone;
+
+static void *producer(void *arg)
+{
+    uint32_t t = 0u - 1000000u;
+    uint32_t i;
+
+    (void)arg;
+    for (i = 0; i < THREAD_EDGES; i++)
+    {
+        volatile int spin;
+
+        for (spin = 0; spin < 200 && i % 65536 >= THREAD_BURST; spin++)
+        {
+        }
+        t += THREAD_PERIOD / 2;
+        capture_edge(&capture, t, !(i & 1));
+        producerCount = t;
+    }
+    producerDone = 1;
+    return NULL;
+}
+
+/*
+ *  ======== testThreads ========
+ */
+static int testThreads(void)
+{
+    pthread_t thread;
+    struct timespec t0, t1;
+    CaptureResult r;
+    uint64_t periods = 0;
+    uint32_t windows = 0, bad = 0;
+    double seconds;
+    int done = 0;
+
+    capture_init(&capture, CLOCK_HZ, 1, 0u - 1000000u, 0);
+    producerCount = 0u - 1000000u;
+    producerDone = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (pthread_create(&thread, NULL, producer, NULL) != 0)
+    {
+        printf("threads   pthread_create failed                   FAILED\n");
+        return 0;
+    }
+    while (!done)
+    {
+        // Read before the poll, as the firmware reads its timer.
+        uint32_t now = producerCount;
+
+        done = producerDone;
+        while (capture_poll(&capture, now, &r))
+        {
+            if (r.periods == 0)
+            {
+                continue;       // the consumer fell a window behind
+            }
+            windows++;
+            periods += r.periods;
+            if (r.milliHz != 100000000u || r.periodNs != 10000 || r.widthNs != 5000 || r.duty != 500)
+            {
+                bad++;
+            }
+        }
+    }
+    pthread_join(thread, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    printf("threads   %u edges, %u dropped, %u windows exact  %s\n",
+           THREAD_EDGES, (unsigned)capture.dropped, windows, (bad == 0 && windows > 0) ? "ok" : "FAILED");
+    printf("          %.1f M edges/s on this host, %.1f%% of the periods measured\n",
+           THREAD_EDGES / seconds / 1e6, 100.0 * 2 * periods / THREAD_EDGES);
+    return bad == 0 && windows > 0;
+}
+
+/*
+ *  ======== maxRate ========
+ *  Raises the edge rate in 2% steps while nothing is dropped.
+ */
+static int maxRate(void)
+{
+    double rate = 1000.0, best = 0.0;
+    int ok = 1;
+
+    for (; rate < 10e6; rate *= 1.02)
+    {
+        Signal s = {rate / 2, 0.5, 0, 2.5 * WINDOW_MS / 1000.0};
+        Outcome out = {0, 0, 0, 0, 0.0, 0.0, 0.0};
+
+        if (CLOCK_HZ / rate < 2.0 * (latency + 1))
+        {
+            break;
+        }
+        simulate(&s, &out);
+        if (out.dropped != 0)
+        {
+            break;
+        }
+        ok &= (out.bad == 0);
+        best = rate;
+    }
+
+    printf("\nring of %d edges, %u us stall every %u ms, %.2f us latency:\n",
+           CAPTURE_RING_SIZE, (unsigned)stall, TICK_US / 1000, latency * 1e6 / CLOCK_HZ);
+    printf("  highest edge rate with none dropped   %.0f edges/s (%.0f Hz)  %s\n",
+           best, best / 2, ok ? "ok" : "FAILED");
+    printf("  ring size / stall                     %.0f edges/s\n",
+           CAPTURE_RING_SIZE * 1e6 / (stall + POLL_US));
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    int ok = 1;
+
+    if (argc > 1)
+    {
+        latency = (uint32_t)(atof(argv[1]) * (CLOCK_HZ / 1000000));
+    }
+    if (argc > 2)
+    {
+        stall = (uint32_t)atoi(argv[2]);
+    }
+
+    ok &= testAccuracy(0);
+    ok &= testAccuracy(50);
+    ok &= testStopped();
+    ok &= testQuiet();
+    ok &= testThreads();
+    ok &= maxRate();
+    return ok ? 0 : 1;
+}
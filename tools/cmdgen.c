@@ -0,0 +1,230 @@
+/*
+ *  ======== cmdgen.c ========
+ *
+ *  Generates the uart2echo command recognizer (command_dfa.h) from the
+ *  keyword list in commands.def.
+ *
+ *  The keywords are built into an Aho-Corasick automaton and the failure
+ *  links are folded into a complete transition table, so the target does
+ *  one table lookup per received byte and overlapping input ("OON",
+ *  "OOFF", "OFON") still finds every keyword. Bytes that appear in no
+ *  keyword share one input class to keep the table small.
+ *
+ *  The header also records the number of keywords and a checksum of
+ *  their lengths and order, which uart2echo.c recomputes from
+ *  commands.def at compile time, so a table left stale by an edit to
+ *  commands.def stops the build. --check compares a header with what
+ *  cmdgen would write now and exits non-zero if they differ, for use as
+ *  a pre-build step.
+ *
+ *  Build:  cc -I uart2echo_CC3220SF_LAUNCHXL_nortos_gcc -o cmdgen tools/cmdgen.c
+ *  Usage:  ./cmdgen > uart2echo_CC3220SF_LAUNCHXL_nortos_gcc/command_dfa.h
+ *          ./cmdgen --check uart2echo_CC3220SF_LAUNCHXL_nortos_gcc/command_dfa.h
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_STATES 256          /* state numbers are stored as uint8_t */
+
+static const char *keywords[] = {
+#define COMMAND(name, keyword, ...) keyword,
+#include "commands.def"
+#undef COMMAND
+};
+#define NUM_KEYWORDS (int)(sizeof(keywords) / sizeof(keywords[0]))
+
+static int next[MAX_STATES][256];
+static int fail[MAX_STATES];
+static int match[MAX_STATES];   /* command number + 1, 0 for none */
+static int classOf[256];
+
+/*
+ *  ======== check ========
+ *  Returns 0 if the file called name holds exactly what generated holds.
+ */
+static int check(FILE *generated, const char *name)
+{
+    FILE *f = fopen(name, "rb");
+    int a, b;
+
+    if (f == NULL)
+    {
+        fprintf(stderr, "cmdgen: cannot open %s\n", name);
+        return 1;
+    }
+    rewind(generated);
+    do
+    {
+        a = getc(generated);
+        b = getc(f);
+    } while (a == b && a != EOF);
+    fclose(f);
+
+    if (a != b)
+    {
+        fprintf(stderr, "cmdgen: %s is out of date with commands.def; regenerate it\n", name);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *out = stdout;
+    unsigned long lengths = 0;
+    int queue[MAX_STATES];
+    int head = 0;
+    int tail = 0;
+    int states = 1;
+    int classes = 1;            /* class 0 is "any other byte" */
+    int k, s, c;
+
+    if (argc == 3 && strcmp(argv[1], "--check") == 0)
+    {
+        out = tmpfile();
+        if (out == NULL)
+        {
+            return 1;
+        }
+    }
+    else if (argc != 1)
+    {
+        fprintf(stderr, "usage: %s [--check command_dfa.h]\n", argv[0]);
+        return 2;
+    }
+
+    memset(next, -1, sizeof(next));
+
+    // Trie of all keywords.
+    for (k = 0; k < NUM_KEYWORDS; k++)
+    {
+        const unsigned char *p = (const unsigned char *)keywords[k];
+
+        if (*p == '\0')
+        {
+            fprintf(stderr, "cmdgen: empty keyword\n");
+            return 1;
+        }
+        for (s = 0; *p != '\0'; p++)
+        {
+            if (next[s][*p] < 0)
+            {
+                if (states == MAX_STATES)
+                {
+                    fprintf(stderr, "cmdgen: more than %d states\n", MAX_STATES);
+                    return 1;
+                }
+                next[s][*p] = states++;
+            }
+            s = next[s][*p];
+            if (classOf[*p] == 0)
+            {
+                classOf[*p] = classes++;
+            }
+        }
+        if (match[s] != 0)
+        {
+            fprintf(stderr, "cmdgen: duplicate keyword \"%s\"\n", keywords[k]);
+            return 1;
+        }
+        match[s] = k + 1;
+        lengths += (unsigned long)(k + 1) * strlen(keywords[k]);
+    }
+
+    // Breadth first: failure links, then fill in the missing transitions
+    // so that the table is a complete DFA.
+    for (c = 0; c < 256; c++)
+    {
+        if (next[0][c] < 0)
+        {
+            next[0][c] = 0;
+        }
+        else
+        {
+            fail[next[0][c]] = 0;
+            queue[tail++] = next[0][c];
+        }
+    }
+    while (head < tail)
+    {
+        s = queue[head++];
+
+        // A state with no keyword of its own reports the longest keyword
+        // that ends here (found through its failure link).
+        if (match[s] == 0)
+        {
+            match[s] = match[fail[s]];
+        }
+
+        for (c = 0; c < 256; c++)
+        {
+            int t = next[s][c];
+
+            if (t < 0)
+            {
+                next[s][c] = next[fail[s]][c];
+            }
+            else
+            {
+                fail[t] = next[fail[s]][c];
+                queue[tail++] = t;
+            }
+        }
+    }
+
+    fprintf(out, "/*\n"
+                 " *  ======== command_dfa.h ========\n"
+                 " *\n"
+                 " *  DO NOT EDIT - generated by tools/cmdgen.c from commands.def.\n"
+                 " *\n"
+                 " *  state = commandDfaNext[state][commandDfaClass[byte]];\n"
+                 " *  commandDfaMatch[state] is 0, or the command number + 1 in\n"
+                 " *  commands.def order of the keyword that just ended.\n"
+                 " */\n\n"
+                 "#ifndef COMMAND_DFA_H_\n"
+                 "#define COMMAND_DFA_H_\n\n"
+                 "#include <stdint.h>\n\n"
+                 "#define COMMAND_DFA_STATES  %d\n"
+                 "#define COMMAND_DFA_CLASSES %d\n\n"
+                 "/* Keywords in commands.def and the sum of (number * length) over\n"
+                 " * them, numbering from 1, to catch a stale table */\n"
+                 "#define COMMAND_DFA_KEYWORDS %d\n"
+                 "#define COMMAND_DFA_LENGTHS  %lu\n\n", states, classes, NUM_KEYWORDS, lengths);
+
+    fprintf(out, "static const uint8_t commandDfaClass[256] = {");
+    for (c = 0; c < 256; c++)
+    {
+        fprintf(out, "%s%d,", (c % 16 == 0) ? "\n    " : " ", classOf[c]);
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out, "static const uint8_t commandDfaNext[COMMAND_DFA_STATES][COMMAND_DFA_CLASSES] = {\n");
+    for (s = 0; s < states; s++)
+    {
+        int cls;
+
+        fprintf(out, "    {");
+        for (cls = 0; cls < classes; cls++)
+        {
+            // Any byte of the class gives the same transition.
+            int b = 0;
+            while (classOf[b] != cls)
+            {
+                b++;
+            }
+            fprintf(out, "%s%d", cls ? ", " : " ", next[s][b]);
+        }
+        fprintf(out, " },\n");
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static const uint8_t commandDfaMatch[COMMAND_DFA_STATES] = {");
+    for (s = 0; s < states; s++)
+    {
+        fprintf(out, "%s%d", s ? ", " : " ", match[s]);
+    }
+    fprintf(out, " };\n\n#endif /* COMMAND_DFA_H_ */\n");
+
+    return (out == stdout) ? 0 : check(out, argv[2]);
+}
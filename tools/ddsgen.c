@@ -0,0 +1,43 @@
+/*
+ *  ======== ddsgen.c ========
+ *
+ *  Generates the pwmled2 tone wavetables (dds_tables.h): one cycle of a
+ *  sine in Q15, DDS_SINE_BITS bits of index. See dds.h for how they are
+ *  played.
+ *
+ *  Build:  cc -o ddsgen tools/ddsgen.c -lm
+ *  Usage:  ./ddsgen > pwmled2_CC3220SF_LAUNCHXL_nortos_gcc/dds_tables.h
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#define SINE_BITS 8
+#define SINE_SIZE (1 << SINE_BITS)
+
+int main(void)
+{
+    const double pi = 3.14159265358979323846;
+    int i;
+
+    printf("/*\n"
+           " *  ======== dds_tables.h ========\n"
+           " *\n"
+           " *  DO NOT EDIT - generated by tools/ddsgen.c.\n"
+           " *  One cycle per table, signed Q15; see dds.h.\n"
+           " */\n\n"
+           "#ifndef DDS_TABLES_H_\n"
+           "#define DDS_TABLES_H_\n\n"
+           "#include <stdint.h>\n\n"
+           "#define DDS_SINE_BITS %d\n\n"
+           "static const int16_t ddsSine[%d] = {", SINE_BITS, SINE_SIZE);
+
+    for (i = 0; i < SINE_SIZE; i++)
+    {
+        long value = lround(32767.0 * sin(2.0 * pi * i / SINE_SIZE));
+
+        printf("%s%6ld,", (i % 8 == 0) ? "\n  " : " ", value);
+    }
+    printf("\n};\n\n#endif /* DDS_TABLES_H_ */\n");
+    return 0;
+}
@@ -0,0 +1,361 @@
+/*
+ *  ======== ddsspectrum.c ========
+ *
+ *  Runs pwmled2's tone synthesis (dds.c) on the host and checks what it
+ *  produces through an FFT of the sample stream:
+ *
+ *      sine        spur-free dynamic range and SINAD at a few frequencies
+ *      frequency   the frequency asked for against the one produced,
+ *                  from the phase increment and from the spectrum
+ *      square      odd harmonics at 4 / (pi n) of full scale
+ *      wavetable   a table with 3rd and 5th harmonics gives them back at
+ *                  the levels it was built with (interpolating a table
+ *                  of fewer entries rolls the harmonics off a little)
+ *      amplitude   half amplitude is 6.02 dB down
+ *
+ *  Most tests use frequencies that fit a whole number of cycles into the
+ *  FFT, so every tone falls on a bin and needs no window. Then it times
+ *  the synthesis and reports the cost per sample: nanoseconds, and cycles
+ *  of the host's time stamp counter on x86.
+ *
+ *  Build:  cc -O2 -I pwmled2_CC3220SF_LAUNCHXL_nortos_gcc -o ddsspectrum tools/ddsspectrum.c \
+ *              pwmled2_CC3220SF_LAUNCHXL_nortos_gcc/dds.c -lm
+ *  Usage:  ./ddsspectrum [-v]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "dds.h"
+#include "dds_tables.h"
+
+#define FFT_BITS    12
+#define FFT_SIZE    (1 << FFT_BITS)
+#define SAMPLE_RATE 16000
+#define PI          3.14159265358979323846
+
+static double re[FFT_SIZE];
+static double im[FFT_SIZE];
+static double power[FFT_SIZE / 2 + 1];  /* relative to a full scale sine */
+static int16_t samples[FFT_SIZE];
+static int verbose;
+
+/*
+ *  ======== fft ========
+ *  In place, radix 2, decimation in time.
+ */
+static void fft(void)
+{
+    int i, j, size;
+
+    for (i = 1, j = 0; i < FFT_SIZE; i++)
+    {
+        int bit = FFT_SIZE >> 1;
+
+        for (; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j)
+        {
+            double t = re[i];
+
+            re[i] = re[j];
+            re[j] = t;
+            t = im[i];
+            im[i] = im[j];
+            im[j] = t;
+        }
+    }
+
+    for (size = 2; size <= FFT_SIZE; size <<= 1)
+    {
+        double angle = -2.0 * PI / size;
+
+        for (i = 0; i < FFT_SIZE; i += size)
+        {
+            int k;
+
+            for (k = 0; k < size / 2; k++)
+            {
+                double wr = cos(angle * k), wi = sin(angle * k);
+                int a = i + k, b = i + k + size / 2;
+                double tr = re[b] * wr - im[b] * wi;
+                double ti = re[b] * wi + im[b] * wr;
+
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+/*
+ *  ======== spectrum ========
+ *  Fills samples[] from v and power[] from them, with a Blackman-Harris
+ *  window if windowed is set.
+ */
+static void spectrum(DdsVoice *v, int windowed)
+{
+    double gain = 0.0;
+    int i;
+
+    dds_fill(v, samples, FFT_SIZE);
+    for (i = 0; i < FFT_SIZE; i++)
+    {
+        double x = 2.0 * PI * i / FFT_SIZE;
+        double w = windowed ? 0.35875 - 0.48829 * cos(x) + 0.14128 * cos(2 * x)
+                                  - 0.01168 * cos(3 * x)
+                            : 1.0;
+
+        re[i] = samples[i] / 32768.0 * w;
+        im[i] = 0.0;
+        gain += w;
+    }
+    fft();
+
+    /* A full scale sine on a bin gives power 1 */
+    for (i = 0; i <= FFT_SIZE / 2; i++)
+    {
+        double scale = ((i == 0 || i == FFT_SIZE / 2) ? 1.0 : 2.0) / gain;
+
+        power[i] = (re[i] * re[i] + im[i] * im[i]) * scale * scale;
+    }
+}
+
+/*
+ *  ======== dB ========
+ */
+static double dB(double p)
+{
+    return 10.0 * log10(p > 1e-30 ? p : 1e-30);
+}
+
+/*
+ *  ======== binVoice ========
+ *  A voice at exactly bin cycles per FFT.
+ */
+static void binVoice(DdsVoice *v, const int16_t *table, uint8_t bits, int bin)
+{
+    dds_init(v, table, bits);
+    v->increment = (uint32_t)bin << (32 - FFT_BITS);
+}
+
+/*
+ *  ======== testSine ========
+ */
+static int testSine(int bin)
+{
+    DdsVoice v;
+    double signal, noise = 0.0, spur = 0.0;
+    int i, ok;
+
+    binVoice(&v, ddsSine, DDS_SINE_BITS, bin);
+    spectrum(&v, 0);
+    signal = power[bin];
+    for (i = 1; i <= FFT_SIZE / 2; i++)
+    {
+        if (i != bin)
+        {
+            noise += power[i];
+            spur = (power[i] > spur) ? power[i] : spur;
+        }
+    }
+
+    ok = fabs(dB(signal)) < 0.01 && dB(signal / spur) > 85.0 && dB(signal / noise) > 80.0;
+    printf("sine %7.1f Hz   level %6.3f dB  SFDR %5.1f dB  SINAD %5.1f dB   %s\n",
+           (double)bin * SAMPLE_RATE / FFT_SIZE, dB(signal), dB(signal / spur),
+           dB(signal / noise), ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/*
+ *  ======== testFrequency ========
+ *  The increment must be the nearest to the frequency asked for, and the
+ *  spectrum peak, interpolated between bins, must agree.
+ */
+static int testFrequency(uint32_t milliHz)
+{
+    DdsVoice v;
+    double wanted = milliHz / 1000.0;
+    double produced, step = (double)SAMPLE_RATE / 4294967296.0;
+    double measured, a, b, c;
+    int i, peak = 1, ok;
+
+    dds_init(&v, ddsSine, DDS_SINE_BITS);
+    dds_setFrequency(&v, milliHz, SAMPLE_RATE);
+    produced = v.increment * step;
+
+    spectrum(&v, 1);
+    for (i = 2; i < FFT_SIZE / 2; i++)
+    {
+        peak = (power[i] > power[peak]) ? i : peak;
+    }
+    a = log(power[peak - 1]);
+    b = log(power[peak]);
+    c = log(power[peak + 1]);
+    measured = (peak + 0.5 * (a - c) / (a - 2.0 * b + c)) * SAMPLE_RATE / FFT_SIZE;
+
+    ok = fabs(produced - wanted) <= step / 2.0 + 1e-9
+         && fabs(measured - wanted) < 0.05 * SAMPLE_RATE / FFT_SIZE;
+    printf("freq %10.3f Hz  produced %+.2e Hz  spectrum %+.4f Hz         %s\n", wanted,
+           produced - wanted, measured - wanted, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/*
+ *  ======== testHarmonics ========
+ *  levels[n] is the expected level of harmonic n (1 to 5) relative to
+ *  full scale, 0 where it should be absent.
+ */
+static int testHarmonics(const char *name, const int16_t *table, uint8_t bits, int bin,
+                         const double *levels, double tolerance)
+{
+    DdsVoice v;
+    int n, ok = 1;
+
+    binVoice(&v, table, bits, bin);
+    spectrum(&v, 0);
+
+    printf("%-9s", name);
+    for (n = 1; n <= 5; n++)
+    {
+        double got = dB(power[n * bin]);
+
+        if (levels[n] > 0.0)
+        {
+            double want = dB(levels[n] * levels[n]);
+
+            printf("  h%d %6.2f/%6.2f", n, got, want);
+            ok &= fabs(got - want) < tolerance;
+        }
+        else
+        {
+            printf("  h%d %6.1f", n, got);
+            ok &= got < -40.0;
+        }
+    }
+    printf("  %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/*
+ *  ======== testAmplitude ========
+ */
+static int testAmplitude(void)
+{
+    DdsVoice v;
+    double full, half;
+    int ok;
+
+    binVoice(&v, ddsSine, DDS_SINE_BITS, 301);
+    spectrum(&v, 0);
+    full = dB(power[301]);
+    binVoice(&v, ddsSine, DDS_SINE_BITS, 301);
+    dds_setAmplitude(&v, 16384);
+    spectrum(&v, 0);
+    half = dB(power[301]);
+
+    ok = fabs(full - half - 6.0206) < 0.01;
+    printf("amplitude 1/2      %6.3f dB                                  %s\n",
+           half - full, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/*
+ *  ======== timeVoice ========
+ */
+static void timeVoice(const char *name, const int16_t *table, uint8_t bits)
+{
+    enum { ROUNDS = 2000 };
+    struct timespec t0, t1;
+    DdsVoice v;
+    double ns;
+    int i;
+#if defined(__x86_64__) || defined(__i386__)
+    uint64_t c0, c1;
+#endif
+
+    dds_init(&v, table, bits);
+    dds_setFrequency(&v, 440000, SAMPLE_RATE);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+#if defined(__x86_64__) || defined(__i386__)
+    c0 = __rdtsc();
+#endif
+    for (i = 0; i < ROUNDS; i++)
+    {
+        dds_fill(&v, samples, FFT_SIZE);
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    c1 = __rdtsc();
+#endif
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    ns = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / ((double)ROUNDS * FFT_SIZE);
+    printf("%-9s %6.2f ns/sample", name, ns);
+#if defined(__x86_64__) || defined(__i386__)
+    printf("  %6.2f TSC cycles/sample", (double)(c1 - c0) / ((double)ROUNDS * FFT_SIZE));
+#endif
+    printf("  (check %d)\n", samples[FFT_SIZE - 1]);
+}
+
+int main(int argc, char *argv[])
+{
+    static const int sineBins[] = { 7, 37, 441, 1021, 1801 };
+    static const uint32_t frequencies[] = { 440000, 1000500, 3333333, 7000001 };
+    static const double squareLevels[6] = { 0, 4 / PI, 0, 4 / (3 * PI), 0, 4 / (5 * PI) };
+    static const double tableLevels[6] = { 0, 0.6, 0, 0.25, 0, 0.1 };
+    static int16_t table[256];
+    int ok = 1;
+    int i;
+
+    verbose = (argc > 1 && strcmp(argv[1], "-v") == 0);
+
+    for (i = 0; i < (int)(sizeof(sineBins) / sizeof(sineBins[0])); i++)
+    {
+        ok &= testSine(sineBins[i]);
+    }
+    for (i = 0; i < (int)(sizeof(frequencies) / sizeof(frequencies[0])); i++)
+    {
+        ok &= testFrequency(frequencies[i]);
+    }
+
+    for (i = 0; i < 256; i++)
+    {
+        double x = 2.0 * PI * i / 256;
+
+        table[i] = (int16_t)lround(32767.0 * (tableLevels[1] * sin(x) + tableLevels[3] * sin(3 * x)
+                                             + tableLevels[5] * sin(5 * x)));
+    }
+    ok &= testHarmonics("square", NULL, 0, 64, squareLevels, 0.1);
+    ok &= testHarmonics("wavetable", table, 8, 37, tableLevels, 0.1);
+    ok &= testAmplitude();
+
+    timeVoice("sine", ddsSine, DDS_SINE_BITS);
+    timeVoice("square", NULL, 0);
+
+    if (verbose)
+    {
+        DdsVoice v;
+
+        binVoice(&v, ddsSine, DDS_SINE_BITS, 441);
+        spectrum(&v, 0);
+        for (i = 0; i <= FFT_SIZE / 2; i++)
+        {
+            printf("%8.2f %7.2f\n", (double)i * SAMPLE_RATE / FFT_SIZE, dB(power[i]));
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+/*
+ *  ======== dithermodel.c ========
+ *
+ *  Runs pwmled2's duty dithering (dither.c) on the host against a model
+ *  of the PWM output and measures how far the average duty the LED sees
+ *  is from the fractional duty asked for, compared with rounding to the
+ *  nearest whole unit.
+ *
+ *  Each PWM period shows the last whole-unit duty written before it
+ *  starts. For every fractional target over the whole range (or every
+ *  stride-th one) the model runs the dither for a number of periods and
+ *  reports:
+ *
+ *      rounded      error of the nearest whole unit, no dithering
+ *      window N     worst error of the average over any N periods in a row
+ *      long run     error of the average over all the periods run
+ *      ramp         worst error of the average over each step of a sweep
+ *                   that moves to a new target every -s periods, as the
+ *                   waveform engine does
+ *
+ *  in duty units, and as effective bits: log2(period / (2 * error)), the
+ *  resolution of a plain quantizer with the same worst error.
+ *
+ *  With -d the update timer runs that many ppm slow (or fast, negative)
+ *  against the PWM, so now and then a period repeats a duty or one is
+ *  never shown. Both timers share a crystal on the board, so 0 is the
+ *  real case; this shows what happens if they do not.
+ *
+ *  Build:  cc -O2 -I pwmled2_CC3220SF_LAUNCHXL_nortos_gcc -o dithermodel tools/dithermodel.c \
+ *              pwmled2_CC3220SF_LAUNCHXL_nortos_gcc/dither.c -lm
+ *  Usage:  dithermodel [-p period] [-f fraction_bits] [-s periods_per_step] [-d ppm] [-x stride]
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dither.h"
+
+#define MAX_PERIODS 65536
+#define NUM_WINDOWS 4
+
+static uint32_t shown[MAX_PERIODS];
+
+/*
+ *  ======== run ========
+ *  Fills shown[] with the duty each PWM period shows for a steady target.
+ */
+static void run(uint32_t target, int fractionBits, int periods, double ppm)
+{
+    Dither d;
+    double update = 1.0 + ppm * 1e-6;       /* update interval, in PWM periods */
+    double nextUpdate = 0.0;
+    uint32_t duty = 0;
+    int i;
+
+    dither_init(&d, (uint8_t)fractionBits);
+    for (i = 0; i < periods; i++)
+    {
+        while (nextUpdate <= (double)i)
+        {
+            duty = dither_next(&d, target);
+            nextUpdate += update;
+        }
+        shown[i] = duty;
+    }
+}
+
+/*
+ *  ======== bits ========
+ */
+static double bits(double period, double error)
+{
+    return (error > 0.0) ? log2(period / (2.0 * error)) : INFINITY;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t period = 3000;
+    int fractionBits = 4;
+    int stepPeriods = 8;
+    double ppm = 0.0;
+    uint32_t stride = 1;
+    int windows[NUM_WINDOWS];
+    double worstWindow[NUM_WINDOWS] = { 0 };
+    double worstRounded = 0.0;
+    double worstLong = 0.0;
+    double worstRamp = 0.0;
+    uint32_t scale, target;
+    char name[16];
+    int periods;
+    int i, w;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (i + 1 < argc && strcmp(argv[i], "-p") == 0)
+        {
+            period = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "-f") == 0)
+        {
+            fractionBits = atoi(argv[++i]);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "-s") == 0)
+        {
+            stepPeriods = atoi(argv[++i]);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "-d") == 0)
+        {
+            ppm = atof(argv[++i]);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "-x") == 0)
+        {
+            stride = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [-p period] [-f fraction_bits] [-s periods_per_step]"
+                            " [-d ppm] [-x stride]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (period == 0 || fractionBits < 1 || fractionBits > 12 || stepPeriods < 1
+        || stride == 0 || ((uint64_t)period << fractionBits) >= (1u << 31))
+    {
+        fprintf(stderr, "dithermodel: out of range\n");
+        return 2;
+    }
+
+    scale = 1u << fractionBits;
+    periods = (int)(16 * scale);
+    if (periods > MAX_PERIODS)
+    {
+        periods = MAX_PERIODS;
+    }
+
+    /* Windows of a quarter, a half, one and four dither cycles */
+    windows[0] = (int)(scale / 4 > 0 ? scale / 4 : 1);
+    windows[1] = (int)(scale / 2 > 0 ? scale / 2 : 1);
+    windows[2] = (int)scale;
+    windows[3] = (int)(4 * scale);
+
+    for (target = 0; target <= period * scale; target += stride)
+    {
+        double wanted = (double)target / scale;
+        double total = 0.0;
+
+        worstRounded = fmax(worstRounded, fabs(floor(wanted + 0.5) - wanted));
+
+        run(target, fractionBits, periods, ppm);
+        for (i = 0; i < periods; i++)
+        {
+            total += shown[i];
+        }
+        worstLong = fmax(worstLong, fabs(total / periods - wanted));
+
+        for (w = 0; w < NUM_WINDOWS; w++)
+        {
+            double sum = 0.0;
+
+            for (i = 0; i < periods; i++)
+            {
+                sum += shown[i];
+                if (i >= windows[w])
+                {
+                    sum -= shown[i - windows[w]];
+                }
+                if (i + 1 >= windows[w])
+                {
+                    worstWindow[w] = fmax(worstWindow[w], fabs(sum / windows[w] - wanted));
+                }
+            }
+        }
+    }
+
+    /* A ramp over the whole range, one target per step, the dither state
+     * carried from step to step */
+    {
+        Dither d;
+        uint32_t step = (period * scale) / 256 > 0 ? (period * scale) / 256 : 1;
+
+        dither_init(&d, (uint8_t)fractionBits);
+        for (target = 0; target <= period * scale; target += step)
+        {
+            double sum = 0.0;
+
+            for (i = 0; i < stepPeriods; i++)
+            {
+                sum += dither_next(&d, target);
+            }
+            worstRamp = fmax(worstRamp, fabs(sum / stepPeriods - (double)target / scale));
+        }
+    }
+
+    printf("period %lu units, %d fraction bits (%.1f bits), %d periods per target,"
+           " %.1f ppm\n", (unsigned long)period, fractionBits,
+           log2((double)period * scale), periods, ppm);
+    printf("%-12s %10s %6s\n", "", "error", "bits");
+    printf("%-12s %10.5f %6.2f\n", "rounded", worstRounded, bits(period, worstRounded));
+    for (w = 0; w < NUM_WINDOWS; w++)
+    {
+        snprintf(name, sizeof(name), "window %d", windows[w]);
+        printf("%-12s %10.5f %6.2f\n", name, worstWindow[w], bits(period, worstWindow[w]));
+    }
+    printf("%-12s %10.5f %6.2f\n", "long run", worstLong, bits(period, worstLong));
+    snprintf(name, sizeof(name), "ramp/%d", stepPeriods);
+    printf("%-12s %10.5f %6.2f\n", name, worstRamp, bits(period, worstRamp));
+    return 0;
+}
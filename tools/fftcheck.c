@@ -0,0 +1,401 @@
+/*
+ *  ======== fftcheck.c ========
+ *
+ *  Checks the thermostat's fixed point FFT (fft.c) and Goertzel detector
+ *  (goertzel.c) against double precision on the host:
+ *
+ *      fft         at every size, the output times N against a double
+ *                  FFT of the same Q15 input, for random complex input
+ *                  and for a near full scale sine on a bin: signal to
+ *                  error ratio, the worst error, and for the sine the
+ *                  level of the bin (-6.02 dB, since it comes out at 1/2)
+ *      cosine      the detector's integer cosine against cos()
+ *      goertzel    the DTMF tones at 8 kHz over 205 samples, the power
+ *                  against the same sum done in doubles, and each tone
+ *                  against the other seven detectors
+ *      dsp         built for an ARM host with the DSP extension, the
+ *                  instructions against their C models in dsp.h
+ *
+ *  Then it times fftbench.c's runs, which the firmware built with
+ *  FFT_BENCH=1 also logs, and prints a table per size: the memory used
+ *  (the data, in place, and the shared twiddle table in flash), cycles
+ *  of the host's time stamp counter on x86 (nanoseconds elsewhere), and
+ *  the checksum the firmware must log too.
+ *
+ *  Build:  cc -O2 -I thermostat-gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc -o fftcheck \
+ *              tools/fftcheck.c thermostat-gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc/fft.c \
+ *              thermostat-gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc/goertzel.c \
+ *              thermostat-gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc/fftbench.c -lm
+ *  Usage:  ./fftcheck [rounds]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "dsp.h"
+#include "fft.h"
+#include "fftbench.h"
+#include "goertzel.h"
+
+#define PI    3.14159265358979323846
+#define SIZES (FFT_MAX_BITS - FFT_MIN_BITS + 1)
+
+static uint64_t seed = 88172645463325252ull;
+
+static int16_t data[2 * FFT_MAX_SIZE];
+static double re[FFT_MAX_SIZE];
+static double im[FFT_MAX_SIZE];
+
+static double snrRandom[SIZES];
+static double snrSine[SIZES];
+
+/*
+ *  ======== rnd ========
+ *  xorshift64
+ */
+static uint32_t rnd(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (uint32_t)(seed >> 32);
+}
+
+/*
+ *  ======== dB ========
+ */
+static double dB(double p)
+{
+    return 10.0 * log10(p > 1e-30 ? p : 1e-30);
+}
+
+/*
+ *  ======== reference ========
+ *  In place, radix 2, decimation in time, on re[] and im[].
+ */
+static void reference(int n)
+{
+    int i, j, size;
+
+    for (i = 1, j = 0; i < n; i++)
+    {
+        int bit = n >> 1;
+
+        for (; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j)
+        {
+            double t = re[i];
+
+            re[i] = re[j];
+            re[j] = t;
+            t = im[i];
+            im[i] = im[j];
+            im[j] = t;
+        }
+    }
+
+    for (size = 2; size <= n; size <<= 1)
+    {
+        double angle = -2.0 * PI / size;
+
+        for (i = 0; i < n; i += size)
+        {
+            int k;
+
+            for (k = 0; k < size / 2; k++)
+            {
+                double wr = cos(angle * k), wi = sin(angle * k);
+                int a = i + k, b = i + k + size / 2;
+                double tr = re[b] * wr - im[b] * wi;
+                double ti = re[b] * wi + im[b] * wr;
+
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+/*
+ *  ======== compare ========
+ *  Runs both transforms on data[] (n points) and returns the signal to
+ *  error ratio in dB; worst gets the largest error in output LSBs.
+ */
+static double compare(unsigned int bits, double *worst)
+{
+    int n = 1 << bits;
+    double signal = 0.0, noise = 0.0;
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        re[i] = data[2 * i] / (double)n;
+        im[i] = data[2 * i + 1] / (double)n;
+    }
+    reference(n);
+    fft_q15(data, bits);
+
+    *worst = 0.0;
+    for (i = 0; i < n; i++)
+    {
+        double er = data[2 * i] - re[i], ei = data[2 * i + 1] - im[i];
+
+        signal += re[i] * re[i] + im[i] * im[i];
+        noise += er * er + ei * ei;
+        *worst = fmax(*worst, fmax(fabs(er), fabs(ei)));
+    }
+    return dB(signal / noise);
+}
+
+/*
+ *  ======== testFft ========
+ */
+static int testFft(unsigned int bits)
+{
+    int n = 1 << bits;
+    int bin = n / 8 + 3;
+    double worstRandom, worstSine, level;
+    int i, ok;
+
+    /* Random within the unit circle */
+    for (i = 0; i < n; i++)
+    {
+        double r = sqrt((double)rnd() / 4294967296.0) * 32767.0;
+        double a = 2.0 * PI * rnd() / 4294967296.0;
+
+        data[2 * i] = (int16_t)floor(r * cos(a));
+        data[2 * i + 1] = (int16_t)floor(r * sin(a));
+    }
+    snrRandom[bits - FFT_MIN_BITS] = compare(bits, &worstRandom);
+
+    /* A real sine at 0.99 of full scale */
+    for (i = 0; i < n; i++)
+    {
+        data[2 * i] = (int16_t)lround(32440.0 * sin(2.0 * PI * bin * i / n));
+        data[2 * i + 1] = 0;
+    }
+    snrSine[bits - FFT_MIN_BITS] = compare(bits, &worstSine);
+    level = dB(((double)data[2 * bin] * data[2 * bin]
+                + (double)data[2 * bin + 1] * data[2 * bin + 1]) / (32440.0 * 32440.0));
+
+    /* About 3 dB less per doubling: the output falls as 1/sqrt(N) per bin
+     * for random input, the rounding noise in each bin does not. The sine
+     * keeps its level but gathers the noise of more bins. */
+    ok = snrRandom[bits - FFT_MIN_BITS] > 66.0 - 3.0 * (bits - FFT_MIN_BITS)
+         && snrSine[bits - FFT_MIN_BITS] > 70.0 - 3.0 * (bits - FFT_MIN_BITS)
+         && fabs(level + 6.0206) < 0.01;
+    printf("fft %4d   random %5.1f dB (worst %4.1f LSB)  sine %5.1f dB (worst %4.1f LSB)"
+           "  level %7.3f dB  %s\n", n, snrRandom[bits - FFT_MIN_BITS], worstRandom,
+           snrSine[bits - FFT_MIN_BITS], worstSine, level, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/*
+ *  ======== testCosine ========
+ *  Through goertzel_init(): the coefficient is 2 cos(w), Q30.
+ */
+static int testCosine(void)
+{
+    double worst = 0.0;
+    uint32_t milliHz;
+    Goertzel g;
+    int ok;
+
+    for (milliHz = 1; milliHz < 4000000; milliHz += 997)
+    {
+        double want = 2.0 * cos(2.0 * PI * milliHz / 8000000.0) * 1073741824.0;
+
+        goertzel_init(&g, milliHz, 8000, 205);
+        want = (want > 2147483647.0) ? 2147483647.0 : want;
+        worst = fmax(worst, fabs(g.coeff - want));
+    }
+    ok = worst <= 8.0;
+    printf("cosine    worst %.1f Q30 LSBs over 0 to 4 kHz at 8 kHz                   %s\n",
+           worst, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/*
+ *  ======== goertzelDouble ========
+ *  The same detector in doubles, as amplitude squared.
+ */
+static double goertzelDouble(const int16_t *x, int n, double hz, double rate)
+{
+    double c = 2.0 * cos(2.0 * PI * hz / rate);
+    double s1 = 0.0, s2 = 0.0;
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        double s = x[i] / 32768.0 + c * s1 - s2;
+
+        s2 = s1;
+        s1 = s;
+    }
+    return 4.0 * (s1 * s1 + s2 * s2 - c * s1 * s2) / ((double)n * n);
+}
+
+/*
+ *  ======== testGoertzel ========
+ */
+static int testGoertzel(void)
+{
+    static const uint32_t tones[8] = { 697, 770, 852, 941, 1209, 1336, 1477, 1633 };
+    static int16_t x[205];
+    double worstError = 0.0, worstRejection = 1e9;
+    int ok = 1;
+    int t, d, i;
+
+    for (t = 0; t < 8; t++)
+    {
+        double on = 0.0, off = 0.0;
+
+        for (i = 0; i < 205; i++)
+        {
+            x[i] = (int16_t)lround(16384.0 * sin(2.0 * PI * tones[t] * i / 8000.0 + 0.3 * t)
+                                   + (double)(int16_t)(rnd() >> 16) / 64.0);
+        }
+        for (d = 0; d < 8; d++)
+        {
+            Goertzel g;
+            double want, got;
+
+            goertzel_init(&g, tones[d] * 1000, 8000, 205);
+            goertzel_update(&g, x, 205);
+            ok &= goertzel_done(&g);
+            got = goertzel_power(&g) / 1073741824.0;
+            want = goertzelDouble(x, 205, tones[d], 8000.0);
+            if (d == t)
+            {
+                on = got;
+                worstError = fmax(worstError, fabs(dB(got / want)));
+            }
+            else
+            {
+                off = fmax(off, got);
+                /* Small powers: compare as absolute error instead */
+                ok &= fabs(got - want) < 1e-6;
+            }
+        }
+        worstRejection = fmin(worstRejection, dB(on / off));
+    }
+
+    /* The nearest other tone is under 2 bins away */
+    ok &= worstError < 0.01 && worstRejection > 15.0;
+    printf("goertzel  DTMF, 205 samples: level error %.4f dB, rejection %.1f dB"
+           "         %s\n", worstError, worstRejection, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/*
+ *  ======== testDsp ========
+ */
+static int testDsp(void)
+{
+#if DSP_INSTRUCTIONS
+    int i;
+
+    for (i = 0; i < 1000000; i++)
+    {
+        uint32_t x = rnd(), y = rnd();
+
+        if (i < 256)
+        {
+            /* Both halves at the extremes */
+            x = (i & 1 ? 0x8000u : 0x7FFFu) | (i & 2 ? 0x80000000u : 0x7FFF0000u);
+            y = (i & 4 ? 0x8000u : 0x7FFFu) | (i & 8 ? 0x80000000u : 0x7FFF0000u);
+        }
+        if (dsp_smuad(x, y) != dsp_smuadModel(x, y) || dsp_smusdx(x, y) != dsp_smusdxModel(x, y)
+            || dsp_shadd16(x, y) != dsp_shadd16Model(x, y)
+            || dsp_shsub16(x, y) != dsp_shsub16Model(x, y)
+            || dsp_shasx(x, y) != dsp_shasxModel(x, y) || dsp_shsax(x, y) != dsp_shsaxModel(x, y))
+        {
+            printf("dsp: an instruction differs from its model for %08x %08x\n", x, y);
+            return 0;
+        }
+    }
+    printf("dsp       SMUAD, SMUSDX, SHADD16, SHSUB16, SHASX, SHSAX match their models  ok\n");
+#endif
+    return 1;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+static uint32_t now(void)
+{
+    return (uint32_t)__rdtsc();
+}
+#define UNITS "TSC cycles"
+#else
+static uint32_t now(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint32_t)(t.tv_sec * 1000000000ull + t.tv_nsec);
+}
+#define UNITS "ns"
+#endif
+
+int main(int argc, char *argv[])
+{
+    FftBenchResult results[FFTBENCH_CASES], best[FFTBENCH_CASES];
+    int rounds = (argc > 1) ? atoi(argv[1]) : 200;
+    unsigned int bits;
+    int ok = 1;
+    int i, r;
+
+    for (bits = FFT_MIN_BITS; bits <= FFT_MAX_BITS; bits++)
+    {
+        ok &= testFft(bits);
+    }
+    ok &= (fft_q15(data, FFT_MIN_BITS - 1) == 0 && fft_q15(data, FFT_MAX_BITS + 1) == 0);
+    ok &= testCosine();
+    ok &= testGoertzel();
+    ok &= testDsp();
+
+    for (r = 0; r < rounds; r++)
+    {
+        fftbench_run(results, now);
+        for (i = 0; i < FFTBENCH_CASES; i++)
+        {
+            if (r == 0 || results[i].ticks < best[i].ticks)
+            {
+                best[i] = results[i];
+            }
+        }
+    }
+
+    printf("\n%-13s %9s %9s %10s %10s %10s\n", "", "RAM", "flash", UNITS, "SNR dB", "checksum");
+    printf("%-13s %9s %9s %10s %10s\n", "", "(bytes)", "(bytes)", "", "rnd/sine");
+    for (i = 0; i < FFTBENCH_CASES; i++)
+    {
+        if (i < SIZES)
+        {
+            printf("%-13s %9u %9u %10lu %4.0f/%4.0f   %08lx\n", best[i].name, 4u * best[i].size,
+                   (unsigned int)(3 * FFT_MAX_SIZE), (unsigned long)best[i].ticks,
+                   snrRandom[i], snrSine[i], (unsigned long)best[i].checksum);
+        }
+        else
+        {
+            printf("%-13s %9u %9u %10lu %10s   %08lx\n", best[i].name,
+                   (unsigned int)sizeof(Goertzel), 0u, (unsigned long)best[i].ticks, "",
+                   (unsigned long)best[i].checksum);
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,46 @@
+/*
+ *  ======== fftgen.c ========
+ *
+ *  Generates the thermostat FFT's twiddle factors (fft_tables.h): W^m =
+ *  cos(2 pi m / N) - j sin(2 pi m / N) for the largest size N, as Q15
+ *  (cos, sin) pairs, for m up to 3N/4 (what a radix-4 stage reaches).
+ *  Smaller sizes take every (N / size)th entry. See fft.h.
+ *
+ *  Build:  cc -o fftgen tools/fftgen.c -lm
+ *  Usage:  ./fftgen > thermostat-gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc/fft_tables.h
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#define TWIDDLE_BITS 10
+#define TWIDDLE_SIZE (1 << TWIDDLE_BITS)
+#define TWIDDLES     (3 * TWIDDLE_SIZE / 4)
+
+int main(void)
+{
+    const double pi = 3.14159265358979323846;
+    int m;
+
+    printf("/*\n"
+           " *  ======== fft_tables.h ========\n"
+           " *\n"
+           " *  DO NOT EDIT - generated by tools/fftgen.c.\n"
+           " *  Twiddle factors, Q15 (cos, sin) pairs; see fft.h.\n"
+           " */\n\n"
+           "#ifndef FFT_TABLES_H_\n"
+           "#define FFT_TABLES_H_\n\n"
+           "#include <stdint.h>\n\n"
+           "#define FFT_TWIDDLE_BITS %d\n\n"
+           "static const int16_t fftTwiddle[2 * %d] = {", TWIDDLE_BITS, TWIDDLES);
+
+    for (m = 0; m < TWIDDLES; m++)
+    {
+        double angle = 2.0 * pi * m / TWIDDLE_SIZE;
+
+        printf("%s%6ld, %6ld,", (m % 4 == 0) ? "\n  " : " ", lround(32767.0 * cos(angle)),
+               lround(32767.0 * sin(angle)));
+    }
+    printf("\n};\n\n#endif /* FFT_TABLES_H_ */\n");
+    return 0;
+}
@@ -0,0 +1,486 @@
+/*
+ *  ======== filterbench.c ========
+ *
+ *  Checks the thermostat's fixed point filters (filter.c) on the host and
+ *  times them:
+ *
+ *      exact       every kernel against a straightforward reference
+ *                  written here (64 bit sums, round, saturate), over
+ *                  random filters, random block splits and inputs with
+ *                  long runs at full scale; the outputs must be the same
+ *                  bit for bit
+ *      settle      a settled biquad fed its settling value stays there
+ *      dsp         built for an ARM host with the DSP extension, the
+ *                  SMLALD and SSAT instructions against the C models in
+ *                  dsp.h that the other hosts use
+ *
+ *  Then it runs the block filterbench.c also runs on the target and
+ *  prints each case's checksum, which must match what the firmware built
+ *  with FILTER_BENCH=1 logs, and its cost per tap (multiply-accumulate):
+ *  cycles of the host's time stamp counter on x86, nanoseconds elsewhere.
+ *  The firmware logs the same figure in M4 cycles.
+ *
+ *  Build:  cc -O2 -I thermostat-gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc -o filterbench \
+ *              tools/filterbench.c thermostat-gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc/filter.c \
+ *              thermostat-gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc/filterbench.c -lm
+ *  Usage:  ./filterbench [rounds]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "dsp.h"
+#include "filter.h"
+#include "filterbench.h"
+
+#define MAX_TAPS   72
+#define MAX_STAGES 4
+#define SIGNAL     1024
+#define PI         3.14159265358979323846
+
+static uint64_t seed = 88172645463325252ull;
+
+static int16_t x16[SIGNAL], y16[SIGNAL], r16[SIGNAL];
+static int32_t x32[SIGNAL], y32[SIGNAL], r32[SIGNAL];
+
+/*
+ *  ======== rnd ========
+ *  xorshift64
+ */
+static uint32_t rnd(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (uint32_t)(seed >> 32);
+}
+
+/*
+ *  ======== below ========
+ */
+static uint32_t below(uint32_t n)
+{
+    return rnd() % n;
+}
+
+/*
+ *  ======== sat ========
+ */
+static int64_t sat(int64_t x, int bits)
+{
+    int64_t max = ((int64_t)1 << (bits - 1)) - 1;
+
+    return (x > max) ? max : (x < -max - 1) ? -max - 1 : x;
+}
+
+/*
+ *  ======== makeSignal ========
+ *  Random samples, stretches of them pinned at full scale.
+ */
+static void makeSignal(void)
+{
+    int i;
+
+    for (i = 0; i < SIGNAL; i++)
+    {
+        uint32_t r = rnd();
+
+        x32[i] = (int32_t)r;
+        if ((i / 64) % 4 == 3)
+        {
+            x32[i] = (r & 1) ? INT32_MAX : INT32_MIN;
+        }
+        x16[i] = (int16_t)(x32[i] >> 16);
+    }
+}
+
+/*
+ *  ======== nextBlock ========
+ *  Feeds the signal through in random sized blocks.
+ */
+static size_t nextBlock(size_t done)
+{
+    size_t n = 1 + below(97);
+
+    return (done + n > SIGNAL) ? SIGNAL - done : n;
+}
+
+/*
+ *  ======== testFir ========
+ */
+static int testFir(int q31, uint16_t taps, uint16_t factor, int full)
+{
+    static int16_t h16[MAX_TAPS], s16[FILTER_FIR_STATE(MAX_TAPS)];
+    static int32_t h32[MAX_TAPS], s32[FILTER_FIR_STATE(MAX_TAPS)];
+    FilterFirQ15 f16;
+    FilterFirQ31 f32;
+    size_t done, written = 0, expected = 0;
+    int i, k;
+
+    for (k = 0; k < taps; k++)
+    {
+        h16[k] = (int16_t)(rnd() >> 16);
+        h32[k] = (int32_t)rnd();
+        if (!full)
+        {
+            h16[k] /= taps;
+            h32[k] /= taps;
+        }
+    }
+    makeSignal();
+
+    filter_firInitQ15(&f16, h16, taps, s16, factor);
+    filter_firInitQ31(&f32, h32, taps, s32, factor);
+    for (done = 0; done < SIGNAL; )
+    {
+        size_t n = nextBlock(done);
+
+        written += q31 ? filter_firQ31(&f32, &x32[done], &y32[written], n)
+                       : filter_firQ15(&f16, &x16[done], &y16[written], n);
+        done += n;
+    }
+
+    for (i = 0; i < SIGNAL; i += factor)
+    {
+        int64_t acc = 0;
+
+        for (k = 0; k < taps && k <= i; k++)
+        {
+            acc += q31 ? (int64_t)h32[k] * x32[i - k] : (int64_t)h16[k] * x16[i - k];
+        }
+        if (q31)
+        {
+            r32[expected++] = (int32_t)sat((acc + ((int64_t)1 << 30)) >> 31, 32);
+        }
+        else
+        {
+            r16[expected++] = (int16_t)sat((acc + (1 << 14)) >> 15, 16);
+        }
+    }
+
+    if (written != expected)
+    {
+        printf("fir q%d %u taps /%u: %zu outputs, expected %zu\n", q31 ? 31 : 15, taps,
+               factor, written, expected);
+        return 0;
+    }
+    for (i = 0; i < (int)expected; i++)
+    {
+        if (q31 ? (y32[i] != r32[i]) : (y16[i] != r16[i]))
+        {
+            printf("fir q%d %u taps /%u: output %d is %ld, expected %ld\n", q31 ? 31 : 15,
+                   taps, factor, i, q31 ? (long)y32[i] : (long)y16[i],
+                   q31 ? (long)r32[i] : (long)r16[i]);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ *  ======== lowpass ========
+ *  A Butterworth section at cutoff (as a fraction of the sample rate),
+ *  as doubles: b0, b1, b2, a1, a2 in filter.h's signs.
+ */
+static void lowpass(double cutoff, double q, double *c)
+{
+    double k = tan(PI * cutoff);
+    double norm = 1.0 / (1.0 + k / q + k * k);
+
+    c[0] = k * k * norm;
+    c[1] = 2.0 * c[0];
+    c[2] = c[0];
+    c[3] = -2.0 * (k * k - 1.0) * norm;
+    c[4] = -(1.0 - k / q + k * k) * norm;
+}
+
+/*
+ *  ======== biquadCoeffs ========
+ *  Low pass sections, or random ones (gains well over 1, some unstable)
+ *  to make the outputs saturate.
+ */
+static void biquadCoeffs(int16_t *c16, int32_t *c32, int stages, int wild)
+{
+    int s, k;
+
+    for (s = 0; s < stages; s++)
+    {
+        double c[5];
+
+        if (wild)
+        {
+            for (k = 0; k < 5; k++)
+            {
+                c[k] = ((double)rnd() / 4294967296.0 - 0.5) * 1.5;
+            }
+        }
+        else
+        {
+            lowpass(0.005 + 0.4 * rnd() / 4294967296.0, 0.5 + rnd() / 4294967296.0, c);
+        }
+
+        c16[s * 6 + 0] = (int16_t)lround(c[0] * 16384.0);
+        c16[s * 6 + 1] = 0;
+        for (k = 1; k < 5; k++)
+        {
+            c16[s * 6 + k + 1] = (int16_t)sat(lround(c[k] * 16384.0), 16);
+        }
+        for (k = 0; k < 5; k++)
+        {
+            c32[s * 5 + k] = (int32_t)sat(llround(c[k] * 1073741824.0), 32);
+        }
+    }
+}
+
+/*
+ *  ======== testBiquad ========
+ */
+static int testBiquad(int q31, int stages, int wild)
+{
+    static int16_t c16[MAX_STAGES * 6], s16[FILTER_BIQUAD_STATE(MAX_STAGES)];
+    static int32_t c32[MAX_STAGES * 5], s32[FILTER_BIQUAD_STATE(MAX_STAGES)];
+    static int64_t in[SIGNAL], out[SIGNAL];
+    FilterBiquadQ15 f16;
+    FilterBiquadQ31 f32;
+    size_t done;
+    int i, s;
+
+    biquadCoeffs(c16, c32, stages, wild);
+    makeSignal();
+
+    filter_biquadInitQ15(&f16, c16, (uint8_t)stages, s16);
+    filter_biquadInitQ31(&f32, c32, (uint8_t)stages, s32);
+    for (done = 0; done < SIGNAL; )
+    {
+        size_t n = nextBlock(done);
+
+        if (q31)
+        {
+            filter_biquadQ31(&f32, &x32[done], &y32[done], n);
+        }
+        else
+        {
+            filter_biquadQ15(&f16, &x16[done], &y16[done], n);
+        }
+        done += n;
+    }
+
+    for (i = 0; i < SIGNAL; i++)
+    {
+        in[i] = q31 ? x32[i] : x16[i];
+    }
+    for (s = 0; s < stages; s++)
+    {
+        for (i = 0; i < SIGNAL; i++)
+        {
+            int64_t acc;
+
+            if (q31)
+            {
+                const int32_t *c = &c32[s * 5];
+
+                acc = ((int64_t)1 << 29) + (int64_t)c[0] * in[i]
+                      + (i >= 1 ? (int64_t)c[1] * in[i - 1] + (int64_t)c[3] * out[i - 1] : 0)
+                      + (i >= 2 ? (int64_t)c[2] * in[i - 2] + (int64_t)c[4] * out[i - 2] : 0);
+                out[i] = sat(acc >> 30, 32);
+            }
+            else
+            {
+                const int16_t *c = &c16[s * 6];
+
+                acc = (1 << 13) + (int64_t)c[0] * in[i]
+                      + (i >= 1 ? (int64_t)c[2] * in[i - 1] + (int64_t)c[4] * out[i - 1] : 0)
+                      + (i >= 2 ? (int64_t)c[3] * in[i - 2] + (int64_t)c[5] * out[i - 2] : 0);
+                out[i] = sat(acc >> 14, 16);
+            }
+        }
+        memcpy(in, out, sizeof(in));
+    }
+
+    for (i = 0; i < SIGNAL; i++)
+    {
+        int64_t got = q31 ? y32[i] : y16[i];
+
+        if (got != out[i])
+        {
+            printf("biquad q%d %d stages%s: output %d is %lld, expected %lld\n",
+                   q31 ? 31 : 15, stages, wild ? " (wild)" : "", i, (long long)got,
+                   (long long)out[i]);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ *  ======== testSettle ========
+ *  A low pass settled at a value and fed it must hold its output, within
+ *  a couple of LSBs per section for the rounding of the settled levels. The output
+ *  is the value times the gain of the quantized coefficients, which at
+ *  low cutoffs can be some way from 1 in Q14.
+ */
+static int testSettle(int stages)
+{
+    int16_t c16[MAX_STAGES * 6], s16[FILTER_BIQUAD_STATE(MAX_STAGES)];
+    int32_t c32[MAX_STAGES * 5], s32[FILTER_BIQUAD_STATE(MAX_STAGES)];
+    FilterBiquadQ15 f16;
+    FilterBiquadQ31 f32;
+    int16_t v16 = (int16_t)((int16_t)(rnd() >> 16) / 2);
+    int32_t v32 = (int32_t)rnd() / 2;
+    int16_t settled16;
+    int32_t settled32;
+    int i;
+
+    biquadCoeffs(c16, c32, stages, 0);
+    filter_biquadInitQ15(&f16, c16, (uint8_t)stages, s16);
+    filter_biquadInitQ31(&f32, c32, (uint8_t)stages, s32);
+    filter_biquadSettleQ15(&f16, v16);
+    filter_biquadSettleQ31(&f32, v32);
+    settled16 = s16[4 * (stages - 1) + 2];
+    settled32 = s32[4 * (stages - 1) + 2];
+    for (i = 0; i < 64; i++)
+    {
+        x16[i] = v16;
+        x32[i] = v32;
+    }
+    filter_biquadQ15(&f16, x16, y16, 64);
+    filter_biquadQ31(&f32, x32, y32, 64);
+
+    for (i = 0; i < 64; i++)
+    {
+        if (abs(y16[i] - settled16) > 2 * stages
+            || llabs((long long)y32[i] - settled32) > 2 * stages)
+        {
+            printf("settle %d stages: output %d is %d / %ld, settled at %d / %ld\n", stages,
+                   i, y16[i], (long)y32[i], settled16, (long)settled32);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ *  ======== testDsp ========
+ */
+static int testDsp(void)
+{
+#if DSP_INSTRUCTIONS
+    static const uint32_t edges[] = { 0x00000000, 0x7FFF7FFF, 0x80008000, 0x80007FFF,
+                                      0xFFFFFFFF, 0x00010001, 0x7FFF8000 };
+    int i;
+
+    for (i = 0; i < 1000000; i++)
+    {
+        uint32_t x = (i < 49) ? edges[i % 7] : rnd();
+        uint32_t y = (i < 49) ? edges[i / 7] : rnd();
+        int64_t acc = ((int64_t)rnd() << 32) | rnd();
+        int32_t v = (int32_t)rnd() >> (rnd() % 32);
+
+        if (dsp_smlald(x, y, acc) != dsp_smlaldModel(x, y, acc)
+            || dsp_ssat16(v) != dsp_ssat16Model(v))
+        {
+            printf("dsp: smlald %08x %08x or ssat %ld differs from its model\n", x, y,
+                   (long)v);
+            return 0;
+        }
+    }
+    printf("dsp       SMLALD and SSAT match their models       ok\n");
+#endif
+    return 1;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+static uint32_t now(void)
+{
+    return (uint32_t)__rdtsc();
+}
+#define UNITS "TSC cycles"
+#else
+static uint32_t now(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint32_t)(t.tv_sec * 1000000000ull + t.tv_nsec);
+}
+#define UNITS "ns"
+#endif
+
+int main(int argc, char *argv[])
+{
+    FilterBenchResult results[FILTERBENCH_CASES], best[FILTERBENCH_CASES];
+    int rounds = (argc > 1) ? atoi(argv[1]) : 200;
+    int ok = 1, passed = 0, tests = 0;
+    int i, r;
+
+    for (i = 0; i < 400; i++)
+    {
+        uint16_t taps = (uint16_t)(1 + below(MAX_TAPS));
+        uint16_t factor = (uint16_t)((i % 3 == 0) ? 1 + below(5) : 1);
+
+        tests += 2;
+        passed += testFir(0, taps, factor, i % 4 == 1);
+        passed += testFir(1, taps, factor, 0);
+    }
+    printf("exact     fir q15/q31, %d filters                  %s\n", tests,
+           passed == tests ? "ok" : "FAILED");
+    ok &= (passed == tests);
+
+    passed = tests = 0;
+    for (i = 0; i < 400; i++)
+    {
+        int stages = 1 + (int)below(MAX_STAGES);
+
+        tests += 2;
+        passed += testBiquad(0, stages, i % 2);
+        passed += testBiquad(1, stages, i % 2);
+    }
+    printf("exact     biquad q15/q31, %d filters               %s\n", tests,
+           passed == tests ? "ok" : "FAILED");
+    ok &= (passed == tests);
+
+    passed = tests = 0;
+    for (i = 0; i < 200; i++)
+    {
+        tests++;
+        passed += testSettle(1 + (int)below(MAX_STAGES));
+    }
+    printf("settle    biquad q15/q31, %d filters               %s\n", tests,
+           passed == tests ? "ok" : "FAILED");
+    ok &= (passed == tests);
+
+    ok &= testDsp();
+
+    /* Best of a number of rounds, the checksums the same every time */
+    for (r = 0; r < rounds; r++)
+    {
+        filterbench_run(results, now);
+        for (i = 0; i < FILTERBENCH_CASES; i++)
+        {
+            if (r == 0 || results[i].ticks < best[i].ticks)
+            {
+                best[i] = results[i];
+            }
+        }
+    }
+
+    printf("\n%-24s %5s %7s %10s %8s\n", "", "taps", "outputs", "checksum", UNITS);
+    printf("%-24s %5s %7s %10s %8s\n", "", "", "", "", "per tap");
+    for (i = 0; i < FILTERBENCH_CASES; i++)
+    {
+        printf("%-24s %5u %7u   %08lx %8.3f\n", best[i].name, best[i].macs, best[i].outputs,
+               (unsigned long)best[i].checksum,
+               (double)best[i].ticks / ((double)best[i].outputs * best[i].macs));
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,515 @@
+/*
+ *  ======== sim.c ========
+ *
+ *  Host stand-ins for the TI drivers gpiointerrupt.c uses, on a simulated
+ *  clock. See sim.h.
+ */
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ti/drivers/GPIO.h>
+#include <ti/drivers/Power.h>
+#include <ti/drivers/PWM.h>
+#include <ti/drivers/Timer.h>
+#include <ti/drivers/UART2.h>
+#include <ti/drivers/dpl/HwiP.h>
+
+#include "ti_drivers_config.h"
+#include "sim.h"
+
+#define MAX_INPUTS      4096
+#define MAX_INTERRUPTS  65536
+#define OUTPUT_SIZE     65536
+
+extern void *mainThread(void *arg0);
+
+enum InputTypes {INPUT_BUTTON, INPUT_KEY, INPUT_TEXT};
+
+typedef struct {
+    uint64_t count;
+    enum InputTypes type;
+    int arg;
+    const char *text;
+} Input;
+
+struct Timer_Config_ {
+    Timer_Params params;
+    uint64_t period;            /* counts */
+    uint64_t expiry;
+    int running;
+};
+
+struct PWM_Config_ {
+    int unused;
+};
+
+struct UART2_Config_ {
+    UART2_Params params;
+    void *readBuffer;           /* the read in progress, if any */
+    size_t readSize;
+};
+
+static uint64_t now = 0;
+static uint64_t end = 0;
+static jmp_buf finished;
+
+static Input inputs[MAX_INPUTS];
+static size_t inputCount = 0;
+static size_t nextInput = 0;
+
+static SimWrite writes[SIM_MAX_WRITES];
+static size_t writeCount = 0;
+
+static uint64_t interrupts[MAX_INTERRUPTS];
+static size_t interruptCount = 0;
+
+static char output[OUTPUT_SIZE];
+static size_t outputLength = 0;
+
+static struct Timer_Config_ timers[2];
+static struct PWM_Config_ pwm;
+static struct UART2_Config_ uart;
+
+static GPIO_CallbackFxn gpioCallbacks[CONFIG_GPIO_COUNT];
+static unsigned int pinLevels[CONFIG_GPIO_COUNT];
+
+/*
+ *  ======== addInput ========
+ */
+static void addInput(uint32_t ms, enum InputTypes type, int arg, const char *text)
+{
+    if (inputCount == MAX_INPUTS)
+    {
+        fprintf(stderr, "sim: more than %d inputs\n", MAX_INPUTS);
+        exit(2);
+    }
+    inputs[inputCount].count = (uint64_t)ms * SIM_COUNTS_PER_MS;
+    inputs[inputCount].type = type;
+    inputs[inputCount].arg = arg;
+    inputs[inputCount].text = text;
+    inputCount++;
+}
+
+/*
+ *  ======== compareInputs ========
+ *  By time, then in the order they were added.
+ */
+static int compareInputs(const void *a, const void *b)
+{
+    const Input *x = a;
+    const Input *y = b;
+
+    if (x->count != y->count)
+    {
+        return (x->count > y->count) - (x->count < y->count);
+    }
+    return (x > y) - (x < y);
+}
+
+/*
+ *  ======== record ========
+ */
+static void record(uint8_t index, uint8_t level)
+{
+    if (writeCount < SIM_MAX_WRITES)
+    {
+        writes[writeCount].count = now;
+        writes[writeCount].index = index;
+        writes[writeCount].level = level;
+        writeCount++;
+    }
+}
+
+/*
+ *  ======== sendText ========
+ *  Completes UART reads with text, as the driver would as it arrives.
+ */
+static void sendText(const char *text)
+{
+    size_t length = strlen(text);
+
+    while (length > 0 && uart.readBuffer != NULL)
+    {
+        void *buffer = uart.readBuffer;
+        size_t n = (length < uart.readSize) ? length : uart.readSize;
+
+        memcpy(buffer, text, n);
+        text += n;
+        length -= n;
+        uart.readBuffer = NULL;
+        uart.params.readCallback(&uart, buffer, n, uart.params.userArg, UART2_STATUS_SUCCESS);
+    }
+    if (length > 0)
+    {
+        fprintf(stderr, "sim: no UART read pending, %zu bytes lost\n", length);
+    }
+}
+
+/*
+ *  ======== runInput ========
+ */
+static void runInput(const Input *in)
+{
+    switch (in->type)
+    {
+        case INPUT_BUTTON:
+            pinLevels[in->arg] = 0;
+            if (gpioCallbacks[in->arg] != NULL)
+            {
+                gpioCallbacks[in->arg]((uint_least8_t)in->arg);
+            }
+            pinLevels[in->arg] = 1;
+            break;
+
+        case INPUT_KEY:
+            pinLevels[CONFIG_GPIO_BUTTON_1] = !in->arg;
+            if (gpioCallbacks[CONFIG_GPIO_BUTTON_1] != NULL)
+            {
+                gpioCallbacks[CONFIG_GPIO_BUTTON_1](CONFIG_GPIO_BUTTON_1);
+            }
+            break;
+
+        case INPUT_TEXT:
+            sendText(in->text);
+            break;
+    }
+}
+
+/*
+ *  ======== sim_pressButton ========
+ */
+void sim_pressButton(uint32_t ms, uint_least8_t index)
+{
+    addInput(ms, INPUT_BUTTON, index, NULL);
+}
+
+/*
+ *  ======== sim_setKey ========
+ */
+void sim_setKey(uint32_t ms, int pressed)
+{
+    addInput(ms, INPUT_KEY, pressed != 0, NULL);
+}
+
+/*
+ *  ======== sim_sendText ========
+ */
+void sim_sendText(uint32_t ms, const char *text)
+{
+    addInput(ms, INPUT_TEXT, 0, text);
+}
+
+/*
+ *  ======== sim_run ========
+ */
+void sim_run(uint32_t ms)
+{
+    unsigned int i;
+
+    for (i = 0; i < CONFIG_GPIO_COUNT; i++)
+    {
+        pinLevels[i] = 1;       /* buttons pulled up */
+    }
+    qsort(inputs, inputCount, sizeof(inputs[0]), compareInputs);
+    end = (uint64_t)ms * SIM_COUNTS_PER_MS;
+    if (setjmp(finished) == 0)
+    {
+        mainThread(NULL);
+    }
+}
+
+/*
+ *  ======== sim_writes ========
+ */
+size_t sim_writes(const SimWrite **list)
+{
+    *list = writes;
+    return writeCount;
+}
+
+/*
+ *  ======== sim_levelAt ========
+ */
+unsigned int sim_levelAt(uint8_t index, uint64_t count)
+{
+    unsigned int level = 0;
+    size_t i;
+
+    for (i = 0; i < writeCount && writes[i].count <= count; i++)
+    {
+        if (writes[i].index == index)
+        {
+            level = writes[i].level;
+        }
+    }
+    return level;
+}
+
+/*
+ *  ======== sim_interrupts ========
+ */
+unsigned int sim_interrupts(uint32_t fromMs, uint32_t toMs)
+{
+    uint64_t from = (uint64_t)fromMs * SIM_COUNTS_PER_MS;
+    uint64_t to = (uint64_t)toMs * SIM_COUNTS_PER_MS;
+    unsigned int count = 0;
+    size_t i;
+
+    for (i = 0; i < interruptCount; i++)
+    {
+        count += (interrupts[i] >= from && interrupts[i] < to);
+    }
+    return count;
+}
+
+/*
+ *  ======== sim_uartOutput ========
+ */
+const char *sim_uartOutput(void)
+{
+    output[outputLength] = '\0';
+    return output;
+}
+
+/*
+ *  ======== Power_idleFunc ========
+ *  Sleeps until the next interrupt: moves the clock on to the earliest
+ *  timer expiry or input and runs its callback.
+ */
+void Power_idleFunc(void)
+{
+    struct Timer_Config_ *timer = &timers[0];
+    uint64_t next = end;
+
+    if (timer->running && timer->expiry < next)
+    {
+        next = timer->expiry;
+    }
+    if (nextInput < inputCount && inputs[nextInput].count < next)
+    {
+        next = inputs[nextInput].count;
+    }
+    if (next >= end)
+    {
+        now = end;
+        longjmp(finished, 1);
+    }
+    now = next;
+
+    if (timer->running && timer->expiry == now)
+    {
+        timer->running = 0;
+        if (interruptCount < MAX_INTERRUPTS)
+        {
+            interrupts[interruptCount++] = now;
+        }
+        timer->params.timerCallback(timer, 0);
+    }
+    else
+    {
+        runInput(&inputs[nextInput++]);
+    }
+}
+
+/*
+ *  ======== HwiP ========
+ */
+uintptr_t HwiP_disable(void)
+{
+    return 0;
+}
+
+void HwiP_restore(uintptr_t key)
+{
+    (void)key;
+}
+
+/*
+ *  ======== GPIO ========
+ */
+void GPIO_init(void)
+{
+}
+
+int_fast16_t GPIO_setConfig(uint_least8_t index, GPIO_PinConfig pinConfig)
+{
+    if (pinConfig & GPIO_CFG_OUT_STD)
+    {
+        pinLevels[index] = (pinConfig & GPIO_CFG_OUT_HIGH) ? 1 : 0;
+    }
+    return 0;
+}
+
+void GPIO_write(uint_least8_t index, unsigned int value)
+{
+    pinLevels[index] = value;
+    record((uint8_t)index, (uint8_t)value);
+}
+
+uint_fast8_t GPIO_read(uint_least8_t index)
+{
+    return (uint_fast8_t)pinLevels[index];
+}
+
+void GPIO_setCallback(uint_least8_t index, GPIO_CallbackFxn callback)
+{
+    gpioCallbacks[index] = callback;
+}
+
+void GPIO_enableInt(uint_least8_t index)
+{
+    (void)index;
+}
+
+/*
+ *  ======== PWM ========
+ */
+void PWM_init(void)
+{
+}
+
+void PWM_Params_init(PWM_Params *params)
+{
+    memset(params, 0, sizeof(*params));
+    params->periodUnits = PWM_PERIOD_HZ;
+    params->periodValue = 1000000;
+    params->dutyUnits = PWM_DUTY_FRACTION;
+}
+
+PWM_Handle PWM_open(uint_least8_t index, PWM_Params *params)
+{
+    (void)index;
+    (void)params;
+    return &pwm;
+}
+
+int_fast16_t PWM_start(PWM_Handle handle)
+{
+    (void)handle;
+    return PWM_STATUS_SUCCESS;
+}
+
+int_fast16_t PWM_setDuty(PWM_Handle handle, uint32_t duty)
+{
+    (void)handle;
+    record(SIM_PWM, (uint8_t)(((uint64_t)duty * 255 + PWM_DUTY_FRACTION_MAX / 2)
+                              / PWM_DUTY_FRACTION_MAX));
+    return PWM_STATUS_SUCCESS;
+}
+
+/*
+ *  ======== Timer ========
+ *  CONFIG_TIMER_0 is the one-shot, CONFIG_TIMER_1 the free-running clock.
+ */
+void Timer_init(void)
+{
+}
+
+void Timer_Params_init(Timer_Params *params)
+{
+    memset(params, 0, sizeof(*params));
+    params->timerMode = Timer_ONESHOT_BLOCKING;
+    params->periodUnits = Timer_PERIOD_COUNTS;
+    params->period = 0xFFFFFFFF;
+}
+
+Timer_Handle Timer_open(uint_least8_t index, Timer_Params *params)
+{
+    struct Timer_Config_ *timer = &timers[index];
+
+    timer->params = *params;
+    Timer_setPeriod(timer, params->periodUnits, params->period);
+    return timer;
+}
+
+int32_t Timer_start(Timer_Handle handle)
+{
+    handle->expiry = now + handle->period;
+    handle->running = 1;
+    return Timer_STATUS_SUCCESS;
+}
+
+void Timer_stop(Timer_Handle handle)
+{
+    handle->running = 0;
+}
+
+int32_t Timer_setPeriod(Timer_Handle handle, Timer_PeriodUnits periodUnits, uint32_t period)
+{
+    switch (periodUnits)
+    {
+        case Timer_PERIOD_US:
+            handle->period = (uint64_t)period * (SIM_COUNTS_PER_MS / 1000);
+            break;
+
+        case Timer_PERIOD_HZ:
+            handle->period = (uint64_t)SIM_COUNTS_PER_MS * 1000 / (period ? period : 1);
+            break;
+
+        case Timer_PERIOD_COUNTS:
+            handle->period = period;
+            break;
+    }
+    return Timer_STATUS_SUCCESS;
+}
+
+uint32_t Timer_getCount(Timer_Handle handle)
+{
+    (void)handle;
+    return (uint32_t)now;
+}
+
+/*
+ *  ======== UART2 ========
+ */
+void UART2_Params_init(UART2_Params *params)
+{
+    memset(params, 0, sizeof(*params));
+    params->readMode = UART2_Mode_BLOCKING;
+    params->writeMode = UART2_Mode_BLOCKING;
+    params->readReturnMode = UART2_ReadReturnMode_FULL;
+    params->baudRate = 115200;
+}
+
+UART2_Handle UART2_open(uint_least8_t index, UART2_Params *params)
+{
+    (void)index;
+    if (params->readMode != UART2_Mode_CALLBACK || params->readCallback == NULL)
+    {
+        fprintf(stderr, "sim: only callback mode UART2 reads are implemented\n");
+        return NULL;
+    }
+    uart.params = *params;
+    return &uart;
+}
+
+int_fast16_t UART2_read(UART2_Handle handle, void *buffer, size_t size, size_t *bytesRead)
+{
+    handle->readBuffer = buffer;
+    handle->readSize = size;
+    if (bytesRead != NULL)
+    {
+        *bytesRead = 0;
+    }
+    return UART2_STATUS_SUCCESS;
+}
+
+int_fast16_t UART2_write(UART2_Handle handle, const void *buffer, size_t size,
+                         size_t *bytesWritten)
+{
+    (void)handle;
+    if (size > OUTPUT_SIZE - 1 - outputLength)
+    {
+        size = OUTPUT_SIZE - 1 - outputLength;
+    }
+    memcpy(output + outputLength, buffer, size);
+    outputLength += size;
+    if (bytesWritten != NULL)
+    {
+        *bytesWritten = size;
+    }
+    return UART2_STATUS_SUCCESS;
+}
@@ -0,0 +1,84 @@
+/*
+ *  ======== sim.h ========
+ *
+ *  What the host checks can see of the gpiointerrupt driver stand-ins.
+ *
+ *  The firmware runs unchanged on a simulated 80 MHz clock. Time only
+ *  moves in Power_idleFunc(), the main loop's sleep: it jumps to the next
+ *  timer expiry or scripted input and runs that interrupt's callback, so
+ *  a run is exact and repeatable, and a minute of Morse takes
+ *  milliseconds. Interrupts are never late, and code takes no time.
+ *
+ *  Inputs are scripted before sim_run(), which can be called once per
+ *  process since the firmware keeps its state in statics.
+ */
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIM_COUNTS_PER_MS   80000
+#define SIM_MAX_WRITES      65536
+
+/* Index of the PWM in SimWrite; duty is recorded as a level 0 - 255 */
+#define SIM_PWM             0xFF
+
+/* One GPIO_write() or PWM_setDuty() */
+typedef struct {
+    uint64_t count;             /* simulated clock */
+    uint8_t index;
+    uint8_t level;
+} SimWrite;
+
+/*
+ *  ======== sim_pressButton ========
+ *  A falling edge on a button pin at ms, like a press of SW2.
+ */
+void sim_pressButton(uint32_t ms, uint_least8_t index);
+
+/*
+ *  ======== sim_setKey ========
+ *  The SW3 Morse key goes down or up at ms.
+ */
+void sim_setKey(uint32_t ms, int pressed);
+
+/*
+ *  ======== sim_sendText ========
+ *  text arrives on the UART at ms. It is not copied.
+ */
+void sim_sendText(uint32_t ms, const char *text);
+
+/*
+ *  ======== sim_run ========
+ *  Runs mainThread() from time 0 until ms.
+ */
+void sim_run(uint32_t ms);
+
+/*
+ *  ======== sim_writes ========
+ *  Returns the number of writes recorded (at most SIM_MAX_WRITES) and
+ *  points *writes at them.
+ */
+size_t sim_writes(const SimWrite **writes);
+
+/*
+ *  ======== sim_levelAt ========
+ *  The level an output had at clock count, 0 before any write.
+ */
+unsigned int sim_levelAt(uint8_t index, uint64_t count);
+
+/*
+ *  ======== sim_interrupts ========
+ *  Timer interrupts taken from fromMs up to, not including, toMs.
+ */
+unsigned int sim_interrupts(uint32_t fromMs, uint32_t toMs);
+
+/*
+ *  ======== sim_uartOutput ========
+ *  Everything written to the UART, as a string.
+ */
+const char *sim_uartOutput(void);
+
+#endif /* SIM_H_ */
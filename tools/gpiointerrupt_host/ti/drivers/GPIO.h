@@ -0,0 +1,32 @@
+/*
+ *  ======== GPIO.h ========
+ *
+ *  Host stand-in for the parts of the TI GPIO driver that gpiointerrupt
+ *  uses. Writes are recorded against the simulated clock and buttons are
+ *  pressed by the simulation (see sim.h).
+ */
+
+#ifndef ti_drivers_GPIO__include
+#define ti_drivers_GPIO__include
+
+#include <stdint.h>
+
+typedef uint32_t GPIO_PinConfig;
+
+typedef void (*GPIO_CallbackFxn)(uint_least8_t index);
+
+#define GPIO_CFG_OUT_STD            0x0001
+#define GPIO_CFG_OUT_LOW            0x0000
+#define GPIO_CFG_OUT_HIGH           0x0002
+#define GPIO_CFG_IN_PU              0x0010
+#define GPIO_CFG_IN_INT_FALLING     0x0100
+#define GPIO_CFG_IN_INT_BOTH_EDGES  0x0200
+
+void GPIO_init(void);
+int_fast16_t GPIO_setConfig(uint_least8_t index, GPIO_PinConfig pinConfig);
+void GPIO_write(uint_least8_t index, unsigned int value);
+uint_fast8_t GPIO_read(uint_least8_t index);
+void GPIO_setCallback(uint_least8_t index, GPIO_CallbackFxn callback);
+void GPIO_enableInt(uint_least8_t index);
+
+#endif /* ti_drivers_GPIO__include */
@@ -0,0 +1,45 @@
+/*
+ *  ======== PWM.h ========
+ *
+ *  Host stand-in for the parts of the TI PWM driver that gpiointerrupt
+ *  uses. Duty changes are recorded like GPIO writes (see sim.h).
+ */
+
+#ifndef ti_drivers_PWM__include
+#define ti_drivers_PWM__include
+
+#include <stdint.h>
+
+#define PWM_STATUS_SUCCESS    0
+#define PWM_STATUS_ERROR      (-1)
+
+#define PWM_DUTY_FRACTION_MAX ((uint32_t)~0)
+
+typedef struct PWM_Config_ *PWM_Handle;
+
+typedef enum {
+    PWM_PERIOD_US,
+    PWM_PERIOD_HZ,
+    PWM_PERIOD_COUNTS
+} PWM_Period_Units;
+
+typedef enum {
+    PWM_DUTY_US,
+    PWM_DUTY_FRACTION,
+    PWM_DUTY_COUNTS
+} PWM_Duty_Units;
+
+typedef struct {
+    PWM_Period_Units periodUnits;
+    uint32_t periodValue;
+    PWM_Duty_Units dutyUnits;
+    uint32_t dutyValue;
+} PWM_Params;
+
+void PWM_init(void);
+void PWM_Params_init(PWM_Params *params);
+PWM_Handle PWM_open(uint_least8_t index, PWM_Params *params);
+int_fast16_t PWM_start(PWM_Handle handle);
+int_fast16_t PWM_setDuty(PWM_Handle handle, uint32_t duty);
+
+#endif /* ti_drivers_PWM__include */
@@ -0,0 +1,13 @@
+/*
+ *  ======== Power.h ========
+ *
+ *  Host stand-in for the TI Power driver. Power_idleFunc() is where the
+ *  simulated clock moves on to the next interrupt (see sim.c).
+ */
+
+#ifndef ti_drivers_Power__include
+#define ti_drivers_Power__include
+
+void Power_idleFunc(void);
+
+#endif /* ti_drivers_Power__include */
@@ -0,0 +1,50 @@
+/*
+ *  ======== UART2.h ========
+ *
+ *  Host stand-in for the parts of the TI UART2 driver that gpiointerrupt
+ *  uses: callback mode reads, which the simulation completes with text
+ *  it sends, and writes, which it collects (see sim.h).
+ */
+
+#ifndef ti_drivers_UART2__include
+#define ti_drivers_UART2__include
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct UART2_Config_ *UART2_Handle;
+
+typedef void (*UART2_Callback)(UART2_Handle handle, void *buf, size_t count,
+                               void *userArg, int_fast16_t status);
+
+typedef enum {
+    UART2_Mode_BLOCKING,
+    UART2_Mode_CALLBACK,
+    UART2_Mode_NONBLOCKING
+} UART2_Mode;
+
+typedef enum {
+    UART2_ReadReturnMode_FULL,
+    UART2_ReadReturnMode_PARTIAL
+} UART2_ReadReturnMode;
+
+typedef struct {
+    UART2_Mode readMode;
+    UART2_Mode writeMode;
+    UART2_Callback readCallback;
+    UART2_Callback writeCallback;
+    UART2_ReadReturnMode readReturnMode;
+    uint32_t baudRate;
+    void *userArg;
+} UART2_Params;
+
+#define UART2_STATUS_SUCCESS  (0)
+#define UART2_STATUS_EFAIL    (-1)
+
+void UART2_Params_init(UART2_Params *params);
+UART2_Handle UART2_open(uint_least8_t index, UART2_Params *params);
+int_fast16_t UART2_read(UART2_Handle handle, void *buffer, size_t size, size_t *bytesRead);
+int_fast16_t UART2_write(UART2_Handle handle, const void *buffer, size_t size,
+                         size_t *bytesWritten);
+
+#endif /* ti_drivers_UART2__include */
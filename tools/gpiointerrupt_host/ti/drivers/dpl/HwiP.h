@@ -0,0 +1,16 @@
+/*
+ *  ======== HwiP.h ========
+ *
+ *  Host stand-in. The simulation runs interrupts only from
+ *  Power_idleFunc(), so there is nothing to mask.
+ */
+
+#ifndef ti_drivers_dpl_HwiP__include
+#define ti_drivers_dpl_HwiP__include
+
+#include <stdint.h>
+
+uintptr_t HwiP_disable(void);
+void HwiP_restore(uintptr_t key);
+
+#endif /* ti_drivers_dpl_HwiP__include */
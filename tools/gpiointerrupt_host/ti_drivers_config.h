@@ -0,0 +1,29 @@
+/*
+ *  ======== ti_drivers_config.h ========
+ *
+ *  Host stand-in for the SysConfig generated configuration of the
+ *  gpiointerrupt example (see sim.c).
+ */
+
+#ifndef TI_DRIVERS_CONFIG_H_
+#define TI_DRIVERS_CONFIG_H_
+
+#include <stdint.h>
+
+#define CONFIG_GPIO_BUTTON_0    0
+#define CONFIG_GPIO_BUTTON_1    1
+#define CONFIG_GPIO_LED_0       2
+#define CONFIG_GPIO_LED_1       3
+#define CONFIG_GPIO_COUNT       4
+
+#define CONFIG_GPIO_LED_ON      (1)
+#define CONFIG_GPIO_LED_OFF     (0)
+
+#define CONFIG_PWM_0            0
+
+#define CONFIG_TIMER_0          0
+#define CONFIG_TIMER_1          1
+
+#define CONFIG_UART2_0          0
+
+#endif /* TI_DRIVERS_CONFIG_H_ */
@@ -0,0 +1,151 @@
+/*
+ *  ======== lightness.c ========
+ *
+ *  Checks the brightness tables that pwmled2's lightness.h has the
+ *  compiler build against the CIE 1976 lightness curve worked out here
+ *  at run time, for a range of resolutions and duty scales: each entry
+ *  must be the reference duty rounded to the nearest unit, and the tables
+ *  must never fall and must run from 0 to full scale.
+ *
+ *  It also reads each entry back through the forward curve (duty to L*)
+ *  and reports how far rounding moved a level. More than half a step
+ *  (50%) means the duty resolution is too coarse for that many levels:
+ *  some neighbouring levels share a duty.
+ *
+ *  Build:  cc -I pwmled2_CC3220SF_LAUNCHXL_nortos_gcc -o lightness tools/lightness.c -lm
+ *  Usage:  ./lightness
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "lightness.h"
+
+/* pwmled2 itself: 3000 us period in sixteenths of an 80 MHz count */
+static const uint32_t counts3840000x64[] = { LIGHTNESS_TABLE(64, 240000 << 4) };
+
+/* The same period in microseconds */
+static const uint32_t us3000x64[] = { LIGHTNESS_TABLE(64, 3000) };
+static const uint32_t us3000x16[] = { LIGHTNESS_TABLE(16, 3000) };
+static const uint32_t us3000x1024[] = { LIGHTNESS_TABLE(1024, 3000) };
+
+/* 8 bit and 16 bit duty, and timer counts for 3 ms at 80 MHz */
+static const uint32_t bits8x256[] = { LIGHTNESS_TABLE(256, 255) };
+static const uint32_t bits16x256[] = { LIGHTNESS_TABLE(256, 65535) };
+static const uint32_t counts240000x128[] = { LIGHTNESS_TABLE(128, 240000) };
+
+/* PWM_DUTY_FRACTION */
+static const uint32_t fractionx32[] = { LIGHTNESS_TABLE(32, 0xFFFFFFFF) };
+
+/* Smallest tables */
+static const uint32_t us3000x2[] = { LIGHTNESS_TABLE(2, 3000) };
+static const uint32_t us3000x4[] = { LIGHTNESS_TABLE(4, 3000) };
+
+#define TABLE(t, full) { #t, t, sizeof(t) / sizeof(t[0]), full }
+
+static const struct {
+    const char *name;
+    const uint32_t *table;
+    size_t levels;
+    double full;
+} tables[] = {
+    TABLE(counts3840000x64, 3840000),
+    TABLE(us3000x64, 3000),
+    TABLE(us3000x16, 3000),
+    TABLE(us3000x1024, 3000),
+    TABLE(bits8x256, 255),
+    TABLE(bits16x256, 65535),
+    TABLE(counts240000x128, 240000),
+    TABLE(fractionx32, 4294967295.0),
+    TABLE(us3000x2, 3000),
+    TABLE(us3000x4, 3000),
+};
+#define NUM_TABLES (int)(sizeof(tables) / sizeof(tables[0]))
+
+/*
+ *  ======== luminance ========
+ *  CIE 1976: L* to relative luminance Y.
+ */
+static double luminance(double l)
+{
+    return (l > 8.0) ? pow((l + 16.0) / 116.0, 3.0) : l * 27.0 / 24389.0;
+}
+
+/*
+ *  ======== lightness ========
+ *  CIE 1976: relative luminance Y to L*.
+ */
+static double lightness(double y)
+{
+    return (y > 216.0 / 24389.0) ? 116.0 * cbrt(y) - 16.0 : y * 24389.0 / 27.0;
+}
+
+/*
+ *  ======== check ========
+ */
+static int check(int t)
+{
+    const uint32_t *table = tables[t].table;
+    double full = tables[t].full;
+    double step = 100.0 / (double)(tables[t].levels - 1);
+    double worstDuty = 0.0;
+    double worstL = 0.0;
+    int ok = 1;
+    size_t k;
+
+    for (k = 0; k < tables[t].levels; k++)
+    {
+        double l = step * (double)k;
+        double reference = full * luminance(l);
+        double error = fabs((double)table[k] - reference);
+
+        if (error > worstDuty)
+        {
+            worstDuty = error;
+        }
+        if (error > 0.5 + 1e-6)
+        {
+            printf("%s[%zu] = %lu, reference %.3f\n", tables[t].name, k,
+                   (unsigned long)table[k], reference);
+            ok = 0;
+        }
+        if (k > 0 && table[k] < table[k - 1])
+        {
+            printf("%s[%zu] = %lu is below the level before it\n", tables[t].name, k,
+                   (unsigned long)table[k]);
+            ok = 0;
+        }
+
+        // How far rounding moved the level
+        error = fabs(lightness((double)table[k] / full) - l);
+        if (error > worstL)
+        {
+            worstL = error;
+        }
+    }
+
+    if (table[0] != 0 || (double)table[tables[t].levels - 1] != full)
+    {
+        printf("%s runs from %lu to %lu, not 0 to %.0f\n", tables[t].name,
+               (unsigned long)table[0], (unsigned long)table[tables[t].levels - 1], full);
+        ok = 0;
+    }
+
+    printf("%-18s %5zu levels  duty error %.3f  L* error %.3f (%.1f%% of a step)  %s\n",
+           tables[t].name, tables[t].levels, worstDuty, worstL, 100.0 * worstL / step,
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(void)
+{
+    int ok = 1;
+    int t;
+
+    for (t = 0; t < NUM_TABLES; t++)
+    {
+        ok &= check(t);
+    }
+    return ok ? 0 : 1;
+}
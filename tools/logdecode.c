@@ -0,0 +1,264 @@
+/*
+ *  ======== logdecode.c ========
+ *
+ *  Host side decoder for the thermostat's deferred log records (see
+ *  thermostat-gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc/log.h).
+ *
+ *  The format strings never reach the target; they stay in the .log_data
+ *  section of the .out file. This tool loads that file, reads the UART
+ *  capture from a file or stdin, passes plain text (the <AA,BB,S,CCCC>
+ *  reports) through unchanged and turns every log record back into a line
+ *  of text.
+ *
+ *  With the UART channel multiplexer on (MUX_FRAMED in mux.h), split the
+ *  capture with muxdemux first and decode the log channel (2) on its own.
+ *
+ *  Build:  cc -O2 -o logdecode logdecode.c
+ *  Usage:  logdecode thermostat.out [capture]
+ *          e.g. logdecode Debug/thermostat-...out < /dev/ttyACM0
+ */
+
+#include <elf.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Keep in sync with log.h */
+#define LOG_RECORD_START 0xFE
+#define LOG_DATA_BASE    0x90000000u
+#define LOG_MAX_ARGS     8
+
+/* One allocated section of the .out file */
+typedef struct {
+    uint32_t addr;
+    uint32_t size;
+    const uint8_t *data;
+} Section;
+
+static uint8_t *image;
+static Section sections[64];
+static int numSections;
+
+/*
+ *  ======== loadElf ========
+ *  Reads the whole .out file and records every section that has both an
+ *  address and file contents (.rodata for %s arguments, .log_data for the
+ *  format strings).
+ */
+static void loadElf(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    long length;
+    const Elf32_Ehdr *eh;
+    int i;
+
+    if (f == NULL || fseek(f, 0, SEEK_END) != 0 || (length = ftell(f)) <= 0)
+    {
+        fprintf(stderr, "logdecode: cannot read %s\n", path);
+        exit(1);
+    }
+    rewind(f);
+    image = malloc(length);
+    if (image == NULL || fread(image, 1, length, f) != (size_t)length)
+    {
+        fprintf(stderr, "logdecode: cannot read %s\n", path);
+        exit(1);
+    }
+    fclose(f);
+
+    eh = (const Elf32_Ehdr *)image;
+    if ((size_t)length < sizeof(*eh) || memcmp(eh->e_ident, ELFMAG, SELFMAG) != 0
+        || eh->e_ident[EI_CLASS] != ELFCLASS32
+        || eh->e_ident[EI_DATA] != ELFDATA2LSB
+        || eh->e_shoff + (uint32_t)eh->e_shnum * sizeof(Elf32_Shdr) > (size_t)length)
+    {
+        fprintf(stderr, "logdecode: %s is not a 32-bit little endian ELF file\n", path);
+        exit(1);
+    }
+
+    for (i = 0; i < eh->e_shnum && numSections < 64; i++)
+    {
+        const Elf32_Shdr *sh = (const Elf32_Shdr *)(image + eh->e_shoff) + i;
+
+        if (sh->sh_addr == 0 || sh->sh_type == SHT_NOBITS
+            || sh->sh_offset + sh->sh_size > (size_t)length)
+        {
+            continue;
+        }
+        sections[numSections].addr = sh->sh_addr;
+        sections[numSections].size = sh->sh_size;
+        sections[numSections].data = image + sh->sh_offset;
+        numSections++;
+    }
+}
+
+/*
+ *  ======== lookupString ========
+ *  Returns the NUL terminated string at a target address, or NULL.
+ */
+static const char *lookupString(uint32_t addr)
+{
+    int i;
+
+    for (i = 0; i < numSections; i++)
+    {
+        if (addr >= sections[i].addr && addr - sections[i].addr < sections[i].size)
+        {
+            uint32_t offset = addr - sections[i].addr;
+
+            if (memchr(sections[i].data + offset, '\0', sections[i].size - offset) == NULL)
+            {
+                return NULL;
+            }
+            return (const char *)sections[i].data + offset;
+        }
+    }
+    return NULL;
+}
+
+/*
+ *  ======== printRecord ========
+ *  Formats one record with the printf-style string from the .out file.
+ *  Conversions are handled one at a time, so every argument word is
+ *  passed with the type its conversion expects.
+ */
+static void printRecord(uint16_t id, const uint32_t *args, int nargs)
+{
+    const char *fmt = lookupString(LOG_DATA_BASE + ((uint32_t)id << 2));
+    int next = 0;
+
+    if (fmt == NULL)
+    {
+        printf("<unknown log id %u>\n", id);
+        return;
+    }
+
+    while (*fmt != '\0')
+    {
+        char spec[16];
+        size_t n = 0;
+        char conv;
+        uint32_t arg;
+
+        if (*fmt != '%')
+        {
+            putchar(*fmt++);
+            continue;
+        }
+        if (fmt[1] == '%')
+        {
+            putchar('%');
+            fmt += 2;
+            continue;
+        }
+
+        // Copy flags, width and precision; drop length modifiers.
+        spec[n++] = *fmt++;
+        while (*fmt != '\0' && strchr("-+ #0123456789.", *fmt) != NULL && n < sizeof(spec) - 2)
+        {
+            spec[n++] = *fmt++;
+        }
+        while (*fmt != '\0' && strchr("hlzjt", *fmt) != NULL)
+        {
+            fmt++;
+        }
+        conv = *fmt;
+        if (conv == '\0')
+        {
+            break;
+        }
+        fmt++;
+        spec[n++] = conv;
+        spec[n] = '\0';
+
+        arg = (next < nargs) ? args[next] : 0;
+        next++;
+
+        switch (conv)
+        {
+            case 'd':
+            case 'i':
+            case 'c':
+                printf(spec, (int32_t)arg);
+                break;
+            case 's':
+            {
+                const char *str = lookupString(arg);
+                if (str != NULL)
+                {
+                    printf(spec, str);
+                }
+                else
+                {
+                    printf("<0x%08x>", arg);
+                }
+                break;
+            }
+            case 'p':
+                printf("0x%08x", arg);
+                break;
+            default:
+                printf(spec, arg);
+                break;
+        }
+    }
+    putchar('\n');
+}
+
+/*
+ *  ======== main ========
+ */
+int main(int argc, char *argv[])
+{
+    FILE *in = stdin;
+    int c;
+
+    if (argc < 2 || argc > 3)
+    {
+        fprintf(stderr, "usage: %s firmware.out [capture]\n", argv[0]);
+        return 2;
+    }
+    loadElf(argv[1]);
+    if (argc == 3 && (in = fopen(argv[2], "rb")) == NULL)
+    {
+        fprintf(stderr, "logdecode: cannot open %s\n", argv[2]);
+        return 1;
+    }
+
+    while ((c = getc(in)) != EOF)
+    {
+        uint8_t header[3];
+        uint32_t args[LOG_MAX_ARGS];
+        int i;
+
+        if (c != LOG_RECORD_START)
+        {
+            putchar(c);
+            continue;
+        }
+
+        if (fread(header, 1, 3, in) != 3)
+        {
+            break;
+        }
+        if (header[2] > LOG_MAX_ARGS)
+        {
+            printf("<bad log record>\n");
+            continue;
+        }
+        for (i = 0; i < header[2]; i++)
+        {
+            uint8_t word[4];
+            if (fread(word, 1, 4, in) != 4)
+            {
+                return 0;
+            }
+            args[i] = word[0] | (word[1] << 8) | (word[2] << 16) | ((uint32_t)word[3] << 24);
+        }
+        printRecord((uint16_t)(header[0] | (header[1] << 8)), args, header[2]);
+        fflush(stdout);
+    }
+
+    return 0;
+}
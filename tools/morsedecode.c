@@ -0,0 +1,470 @@
+/*
+ *  ======== morsedecode.c ========
+ *
+ *  Runs the gpiointerrupt Morse receiver (decoder.c) on the host, on key
+ *  timings recorded from a board or generated here, so its thresholds
+ *  can be checked and tuned without pressing a button.
+ *
+ *  A trace is a text file with one key edge per line, "time_ms level",
+ *  where level 1 is pressed; a comma may separate the two, and lines
+ *  starting with # are skipped. That covers a logic analyser export of
+ *  the button pin (invert the level, the button pulls it low) as well as
+ *  the traces written with -o.
+ *
+ *  Generated traces come from the firmware's own encoder (morse.c) at a
+ *  given speed, optionally changing speed from start to end of the text,
+ *  with random timing error on every element and gap and optional switch
+ *  bounce on every edge. The decoded text is compared with what was sent.
+ *
+ *  -t runs a fixed set of generated cases and fails if any of them is not
+ *  decoded exactly once the receiver has had the first word to settle.
+ *
+ *  Build:  cc -O2 -I gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc -o morsedecode tools/morsedecode.c \
+ *              gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc/decoder.c \
+ *              gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc/morse.c
+ *  Usage:  morsedecode [-d dot_ms] trace
+ *          morsedecode [-d dot_ms] -s text [-w wpm[:wpm]] [-j percent] [-b] [-r seed] [-o trace]
+ *          morsedecode -t
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "decoder.h"
+#include "morse.h"
+
+#define MAX_EDGES 20000
+#define MAX_TEXT  1024
+
+/* How often the firmware's main loop gets to poll at the most, ms */
+#define POLL_MS   250
+
+typedef struct {
+    uint32_t time;
+    int pressed;
+} Edge;
+
+static Edge edges[MAX_EDGES];
+
+typedef struct {
+    int startWpm;
+    int endWpm;
+    int jitter;                 /* percent */
+    int bounce;
+    unsigned long seed;
+} Sender;
+
+/*
+ *  ======== nextRandom ========
+ *  Small LCG, so runs are repeatable on any host.
+ */
+static unsigned long nextRandom(unsigned long *seed)
+{
+    *seed = (*seed * 1103515245UL + 12345UL) & 0x7FFFFFFFUL;
+    return *seed >> 8;
+}
+
+/*
+ *  ======== addEdge ========
+ */
+static int addEdge(int count, uint32_t time, int pressed)
+{
+    if (count < MAX_EDGES)
+    {
+        edges[count].time = time;
+        edges[count].pressed = pressed;
+        count++;
+    }
+    return count;
+}
+
+/*
+ *  ======== generate ========
+ *  Key edges for text as sender would key it. Returns the edge count.
+ */
+static int generate(const char *text, Sender *sender)
+{
+    uint8_t runs[MORSE_CHAR_RUNS];
+    int totalUnits = 0;
+    int doneUnits = 0;
+    double time = 1000.0;
+    int count = 0;
+    const char *p;
+
+    /* Total length first, so the speed can change evenly across it */
+    for (p = text; *p != '\0'; p++)
+    {
+        unsigned int n = morse_encodeChar(*p, runs);
+        unsigned int i;
+
+        for (i = 0; i < n; i++)
+        {
+            totalUnits += MORSE_RUN_UNITS(runs[i]);
+        }
+    }
+
+    for (p = text; *p != '\0'; p++)
+    {
+        unsigned int n = morse_encodeChar(*p, runs);
+        unsigned int i;
+
+        for (i = 0; i < n; i++)
+        {
+            int units = MORSE_RUN_UNITS(runs[i]);
+            double wpm = sender->startWpm + (double)(sender->endWpm - sender->startWpm)
+                         * doneUnits / (totalUnits > 0 ? totalUnits : 1);
+            double error = 1.0 + sender->jitter
+                           * ((double)(nextRandom(&sender->seed) % 2001) - 1000.0) / 100000.0;
+
+            if (MORSE_RUN_STATE(runs[i]) != OFF)
+            {
+                count = addEdge(count, (uint32_t)time, 1);
+                if (sender->bounce)
+                {
+                    count = addEdge(count, (uint32_t)time + 2, 0);
+                    count = addEdge(count, (uint32_t)time + 4, 1);
+                }
+            }
+            else if (count > 0 && edges[count - 1].pressed)
+            {
+                count = addEdge(count, (uint32_t)time, 0);
+                if (sender->bounce)
+                {
+                    count = addEdge(count, (uint32_t)time + 3, 1);
+                    count = addEdge(count, (uint32_t)time + 5, 0);
+                }
+            }
+            time += units * 1200.0 / wpm * error;
+            doneUnits += units;
+        }
+    }
+    return count;
+}
+
+/*
+ *  ======== readTrace ========
+ */
+static int readTrace(const char *name)
+{
+    FILE *f = fopen(name, "r");
+    char line[128];
+    int count = 0;
+
+    if (f == NULL)
+    {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        char *p;
+        unsigned long time;
+        int level;
+
+        if (line[0] == '#')
+        {
+            continue;
+        }
+        for (p = line; *p != '\0'; p++)
+        {
+            if (*p == ',')
+            {
+                *p = ' ';
+            }
+        }
+        if (sscanf(line, "%lu %d", &time, &level) == 2)
+        {
+            count = addEdge(count, (uint32_t)time, level != 0);
+        }
+    }
+    fclose(f);
+    return count;
+}
+
+/*
+ *  ======== decode ========
+ *  Feeds the edges to the receiver, polling in between the way the main
+ *  loop does, and returns the final speed.
+ */
+static unsigned int decode(int count, uint16_t dotMs, char *text, size_t size)
+{
+    Decoder d;
+    char out[DECODER_MAX_OUT];
+    size_t length = 0;
+    uint32_t time = (count > 0) ? edges[0].time - 1000 : 0;
+    int i;
+
+    decoder_init(&d, time, dotMs);
+    for (i = 0; i <= count; i++)
+    {
+        uint32_t next = (i < count) ? edges[i].time : time + 60000;
+        unsigned int n, k;
+
+        while (time + POLL_MS < next)
+        {
+            time += POLL_MS;
+            n = decoder_poll(&d, time, out);
+            for (k = 0; k < n && length + 1 < size; k++)
+            {
+                text[length++] = out[k];
+            }
+        }
+        if (i < count)
+        {
+            time = next;
+            n = decoder_edge(&d, time, edges[i].pressed, out);
+            for (k = 0; k < n && length + 1 < size; k++)
+            {
+                text[length++] = out[k];
+            }
+        }
+    }
+    text[length] = '\0';
+    return decoder_wpm(&d);
+}
+
+/*
+ *  ======== expected ========
+ *  What the receiver should give for text: upper case, single spaces,
+ *  characters with no code left out, ending in '\n'.
+ */
+static void expected(const char *text, char *out)
+{
+    uint8_t runs[MORSE_CHAR_RUNS];
+    char *start = out;
+
+    for (; *text != '\0'; text++)
+    {
+        char c = (*text >= 'a' && *text <= 'z') ? (char)(*text - ('a' - 'A')) : *text;
+
+        if (c == ' ')
+        {
+            if (out > start && out[-1] != ' ')
+            {
+                *out++ = ' ';
+            }
+        }
+        else if (morse_encodeChar(c, runs) != 0)
+        {
+            *out++ = c;
+        }
+    }
+    if (out > start && out[-1] == ' ')
+    {
+        out--;
+    }
+    *out++ = '\n';
+    *out = '\0';
+}
+
+/*
+ *  ======== distance ========
+ *  Edit distance, counting wrong, missing and extra characters.
+ */
+static int distance(const char *a, const char *b)
+{
+    static int row[MAX_TEXT + 1];
+    size_t lengthB = strlen(b);
+    size_t i, j;
+
+    if (lengthB > MAX_TEXT)
+    {
+        lengthB = MAX_TEXT;
+    }
+    for (j = 0; j <= lengthB; j++)
+    {
+        row[j] = (int)j;
+    }
+    for (i = 1; a[i - 1] != '\0'; i++)
+    {
+        int diagonal = row[0];
+
+        row[0] = (int)i;
+        for (j = 1; j <= lengthB; j++)
+        {
+            int best = diagonal + (a[i - 1] != b[j - 1]);
+            int above = row[j];
+
+            if (row[j] + 1 < best)
+            {
+                best = row[j] + 1;
+            }
+            if (row[j - 1] + 1 < best)
+            {
+                best = row[j - 1] + 1;
+            }
+            diagonal = above;
+            row[j] = best;
+        }
+    }
+    return row[lengthB];
+}
+
+/*
+ *  ======== settledErrors ========
+ *  Errors in what was received for everything after the first word sent,
+ *  taking the same number of characters from the end of received.
+ */
+static int settledErrors(const char *sent, const char *received)
+{
+    const char *space = strchr(sent, ' ');
+    size_t length;
+
+    sent = (space != NULL) ? space + 1 : sent;
+    length = strlen(sent);
+    if (strlen(received) > length)
+    {
+        received += strlen(received) - length;
+    }
+    return distance(sent, received);
+}
+
+/*
+ *  ======== selfTest ========
+ */
+static int selfTest(void)
+{
+    static const char *text = "The quick brown fox jumps over the lazy dog 0123456789 ?/=+";
+    static const Sender cases[] = {
+        { 12, 12,  0, 0, 1 }, {  5,  5,  0, 0, 1 }, { 40, 40,  0, 0, 1 },
+        {  8,  8, 10, 0, 2 }, { 20, 20, 10, 0, 3 }, { 30, 30, 10, 0, 4 },
+        { 12, 12, 20, 0, 5 }, { 25, 25, 20, 0, 6 }, { 15, 15, 10, 1, 7 },
+        {  8, 25, 10, 0, 8 }, { 25,  8, 10, 0, 9 }, {  5, 35, 10, 1, 10 },
+    };
+    char want[MAX_TEXT];
+    char got[MAX_TEXT];
+    int failed = 0;
+    size_t i;
+
+    expected(text, want);
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        Sender sender = cases[i];
+        unsigned int wpm = decode(generate(text, &sender), DECODER_DEFAULT_DOT_MS,
+                                  got, sizeof(got));
+        int errors = distance(want, got);
+        int late = settledErrors(want, got);
+
+        printf("%2d-%2d wpm  %2d%% jitter  %-6s  %2u wpm tracked  %d errors, %d after the first word\n",
+               cases[i].startWpm, cases[i].endWpm, cases[i].jitter,
+               cases[i].bounce ? "bounce" : "", wpm, errors, late);
+        if (late != 0)
+        {
+            printf("    sent:     %s    received: %s", want, got);
+            failed = 1;
+        }
+    }
+    printf(failed ? "FAILED\n" : "ok\n");
+    return failed;
+}
+
+int main(int argc, char *argv[])
+{
+    Sender sender = { 12, 12, 0, 0, 1 };
+    const char *text = NULL;
+    const char *traceOut = NULL;
+    const char *traceIn = NULL;
+    uint16_t dotMs = DECODER_DEFAULT_DOT_MS;
+    char want[MAX_TEXT];
+    char got[MAX_TEXT];
+    unsigned int wpm;
+    int count;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-t") == 0)
+        {
+            return selfTest();
+        }
+        else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc)
+        {
+            dotMs = (uint16_t)atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            text = argv[++i];
+        }
+        else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+        {
+            char *colon;
+
+            sender.startWpm = atoi(argv[++i]);
+            colon = strchr(argv[i], ':');
+            sender.endWpm = (colon != NULL) ? atoi(colon + 1) : sender.startWpm;
+        }
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            sender.jitter = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-b") == 0)
+        {
+            sender.bounce = 1;
+        }
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+        {
+            sender.seed = strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            traceOut = argv[++i];
+        }
+        else if (traceIn == NULL && argv[i][0] != '-')
+        {
+            traceIn = argv[i];
+        }
+        else
+        {
+            traceIn = NULL;
+            text = NULL;
+            break;
+        }
+    }
+    if ((text == NULL) == (traceIn == NULL) || dotMs == 0 || sender.startWpm <= 0
+        || sender.endWpm <= 0 || strlen(text != NULL ? text : "") >= MAX_TEXT / 2)
+    {
+        fprintf(stderr, "usage: %s [-d dot_ms] trace\n"
+                        "       %s [-d dot_ms] -s text [-w wpm[:wpm]] [-j percent] [-b]"
+                        " [-r seed] [-o trace]\n"
+                        "       %s -t\n", argv[0], argv[0], argv[0]);
+        return 2;
+    }
+
+    if (traceIn != NULL)
+    {
+        count = readTrace(traceIn);
+        if (count < 0)
+        {
+            fprintf(stderr, "morsedecode: cannot read %s\n", traceIn);
+            return 1;
+        }
+        wpm = decode(count, dotMs, got, sizeof(got));
+        printf("%s(%u edges, %u wpm at the end)\n", got, count, wpm);
+        return 0;
+    }
+
+    count = generate(text, &sender);
+    if (traceOut != NULL)
+    {
+        FILE *f = fopen(traceOut, "w");
+
+        if (f == NULL)
+        {
+            fprintf(stderr, "morsedecode: cannot write %s\n", traceOut);
+            return 1;
+        }
+        fprintf(f, "# \"%s\" at %d-%d wpm, %d%% jitter%s\n", text, sender.startWpm,
+                sender.endWpm, sender.jitter, sender.bounce ? ", bounce" : "");
+        for (i = 0; i < count; i++)
+        {
+            fprintf(f, "%lu %d\n", (unsigned long)edges[i].time, edges[i].pressed);
+        }
+        fclose(f);
+    }
+    wpm = decode(count, dotMs, got, sizeof(got));
+    expected(text, want);
+    printf("sent:     %sreceived: %s%d errors, %u wpm at the end\n", want, got,
+           distance(want, got), wpm);
+    return strcmp(want, got) != 0;
+}
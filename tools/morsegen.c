@@ -0,0 +1,353 @@
+/*
+ *  ======== morsegen.c ========
+ *
+ *  Generates the gpiointerrupt Morse run tables (morse_table.h) from the
+ *  messages in messages.def. The run format and timing are described in
+ *  morse.h.
+ *
+ *  Before writing anything the generator encodes every character of the
+ *  code table on its own and decodes the result again, then does the
+ *  same for each message, and refuses to produce a table if any of them
+ *  does not come back unchanged. It also checks that the firmware's
+ *  run-time encoder (morse_encodeChar() in morse.c) sends every character
+ *  with the same timing as this table, and nothing for the rest of ASCII.
+ *
+ *  Build:  cc -I gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc -o morsegen tools/morsegen.c \
+ *              gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc/morse.c
+ *  Usage:  ./morsegen > gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc/morse_table.h
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "morse.h"
+
+#define MAX_RUNS 1024
+
+static const struct {
+    const char *name;
+    const char *text;
+} messages[] = {
+#define MESSAGE(name, text) { #name, text },
+#include "messages.def"
+#undef MESSAGE
+};
+#define NUM_MESSAGES (int)(sizeof(messages) / sizeof(messages[0]))
+
+/* ITU-R M.1677-1 */
+static const struct {
+    char c;
+    const char *code;
+} codes[] = {
+    { 'A', ".-" },     { 'B', "-..." },   { 'C', "-.-." },   { 'D', "-.." },
+    { 'E', "." },      { 'F', "..-." },   { 'G', "--." },    { 'H', "...." },
+    { 'I', ".." },     { 'J', ".---" },   { 'K', "-.-" },    { 'L', ".-.." },
+    { 'M', "--" },     { 'N', "-." },     { 'O', "---" },    { 'P', ".--." },
+    { 'Q', "--.-" },   { 'R', ".-." },    { 'S', "..." },    { 'T', "-" },
+    { 'U', "..-" },    { 'V', "...-" },   { 'W', ".--" },    { 'X', "-..-" },
+    { 'Y', "-.--" },   { 'Z', "--.." },
+    { '0', "-----" },  { '1', ".----" },  { '2', "..---" },  { '3', "...--" },
+    { '4', "....-" },  { '5', "....." },  { '6', "-...." },  { '7', "--..." },
+    { '8', "---.." },  { '9', "----." },
+    { '.', ".-.-.-" }, { ',', "--..--" }, { '?', "..--.." }, { '\'', ".----." },
+    { '!', "-.-.--" }, { '/', "-..-." },  { '(', "-.--." },  { ')', "-.--.-" },
+    { '&', ".-..." },  { ':', "---..." }, { ';', "-.-.-." }, { '=', "-...-" },
+    { '+', ".-.-." },  { '-', "-....-" }, { '_', "..--.-" }, { '"', ".-..-." },
+    { '@', ".--.-." },
+};
+#define NUM_CODES (int)(sizeof(codes) / sizeof(codes[0]))
+
+/*
+ *  ======== lookup ========
+ */
+static const char *lookup(char c)
+{
+    int i;
+
+    if (c >= 'a' && c <= 'z')
+    {
+        c -= 'a' - 'A';
+    }
+    for (i = 0; i < NUM_CODES; i++)
+    {
+        if (codes[i].c == c)
+        {
+            return codes[i].code;
+        }
+    }
+    return NULL;
+}
+
+/*
+ *  ======== encode ========
+ *  Returns the number of runs, or -1 for a character with no code.
+ */
+static int encode(const char *text, uint8_t *runs)
+{
+    int count = 0;
+    int gap = 0;                /* gap owed before the next letter */
+
+    for (; *text != '\0'; text++)
+    {
+        const char *code;
+        int j;
+
+        if (*text == ' ')
+        {
+            gap = (count > 0) ? MORSE_WORD_GAP : 0;
+            continue;
+        }
+        code = lookup(*text);
+        if (code == NULL || count + 2 * (int)strlen(code) + 1 > MAX_RUNS)
+        {
+            return -1;
+        }
+        if (gap > 0)
+        {
+            runs[count++] = MORSE_RUN(OFF, gap);
+        }
+        for (j = 0; code[j] != '\0'; j++)
+        {
+            if (j > 0)
+            {
+                runs[count++] = MORSE_RUN(OFF, MORSE_ELEMENT_GAP);
+            }
+            runs[count++] = (code[j] == '.') ? MORSE_RUN(DOT, MORSE_DOT_UNITS)
+                                             : MORSE_RUN(DASH, MORSE_DASH_UNITS);
+        }
+        gap = MORSE_LETTER_GAP;
+    }
+    runs[count++] = MORSE_RUN(OFF, MORSE_WORD_GAP);
+    return count;
+}
+
+/*
+ *  ======== decode ========
+ *  Turns runs back into text; "#" for anything that is not valid.
+ */
+static void decode(const uint8_t *runs, int count, char *text)
+{
+    char code[16];
+    int length = 0;
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        int units = MORSE_RUN_UNITS(runs[i]);
+        int k;
+
+        switch (MORSE_RUN_STATE(runs[i]))
+        {
+            case DOT:
+            case DASH:
+                if (length + 1 == (int)sizeof(code)
+                    || units != (MORSE_RUN_STATE(runs[i]) == DOT ? MORSE_DOT_UNITS
+                                                                  : MORSE_DASH_UNITS))
+                {
+                    *text++ = '#';
+                    length = 0;
+                    break;
+                }
+                code[length++] = (MORSE_RUN_STATE(runs[i]) == DOT) ? '.' : '-';
+                break;
+
+            case OFF:
+                if (units == MORSE_ELEMENT_GAP)
+                {
+                    break;
+                }
+                code[length] = '\0';
+                for (k = 0; k < NUM_CODES && strcmp(codes[k].code, code) != 0; k++)
+                {
+                }
+                *text++ = (k < NUM_CODES) ? codes[k].c : '#';
+                length = 0;
+                if (units == MORSE_WORD_GAP && i + 1 < count)
+                {
+                    *text++ = ' ';
+                }
+                else if (units != MORSE_LETTER_GAP && units != MORSE_WORD_GAP)
+                {
+                    *text++ = '#';
+                }
+                break;
+
+            default:
+                *text++ = '#';
+                break;
+        }
+    }
+    *text = '\0';
+}
+
+/*
+ *  ======== normalize ========
+ *  Upper case, single spaces, none leading or trailing.
+ */
+static void normalize(const char *in, char *out)
+{
+    char *start = out;
+
+    for (; *in != '\0'; in++)
+    {
+        if (*in == ' ' && (out == start || out[-1] == ' '))
+        {
+            continue;
+        }
+        *out++ = (*in >= 'a' && *in <= 'z') ? (char)(*in - ('a' - 'A')) : *in;
+    }
+    if (out > start && out[-1] == ' ')
+    {
+        out--;
+    }
+    *out = '\0';
+}
+
+/*
+ *  ======== check ========
+ */
+static int check(const char *text)
+{
+    static uint8_t runs[MAX_RUNS];
+    static char expected[MAX_RUNS];
+    static char decoded[MAX_RUNS];
+    int count = encode(text, runs);
+
+    if (count < 0)
+    {
+        fprintf(stderr, "morsegen: \"%s\" has a character with no Morse code\n", text);
+        return 0;
+    }
+    normalize(text, expected);
+    decode(runs, count, decoded);
+    if (strcmp(expected, decoded) != 0)
+    {
+        fprintf(stderr, "morsegen: \"%s\" decodes as \"%s\"\n", expected, decoded);
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ *  ======== expand ========
+ *  One state per unit, so run lists that split gaps differently compare
+ *  equal when they light the LEDs the same way.
+ */
+static int expand(const uint8_t *runs, int count, char *units)
+{
+    int n = 0;
+    int i, k;
+
+    for (i = 0; i < count; i++)
+    {
+        for (k = 0; k < MORSE_RUN_UNITS(runs[i]); k++)
+        {
+            units[n++] = (char)MORSE_RUN_STATE(runs[i]);
+        }
+    }
+    return n;
+}
+
+/*
+ *  ======== checkRuntime ========
+ *  morse_encodeChar(c) followed by a space must give what encode() gives
+ *  for c on its own.
+ */
+static int checkRuntime(char c)
+{
+    static char expected[MAX_RUNS * MORSE_MAX_UNITS];
+    static char actual[MAX_RUNS * MORSE_MAX_UNITS];
+    uint8_t reference[MAX_RUNS];
+    uint8_t runs[MORSE_CHAR_RUNS + 1];
+    char one[2] = { 0, 0 };
+    int count = (int)morse_encodeChar(c, runs);
+    int expectedUnits, actualUnits;
+
+    one[0] = c;
+    if (lookup(c) == NULL || c == ' ')
+    {
+        if (count != 0 && c != ' ')
+        {
+            fprintf(stderr, "morsegen: morse.c has a code for 0x%02X\n", (unsigned char)c);
+            return 0;
+        }
+        return 1;
+    }
+    if (count == 0 || count > MORSE_CHAR_RUNS)
+    {
+        fprintf(stderr, "morsegen: morse.c gives %d runs for '%c'\n", count, c);
+        return 0;
+    }
+    count += (int)morse_encodeChar(' ', runs + count);
+    expectedUnits = expand(reference, encode(one, reference), expected);
+    actualUnits = expand(runs, count, actual);
+    if (expectedUnits != actualUnits || memcmp(expected, actual, (size_t)actualUnits) != 0)
+    {
+        fprintf(stderr, "morsegen: morse.c sends '%c' differently\n", c);
+        return 0;
+    }
+    return 1;
+}
+
+int main(void)
+{
+    static const char *stateNames[] = { "DOT", "DASH", "OFF" };
+    static uint8_t runs[MAX_RUNS];
+    char one[2] = { 0, 0 };
+    int ok = 1;
+    int m, i;
+
+    // Every character, then every message, must survive the round trip,
+    // and the firmware's encoder must agree with ours.
+    for (i = 0; i < NUM_CODES; i++)
+    {
+        one[0] = codes[i].c;
+        ok &= check(one);
+    }
+    for (m = 0; m < NUM_MESSAGES; m++)
+    {
+        ok &= check(messages[m].text);
+    }
+    for (i = 1; i < 128; i++)
+    {
+        ok &= checkRuntime((char)i);
+    }
+    if (!ok)
+    {
+        return 1;
+    }
+
+    printf("/*\n"
+           " *  ======== morse_table.h ========\n"
+           " *\n"
+           " *  DO NOT EDIT - generated by tools/morsegen.c from messages.def.\n"
+           " *  Run format and timing: see morse.h.\n"
+           " */\n\n"
+           "#ifndef MORSE_TABLE_H_\n"
+           "#define MORSE_TABLE_H_\n\n"
+           "#include \"morse.h\"\n");
+
+    for (m = 0; m < NUM_MESSAGES; m++)
+    {
+        int count = encode(messages[m].text, runs);
+        int units = 0;
+
+        for (i = 0; i < count; i++)
+        {
+            units += MORSE_RUN_UNITS(runs[i]);
+        }
+        printf("\n/* \"%s\": %d runs, %d units */\n"
+               "static const uint8_t morse%s[%d] = {",
+               messages[m].text, count, units, messages[m].name, count);
+        for (i = 0; i < count; i++)
+        {
+            printf("%sMORSE_RUN(%s, %d),", (i % 6 == 0) ? "\n    " : " ",
+                   stateNames[MORSE_RUN_STATE(runs[i])], MORSE_RUN_UNITS(runs[i]));
+        }
+        printf("\n};\n");
+    }
+
+    printf("\n#endif /* MORSE_TABLE_H_ */\n");
+    return 0;
+}
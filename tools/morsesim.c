@@ -0,0 +1,380 @@
+/*
+ *  ======== morsesim.c ========
+ *
+ *  Runs the gpiointerrupt firmware itself (gpiointerrupt.c with the
+ *  sequencer, encoder and decoder) on the host, on a simulated clock, and
+ *  checks what it does to the LEDs and the UART (see
+ *  tools/gpiointerrupt_host/sim.h):
+ *
+ *      text        "hi there" sent on the UART plays once the current SOS
+ *                  is done, timed unit for unit like morse_encodeChar()
+ *                  runs, then SOS carries on; the line is reported as
+ *                  TEXT with its ticks
+ *      unended     "hi" with no CR or LF plays, the timer holds for
+ *                  HOLD_TIMEOUT_UNITS with nothing more coming, the line is
+ *                  ended with a word gap and reported as TEXT, and SOS
+ *                  comes back
+ *      timeline    three SOS messages match the old fixed 500 ms tick unit
+ *                  for unit, every LED change lands on a unit boundary, and
+ *                  each message after the first takes 18 timer interrupts,
+ *                  one per change, against 34 ticks
+ *      flash       SW2 during SOS flashes all three LEDs on, off and on in
+ *                  80 ms steps over the Morse and gives them back; SOS
+ *                  still reports 18 interrupts, and OK follows
+ *      letters     an "E" keyed on SW3 fades the yellow LED out in 300 ms
+ *                  and is written as "RX E (12 WPM)"; SOS still reports
+ *                  18 interrupts
+ *
+ *  The LEDs are checked in the middle of every 500 ms unit. Each check
+ *  runs in a child process, as the firmware keeps its state in statics.
+ *
+ *  Build:  cc -O2 -I tools/gpiointerrupt_host -I gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc \
+ *              -o morsesim tools/morsesim.c tools/gpiointerrupt_host/sim.c \
+ *              gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc/gpiointerrupt.c \
+ *              gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc/sequencer.c \
+ *              gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc/morse.c \
+ *              gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc/decoder.c
+ *  Usage:  morsesim [-v]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ti_drivers_config.h"
+#include "morse_table.h"
+#include "sim.h"
+
+#define UNIT_MS     500
+#define HOLD_TIMEOUT_UNITS 20       /* as in gpiointerrupt.c */
+#define MAX_UNITS   1024
+
+static int verbose = 0;
+
+/* The LED state expected in each unit */
+static enum CodeStates expected[MAX_UNITS];
+static unsigned int expectedUnits = 0;
+
+/*
+ *  ======== expectRuns ========
+ */
+static void expectRuns(const uint8_t *runs, unsigned int count)
+{
+    unsigned int i, u;
+
+    for (i = 0; i < count; i++)
+    {
+        for (u = 0; u < MORSE_RUN_UNITS(runs[i]) && expectedUnits < MAX_UNITS; u++)
+        {
+            expected[expectedUnits++] = MORSE_RUN_STATE(runs[i]);
+        }
+    }
+}
+
+/*
+ *  ======== expectText ========
+ *  A line as streamText() sends it: the characters, then the word gap
+ *  that ends the line. Returns its units.
+ */
+static unsigned int expectText(const char *text)
+{
+    unsigned int start = expectedUnits;
+    uint8_t runs[MORSE_CHAR_RUNS];
+
+    for (; *text != '\0'; text++)
+    {
+        expectRuns(runs, morse_encodeChar(*text, runs));
+    }
+    expectRuns(runs, morse_encodeChar(' ', runs));
+    return expectedUnits - start;
+}
+
+/*
+ *  ======== checkTimeline ========
+ *  Red on for a dot, green for a dash, both off otherwise, in the middle
+ *  of each expected unit from startMs, skipping units that overlap
+ *  [skipFromMs, skipToMs). Returns the number of units that differ.
+ */
+static unsigned int checkTimeline(uint32_t startMs, uint32_t skipFromMs, uint32_t skipToMs)
+{
+    unsigned int failed = 0;
+    unsigned int u;
+
+    for (u = 0; u < expectedUnits; u++)
+    {
+        uint32_t ms = startMs + u * UNIT_MS;
+        uint64_t count = ((uint64_t)ms * SIM_COUNTS_PER_MS) + (UNIT_MS / 2) * SIM_COUNTS_PER_MS;
+        unsigned int red = sim_levelAt(CONFIG_GPIO_LED_0, count);
+        unsigned int green = sim_levelAt(CONFIG_GPIO_LED_1, count);
+
+        if (ms + UNIT_MS > skipFromMs && ms < skipToMs)
+        {
+            continue;
+        }
+        if (red != (expected[u] == DOT) || green != (expected[u] == DASH))
+        {
+            if (failed++ == 0 || verbose)
+            {
+                printf("  unit %u (%u ms): red %u green %u, expected %s\n", u, (unsigned int)ms,
+                       red, green, (expected[u] == DOT) ? "dot" : (expected[u] == DASH) ? "dash" : "off");
+            }
+        }
+    }
+    return failed;
+}
+
+/*
+ *  ======== checkReport ========
+ *  The next report line on the UART, from *offset, is for name and gives
+ *  units ticks. Returns its interrupt count, or -1 if it is not.
+ */
+static int checkReport(size_t *offset, const char *name, unsigned int units)
+{
+    const char *line = sim_uartOutput() + *offset;
+    char format[32];
+    unsigned int interrupts, ticks;
+    int length = 0;
+
+    snprintf(format, sizeof(format), "%s %%u interrupts, %%u ticks%%n", name);
+    if (sscanf(line, format, &interrupts, &ticks, &length) != 2 || length == 0
+        || strncmp(line + length, "\r\n", 2) != 0 || ticks != units)
+    {
+        printf("  UART: \"%.40s\", expected %s with %u ticks\n", line, name, units);
+        return -1;
+    }
+    *offset += (size_t)length + 2;
+    return (int)interrupts;
+}
+
+/*
+ *  ======== testText ========
+ */
+static int testText(void)
+{
+    static const char text[] = "hi there";
+    unsigned int textUnits;
+    size_t offset = 0;
+
+    sim_sendText(100, "hi there\r");
+    expectRuns(morseSOS, sizeof(morseSOS));
+    textUnits = expectText(text);
+    expectRuns(morseSOS, sizeof(morseSOS));
+    sim_run(expectedUnits * UNIT_MS - 1);
+
+    return checkTimeline(0, 0, 0) == 0
+           && checkReport(&offset, "SOS", 34) >= 0
+           && checkReport(&offset, "TEXT", textUnits) >= 0
+           && sim_uartOutput()[offset] == '\0';
+}
+
+/*
+ *  ======== testUnended ========
+ */
+static int testUnended(void)
+{
+    uint8_t runs[MORSE_CHAR_RUNS];
+    unsigned int textUnits;
+    size_t offset = 0;
+
+    sim_sendText(100, "hi");
+    expectRuns(morseSOS, sizeof(morseSOS));
+    textUnits = expectedUnits;
+    expectRuns(runs, morse_encodeChar('h', runs));
+    expectRuns(runs, morse_encodeChar('i', runs));
+    runs[0] = MORSE_RUN(OFF, HOLD_TIMEOUT_UNITS);
+    expectRuns(runs, 1);
+    expectRuns(runs, morse_encodeChar(' ', runs));
+    textUnits = expectedUnits - textUnits;
+    expectRuns(morseSOS, sizeof(morseSOS));
+    sim_run(expectedUnits * UNIT_MS - 1);
+
+    return checkTimeline(0, 0, 0) == 0
+           && checkReport(&offset, "SOS", 34) >= 0
+           && checkReport(&offset, "TEXT", textUnits) >= 0
+           && sim_uartOutput()[offset] == '\0';
+}
+
+/*
+ *  ======== testTimeline ========
+ *  The first message is started from mainThread, so it takes one timer
+ *  interrupt less.
+ */
+static int testTimeline(void)
+{
+    const SimWrite *writes;
+    size_t count, i;
+    unsigned int m, offBoundary = 0;
+    int ok = 1;
+
+    for (m = 0; m < 3; m++)
+    {
+        expectRuns(morseSOS, sizeof(morseSOS));
+    }
+    sim_run(expectedUnits * UNIT_MS - 1);
+
+    count = sim_writes(&writes);
+    for (i = 0; i < count; i++)
+    {
+        offBoundary += (writes[i].count % ((uint64_t)UNIT_MS * SIM_COUNTS_PER_MS) != 0);
+    }
+    if (offBoundary != 0)
+    {
+        printf("  %u of %zu LED writes off a unit boundary\n", offBoundary, count);
+        ok = 0;
+    }
+
+    for (m = 1; m < 3; m++)
+    {
+        unsigned int interrupts = sim_interrupts(m * 34 * UNIT_MS, (m + 1) * 34 * UNIT_MS);
+
+        if (interrupts != 18)
+        {
+            printf("  message %u: %u interrupts\n", m + 1, interrupts);
+            ok = 0;
+        }
+    }
+    return checkTimeline(0, 0, 0) == 0 && ok;
+}
+
+/*
+ *  ======== checkLeds ========
+ *  Red, green and the yellow PWM level at ms.
+ */
+static int checkLeds(uint32_t ms, unsigned int red, unsigned int green, unsigned int yellow)
+{
+    uint64_t count = (uint64_t)ms * SIM_COUNTS_PER_MS;
+    unsigned int r = sim_levelAt(CONFIG_GPIO_LED_0, count);
+    unsigned int g = sim_levelAt(CONFIG_GPIO_LED_1, count);
+    unsigned int y = sim_levelAt(SIM_PWM, count);
+
+    if (r != red || g != green || y != yellow)
+    {
+        printf("  %u ms: red %u green %u yellow %u, expected %u %u %u\n",
+               (unsigned int)ms, r, g, y, red, green, yellow);
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ *  ======== testFlash ========
+ *  2250 ms is in the middle of the third dot; the flash ends before it
+ *  does.
+ */
+static int testFlash(void)
+{
+    size_t offset = 0;
+    int ok = 1;
+
+    sim_pressButton(2250, CONFIG_GPIO_BUTTON_0);
+    expectRuns(morseSOS, sizeof(morseSOS));
+    expectRuns(morseOK, sizeof(morseOK));
+    sim_run(expectedUnits * UNIT_MS + 1);
+
+    ok &= checkLeds(2290, 1, 1, 255);
+    ok &= checkLeds(2370, 0, 0, 0);
+    ok &= checkLeds(2450, 1, 1, 255);
+    ok &= checkLeds(2490, 1, 0, 0);
+    return ok && checkTimeline(0, 2250, 2490) == 0
+           && checkReport(&offset, "SOS", 34) == 18
+           && checkReport(&offset, "OK", 30) == 12;
+}
+
+/*
+ *  ======== testLetters ========
+ *  An E (one 100 ms dot, the decoder's starting speed) keyed during the
+ *  first S. The main loop decodes it when it next wakes, at the end of
+ *  the second dot at 1500 ms.
+ */
+static int testLetters(void)
+{
+    const SimWrite *writes;
+    size_t count, i, offset;
+    unsigned int steps = 0, last = 256;
+    uint64_t start = 0, end = 0;
+    int ok = 1;
+
+    sim_setKey(1000, 1);
+    sim_setKey(1100, 0);
+    expectRuns(morseSOS, sizeof(morseSOS));
+    sim_run(expectedUnits * UNIT_MS + 1);
+
+    count = sim_writes(&writes);
+    for (i = 0; i < count; i++)
+    {
+        if (writes[i].index != SIM_PWM || writes[i].count == 0)
+        {
+            continue;
+        }
+        if (steps == 0)
+        {
+            start = writes[i].count;
+        }
+        if (writes[i].level >= last)
+        {
+            ok = 0;
+        }
+        last = writes[i].level;
+        end = writes[i].count;
+        steps++;
+    }
+    if (!ok || steps < 2 || start != 1500ull * SIM_COUNTS_PER_MS || last != 0
+        || end - start != 300ull * SIM_COUNTS_PER_MS)
+    {
+        printf("  yellow: %u writes from %.1f to %.1f ms, ending at %u\n", steps,
+               (double)start / SIM_COUNTS_PER_MS, (double)end / SIM_COUNTS_PER_MS, last);
+        ok = 0;
+    }
+
+    offset = strlen("RX E (12 WPM)\r\n");
+    if (strncmp(sim_uartOutput(), "RX E (12 WPM)\r\n", offset) != 0)
+    {
+        printf("  UART: \"%.20s\"\n", sim_uartOutput());
+        ok = 0;
+    }
+    return ok && checkTimeline(0, 0, 0) == 0 && checkReport(&offset, "SOS", 34) == 18;
+}
+
+/*
+ *  ======== run ========
+ *  Runs test in a child of its own.
+ */
+static int run(const char *name, const char *description, int (*test)(void))
+{
+    int status;
+    pid_t child;
+
+    fflush(stdout);
+    child = fork();
+    if (child < 0)
+    {
+        perror("morsesim: fork");
+        exit(2);
+    }
+    if (child == 0)
+    {
+        exit(test() ? 0 : 1);
+    }
+    waitpid(child, &status, 0);
+
+    status = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    printf("%-10s %-40s %s\n", name, description, status ? "ok" : "FAILED");
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    int ok = 1;
+
+    verbose = (argc > 1 && strcmp(argv[1], "-v") == 0);
+
+    ok &= run("text", "\"hi there\" after SOS", testText);
+    ok &= run("unended", "\"hi\" with no line end", testUnended);
+    ok &= run("timeline", "SOS x3 against the fixed tick", testTimeline);
+    ok &= run("flash", "SW2 at 2250 ms", testFlash);
+    ok &= run("letters", "\"E\" keyed on SW3", testLetters);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,272 @@
+/*
+ *  ======== muxdemux.c ========
+ *
+ *  Splits the thermostat's multiplexed UART stream (see mux.h in the
+ *  thermostat project) back into its channels:
+ *
+ *      0  telemetry   <AA,BB,S,CCCC> and [MIN,MAX,MEAN,BB,H,CCCC] reports
+ *      1  reply       command replies
+ *      2  log         deferred log records or text (see log.h)
+ *
+ *  Each channel can go to a file or to a new pseudo-terminal, whose name
+ *  is printed, so the existing tools can read a channel on its own:
+ *
+ *      muxdemux /dev/ttyACM0 0=pty 2=log.bin
+ *      telemetry_ingest -o out.tlm /dev/pts/N
+ *      logdecode firmware.out log.bin
+ *
+ *  Channels without a destination are discarded. Nothing waits for a slow
+ *  reader: output a pseudo-terminal cannot take is dropped and counted.
+ *
+ *  Build:  cc -O2 -o muxdemux tools/muxdemux.c
+ *  Usage:  muxdemux [-b baud] input channel=file|pty...   ("-" is stdin)
+ */
+
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+/* Must match mux.h */
+#define MUX_FLAG        0x7E
+#define MUX_ESCAPE      0x7D
+#define MUX_MAX_PAYLOAD 32
+#define NUM_CHANNELS    3
+
+static const char *channelNames[NUM_CHANNELS] = { "telemetry", "reply", "log" };
+
+typedef struct {
+    int fd;                     /* -1: discard */
+    int isPty;
+    unsigned long frames;
+    unsigned long bytes;
+    unsigned long dropped;      /* bytes a pseudo-terminal could not take */
+} Output;
+
+static Output outputs[NUM_CHANNELS];
+static unsigned long badFrames;
+
+/*
+ *  ======== openPty ========
+ */
+static int openPty(int channel)
+{
+    struct termios tio;
+    int fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0)
+    {
+        return -1;
+    }
+    if (tcgetattr(fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    printf("channel %d (%s): %s\n", channel, channelNames[channel], ptsname(fd));
+    fflush(stdout);
+    return fd;
+}
+
+/*
+ *  ======== openInput ========
+ */
+static int openInput(const char *name, long baud)
+{
+    int fd = (strcmp(name, "-") == 0) ? STDIN_FILENO : open(name, O_RDONLY | O_NOCTTY);
+    struct termios tio;
+
+    if (fd >= 0 && isatty(fd) && tcgetattr(fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        if (baud == 115200)
+        {
+            cfsetspeed(&tio, B115200);
+        }
+        else if (baud == 230400)
+        {
+            cfsetspeed(&tio, B230400);
+        }
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+/*
+ *  ======== deliver ========
+ *  frame[0] is the channel, the rest is payload.
+ */
+static void deliver(const uint8_t *frame, size_t length)
+{
+    Output *out;
+    size_t done = 0;
+
+    if (length == 0)
+    {
+        return;                 /* back to back flags */
+    }
+    if (length == 1 || frame[0] >= NUM_CHANNELS)
+    {
+        badFrames++;
+        return;
+    }
+
+    out = &outputs[frame[0]];
+    out->frames++;
+    out->bytes += length - 1;
+    while (out->fd >= 0 && done < length - 1)
+    {
+        ssize_t n = write(out->fd, frame + 1 + done, length - 1 - done);
+
+        if (n > 0)
+        {
+            done += (size_t)n;
+        }
+        else if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else
+        {
+            out->dropped += length - 1 - done;
+            break;
+        }
+    }
+}
+
+/*
+ *  ======== main ========
+ */
+int main(int argc, char *argv[])
+{
+    uint8_t frame[1 + MUX_MAX_PAYLOAD];
+    uint8_t buf[4096];
+    size_t length = 0;
+    int inFrame = 0;
+    int escape = 0;
+    int overflow = 0;
+    unsigned long noise = 0;
+    const char *inName = NULL;
+    long baud = 115200;
+    int in;
+    int i;
+
+    for (i = 0; i < NUM_CHANNELS; i++)
+    {
+        outputs[i].fd = -1;
+    }
+
+    for (i = 1; i < argc; i++)
+    {
+        char *eq = strchr(argv[i], '=');
+
+        if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+        {
+            baud = atol(argv[++i]);
+        }
+        else if (eq != NULL && eq == argv[i] + 1 && argv[i][0] >= '0'
+                 && argv[i][0] < '0' + NUM_CHANNELS)
+        {
+            int channel = argv[i][0] - '0';
+            Output *out = &outputs[channel];
+
+            out->isPty = (strcmp(eq + 1, "pty") == 0);
+            out->fd = out->isPty ? openPty(channel)
+                                 : open(eq + 1, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (out->fd < 0)
+            {
+                fprintf(stderr, "muxdemux: cannot open %s\n", eq + 1);
+                return 1;
+            }
+        }
+        else if (inName == NULL)
+        {
+            inName = argv[i];
+        }
+        else
+        {
+            inName = NULL;
+            break;
+        }
+    }
+    if (inName == NULL)
+    {
+        fprintf(stderr, "usage: %s [-b baud] input channel=file|pty...\n"
+                        "channels: 0 telemetry, 1 reply, 2 log\n", argv[0]);
+        return 2;
+    }
+
+    in = openInput(inName, baud);
+    if (in < 0)
+    {
+        fprintf(stderr, "muxdemux: cannot open %s\n", inName);
+        return 1;
+    }
+
+    for (;;)
+    {
+        ssize_t n = read(in, buf, sizeof(buf));
+
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            break;
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            uint8_t c = buf[i];
+
+            if (c == MUX_FLAG)
+            {
+                if (overflow)
+                {
+                    badFrames++;
+                }
+                else if (inFrame)
+                {
+                    deliver(frame, length);
+                }
+                inFrame = 1;        /* a closing flag may also open the next frame */
+                length = 0;
+                escape = 0;
+                overflow = 0;
+            }
+            else if (!inFrame)
+            {
+                noise++;            /* output from before the board started framing */
+            }
+            else if (c == MUX_ESCAPE)
+            {
+                escape = 1;
+            }
+            else if (length == sizeof(frame))
+            {
+                overflow = 1;
+            }
+            else
+            {
+                frame[length++] = escape ? (uint8_t)(c ^ 0x20) : c;
+                escape = 0;
+            }
+        }
+    }
+
+    for (i = 0; i < NUM_CHANNELS; i++)
+    {
+        fprintf(stderr, "channel %d (%s): %lu frames, %lu bytes, %lu dropped\n", i,
+                channelNames[i], outputs[i].frames, outputs[i].bytes, outputs[i].dropped);
+    }
+    fprintf(stderr, "%lu bad frames, %lu bytes outside frames\n", badFrames, noise);
+    return 0;
+}
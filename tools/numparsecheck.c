@@ -0,0 +1,406 @@
+/*
+ *  ======== numparsecheck.c ========
+ *
+ *  Checks uart2echo's streaming number decoder (numparse.c) on the host,
+ *  feeding it one byte at a time as the echo loop does:
+ *
+ *      cases       fixed inputs with known results: the DUTY, SET and
+ *                  RATE ranges, the int32 limits, overflow however long
+ *                  the input, garbage, extra decimals, a missing number,
+ *                  a lone sign or point, and leading spaces
+ *      random      random inputs, mostly well formed and sometimes with
+ *                  a stray byte, against a reference that parses the
+ *                  whole string at once
+ *
+ *  --bench decodes a buffer of SET-style numbers ("-12.5\r") over and
+ *  over through num_start()/num_feed() and prints the cost per byte in
+ *  nanoseconds.
+ *
+ *  Build:  cc -O2 -I uart2echo_CC3220SF_LAUNCHXL_nortos_gcc -o numparsecheck \
+ *              tools/numparsecheck.c uart2echo_CC3220SF_LAUNCHXL_nortos_gcc/numparse.c
+ *  Usage:  ./numparsecheck
+ *          ./numparsecheck --bench [megabytes]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "numparse.h"
+
+typedef struct {
+    const char *input;
+    uint8_t decimals;
+    int32_t min;
+    int32_t max;
+    enum NUM_RESULTS result;
+    int32_t value;
+} Case;
+
+static const Case cases[] = {
+    // DUTY: 0 - 100, no decimals
+    { "42 ",            0,    0,  100, NUM_DONE,   42 },
+    { "0\r",            0,    0,  100, NUM_DONE,    0 },
+    { "100\n",          0,    0,  100, NUM_DONE,  100 },
+    { "  7\r",          0,    0,  100, NUM_DONE,    7 },
+    { "007\r",          0,    0,  100, NUM_DONE,    7 },
+    { "101\r",          0,    0,  100, NUM_ERROR,   0 },
+    { "1000\r",         0,    0,  100, NUM_ERROR,   0 },
+    { "-5\r",           0,    0,  100, NUM_ERROR,   0 },
+    { "-0\r",           0,    0,  100, NUM_DONE,    0 },
+    { "4.2\r",          0,    0,  100, NUM_ERROR,   0 },
+
+    // SET: -40.0 to 125.0, one decimal
+    { "21.5\r",         1, -400, 1250, NUM_DONE,  215 },
+    { "21\r",           1, -400, 1250, NUM_DONE,  210 },
+    { "21.\r",          1, -400, 1250, NUM_DONE,  210 },
+    { "-3\r",           1, -400, 1250, NUM_DONE,  -30 },
+    { "-40.0\r",        1, -400, 1250, NUM_DONE, -400 },
+    { "-40.1\r",        1, -400, 1250, NUM_ERROR,   0 },
+    { "125.0 ",         1, -400, 1250, NUM_DONE, 1250 },
+    { "125.1 ",         1, -400, 1250, NUM_ERROR,   0 },
+    { "21.55\r",        1, -400, 1250, NUM_ERROR,   0 },
+    { ".5\r",           1, -400, 1250, NUM_ERROR,   0 },
+    { "-.5\r",          1, -400, 1250, NUM_ERROR,   0 },
+    { "1.2.3\r",        1, -400, 1250, NUM_ERROR,   0 },
+
+    // RATE: 1 - 3600, so 0 is below the range
+    { "3600\r",         0,    1, 3600, NUM_DONE, 3600 },
+    { "0\r",            0,    1, 3600, NUM_ERROR,   0 },
+    { "1\r",            0,    1, 3600, NUM_DONE,    1 },
+
+    // A range entirely below or above zero
+    { "5\r",            0,  -10,   -1, NUM_ERROR,   0 },
+    { "-5\r",           0,  -10,   -1, NUM_DONE,   -5 },
+    { "-5\r",           0,    1,   10, NUM_ERROR,   0 },
+
+    // The int32 limits and overflow
+    { "2147483647\r",   0, INT32_MIN, INT32_MAX, NUM_DONE,  INT32_MAX },
+    { "-2147483648\r",  0, INT32_MIN, INT32_MAX, NUM_DONE,  INT32_MIN },
+    { "2147483648\r",   0, INT32_MIN, INT32_MAX, NUM_ERROR, 0 },
+    { "-2147483649\r",  0, INT32_MIN, INT32_MAX, NUM_ERROR, 0 },
+    { "4294967296\r",   0, INT32_MIN, INT32_MAX, NUM_ERROR, 0 },
+    { "99999999999999999999999999999999\r", 0, INT32_MIN, INT32_MAX, NUM_ERROR, 0 },
+    { "0000000000000000000000000000042\r",  0, INT32_MIN, INT32_MAX, NUM_DONE, 42 },
+    { "214748.3647\r",  4, INT32_MIN, INT32_MAX, NUM_DONE,  INT32_MAX },
+    { "214748.3648\r",  4, INT32_MIN, INT32_MAX, NUM_ERROR, 0 },
+    { "1.23456\r",      4, INT32_MIN, INT32_MAX, NUM_ERROR, 0 },
+
+    // Missing numbers and garbage
+    { "\r",             0,    0,  100, NUM_ERROR,   0 },
+    { "   \n",          0,    0,  100, NUM_ERROR,   0 },
+    { "-\r",            0, -100,  100, NUM_ERROR,   0 },
+    { "--1\r",          0, -100,  100, NUM_ERROR,   0 },
+    { "1-2\r",          0, -100,  100, NUM_ERROR,   0 },
+    { "12a\r",          0,    0,  100, NUM_ERROR,   0 },
+    { "x\r",            0,    0,  100, NUM_ERROR,   0 },
+    { "+5\r",           0,    0,  100, NUM_ERROR,   0 },
+    { "5\t",            0,    0,  100, NUM_ERROR,   0 },
+    { "\x80" "5\r",     0,    0,  100, NUM_ERROR,   0 },
+};
+
+static uint64_t seed = 88172645463325252ull;
+
+/*
+ *  ======== rnd ========
+ *  xorshift64
+ */
+static uint32_t rnd(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (uint32_t)(seed >> 32);
+}
+
+/*
+ *  ======== feed ========
+ *  Feeds input to a fresh decoder until it answers, the way uart2echo.c
+ *  does. Returns NUM_MORE if the input ran out first.
+ */
+static enum NUM_RESULTS feed(const char *input, size_t length, uint8_t decimals,
+                             int32_t min, int32_t max, int32_t *value)
+{
+    NumParser p;
+    size_t i;
+
+    num_start(&p, decimals, min, max);
+    for (i = 0; i < length; i++)
+    {
+        enum NUM_RESULTS result = num_feed(&p, (uint8_t)input[i], value);
+
+        if (result != NUM_MORE)
+        {
+            return result;
+        }
+    }
+    return NUM_MORE;
+}
+
+/*
+ *  ======== reference ========
+ *  Parses the whole of a terminated input at once, as numparse.h
+ *  describes it, with 64-bit arithmetic and a cap well above int32.
+ */
+static enum NUM_RESULTS reference(const char *s, uint8_t decimals, int32_t min, int32_t max,
+                                  int32_t *value)
+{
+    int64_t magnitude = 0;
+    int64_t v;
+    int negative = 0;
+    int digits = 0;
+    int fraction = 0;
+
+    while (*s == ' ')
+    {
+        s++;
+    }
+    if (*s == '-')
+    {
+        negative = 1;
+        s++;
+    }
+    while (*s >= '0' && *s <= '9')
+    {
+        magnitude = magnitude * 10 + (*s++ - '0');
+        if (magnitude > ((int64_t)1 << 40))
+        {
+            return NUM_ERROR;
+        }
+        digits++;
+    }
+    if (*s == '.')
+    {
+        if (digits == 0 || decimals == 0)
+        {
+            return NUM_ERROR;
+        }
+        s++;
+        while (*s >= '0' && *s <= '9')
+        {
+            if (++fraction > decimals)
+            {
+                return NUM_ERROR;
+            }
+            magnitude = magnitude * 10 + (*s++ - '0');
+        }
+    }
+    if (digits == 0 || (*s != ' ' && *s != '\r' && *s != '\n'))
+    {
+        return NUM_ERROR;
+    }
+    while (fraction++ < decimals)
+    {
+        magnitude *= 10;
+    }
+
+    v = negative ? -magnitude : magnitude;
+    if (v < min || v > max)
+    {
+        return NUM_ERROR;
+    }
+    *value = (int32_t)v;
+    return NUM_DONE;
+}
+
+/*
+ *  ======== testCases ========
+ */
+static int testCases(void)
+{
+    size_t i;
+    int failed = 0;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        const Case *c = &cases[i];
+        int32_t value = 0;
+        enum NUM_RESULTS result = feed(c->input, strlen(c->input), c->decimals,
+                                       c->min, c->max, &value);
+
+        if (result != c->result || (result == NUM_DONE && value != c->value))
+        {
+            if (failed++ == 0)
+            {
+                printf("  \"%s\" (%u decimals, %ld to %ld): %d %ld, not %d %ld\n",
+                       c->input, c->decimals, (long)c->min, (long)c->max,
+                       result, (long)value, c->result, (long)c->value);
+            }
+        }
+    }
+
+    printf("cases     %3zu inputs                               %s\n",
+           sizeof(cases) / sizeof(cases[0]), failed ? "FAILED" : "ok");
+    return !failed;
+}
+
+/*
+ *  ======== randomInput ========
+ *  [spaces] [-] digits [. digits] terminator, with now and then a piece
+ *  left out or a stray byte put in.
+ */
+static size_t randomInput(char *s, uint8_t decimals)
+{
+    static const char terminators[] = " \r\n";
+    static const char stray[] = "+-.xX\t\0\x7F\xFF";
+    size_t n = 0;
+    size_t spaces;
+    uint32_t r = rnd();
+    int i, count;
+
+    for (count = rnd() % 3; count > 0; count--)
+    {
+        s[n++] = ' ';
+    }
+    spaces = n;
+    if (r & 1)
+    {
+        s[n++] = '-';
+    }
+    for (count = rnd() % 12; count > 0; count--)
+    {
+        s[n++] = (char)('0' + rnd() % 10);
+    }
+    if (r & 2)
+    {
+        s[n++] = '.';
+        for (count = rnd() % (decimals + 2); count > 0; count--)
+        {
+            s[n++] = (char)('0' + rnd() % 10);
+        }
+    }
+    // A space only ends a number once something has started one.
+    s[n] = (n == spaces) ? '\r' : terminators[rnd() % 3];
+    n++;
+    if ((r & 0x1C) == 0 && n > 1)
+    {
+        i = (int)(rnd() % (n - 1));     // never the terminator
+        s[i] = stray[rnd() % (sizeof(stray) - 1)];
+    }
+    s[n] = '\0';
+    return n;
+}
+
+/*
+ *  ======== testRandom ========
+ */
+static int testRandom(void)
+{
+    char s[48];
+    int i, failed = 0;
+    long done = 0;
+
+    for (i = 0; i < 1000000; i++)
+    {
+        uint8_t decimals = (uint8_t)(rnd() % (NUM_MAX_DECIMALS + 1));
+        int32_t a = (int32_t)rnd() >> (rnd() % 32);
+        int32_t b = (int32_t)rnd() >> (rnd() % 32);
+        int32_t min = (a < b) ? a : b;
+        int32_t max = (a < b) ? b : a;
+        size_t length = randomInput(s, decimals);
+        int32_t expected = 0, value = 0;
+        enum NUM_RESULTS want, got;
+
+        // A stray NUL ends the reference early; the stream has no such end.
+        want = (strlen(s) == length) ? reference(s, decimals, min, max, &expected) : NUM_ERROR;
+        got = feed(s, length, decimals, min, max, &value);
+        done += (got == NUM_DONE);
+
+        if (got != want || (got == NUM_DONE && value != expected))
+        {
+            if (failed++ == 0)
+            {
+                printf("  \"%s\" (%u decimals, %ld to %ld): %d %ld, not %d %ld\n",
+                       s, decimals, (long)min, (long)max, got, (long)value, want, (long)expected);
+            }
+        }
+    }
+
+    printf("random    1000000 inputs, %6ld accepted            %s\n",
+           done, failed ? "FAILED" : "ok");
+    return !failed;
+}
+
+/*
+ *  ======== nowNs ========
+ */
+static uint64_t nowNs(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+/*
+ *  ======== bench ========
+ */
+static int bench(size_t megabytes)
+{
+    size_t size = 1 << 20;
+    char *buffer = malloc(size + 16);
+    size_t length = 0;
+    size_t numbers = 0;
+    size_t pass, passes = megabytes ? megabytes : 1;
+    int64_t sum = 0;
+    uint64_t best = UINT64_MAX;
+
+    if (buffer == NULL)
+    {
+        return 1;
+    }
+    while (length < size)
+    {
+        int32_t v = (int32_t)(rnd() % 1651) - 400;
+
+        length += (size_t)sprintf(buffer + length, "%s%d.%d\r", v < 0 ? "-" : "",
+                                  abs(v) / 10, abs(v) % 10);
+        numbers++;
+    }
+
+    for (pass = 0; pass < passes; pass++)
+    {
+        uint64_t t0 = nowNs(), t;
+        NumParser p;
+        int32_t value;
+        size_t i;
+
+        num_start(&p, 1, -400, 1250);
+        for (i = 0; i < length; i++)
+        {
+            enum NUM_RESULTS result = num_feed(&p, (uint8_t)buffer[i], &value);
+
+            if (result != NUM_MORE)
+            {
+                sum += (result == NUM_DONE) ? value : 1000000;
+                num_start(&p, 1, -400, 1250);
+            }
+        }
+        t = nowNs() - t0;
+        best = (t < best) ? t : best;
+    }
+
+    printf("%zu numbers in %zu bytes, best of %zu passes\n", numbers, length, passes);
+    printf("%.2f ns/byte, %.1f ns/number (checksum %lld)\n",
+           (double)best / length, (double)best / numbers, (long long)sum);
+    free(buffer);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int ok = 1;
+
+    if (argc >= 2 && strcmp(argv[1], "--bench") == 0)
+    {
+        return bench(argc > 2 ? (size_t)atoi(argv[2]) : 64);
+    }
+
+    ok &= testCases();
+    ok &= testRandom();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,390 @@
+/*
+ *  ======== pwmgroupcheck.c ========
+ *
+ *  Checks pwmled2's synchronized PWM updates (pwmgroup.c) on the host,
+ *  against a model of the general purpose timers behind the outputs. The
+ *  model counts each half down from the period as the hardware does in
+ *  PWM mode, loads a new duty at the timeout when the half is set to
+ *  (TnMRSU), and moves time on by ACCESS_COUNTS for every register access
+ *  and SETDUTY_COUNTS for every PWM_setDuty(). With interrupts on, any
+ *  access, and above all the moment before they go off, may also be held
+ *  up by a made-up interrupt of up to 40 us.
+ *
+ *      init        both halves load new duties only at the timeout
+ *      phase       a phase commit restarts the halves together, member 1
+ *                  the given offset behind member 0
+ *      duty        200000 commits at random points of the period: every
+ *                  commit's writes land inside one period of member 0, and
+ *                  each member loads its new duty at its next timeout
+ *      masked      the longest time interrupts are off in a commit, which
+ *                  must not include the wait for room
+ *
+ *  The outputs are set up as in pwmled2.c: TIMERA3 A and B, a 3000 us
+ *  period and member 1 half a period behind.
+ *
+ *  Build:  cc -O2 -I tools/pwmled2_host -I pwmled2_CC3220SF_LAUNCHXL_nortos_gcc \
+ *              -o pwmgroupcheck tools/pwmgroupcheck.c
+ *  Usage:  ./pwmgroupcheck
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <ti/drivers/PWM.h>
+#include <ti/drivers/dpl/HwiP.h>
+
+/* pwmgroup.c is built here with its registers in the model */
+static volatile uint32_t *modelReg(uint32_t base, uint32_t offset);
+#define GPT_REG(base, offset) (*modelReg((base), (offset)))
+#include "pwmgroup.c"
+
+#define ACCESS_COUNTS   4       /* 50 ns */
+#define SETDUTY_COUNTS  160     /* 2 us */
+#define MAX_IRQ_COUNTS  3200    /* 40 us */
+#define MODULES         4
+#define REGISTERS       (0x58 / 4)
+
+#define PERIOD_US       3000
+#define PHASE_US        1500
+#define PERIOD          (PERIOD_US * PWMGROUP_COUNTS_PER_US)
+#define TRIALS          200000
+
+typedef struct {
+    uint32_t value;             // counter, down from period - 1
+    uint32_t mode;              // TnMR
+    int enabled;
+    uint32_t duty;              // shown
+    uint32_t pending;
+    int hasPending;
+    uint64_t timeouts;
+    uint64_t writtenTimeout;    // timeouts when a duty was last written
+    uint64_t loadedTimeout;     // and when it was loaded
+} Half;
+
+struct PWM_Config_ {
+    unsigned int module;
+    unsigned int half;
+};
+
+static Half halves[MODULES][2];
+static uint32_t regs[MODULES][REGISTERS];
+static uint32_t published[MODULES][REGISTERS];
+static uint64_t now = 0;
+static uint64_t seed = 88172645463325252ull;
+
+static int masked = 0;
+static uint64_t maskedAt;
+static uint64_t longestMasked = 0;
+static int interruptsHappen = 0;
+
+/* The writes of the commit in progress */
+static uint64_t firstWriteTimeouts, lastWriteTimeouts;
+static unsigned int writesInCommit = 0;
+
+static struct PWM_Config_ pwmA = { 3, PWMGROUP_HALF_A };
+static struct PWM_Config_ pwmB = { 3, PWMGROUP_HALF_B };
+
+static const PwmGroupOutput outputs[] = {
+    { &pwmA, PWMGROUP_TIMERA3, PWMGROUP_HALF_A },
+    { &pwmB, PWMGROUP_TIMERA3, PWMGROUP_HALF_B },
+};
+
+/*
+ *  ======== rnd ========
+ *  xorshift64
+ */
+static uint32_t rnd(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (uint32_t)(seed >> 32);
+}
+
+/*
+ *  ======== advance ========
+ */
+static void advance(uint32_t counts)
+{
+    unsigned int m, h;
+
+    now += counts;
+    for (m = 0; m < MODULES; m++)
+    {
+        for (h = 0; h < 2; h++)
+        {
+            Half *t = &halves[m][h];
+            uint32_t left = counts;
+
+            while (t->enabled && left > 0)
+            {
+                if (left <= t->value)
+                {
+                    t->value -= left;
+                    break;
+                }
+                left -= t->value + 1;
+                t->value = PERIOD - 1;
+                t->timeouts++;
+                if (t->hasPending)
+                {
+                    t->duty = t->pending;
+                    t->hasPending = 0;
+                    t->loadedTimeout = t->timeouts;
+                }
+            }
+        }
+    }
+}
+
+/*
+ *  ======== publish ========
+ *  Puts the model's state in the register file.
+ */
+static void publish(void)
+{
+    unsigned int m;
+
+    for (m = 0; m < MODULES; m++)
+    {
+        regs[m][GPT_O_TAMR / 4] = halves[m][0].mode;
+        regs[m][GPT_O_TBMR / 4] = halves[m][1].mode;
+        regs[m][GPT_O_CTL / 4] = (halves[m][0].enabled ? GPT_CTL_TAEN : 0)
+                                 | (halves[m][1].enabled ? GPT_CTL_TBEN : 0);
+        regs[m][GPT_O_TAV / 4] = halves[m][0].value;
+        regs[m][GPT_O_TBV / 4] = halves[m][1].value;
+    }
+    memcpy(published, regs, sizeof(regs));
+}
+
+/*
+ *  ======== sync ========
+ *  Takes what has been written to the register file since the last
+ *  publish() into the model.
+ */
+static void sync(void)
+{
+    unsigned int m;
+
+    for (m = 0; m < MODULES; m++)
+    {
+        uint32_t *r = regs[m];
+        const uint32_t *p = published[m];
+
+        halves[m][0].mode = r[GPT_O_TAMR / 4];
+        halves[m][1].mode = r[GPT_O_TBMR / 4];
+        if (r[GPT_O_CTL / 4] != p[GPT_O_CTL / 4])
+        {
+            halves[m][0].enabled = (r[GPT_O_CTL / 4] & GPT_CTL_TAEN) != 0;
+            halves[m][1].enabled = (r[GPT_O_CTL / 4] & GPT_CTL_TBEN) != 0;
+        }
+        if (r[GPT_O_TAV / 4] != p[GPT_O_TAV / 4])
+        {
+            halves[m][0].value = r[GPT_O_TAV / 4] & GPT_VALUE_MASK;
+        }
+        if (r[GPT_O_TBV / 4] != p[GPT_O_TBV / 4])
+        {
+            halves[m][1].value = r[GPT_O_TBV / 4] & GPT_VALUE_MASK;
+        }
+    }
+    publish();
+}
+
+/*
+ *  ======== interrupt ========
+ *  Now and then something else runs, while interrupts are on.
+ */
+static void interrupt(unsigned int odds)
+{
+    if (interruptsHappen && !masked && rnd() % odds == 0)
+    {
+        advance(rnd() % MAX_IRQ_COUNTS);
+    }
+}
+
+/*
+ *  ======== modelReg ========
+ */
+static volatile uint32_t *modelReg(uint32_t base, uint32_t offset)
+{
+    unsigned int m = (base - PWMGROUP_TIMERA0) >> 12;
+
+    sync();
+    interrupt(64);
+    advance(ACCESS_COUNTS);
+    publish();
+    return &regs[m][offset / 4];
+}
+
+/*
+ *  ======== PWM_setDuty ========
+ *  The driver's own register writes, as one.
+ */
+int_fast16_t PWM_setDuty(PWM_Handle handle, uint32_t duty)
+{
+    Half *t = &halves[handle->module][handle->half];
+    uint64_t periods;
+
+    sync();
+    interrupt(64);
+    advance(SETDUTY_COUNTS / 2);
+    if (t->mode & GPT_TNMR_TNMRSU)
+    {
+        t->pending = duty;
+        t->hasPending = 1;
+        t->writtenTimeout = t->timeouts;
+    }
+    else
+    {
+        t->duty = duty;
+    }
+    periods = halves[3][0].timeouts;
+    if (writesInCommit++ == 0)
+    {
+        firstWriteTimeouts = periods;
+    }
+    lastWriteTimeouts = periods;
+    advance(SETDUTY_COUNTS / 2);
+    publish();
+    return PWM_STATUS_SUCCESS;
+}
+
+/*
+ *  ======== HwiP ========
+ */
+uintptr_t HwiP_disable(void)
+{
+    // Most likely just before interrupts go off, after the last look
+    sync();
+    interrupt(4);
+    masked = 1;
+    maskedAt = now;
+    return 0;
+}
+
+void HwiP_restore(uintptr_t key)
+{
+    sync();
+    masked = 0;
+    if (now - maskedAt > longestMasked)
+    {
+        longestMasked = now - maskedAt;
+    }
+}
+
+/*
+ *  ======== setUp ========
+ *  Both halves running, started a little apart by the driver, at 50%.
+ */
+static void setUp(PwmGroup *g)
+{
+    halves[3][0].enabled = 1;
+    halves[3][0].value = PERIOD - 1;
+    halves[3][1].enabled = 1;
+    halves[3][1].value = PERIOD - 1001;
+    halves[3][0].duty = halves[3][1].duty = PERIOD / 2;
+    publish();
+
+    pwmgroup_init(g, outputs, 2, PERIOD_US);
+    sync();
+}
+
+/*
+ *  ======== testInit ========
+ */
+static int testInit(PwmGroup *g)
+{
+    int failed = 0;
+    int h;
+
+    for (h = 0; h < 2; h++)
+    {
+        failed |= (halves[3][h].mode & (GPT_TNMR_TNILD | GPT_TNMR_TNMRSU))
+                  != (GPT_TNMR_TNILD | GPT_TNMR_TNMRSU);
+    }
+
+    printf("init      match and period load at timeout     %s\n", failed ? "FAILED" : "ok");
+    return !failed;
+}
+
+/*
+ *  ======== testPhase ========
+ */
+static int testPhase(PwmGroup *g)
+{
+    int failed = 0;
+    int i;
+
+    pwmgroup_stagePhase(g, 1, PHASE_US);
+    pwmgroup_commit(g);
+    for (i = 0; i < 1000; i++)
+    {
+        uint32_t behind;
+
+        advance(rnd() % PERIOD);
+        behind = (halves[3][0].value + PERIOD - halves[3][1].value) % PERIOD;
+        failed |= (behind != PERIOD - PHASE_US * PWMGROUP_COUNTS_PER_US);
+    }
+    failed |= !halves[3][0].enabled || !halves[3][1].enabled;
+
+    printf("phase     member 1 %4d us behind member 0      %s\n", PHASE_US,
+           failed ? "FAILED" : "ok");
+    return !failed;
+}
+
+/*
+ *  ======== testDuty ========
+ */
+static int testDuty(PwmGroup *g)
+{
+    unsigned int split = 0, late = 0;
+    int i;
+
+    interruptsHappen = 1;
+    longestMasked = 0;
+    for (i = 0; i < TRIALS; i++)
+    {
+        uint32_t duty0 = rnd() % PERIOD;
+        uint32_t duty1 = rnd() % PERIOD;
+
+        advance(rnd() % PERIOD);
+        pwmgroup_stageDuty(g, 0, duty0);
+        pwmgroup_stageDuty(g, 1, duty1);
+        writesInCommit = 0;
+        pwmgroup_commit(g);
+        sync();
+
+        split += (writesInCommit != 2 || firstWriteTimeouts != lastWriteTimeouts);
+        advance(PERIOD);
+        late += (halves[3][0].duty != duty0
+                 || halves[3][0].loadedTimeout != halves[3][0].writtenTimeout + 1
+                 || halves[3][1].duty != duty1
+                 || halves[3][1].loadedTimeout != halves[3][1].writtenTimeout + 1);
+    }
+    interruptsHappen = 0;
+
+    printf("duty      %d commits, %u split, %u late      %s\n", TRIALS, split, late,
+           (split || late) ? "FAILED" : "ok");
+    return !split && !late;
+}
+
+int main(void)
+{
+    PwmGroup g;
+    int ok = 1;
+    int failed;
+
+    setUp(&g);
+    ok &= testInit(&g);
+    ok &= testPhase(&g);
+    ok &= testDuty(&g);
+
+    // Two writes and the checks around them
+    failed = (longestMasked >= PWMGROUP_GUARD_US * PWMGROUP_COUNTS_PER_US);
+    printf("masked    longest %.2f us, guard %d us        %s\n",
+           (double)longestMasked / PWMGROUP_COUNTS_PER_US, PWMGROUP_GUARD_US,
+           failed ? "FAILED" : "ok");
+    ok &= !failed;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,21 @@
+/*
+ *  ======== PWM.h ========
+ *
+ *  Host stand-in for the parts of the TI PWM driver that pwmgroup.c and
+ *  waveform.c use. PWM_setDuty() is the check's (see pwmgroupcheck.c and
+ *  waveformcheck.c).
+ */
+
+#ifndef ti_drivers_PWM__include
+#define ti_drivers_PWM__include
+
+#include <stdint.h>
+
+#define PWM_STATUS_SUCCESS    0
+#define PWM_STATUS_ERROR      (-1)
+
+typedef struct PWM_Config_ *PWM_Handle;
+
+int_fast16_t PWM_setDuty(PWM_Handle handle, uint32_t duty);
+
+#endif /* ti_drivers_PWM__include */
@@ -0,0 +1,47 @@
+/*
+ *  ======== Timer.h ========
+ *
+ *  Host stand-in for the parts of the TI Timer driver that waveform.c
+ *  uses. The timer itself is waveformcheck.c's.
+ */
+
+#ifndef ti_drivers_Timer__include
+#define ti_drivers_Timer__include
+
+#include <stdint.h>
+
+#define Timer_STATUS_SUCCESS  0
+#define Timer_STATUS_ERROR    (-1)
+
+typedef struct Timer_Config_ *Timer_Handle;
+
+typedef enum {
+    Timer_ONESHOT_CALLBACK,
+    Timer_ONESHOT_BLOCKING,
+    Timer_CONTINUOUS_CALLBACK,
+    Timer_FREE_RUNNING
+} Timer_Mode;
+
+typedef enum {
+    Timer_PERIOD_US,
+    Timer_PERIOD_HZ,
+    Timer_PERIOD_COUNTS
+} Timer_PeriodUnits;
+
+typedef void (*Timer_CallBackFxn)(Timer_Handle handle, int_fast16_t status);
+
+typedef struct {
+    Timer_Mode timerMode;
+    Timer_PeriodUnits periodUnits;
+    Timer_CallBackFxn timerCallback;
+    uint32_t period;
+} Timer_Params;
+
+void Timer_init(void);
+void Timer_Params_init(Timer_Params *params);
+Timer_Handle Timer_open(uint_least8_t index, Timer_Params *params);
+int32_t Timer_setPeriod(Timer_Handle handle, Timer_PeriodUnits periodUnits, uint32_t period);
+int32_t Timer_start(Timer_Handle handle);
+void Timer_stop(Timer_Handle handle);
+
+#endif /* ti_drivers_Timer__include */
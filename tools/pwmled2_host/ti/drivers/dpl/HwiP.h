@@ -0,0 +1,17 @@
+/*
+ *  ======== HwiP.h ========
+ *
+ *  Host stand-in. Each check supplies the functions: pwmgroupcheck.c
+ *  times how long interrupts stay off, waveformcheck.c holds off its
+ *  timer thread.
+ */
+
+#ifndef ti_drivers_dpl_HwiP__include
+#define ti_drivers_dpl_HwiP__include
+
+#include <stdint.h>
+
+uintptr_t HwiP_disable(void);
+void HwiP_restore(uintptr_t key);
+
+#endif /* ti_drivers_dpl_HwiP__include */
@@ -0,0 +1,231 @@
+/*
+ *  ======== reportbench.c ========
+ *
+ *  Checks the thermostat's report formatter (report.c) against snprintf()
+ *  on the host and times the two:
+ *
+ *      putint      report_putInt() against "%0*d" for every field width
+ *                  up to 12 over the int32 edge cases and random values
+ *      report      report_format() against "<%02d,%02d,%d,%04d>\r\n" over
+ *                  the int16 and int32 edge cases and random values, with
+ *                  any non-zero heat written as 1; never longer than
+ *                  REPORT_MAX_LEN
+ *
+ *  Then it formats the same reports both ways and prints the cost of
+ *  each: cycles of the host's time stamp counter on x86, nanoseconds
+ *  elsewhere.
+ *
+ *  Code size, from the baseline build's .out in Debug/, which still printed
+ *  through the Display driver (nm -S):
+ *
+ *      doPrint (the SystemP printf engine)     1196 bytes flash
+ *      Display_* and DisplayUart2Min_*          466 bytes flash
+ *      displayUART2Buffer and Display objects  1040 bytes RAM
+ *
+ *  plus the soft double subtract, compare and convert helpers, which
+ *  the map shows SystemP_nortos.c.obj pulling in. report.o replaces all
+ *  of it; on the host it is 329 bytes of text at -Os (size report.o).
+ *
+ *  Build:  cc -O2 -I thermostat-gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc -o reportbench \
+ *              tools/reportbench.c thermostat-gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc/report.c
+ *  Usage:  ./reportbench [rounds]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "report.h"
+
+#define REPORTS 1024
+
+static uint64_t seed = 88172645463325252ull;
+
+static const int32_t edges32[] = {
+    0, 1, -1, 9, -9, 10, -10, 99, -99, 100, 9999, 10000, -10000,
+    32767, -32768, 99999, 2147483647, -2147483647 - 1
+};
+
+static struct {
+    int16_t temperature;
+    int16_t setpoint;
+    int heat;
+    int seconds;
+} reports[REPORTS];
+
+/*
+ *  ======== rnd ========
+ *  xorshift64
+ */
+static uint32_t rnd(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (uint32_t)(seed >> 32);
+}
+
+/*
+ *  ======== value ========
+ *  An edge case or a random value of each magnitude.
+ */
+static int32_t value(void)
+{
+    uint32_t r = rnd();
+
+    if (r % 4 == 0)
+    {
+        return edges32[rnd() % (sizeof(edges32) / sizeof(edges32[0]))];
+    }
+    return (int32_t)(rnd() >> (r % 32));
+}
+
+/*
+ *  ======== testPutInt ========
+ */
+static int testPutInt(void)
+{
+    char ours[16], theirs[16];
+    int i, width, failed = 0;
+
+    for (i = 0; i < 20000; i++)
+    {
+        int32_t v = value();
+
+        for (width = 0; width <= 12; width++)
+        {
+            char *end = report_putInt(ours, v, (uint8_t)width);
+
+            *end = '\0';
+            snprintf(theirs, sizeof(theirs), "%0*d", width, (int)v);
+            if (strcmp(ours, theirs) != 0 && failed++ == 0)
+            {
+                printf("  putInt(%d, %d): \"%s\", not \"%s\"\n", (int)v, width, ours, theirs);
+            }
+        }
+    }
+
+    printf("putint    20000 values, widths 0 - 12              %s\n", failed ? "FAILED" : "ok");
+    return !failed;
+}
+
+/*
+ *  ======== testReport ========
+ */
+static int testReport(void)
+{
+    char ours[REPORT_MAX_LEN + 1], theirs[64];
+    int i, failed = 0;
+
+    for (i = 0; i < 100000; i++)
+    {
+        int16_t temperature = (int16_t)value();
+        int16_t setpoint = (int16_t)value();
+        int heat = (i % 3 == 2) ? (int)value() : i & 1;
+        int seconds = (int)value();
+        size_t length = report_format(ours, temperature, setpoint, heat, seconds);
+        int expected = snprintf(theirs, sizeof(theirs), "<%02d,%02d,%d,%04d>\r\n",
+                                temperature, setpoint, heat != 0, seconds);
+
+        ours[length] = '\0';
+        if ((length > REPORT_MAX_LEN || (int)length != expected || strcmp(ours, theirs) != 0)
+            && failed++ == 0)
+        {
+            printf("  \"%s\", not \"%s\"\n", ours, theirs);
+        }
+    }
+
+    printf("report    100000 reports                           %s\n", failed ? "FAILED" : "ok");
+    return !failed;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+static uint64_t now(void)
+{
+    return __rdtsc();
+}
+#define UNITS "TSC cycles"
+#else
+static uint64_t now(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000000ull + t.tv_nsec;
+}
+#define UNITS "ns"
+#endif
+
+int main(int argc, char *argv[])
+{
+    char buf[64];
+    int rounds = (argc > 1) ? atoi(argv[1]) : 200;
+    uint64_t best[2] = {UINT64_MAX, UINT64_MAX};
+    unsigned int sum = 0;
+    int ok = 1;
+    int i, r;
+
+    ok &= testPutInt();
+    ok &= testReport();
+
+    // Thermostat-like reports: room temperatures, a set-point, the heat
+    // and a seconds counter.
+    for (i = 0; i < REPORTS; i++)
+    {
+        reports[i].temperature = (int16_t)(15 + rnd() % 15);
+        reports[i].setpoint = (int16_t)(18 + rnd() % 8);
+        reports[i].heat = (int)(rnd() & 1);
+        reports[i].seconds = i * 37;
+    }
+
+    for (r = 0; r < rounds; r++)
+    {
+        uint64_t t0 = now(), t1, t2;
+
+        for (i = 0; i < REPORTS; i++)
+        {
+            sum += (unsigned int)report_format(buf, reports[i].temperature, reports[i].setpoint,
+                                               reports[i].heat, reports[i].seconds);
+            sum += (unsigned char)buf[1];
+        }
+        t1 = now();
+        for (i = 0; i < REPORTS; i++)
+        {
+            sum += (unsigned int)snprintf(buf, sizeof(buf), "<%02d,%02d,%d,%04d>\r\n",
+                                          reports[i].temperature, reports[i].setpoint,
+                                          reports[i].heat, reports[i].seconds);
+            sum += (unsigned char)buf[1];
+        }
+        t2 = now();
+
+        if (t1 - t0 < best[0])
+        {
+            best[0] = t1 - t0;
+        }
+        if (t2 - t1 < best[1])
+        {
+            best[1] = t2 - t1;
+        }
+    }
+
+    printf("\n%-16s %10s\n", "", UNITS);
+    printf("%-16s %10s\n", "", "per report");
+    printf("%-16s %10.1f\n", "report_format", (double)best[0] / REPORTS);
+    printf("%-16s %10.1f\n", "snprintf", (double)best[1] / REPORTS);
+    printf("%-16s %10.1fx\n", "speed up", (double)best[1] / (double)best[0]);
+
+    // Keeps the compiler from dropping the formatting.
+    if (sum == 0)
+    {
+        printf("\n");
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,299 @@
+/*
+ *  ======== seqcheck.c ========
+ *
+ *  Checks the gpiointerrupt LED sequencer (sequencer.c) on the host,
+ *  stepping it the way the firmware does, by the wait each call returns:
+ *
+ *      priority    a channel shows the highest priority pattern that has
+ *                  set it, falls back to the next one down when that ends,
+ *                  and to 0 when nothing has it; channels the top pattern
+ *                  never set stay with the one below
+ *      fades       fades step at most SEQ_FADE_STEP_MS apart, follow the
+ *                  straight line from level to level, and land on the end
+ *                  level exactly when the fade is over, whatever its length
+ *      keys        keyframes with no wait start together, but no more than
+ *                  SEQ_KEYS_PER_STEP per pattern per call, and a pattern
+ *                  that never waits still returns a wait of 1 ms
+ *      outputs     outputs are written only when their level changes
+ *      tracks      a pattern beyond SEQ_MAX_TRACKS is refused
+ *
+ *  Build:  cc -O2 -I gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc -o seqcheck tools/seqcheck.c \
+ *              gpiointerrupt_CC3220SF_LAUNCHXL_nortos_gcc/sequencer.c
+ *  Usage:  ./seqcheck
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "sequencer.h"
+
+static uint8_t levels[SEQ_MAX_CHANNELS];
+static unsigned int writes = 0;
+static unsigned int sameWrites = 0;
+static unsigned int sourceKeys = 0;
+
+/*
+ *  ======== output ========
+ */
+static void output(unsigned int channel, uint8_t level)
+{
+    sameWrites += (writes > SEQ_MAX_CHANNELS && levels[channel] == level);
+    levels[channel] = level;
+    writes++;
+}
+
+/*
+ *  ======== reset ========
+ */
+static void reset(void)
+{
+    writes = 0;
+    sameWrites = 0;
+    seq_init(output);
+}
+
+/*
+ *  ======== advanceTo ========
+ *  Steps by the waits seq_advance() asks for, from time *t, then the rest
+ *  of the way to end, as a call from outside the timer would.
+ */
+static void advanceTo(uint32_t *t, uint32_t end, uint32_t *wait)
+{
+    while (*t + *wait <= end && *wait != SEQ_IDLE)
+    {
+        *t += *wait;
+        *wait = seq_advance(*wait);
+    }
+    if (*t < end)
+    {
+        *wait = seq_advance(end - *t);
+        *t = end;
+    }
+}
+
+/*
+ *  ======== testPriority ========
+ */
+static int testPriority(void)
+{
+    static const SeqKey lowKeys[] = {
+        SEQ_KEY(0, 100, 0, 0),
+        SEQ_KEY(1, 50, 0, 1000),
+    };
+    static const SeqKey highKeys[] = {
+        SEQ_KEY(0, 200, 0, 100),
+    };
+    static const SeqPattern low = SEQ_PATTERN(lowKeys, 0);
+    static const SeqPattern high = SEQ_PATTERN(highKeys, 0);
+    uint32_t t = 0, wait;
+    int failed = 0;
+
+    reset();
+    seq_play(&low, 1);
+    wait = seq_advance(0);
+    advanceTo(&t, 200, &wait);
+    seq_play(&high, 2);
+    wait = seq_advance(0);
+    failed |= (levels[0] != 200 || levels[1] != 50);
+
+    advanceTo(&t, 250, &wait);
+    failed |= (levels[0] != 200);
+    advanceTo(&t, 300, &wait);
+    failed |= (levels[0] != 100 || levels[1] != 50);
+
+    advanceTo(&t, 1000, &wait);
+    failed |= (levels[0] != 0 || levels[1] != 0 || wait != SEQ_IDLE);
+
+    // The same the other way round: low starting under high changes nothing
+    reset();
+    t = 0;
+    seq_play(&high, 2);
+    wait = seq_advance(0);
+    seq_play(&low, 1);
+    wait = seq_advance(0);
+    failed |= (levels[0] != 200 || levels[1] != 50);
+    advanceTo(&t, 100, &wait);
+    failed |= (levels[0] != 100);
+
+    printf("priority  fall back to the next pattern down   %s\n", failed ? "FAILED" : "ok");
+    return !failed;
+}
+
+/*
+ *  ======== testFade ========
+ *  A fade from 0 to level over fadeMs.
+ */
+static int testFade(uint8_t level, uint16_t fadeMs)
+{
+    SeqKey keys[2] = {
+        SEQ_KEY(2, 0, 0, 0),
+        SEQ_KEY(2, 0, 0, 0),
+    };
+    SeqPattern pattern = SEQ_PATTERN(keys, 0);
+    uint32_t t = 0, wait;
+    int last = -1;
+    int failed = 0;
+
+    keys[1].level = level;
+    keys[1].fadeMs = fadeMs;
+    keys[1].waitMs = (uint16_t)(fadeMs + 100);
+
+    reset();
+    seq_play(&pattern, 1);
+    wait = seq_advance(0);
+    while (t < fadeMs)
+    {
+        int expected = (int)((uint32_t)level * t / fadeMs);
+
+        failed |= (wait == 0 || wait > SEQ_FADE_STEP_MS);
+        failed |= (levels[2] != expected || levels[2] < last);
+        last = levels[2];
+        t += wait;
+        wait = seq_advance(wait);
+    }
+    failed |= (t != fadeMs || levels[2] != level || wait != 100);
+    return !failed;
+}
+
+/*
+ *  ======== testFades ========
+ */
+static int testFades(void)
+{
+    static const uint16_t lengths[] = {1, 7, 20, 21, 50, 300, 1000, 5099};
+    unsigned int i;
+    int failed = 0;
+
+    for (i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+    {
+        if (!testFade(255, lengths[i]) || !testFade(37, lengths[i]))
+        {
+            if (failed++ == 0)
+            {
+                printf("  fade over %u ms\n", lengths[i]);
+            }
+        }
+    }
+
+    printf("fades     1 - 5099 ms, steps and end           %s\n", failed ? "FAILED" : "ok");
+    return !failed;
+}
+
+/*
+ *  ======== source ========
+ *  A pattern that never waits.
+ */
+static int source(void *arg, SeqKey *key)
+{
+    key->channel = 3;
+    key->level = (uint8_t)sourceKeys++;
+    key->fadeMs = 0;
+    key->waitMs = 0;
+    return 1;
+}
+
+/*
+ *  ======== testKeys ========
+ */
+static int testKeys(void)
+{
+    static const SeqKey chordKeys[] = {
+        SEQ_KEY(0, 10, 0, 0),
+        SEQ_KEY(1, 20, 0, 0),
+        SEQ_KEY(2, 30, 0, 500),
+    };
+    static const SeqPattern chord = SEQ_PATTERN(chordKeys, 0);
+    uint32_t wait;
+    int failed = 0;
+    int i;
+
+    // Keyframes with no wait between them go out in the same call
+    reset();
+    seq_play(&chord, 1);
+    wait = seq_advance(0);
+    failed |= (levels[0] != 10 || levels[1] != 20 || levels[2] != 30 || wait != 500);
+
+    // A pattern that never waits is held to SEQ_KEYS_PER_STEP a call
+    reset();
+    sourceKeys = 0;
+    seq_playSource(source, NULL, 1);
+    for (i = 1; i <= 10; i++)
+    {
+        wait = seq_advance(wait);
+        failed |= (sourceKeys != (unsigned int)i * SEQ_KEYS_PER_STEP || wait != 1);
+    }
+
+    printf("keys      at most %2d keyframes a call          %s\n", SEQ_KEYS_PER_STEP,
+           failed ? "FAILED" : "ok");
+    return !failed;
+}
+
+/*
+ *  ======== testOutputs ========
+ */
+static int testOutputs(void)
+{
+    static const SeqKey holdKeys[] = {
+        SEQ_KEY(0, 255, 0, 100),
+        SEQ_KEY(0, 255, 0, 100),
+        SEQ_KEY(1, 0, 0, 100),
+        SEQ_KEY(0, 255, 0, 100),
+    };
+    static const SeqPattern hold = SEQ_PATTERN(holdKeys, 0);
+    uint32_t t = 0, wait;
+    unsigned int steps = 0;
+    int failed;
+
+    reset();
+    seq_play(&hold, 1);
+    wait = seq_advance(0);
+    while (wait != SEQ_IDLE)
+    {
+        t += wait;
+        wait = seq_advance(wait);
+        steps++;
+    }
+    // Four writes from seq_init(), channel 0 up, and back to 0 at the end
+    failed = (writes != SEQ_MAX_CHANNELS + 2 || sameWrites != 0 || steps != 4);
+
+    printf("outputs   written only on a change             %s\n", failed ? "FAILED" : "ok");
+    return !failed;
+}
+
+/*
+ *  ======== testTracks ========
+ */
+static int testTracks(void)
+{
+    static const SeqKey keys[] = {
+        SEQ_KEY(0, 1, 0, 100),
+    };
+    static const SeqPattern pattern = SEQ_PATTERN(keys, 0);
+    int failed = 0;
+    int i;
+
+    reset();
+    for (i = 0; i < SEQ_MAX_TRACKS; i++)
+    {
+        failed |= (seq_play(&pattern, 1) != i);
+    }
+    failed |= (seq_play(&pattern, 1) != -1);
+    seq_stop(2);
+    failed |= (seq_play(&pattern, 1) != 2);
+
+    printf("tracks    %d at once                            %s\n", SEQ_MAX_TRACKS,
+           failed ? "FAILED" : "ok");
+    return !failed;
+}
+
+int main(void)
+{
+    int ok = 1;
+
+    ok &= testPriority();
+    ok &= testFades();
+    ok &= testKeys();
+    ok &= testOutputs();
+    ok &= testTracks();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,469 @@
+/*
+ *  ======== telemetry_ingest.c ========
+ *
+ *  Host side ingestion of the thermostat status reports
+ *
+ *      <%02d,%02d,%d,%04d>  =  <temperature,set-point,heat,seconds>
+ *
+ *  from any number of files, pipes or serial/pseudo-terminal devices at the
+ *  same time. Bytes that are not part of a well formed report (deferred log
+ *  records, line noise, frames cut short by a board reset) are skipped and
+ *  the scanner picks up again at the next '<'.
+ *
+ *  Reports are written to a columnar file (format below). Each input gets
+ *  its own source number, in the order given on the command line.
+ *
+ *  Build:  cc -O2 -march=native -o telemetry_ingest telemetry_ingest.c
+ *  Usage:  telemetry_ingest -o out.tlm input...   ("-" is stdin)
+ *          telemetry_ingest --bench [megabytes]
+ *
+ *  Output format (all values little endian):
+ *
+ *      file header:  "TLMC", uint32 version (1)
+ *      each block:   uint32 rows,
+ *                    uint16 source[rows],
+ *                    int16  temperature[rows],
+ *                    int16  setpoint[rows],
+ *                    uint8  heat[rows],
+ *                    uint32 seconds[rows]
+ *
+ *  Blocks hold up to BLOCK_ROWS rows; the last one may be shorter.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define BLOCK_ROWS  4096
+#define MAX_FRAME   32          /* longest valid report is 29 bytes */
+#define READ_SIZE   65536
+#define MAX_INPUTS  256
+
+/* One parsed report */
+typedef struct {
+    int16_t temperature;
+    int16_t setpoint;
+    uint8_t heat;
+    uint32_t seconds;
+} Row;
+
+/* Column buffers for the block being filled */
+typedef struct {
+    FILE *out;
+    uint32_t rows;
+    uint16_t source[BLOCK_ROWS];
+    int16_t temperature[BLOCK_ROWS];
+    int16_t setpoint[BLOCK_ROWS];
+    uint8_t heat[BLOCK_ROWS];
+    uint32_t seconds[BLOCK_ROWS];
+} Columns;
+
+/* Per input state; carry holds an incomplete frame between reads */
+typedef struct {
+    const char *name;
+    int fd;
+    uint16_t source;
+    size_t carry;
+    uint8_t buf[MAX_FRAME + READ_SIZE];
+} Input;
+
+/* Totals for the summary line */
+static unsigned long long totalBytes;
+static unsigned long long totalFrames;
+static unsigned long long totalCorrupt;
+
+/*
+ *  ======== findStart ========
+ *  Returns the first '<' in [p, end), or end. Scans 16 bytes per step
+ *  where SSE2 is available.
+ */
+static const uint8_t *findStart(const uint8_t *p, const uint8_t *end)
+{
+#ifdef __SSE2__
+    const __m128i open = _mm_set1_epi8('<');
+
+    while (end - p >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, open));
+
+        if (mask != 0)
+        {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && *p != '<')
+    {
+        p++;
+    }
+    return p;
+}
+
+/*
+ *  ======== parseField ========
+ *  Parses an optionally negative decimal number ending in term.
+ *  Returns 1 on success, 0 if the field is malformed and -1 if the data
+ *  ran out first.
+ */
+static int parseField(const uint8_t **pp, const uint8_t *end, char term, int64_t *value)
+{
+    const uint8_t *p = *pp;
+    int negative = 0;
+    int digits = 0;
+    int64_t v = 0;
+
+    if (p < end && *p == '-')
+    {
+        negative = 1;
+        p++;
+    }
+    while (p < end)
+    {
+        unsigned d = (unsigned)*p - '0';
+
+        if (d > 9)
+        {
+            break;
+        }
+        v = v * 10 + d;
+        p++;
+        if (++digits > 10)
+        {
+            return 0;
+        }
+    }
+    if (p == end)
+    {
+        return -1;
+    }
+    if (digits == 0 || *p != (uint8_t)term)
+    {
+        return 0;
+    }
+
+    *value = negative ? -v : v;
+    *pp = p + 1;
+    return 1;
+}
+
+/*
+ *  ======== parseFrame ========
+ *  p points at '<'. Returns 1 and sets *next past the frame on success,
+ *  0 if the frame is corrupt and -1 if more data is needed.
+ */
+static int parseFrame(const uint8_t *p, const uint8_t *end, Row *row, const uint8_t **next)
+{
+    static const char terms[4] = { ',', ',', ',', '>' };
+    int64_t v[4];
+    int i;
+
+    p++;
+    for (i = 0; i < 4; i++)
+    {
+        int rc = parseField(&p, end, terms[i], &v[i]);
+        if (rc != 1)
+        {
+            return rc;
+        }
+    }
+
+    if (v[0] < INT16_MIN || v[0] > INT16_MAX
+        || v[1] < INT16_MIN || v[1] > INT16_MAX
+        || (v[2] != 0 && v[2] != 1)
+        || v[3] < 0 || v[3] > UINT32_MAX)
+    {
+        return 0;
+    }
+
+    row->temperature = (int16_t)v[0];
+    row->setpoint = (int16_t)v[1];
+    row->heat = (uint8_t)v[2];
+    row->seconds = (uint32_t)v[3];
+    *next = p;
+    return 1;
+}
+
+/*
+ *  ======== flushColumns ========
+ */
+static void flushColumns(Columns *c)
+{
+    if (c->rows == 0 || c->out == NULL)
+    {
+        c->rows = 0;
+        return;
+    }
+    fwrite(&c->rows, sizeof(c->rows), 1, c->out);
+    fwrite(c->source, sizeof(c->source[0]), c->rows, c->out);
+    fwrite(c->temperature, sizeof(c->temperature[0]), c->rows, c->out);
+    fwrite(c->setpoint, sizeof(c->setpoint[0]), c->rows, c->out);
+    fwrite(c->heat, sizeof(c->heat[0]), c->rows, c->out);
+    fwrite(c->seconds, sizeof(c->seconds[0]), c->rows, c->out);
+    c->rows = 0;
+}
+
+/*
+ *  ======== scan ========
+ *  Parses every complete frame in buf[0, length) into the columns and
+ *  returns how many trailing bytes must be kept for the next call.
+ */
+static size_t scan(const uint8_t *buf, size_t length, uint16_t source, Columns *c)
+{
+    const uint8_t *p = buf;
+    const uint8_t *end = buf + length;
+
+    while ((p = findStart(p, end)) < end)
+    {
+        const uint8_t *next;
+        Row row;
+        int rc = parseFrame(p, end, &row, &next);
+
+        if (rc < 0)
+        {
+            // Incomplete; keep it unless it is already too long to be valid.
+            if (end - p < MAX_FRAME)
+            {
+                return (size_t)(end - p);
+            }
+            rc = 0;
+        }
+        if (rc == 0)
+        {
+            totalCorrupt++;
+            p++;                    // resynchronize on the next '<'
+            continue;
+        }
+
+        c->source[c->rows] = source;
+        c->temperature[c->rows] = row.temperature;
+        c->setpoint[c->rows] = row.setpoint;
+        c->heat[c->rows] = row.heat;
+        c->seconds[c->rows] = row.seconds;
+        if (++c->rows == BLOCK_ROWS)
+        {
+            flushColumns(c);
+        }
+        totalFrames++;
+        p = next;
+    }
+    return 0;
+}
+
+/*
+ *  ======== openInput ========
+ *  Terminals are switched to raw mode so no bytes are cooked or held back.
+ */
+static int openInput(const char *name)
+{
+    int fd = (strcmp(name, "-") == 0) ? STDIN_FILENO : open(name, O_RDONLY | O_NOCTTY);
+
+    if (fd >= 0 && isatty(fd))
+    {
+        struct termios tio;
+        if (tcgetattr(fd, &tio) == 0)
+        {
+            cfmakeraw(&tio);
+            tcsetattr(fd, TCSANOW, &tio);
+        }
+    }
+    return fd;
+}
+
+/*
+ *  ======== ingest ========
+ *  Reads all inputs as data arrives until every one has reached end of
+ *  file (or hung up, for terminals).
+ */
+static int ingest(Input **inputs, int count, Columns *c)
+{
+    struct pollfd fds[MAX_INPUTS];
+    int remaining = count;
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        fds[i].fd = inputs[i]->fd;
+        fds[i].events = POLLIN;
+    }
+
+    while (remaining > 0)
+    {
+        if (poll(fds, count, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("poll");
+            return 1;
+        }
+
+        for (i = 0; i < count; i++)
+        {
+            Input *in = inputs[i];
+            ssize_t n;
+            size_t keep;
+
+            if (fds[i].fd < 0 || fds[i].revents == 0)
+            {
+                continue;
+            }
+
+            n = read(in->fd, in->buf + in->carry, READ_SIZE);
+            if (n <= 0)
+            {
+                if (n < 0 && (errno == EINTR || errno == EAGAIN))
+                {
+                    continue;
+                }
+                if (in->carry > 0)
+                {
+                    totalCorrupt++;     // frame cut off at end of input
+                }
+                close(in->fd);
+                fds[i].fd = -1;
+                remaining--;
+                continue;
+            }
+
+            totalBytes += (unsigned long long)n;
+            keep = scan(in->buf, in->carry + (size_t)n, in->source, c);
+            memmove(in->buf, in->buf + in->carry + (size_t)n - keep, keep);
+            in->carry = keep;
+        }
+    }
+    return 0;
+}
+
+/*
+ *  ======== bench ========
+ *  Builds an in-memory stream of reports, about one in a hundred of them
+ *  damaged, and reports parse speed for this single thread.
+ */
+static int bench(size_t megabytes, Columns *c)
+{
+    size_t size = megabytes << 20;
+    uint8_t *stream = malloc(size + MAX_FRAME);
+    size_t length = 0;
+    unsigned long seconds = 0;
+    struct timespec t0, t1;
+    double elapsed;
+    int pass;
+    const int passes = 5;
+
+    if (stream == NULL)
+    {
+        return 1;
+    }
+    srand(1);
+    while (length + MAX_FRAME < size)
+    {
+        int n = snprintf((char *)stream + length, MAX_FRAME, "<%02d,%02d,%d,%04lu>\r\n",
+                         rand() % 40, 20 + rand() % 5, rand() & 1, seconds++);
+        if (rand() % 100 == 0)
+        {
+            stream[length + rand() % (n - 2)] = (uint8_t)rand();
+        }
+        length += (size_t)n;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (pass = 0; pass < passes; pass++)
+    {
+        scan(stream, length, 0, c);
+        c->rows = 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    elapsed = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    printf("%lu lines x %d passes in %.3f s: %.1f M lines/s/core, %.0f MB/s "
+           "(%llu parsed, %llu corrupt)\n",
+           seconds, passes, elapsed, seconds * passes / elapsed / 1e6,
+           (double)length * passes / elapsed / (1 << 20), totalFrames, totalCorrupt);
+    free(stream);
+    return 0;
+}
+
+/*
+ *  ======== main ========
+ */
+int main(int argc, char *argv[])
+{
+    static Columns columns;
+    static const uint32_t header[2] = { 0x434D4C54, 1 };    /* "TLMC", v1 */
+    Input *inputs[MAX_INPUTS];
+    const char *outName = NULL;
+    int count = 0;
+    int rc;
+    int i;
+
+    if (argc >= 2 && strcmp(argv[1], "--bench") == 0)
+    {
+        return bench(argc > 2 ? (size_t)atoi(argv[2]) : 64, &columns);
+    }
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            outName = argv[++i];
+        }
+        else if (count == MAX_INPUTS)
+        {
+            fprintf(stderr, "telemetry_ingest: more than %d inputs\n", MAX_INPUTS);
+            return 1;
+        }
+        else
+        {
+            Input *in = calloc(1, sizeof(*in));
+            if (in == NULL || (in->fd = openInput(argv[i])) < 0)
+            {
+                fprintf(stderr, "telemetry_ingest: cannot open %s\n", argv[i]);
+                return 1;
+            }
+            in->name = argv[i];
+            in->source = (uint16_t)count;
+            inputs[count++] = in;
+        }
+    }
+    if (outName == NULL || count == 0)
+    {
+        fprintf(stderr, "usage: %s -o out.tlm input...\n"
+                        "       %s --bench [megabytes]\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    columns.out = fopen(outName, "wb");
+    if (columns.out == NULL)
+    {
+        fprintf(stderr, "telemetry_ingest: cannot create %s\n", outName);
+        return 1;
+    }
+    fwrite(header, sizeof(header), 1, columns.out);
+
+    rc = ingest(inputs, count, &columns);
+    flushColumns(&columns);
+    if (fclose(columns.out) != 0)
+    {
+        rc = 1;
+    }
+
+    fprintf(stderr, "%llu bytes, %llu reports, %llu corrupt\n",
+            totalBytes, totalFrames, totalCorrupt);
+    return rc;
+}
@@ -0,0 +1,594 @@
+/*
+ *  ======== harness.c ========
+ *
+ *  Runs the uart2echo example (uart2echo.c, unchanged) on Linux against
+ *  the driver stand-ins in shim.c and measures it without a LaunchPad.
+ *
+ *  The application's UART is a pseudo-terminal. The load generator writes
+ *  a byte stream into it at a fixed rate, reads the echo back and reports
+ *  the echo round trip latency and the time from the last byte of each
+ *  ON/OFF keyword to the matching GPIO_write(). The stream is either
+ *  generated (lower case filler with ON and OFF mixed in) or replayed from
+ *  a file; a replayed file must not contain keywords that answer with
+ *  output of their own (STATS, BULK), since the echo is matched byte for
+ *  byte.
+ *
+ *  The times are what the application and the host add; they do not
+ *  include the line itself (86.8 us per byte at 115200 baud). Each run
+ *  also reports the CPU time the application thread used, as a share of
+ *  the run: the host's view of how busy the echo loop keeps the CPU.
+ *
+ *  --sweep runs the stream at the byte rates of 115200, 921600 and
+ *  3000000 baud lines and then as fast as the application takes it, and
+ *  ends with a table of the throughput, echo latency and CPU load of
+ *  each.
+ *
+ *  Before the stream, the harness sends "DUTY 42" and checks that the
+ *  PWM duty followed, and sends "DUTY 42" and "STATS" and checks that
+ *  each reply comes back after the echo of the command.
+ *
+ *  With --serve the harness only prints the pseudo-terminal name and
+ *  traces GPIO writes, for use with a terminal program or tools/bulkxfer.
+ *
+ *  Build (from the repository root):
+ *
+ *      cc -O2 -pthread -I tools/uart2echo_host -I uart2echo_CC3220SF_LAUNCHXL_nortos_gcc \
+ *          -o uart2echo_host tools/uart2echo_host/harness.c tools/uart2echo_host/shim.c \
+ *          uart2echo_CC3220SF_LAUNCHXL_nortos_gcc/uart2echo.c \
+ *          uart2echo_CC3220SF_LAUNCHXL_nortos_gcc/bulk.c \
+ *          uart2echo_CC3220SF_LAUNCHXL_nortos_gcc/numparse.c
+ *
+ *  Usage:  uart2echo_host [-r bytes/s] [-n bytes] [-c bytes per command] [-f file]
+ *          uart2echo_host --sweep [-n bytes] [-c bytes per command] [-f file]
+ *          uart2echo_host --serve
+ *
+ *  -r 0 writes as fast as the application takes the input.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <ti/drivers/PWM.h>
+
+#include "command_dfa.h"
+#include "shim.h"
+
+extern void *mainThread(void *arg0);
+
+/* What one run measured, for the --sweep table */
+typedef struct {
+    long rate;                  /* bytes/s offered, 0 = unlimited */
+    double bytesPerSecond;      /* echoed */
+    double echoP99;             /* us */
+    double cpuLoad;             /* application thread CPU time / run time */
+} RunResult;
+
+static pthread_t firmwareThread;
+
+/* Which keywords in commands.def drive the LED */
+static const struct {
+    const char *keyword;
+    const char *index;
+} commands[] = {
+#define COMMAND(name, keyword, index, level) { keyword, #index },
+#include "commands.def"
+#undef COMMAND
+};
+
+/*
+ *  ======== compare ========
+ */
+static int compare(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+ *  ======== threadCpuNs ========
+ *  CPU time the application thread has used.
+ */
+static uint64_t threadCpuNs(void)
+{
+    struct timespec ts;
+    clockid_t clock;
+
+    if (pthread_getcpuclockid(firmwareThread, &clock) != 0 || clock_gettime(clock, &ts) != 0)
+    {
+        return 0;
+    }
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ *  ======== printPercentiles ========
+ *  Sorts times[] (nanoseconds) in place and returns the 99th percentile.
+ */
+static uint64_t printPercentiles(const char *what, uint64_t *times, size_t count)
+{
+    static const double points[] = { 0.50, 0.90, 0.99, 0.999 };
+    size_t i;
+
+    if (count == 0)
+    {
+        printf("%-14s no samples\n", what);
+        return 0;
+    }
+    qsort(times, count, sizeof(times[0]), compare);
+    printf("%-14s n=%zu", what, count);
+    for (i = 0; i < sizeof(points) / sizeof(points[0]); i++)
+    {
+        size_t k = (size_t)(points[i] * count + 0.999999);
+        printf("  p%g %.1f us", points[i] * 100, times[(k > 0 ? k : 1) - 1] / 1e3);
+    }
+    printf("  max %.1f us\n", times[count - 1] / 1e3);
+    return times[(size_t)(0.99 * count + 0.999999) - 1];
+}
+
+/*
+ *  ======== generate ========
+ */
+static uint8_t *generate(size_t length, long perCommand)
+{
+    static const char filler[] = "abcdefghijklmnopqrstuvwxyz \r\n";
+    uint8_t *stream = malloc(length ? length : 1);
+    size_t i = 0;
+    int on = 1;
+
+    srand(1);
+    while (stream != NULL && i < length)
+    {
+        if (perCommand > 0 && rand() % perCommand == 0 && i + 4 <= length)
+        {
+            const char *keyword = on ? "ON" : "OFF";
+
+            memcpy(stream + i, keyword, strlen(keyword));
+            i += strlen(keyword);
+            on = !on;
+        }
+        stream[i++] = (uint8_t)filler[rand() % (sizeof(filler) - 1)];
+    }
+    return stream;
+}
+
+/*
+ *  ======== load ========
+ */
+static uint8_t *load(const char *name, size_t *length)
+{
+    FILE *f = fopen(name, "rb");
+    uint8_t *stream;
+    long size;
+
+    if (f == NULL || fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) < 0)
+    {
+        return NULL;
+    }
+    rewind(f);
+    stream = malloc(size ? (size_t)size : 1);
+    if (stream != NULL && fread(stream, 1, (size_t)size, f) != (size_t)size)
+    {
+        free(stream);
+        stream = NULL;
+    }
+    fclose(f);
+    *length = (size_t)size;
+    return stream;
+}
+
+/*
+ *  ======== findCommands ========
+ *  Runs the application's own recognizer over the stream and returns the
+ *  positions where an LED keyword ends, or -1 for a keyword the echo
+ *  match cannot handle.
+ */
+static long findCommands(const uint8_t *stream, size_t length, size_t *ends)
+{
+    uint8_t state = 0;
+    long count = 0;
+    size_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        uint8_t match;
+
+        state = commandDfaNext[state][commandDfaClass[stream[i]]];
+        match = commandDfaMatch[state];
+        if (match == 0)
+        {
+            continue;
+        }
+        if (strcmp(commands[match - 1].index, "CONFIG_GPIO_LED_0") != 0)
+        {
+            fprintf(stderr, "uart2echo_host: stream contains %s, which is not supported\n",
+                    commands[match - 1].keyword);
+            return -1;
+        }
+        ends[count++] = i;
+    }
+    return count;
+}
+
+/*
+ *  ======== waitForPrompt ========
+ *  Reads and drops the start-up message, the first time only.
+ */
+static void waitForPrompt(int fd)
+{
+    static int prompted = 0;
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    char buf[64];
+    int timeout = 2000;
+
+    if (prompted)
+    {
+        return;
+    }
+    prompted = 1;
+
+    while (poll(&pfd, 1, timeout) > 0 && read(fd, buf, sizeof(buf)) > 0)
+    {
+        timeout = 50;
+    }
+}
+
+/*
+ *  ======== collect ========
+ *  Reads output into buf, as a string, until the application has been
+ *  quiet for 100 ms. Returns its length.
+ */
+static size_t collect(int fd, char *buf, size_t size)
+{
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    size_t length = 0;
+    ssize_t n;
+
+    while (length < size - 1 && poll(&pfd, 1, 100) > 0
+           && (n = read(fd, buf + length, size - 1 - length)) > 0)
+    {
+        length += (size_t)n;
+    }
+    buf[length] = '\0';
+    return length;
+}
+
+/*
+ *  ======== checkStats ========
+ */
+static int checkStats(const char *pty)
+{
+    static const char command[] = "STATS\r";
+    static const char head[] = "STATS\r\nOVR=0 HWM=";
+    static const char tail[] = " FE=0\r\n\r";
+    int fd = open(pty, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    char reply[128];
+    size_t length;
+    int ok;
+
+    if (fd < 0)
+    {
+        perror("uart2echo_host: open");
+        return 1;
+    }
+    waitForPrompt(fd);
+    ok = write(fd, command, sizeof(command) - 1) == (ssize_t)(sizeof(command) - 1);
+    length = collect(fd, reply, sizeof(reply));
+    close(fd);
+
+    ok = ok && length >= sizeof(head) - 1 + sizeof(tail) - 1
+         && strncmp(reply, head, sizeof(head) - 1) == 0
+         && strcmp(reply + length - (sizeof(tail) - 1), tail) == 0;
+    printf("STATS replies after its echo: %s\n", ok ? "ok" : "FAILED");
+    if (!ok)
+    {
+        printf("  got \"%s\"\n", reply);
+    }
+    return !ok;
+}
+
+/*
+ *  ======== checkDuty ========
+ */
+static int checkDuty(const char *pty)
+{
+    static const char command[] = "DUTY 42\r";
+    static const char echo[] = "DUTY 42\r\r\nDUTY=42\r\n";
+    uint32_t expected = (uint32_t)((uint64_t)PWM_DUTY_FRACTION_MAX * 42 / 100);
+    int fd = open(pty, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    char reply[64];
+    int ok, ordered;
+
+    if (fd < 0)
+    {
+        perror("uart2echo_host: open");
+        return 1;
+    }
+    waitForPrompt(fd);
+    ok = write(fd, command, sizeof(command) - 1) == (ssize_t)(sizeof(command) - 1);
+    collect(fd, reply, sizeof(reply));
+    close(fd);
+
+    ok = ok && shim_pwmDuty() == expected;
+    printf("DUTY 42 sets the PWM duty: %s\n", ok ? "ok" : "FAILED");
+    ordered = strcmp(reply, echo) == 0;
+    printf("DUTY 42 replies after its echo: %s\n", ordered ? "ok" : "FAILED");
+    if (!ordered)
+    {
+        printf("  got \"%s\"\n", reply);
+    }
+    return !(ok && ordered);
+}
+
+/*
+ *  ======== run ========
+ */
+static int run(const char *pty, uint8_t *stream, size_t length, long rate, RunResult *result)
+{
+    uint64_t *sendTime = malloc((length + 1) * sizeof(uint64_t));
+    uint64_t *latency = malloc((length + 1) * sizeof(uint64_t));
+    size_t *ends = malloc((length + 1) * sizeof(size_t));
+    const ShimGpioEvent *events;
+    size_t firstEvent;
+    size_t eventCount;
+    size_t sent = 0;
+    size_t received = 0;
+    size_t mismatched = 0;
+    uint64_t start;
+    uint64_t last;
+    uint64_t cpuStart;
+    long commandCount;
+    long k;
+    int fd;
+
+    if (sendTime == NULL || latency == NULL || ends == NULL)
+    {
+        return 1;
+    }
+    commandCount = findCommands(stream, length, ends);
+    if (commandCount < 0)
+    {
+        return 1;
+    }
+
+    fd = open(pty, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0)
+    {
+        perror("uart2echo_host: open");
+        return 1;
+    }
+    waitForPrompt(fd);
+    firstEvent = shim_gpioEvents(&events);
+
+    cpuStart = threadCpuNs();
+    start = shim_nowNs();
+    last = start;
+    while (received < length)
+    {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        struct timespec wait = { 2, 0 };
+        uint64_t now = shim_nowNs();
+        uint8_t buf[4096];
+        ssize_t n;
+
+        if (sent < length)
+        {
+            size_t due = length;
+
+            if (rate > 0)
+            {
+                due = (size_t)((now - start) * (double)rate / 1e9) + 1;
+                due = (due < length) ? due : length;
+            }
+            if (due > sent)
+            {
+                n = write(fd, stream + sent, due - sent);
+                while (n > 0)
+                {
+                    sendTime[sent++] = now;
+                    n--;
+                }
+            }
+            wait.tv_sec = 0;
+            wait.tv_nsec = (rate > 0) ? 1000000000L / rate : 100000;
+            if (wait.tv_nsec > 1000000)
+            {
+                wait.tv_nsec = 1000000;
+            }
+        }
+
+        if (ppoll(&pfd, 1, &wait, NULL) == 0 && sent == length)
+        {
+            break;              /* nothing more is coming back */
+        }
+        n = read(fd, buf, sizeof(buf));
+        now = shim_nowNs();
+        for (k = 0; k < n && received < sent; k++)
+        {
+            mismatched += (buf[k] != stream[received]);
+            latency[received] = now - sendTime[received];
+            received++;
+        }
+        if (n > 0)
+        {
+            last = now;
+        }
+    }
+
+    result->rate = rate;
+    result->bytesPerSecond = received / ((last - start) / 1e9 + 1e-9);
+    result->cpuLoad = (threadCpuNs() - cpuStart) / ((last - start) + 1e-9);
+    close(fd);
+
+    printf("%zu bytes sent, %zu echoed (%zu different) in %.3f s, %.0f bytes/s\n",
+           sent, received, mismatched, (last - start) / 1e9, result->bytesPerSecond);
+    printf("%-14s %.1f%% of the run\n", "CPU", result->cpuLoad * 100);
+    result->echoP99 = printPercentiles("echo", latency, received) / 1e3;
+
+    // The k-th LED keyword goes with the k-th GPIO write after the start.
+    eventCount = shim_gpioEvents(&events) - firstEvent;
+    for (k = 0; k < commandCount && (size_t)k < eventCount; k++)
+    {
+        latency[k] = events[firstEvent + k].time - sendTime[ends[k]];
+    }
+    printPercentiles("command->LED", latency, (size_t)k);
+    if ((size_t)commandCount != eventCount)
+    {
+        printf("%ld LED keywords sent, %zu GPIO writes seen\n", commandCount, eventCount);
+        return 1;
+    }
+    return mismatched != 0 || received != length;
+}
+
+/*
+ *  ======== sweep ========
+ */
+static int sweep(const char *pty, uint8_t *stream, size_t length)
+{
+    static const long bauds[] = { 115200, 921600, 3000000, 0 };
+    RunResult results[sizeof(bauds) / sizeof(bauds[0])];
+    size_t i;
+    int failed = 0;
+
+    for (i = 0; i < sizeof(bauds) / sizeof(bauds[0]); i++)
+    {
+        if (bauds[i] != 0)
+        {
+            printf("\n%ld baud, %ld bytes/s\n", bauds[i], bauds[i] / 10);
+        }
+        else
+        {
+            printf("\nunlimited\n");
+        }
+        failed |= run(pty, stream, length, bauds[i] / 10, &results[i]);
+    }
+
+    printf("\n%-12s %12s %12s %12s %8s\n", "line", "offered", "echoed", "echo p99", "CPU");
+    for (i = 0; i < sizeof(bauds) / sizeof(bauds[0]); i++)
+    {
+        char line[16];
+        char offered[16];
+
+        if (results[i].rate != 0)
+        {
+            snprintf(line, sizeof(line), "%ld", bauds[i]);
+            snprintf(offered, sizeof(offered), "%ld", results[i].rate);
+        }
+        else
+        {
+            snprintf(line, sizeof(line), "unlimited");
+            snprintf(offered, sizeof(offered), "-");
+        }
+        printf("%-12s %12s %12.0f %9.1f us %7.1f%%\n", line, offered,
+               results[i].bytesPerSecond, results[i].echoP99, results[i].cpuLoad * 100);
+    }
+    return failed;
+}
+
+/*
+ *  ======== firmware ========
+ */
+static void *firmware(void *arg)
+{
+    return mainThread(arg);
+}
+
+/*
+ *  ======== main ========
+ */
+int main(int argc, char *argv[])
+{
+    RunResult result;
+    const char *file = NULL;
+    const char *pty;
+    uint8_t *stream;
+    size_t length = 100000;
+    long rate = 11520;          /* bytes/s of a 115200 baud line */
+    long perCommand = 100;
+    int serve = 0;
+    int sweeping = 0;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--serve") == 0)
+        {
+            serve = 1;
+        }
+        else if (strcmp(argv[i], "--sweep") == 0)
+        {
+            sweeping = 1;
+        }
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+        {
+            rate = atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            length = (size_t)atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+        {
+            perCommand = atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+        {
+            file = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [-r bytes/s] [-n bytes] [-c bytes per command] [-f file]\n"
+                            "       %s --sweep [-n bytes] [-c bytes per command] [-f file]\n"
+                            "       %s --serve\n", argv[0], argv[0], argv[0]);
+            return 2;
+        }
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    if (serve)
+    {
+        shim_traceGpio(1);
+    }
+    if (pthread_create(&firmwareThread, NULL, firmware, NULL) != 0)
+    {
+        return 1;
+    }
+    pty = shim_waitForUart();
+
+    if (serve)
+    {
+        printf("uart2echo on %s\n", pty);
+        fflush(stdout);
+        pthread_join(firmwareThread, NULL);
+        return 0;
+    }
+
+    stream = (file != NULL) ? load(file, &length) : generate(length, perCommand);
+    if (stream == NULL)
+    {
+        fprintf(stderr, "uart2echo_host: cannot read %s\n", file ? file : "input");
+        return 1;
+    }
+    if (checkDuty(pty) != 0 || checkStats(pty) != 0)
+    {
+        return 1;
+    }
+    if (sweeping)
+    {
+        return sweep(pty, stream, length);
+    }
+    return run(pty, stream, length, rate, &result);
+}
@@ -0,0 +1,336 @@
+/*
+ *  ======== shim.c ========
+ *
+ *  Host stand-ins for the TI GPIO, PWM and UART2 drivers, enough to run
+ *  uart2echo.c unchanged on Linux. The UART is the master side of a
+ *  pseudo-terminal; GPIO writes are time stamped and kept in memory, and
+ *  the PWM only remembers its duty.
+ */
+
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <ti/drivers/GPIO.h>
+#include <ti/drivers/PWM.h>
+#include <ti/drivers/UART2.h>
+
+#include "shim.h"
+
+struct UART2_Config_ {
+    int fd;
+    UART2_Params params;
+};
+
+struct PWM_Config_ {
+    PWM_Params params;
+    uint32_t duty;
+};
+
+static struct UART2_Config_ uartObject;
+static struct PWM_Config_ pwmObject;
+static char ptyName[64];
+static int uartOpen = 0;
+
+static ShimGpioEvent events[SHIM_MAX_EVENTS];
+static size_t eventCount = 0;
+static int traceGpio = 0;
+static unsigned int levels[256];
+
+/*
+ *  ======== shim_nowNs ========
+ */
+uint64_t shim_nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ *  ======== shim_waitForUart ========
+ */
+const char *shim_waitForUart(void)
+{
+    struct timespec ms = { 0, 1000000 };
+
+    while (!__atomic_load_n(&uartOpen, __ATOMIC_ACQUIRE))
+    {
+        nanosleep(&ms, NULL);
+    }
+    return ptyName;
+}
+
+/*
+ *  ======== shim_gpioEvents ========
+ */
+size_t shim_gpioEvents(const ShimGpioEvent **list)
+{
+    *list = events;
+    return __atomic_load_n(&eventCount, __ATOMIC_ACQUIRE);
+}
+
+/*
+ *  ======== shim_pwmDuty ========
+ */
+uint32_t shim_pwmDuty(void)
+{
+    return __atomic_load_n(&pwmObject.duty, __ATOMIC_ACQUIRE);
+}
+
+/*
+ *  ======== shim_traceGpio ========
+ */
+void shim_traceGpio(int on)
+{
+    traceGpio = on;
+}
+
+/*
+ *  ======== GPIO ========
+ */
+void GPIO_init(void)
+{
+}
+
+int_fast16_t GPIO_setConfig(uint_least8_t index, GPIO_PinConfig pinConfig)
+{
+    levels[index] = (pinConfig & GPIO_CFG_OUT_HIGH) ? 1 : 0;
+    return 0;
+}
+
+void GPIO_write(uint_least8_t index, unsigned int value)
+{
+    size_t n = eventCount;
+
+    levels[index] = value;
+    if (n < SHIM_MAX_EVENTS)
+    {
+        events[n].time = shim_nowNs();
+        events[n].index = (uint8_t)index;
+        events[n].level = (uint8_t)value;
+        __atomic_store_n(&eventCount, n + 1, __ATOMIC_RELEASE);
+    }
+    if (traceGpio)
+    {
+        printf("%.6f GPIO %u = %u\n", shim_nowNs() / 1e9, (unsigned)index, value);
+        fflush(stdout);
+    }
+}
+
+uint_fast8_t GPIO_read(uint_least8_t index)
+{
+    return (uint_fast8_t)levels[index];
+}
+
+/*
+ *  ======== PWM ========
+ */
+void PWM_init(void)
+{
+}
+
+void PWM_Params_init(PWM_Params *params)
+{
+    memset(params, 0, sizeof(*params));
+    params->periodUnits = PWM_PERIOD_HZ;
+    params->periodValue = 1000000;
+    params->dutyUnits = PWM_DUTY_FRACTION;
+}
+
+PWM_Handle PWM_open(uint_least8_t index, PWM_Params *params)
+{
+    (void)index;
+    pwmObject.params = *params;
+    pwmObject.duty = params->dutyValue;
+    return &pwmObject;
+}
+
+int_fast16_t PWM_start(PWM_Handle handle)
+{
+    (void)handle;
+    return PWM_STATUS_SUCCESS;
+}
+
+int_fast16_t PWM_setDuty(PWM_Handle handle, uint32_t duty)
+{
+    __atomic_store_n(&handle->duty, duty, __ATOMIC_RELEASE);
+    if (traceGpio)
+    {
+        printf("%.6f PWM duty = %u\n", shim_nowNs() / 1e9, (unsigned)duty);
+        fflush(stdout);
+    }
+    return PWM_STATUS_SUCCESS;
+}
+
+/*
+ *  ======== UART2_Params_init ========
+ */
+void UART2_Params_init(UART2_Params *params)
+{
+    memset(params, 0, sizeof(*params));
+    params->readMode = UART2_Mode_BLOCKING;
+    params->writeMode = UART2_Mode_BLOCKING;
+    params->readReturnMode = UART2_ReadReturnMode_FULL;
+    params->baudRate = 115200;
+    params->dataLength = UART2_DataLen_8;
+}
+
+/*
+ *  ======== UART2_open ========
+ *  The slave side is opened once and kept open so the master never sees
+ *  a hang-up while no client is connected.
+ */
+UART2_Handle UART2_open(uint_least8_t index, UART2_Params *params)
+{
+    struct termios tio;
+    int fd;
+
+    (void)index;
+    if (params->readMode != UART2_Mode_BLOCKING || params->writeMode != UART2_Mode_BLOCKING)
+    {
+        fprintf(stderr, "shim: only blocking UART2 modes are implemented\n");
+        return NULL;
+    }
+
+    fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0)
+    {
+        return NULL;
+    }
+    snprintf(ptyName, sizeof(ptyName), "%s", ptsname(fd));
+    if (open(ptyName, O_RDWR | O_NOCTTY) < 0 || tcgetattr(fd, &tio) != 0)
+    {
+        return NULL;
+    }
+    cfmakeraw(&tio);
+    tcsetattr(fd, TCSANOW, &tio);
+
+    uartObject.fd = fd;
+    uartObject.params = *params;
+    __atomic_store_n(&uartOpen, 1, __ATOMIC_RELEASE);
+    return &uartObject;
+}
+
+/*
+ *  ======== UART2_close ========
+ */
+void UART2_close(UART2_Handle handle)
+{
+    close(handle->fd);
+    handle->fd = -1;
+}
+
+/*
+ *  ======== UART2_readTimeout ========
+ */
+int_fast16_t UART2_readTimeout(UART2_Handle handle, void *buffer, size_t size,
+                               size_t *bytesRead, uint32_t timeout)
+{
+    uint8_t *p = buffer;
+    size_t count = 0;
+
+    while (count < size)
+    {
+        struct pollfd pfd = { handle->fd, POLLIN, 0 };
+        int wait = (timeout == UART2_WAIT_FOREVER) ? -1 : (int)timeout;
+        ssize_t n;
+
+        if (count > 0 && handle->params.readReturnMode == UART2_ReadReturnMode_PARTIAL)
+        {
+            wait = 0;           /* take only what is already here */
+        }
+        if (poll(&pfd, 1, wait) <= 0)
+        {
+            break;
+        }
+        n = read(handle->fd, p + count, size - count);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            break;
+        }
+        count += (size_t)n;
+    }
+
+    if (bytesRead != NULL)
+    {
+        *bytesRead = count;
+    }
+    return (count == size || (count > 0 && handle->params.readReturnMode
+                                           == UART2_ReadReturnMode_PARTIAL))
+           ? UART2_STATUS_SUCCESS : UART2_STATUS_ETIMEOUT;
+}
+
+/*
+ *  ======== UART2_read ========
+ */
+int_fast16_t UART2_read(UART2_Handle handle, void *buffer, size_t size, size_t *bytesRead)
+{
+    return UART2_readTimeout(handle, buffer, size, bytesRead, UART2_WAIT_FOREVER);
+}
+
+/*
+ *  ======== UART2_write ========
+ */
+int_fast16_t UART2_write(UART2_Handle handle, const void *buffer, size_t size,
+                         size_t *bytesWritten)
+{
+    const uint8_t *p = buffer;
+    size_t count = 0;
+
+    while (count < size)
+    {
+        ssize_t n = write(handle->fd, p + count, size - count);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            break;
+        }
+        count += (size_t)n;
+    }
+
+    if (bytesWritten != NULL)
+    {
+        *bytesWritten = count;
+    }
+    return (count == size) ? UART2_STATUS_SUCCESS : UART2_STATUS_EFAIL;
+}
+
+/*
+ *  ======== UART2_getRxCount ========
+ */
+size_t UART2_getRxCount(UART2_Handle handle)
+{
+    int count = 0;
+
+    ioctl(handle->fd, FIONREAD, &count);
+    return (size_t)count;
+}
+
+/*
+ *  ======== UART2_getOverrunCount ========
+ *  A pseudo-terminal applies back pressure instead of overrunning.
+ */
+uint32_t UART2_getOverrunCount(UART2_Handle handle)
+{
+    (void)handle;
+    return 0;
+}
@@ -0,0 +1,55 @@
+/*
+ *  ======== shim.h ========
+ *
+ *  What the host harness can see of the uart2echo driver stand-ins.
+ */
+
+#ifndef SHIM_H_
+#define SHIM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHIM_MAX_EVENTS 65536
+
+/* One GPIO_write() call */
+typedef struct {
+    uint64_t time;              /* shim_nowNs() */
+    uint8_t index;
+    uint8_t level;
+} ShimGpioEvent;
+
+/*
+ *  ======== shim_nowNs ========
+ *  Monotonic time in nanoseconds; the clock used for every time stamp.
+ */
+uint64_t shim_nowNs(void);
+
+/*
+ *  ======== shim_waitForUart ========
+ *  Waits until the application has opened its UART and returns the name
+ *  of the pseudo-terminal the other end is on.
+ */
+const char *shim_waitForUart(void);
+
+/*
+ *  ======== shim_gpioEvents ========
+ *  Returns the number of GPIO writes recorded so far (at most
+ *  SHIM_MAX_EVENTS) and points *events at them.
+ */
+size_t shim_gpioEvents(const ShimGpioEvent **events);
+
+/*
+ *  ======== shim_pwmDuty ========
+ *  The duty last set on the PWM, in the units it was opened with.
+ */
+uint32_t shim_pwmDuty(void);
+
+/*
+ *  ======== shim_traceGpio ========
+ *  With on set, also prints every GPIO write and PWM duty change to
+ *  stdout as it happens.
+ */
+void shim_traceGpio(int on);
+
+#endif /* SHIM_H_ */
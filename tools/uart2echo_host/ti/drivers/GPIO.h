@@ -0,0 +1,24 @@
+/*
+ *  ======== GPIO.h ========
+ *
+ *  Host stand-in for the parts of the TI GPIO driver that uart2echo uses.
+ *  Writes are recorded with a time stamp (see shim.h).
+ */
+
+#ifndef ti_drivers_GPIO__include
+#define ti_drivers_GPIO__include
+
+#include <stdint.h>
+
+typedef uint32_t GPIO_PinConfig;
+
+#define GPIO_CFG_OUT_STD  0x0001
+#define GPIO_CFG_OUT_LOW  0x0000
+#define GPIO_CFG_OUT_HIGH 0x0002
+
+void GPIO_init(void);
+int_fast16_t GPIO_setConfig(uint_least8_t index, GPIO_PinConfig pinConfig);
+void GPIO_write(uint_least8_t index, unsigned int value);
+uint_fast8_t GPIO_read(uint_least8_t index);
+
+#endif /* ti_drivers_GPIO__include */
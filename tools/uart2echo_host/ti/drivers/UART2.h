@@ -0,0 +1,80 @@
+/*
+ *  ======== UART2.h ========
+ *
+ *  Host stand-in for the parts of the TI UART2 driver that uart2echo uses,
+ *  backed by a pseudo-terminal (see shim.c). Only blocking reads and
+ *  writes are implemented; timeouts are in milliseconds.
+ */
+
+#ifndef ti_drivers_UART2__include
+#define ti_drivers_UART2__include
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct UART2_Config_ *UART2_Handle;
+
+typedef void (*UART2_Callback)(UART2_Handle handle, void *buf, size_t count,
+                               void *userArg, int_fast16_t status);
+
+typedef enum {
+    UART2_Mode_BLOCKING,
+    UART2_Mode_CALLBACK,
+    UART2_Mode_NONBLOCKING
+} UART2_Mode;
+
+typedef enum {
+    UART2_ReadReturnMode_FULL,
+    UART2_ReadReturnMode_PARTIAL
+} UART2_ReadReturnMode;
+
+typedef enum {
+    UART2_DataLen_5,
+    UART2_DataLen_6,
+    UART2_DataLen_7,
+    UART2_DataLen_8
+} UART2_DataLen;
+
+typedef enum {
+    UART2_StopBits_1,
+    UART2_StopBits_2
+} UART2_StopBits;
+
+typedef enum {
+    UART2_Parity_NONE,
+    UART2_Parity_EVEN,
+    UART2_Parity_ODD
+} UART2_Parity;
+
+typedef struct {
+    UART2_Mode readMode;
+    UART2_Mode writeMode;
+    UART2_Callback readCallback;
+    UART2_Callback writeCallback;
+    UART2_ReadReturnMode readReturnMode;
+    uint32_t baudRate;
+    UART2_DataLen dataLength;
+    UART2_StopBits stopBits;
+    UART2_Parity parityType;
+    void *userArg;
+} UART2_Params;
+
+#define UART2_STATUS_SUCCESS  (0)
+#define UART2_STATUS_EFAIL    (-1)
+#define UART2_STATUS_EFRAMING (-2)
+#define UART2_STATUS_ETIMEOUT (-8)
+
+#define UART2_WAIT_FOREVER    (~(0U))
+
+void UART2_Params_init(UART2_Params *params);
+UART2_Handle UART2_open(uint_least8_t index, UART2_Params *params);
+void UART2_close(UART2_Handle handle);
+int_fast16_t UART2_read(UART2_Handle handle, void *buffer, size_t size, size_t *bytesRead);
+int_fast16_t UART2_readTimeout(UART2_Handle handle, void *buffer, size_t size,
+                               size_t *bytesRead, uint32_t timeout);
+int_fast16_t UART2_write(UART2_Handle handle, const void *buffer, size_t size,
+                         size_t *bytesWritten);
+size_t UART2_getRxCount(UART2_Handle handle);
+uint32_t UART2_getOverrunCount(UART2_Handle handle);
+
+#endif /* ti_drivers_UART2__include */
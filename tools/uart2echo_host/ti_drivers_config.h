@@ -0,0 +1,23 @@
+/*
+ *  ======== ti_drivers_config.h ========
+ *
+ *  Host stand-in for the SysConfig generated configuration of the
+ *  uart2echo example (see shim.c).
+ */
+
+#ifndef TI_DRIVERS_CONFIG_H_
+#define TI_DRIVERS_CONFIG_H_
+
+#include <stdint.h>
+
+#define CONFIG_GPIO_LED_0   0
+#define CONFIG_GPIO_COUNT   1
+
+#define CONFIG_GPIO_LED_ON  (1)
+#define CONFIG_GPIO_LED_OFF (0)
+
+#define CONFIG_UART2_0      0
+
+#define CONFIG_PWM_0        0
+
+#endif /* TI_DRIVERS_CONFIG_H_ */
@@ -0,0 +1,508 @@
+/*
+ *  ======== waveformcheck.c ========
+ *
+ *  Checks pwmled2's waveform engine (waveform.c) on the host, with the
+ *  Timer and PWM drivers replaced by stand-ins, and times its updates
+ *  against the usleep() loop it replaced:
+ *
+ *      steps       25 ms steps on 3 ms ticks, as pwmled2.c sets them up:
+ *                  each step comes at the first tick at or after its
+ *                  time, so 3 s of ticks hold 120 steps, not 125 at 24 ms
+ *      fast        steps shorter than a tick come one per tick
+ *      direct      with no update period the timer ticks once per step
+ *      oneshot     a one-shot table leaves its last entry on the output
+ *                  and stops the timer
+ *
+ *  For the checks the timer is stepped by hand. For the timing it runs
+ *  in a thread that sleeps to absolute deadlines, as a hardware timer
+ *  counts whatever the CPU is doing, and the cycle counter is the host
+ *  clock in 80 MHz cycles. The sweep is then stepped for -n steps three
+ *  ways, each timed with waveform_timingMark() as on the LaunchPad:
+ *
+ *      usleep      mainThread's SWEEP_USLEEP loop: mark, write, usleep()
+ *      engine      the engine with a tick per step
+ *      dithered    the engine with 3 ms ticks, as pwmled2.c runs it; the
+ *                  intervals are between ticks
+ *
+ *  and the shortest, longest and mean interval of each is printed. The
+ *  host's scheduling is far noisier than the CC3220's interrupts, so the
+ *  spread is only a bound, but the usleep() loop's mean shows its drift:
+ *  every interval is the sleep plus the loop's work and wake-up delay,
+ *  while the timer's deadlines do not move.
+ *
+ *  Build:  cc -O2 -pthread -I tools/pwmled2_host -I pwmled2_CC3220SF_LAUNCHXL_nortos_gcc \
+ *              -o waveformcheck tools/waveformcheck.c
+ *  Usage:  ./waveformcheck [-n steps]
+ */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <ti/drivers/PWM.h>
+#include <ti/drivers/Timer.h>
+#include <ti/drivers/dpl/HwiP.h>
+
+/* waveform.c is built here with the cycle counter on the host clock */
+static uint32_t hostCycles(void);
+#define CYCLES_H_
+#define CYCLES_ENABLE() do { } while (0)
+#define CYCLES_NOW()    hostCycles()
+#include "waveform.c"
+#include "dither.c"
+
+#define COUNTS_PER_US   80
+#define STEP_US         25000       /* as in pwmled2.c */
+#define RATE_HZ         (1000000 / STEP_US)
+#define PERIOD_US       3000
+#define MAX_WRITES      4096
+
+struct Timer_Config_ {
+    Timer_CallBackFxn callback;
+    uint64_t periodNs;
+    int running;
+    int threaded;               // ticks from a thread, not by hand
+    pthread_t thread;
+};
+
+struct PWM_Config_ {
+    uint32_t duty;
+    unsigned int writes;
+    uint32_t writeTicks[MAX_WRITES];    // tick of each write, 0 for before any
+};
+
+static struct Timer_Config_ timer;
+static struct PWM_Config_ led;
+static pthread_mutex_t interrupts = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t ticksRun = 0;
+static int threadedTimer = 0;
+
+/*
+ *  ======== hostCycles ========
+ */
+static uint32_t hostCycles(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec)
+                      * COUNTS_PER_US / 1000);
+}
+
+/*
+ *  ======== HwiP_disable ========
+ *  Holds off the timer thread.
+ */
+uintptr_t HwiP_disable(void)
+{
+    pthread_mutex_lock(&interrupts);
+    return 0;
+}
+
+/*
+ *  ======== HwiP_restore ========
+ */
+void HwiP_restore(uintptr_t key)
+{
+    (void)key;
+    pthread_mutex_unlock(&interrupts);
+}
+
+/*
+ *  ======== PWM_setDuty ========
+ */
+int_fast16_t PWM_setDuty(PWM_Handle handle, uint32_t duty)
+{
+    handle->duty = duty;
+    if (handle->writes < MAX_WRITES)
+    {
+        handle->writeTicks[handle->writes] = ticksRun;
+    }
+    handle->writes++;
+    return PWM_STATUS_SUCCESS;
+}
+
+/*
+ *  ======== pwmgroup_stageDuty ========
+ *  No group is set here.
+ */
+void pwmgroup_stageDuty(PwmGroup *g, unsigned int member, uint32_t duty)
+{
+    (void)g;
+    (void)member;
+    (void)duty;
+}
+
+/*
+ *  ======== pwmgroup_commit ========
+ */
+void pwmgroup_commit(PwmGroup *g)
+{
+    (void)g;
+}
+
+/*
+ *  ======== Timer_init ========
+ */
+void Timer_init(void)
+{
+}
+
+/*
+ *  ======== Timer_Params_init ========
+ */
+void Timer_Params_init(Timer_Params *params)
+{
+    memset(params, 0, sizeof(*params));
+}
+
+/*
+ *  ======== Timer_setPeriod ========
+ */
+int32_t Timer_setPeriod(Timer_Handle handle, Timer_PeriodUnits periodUnits, uint32_t period)
+{
+    if (period == 0)
+    {
+        return Timer_STATUS_ERROR;
+    }
+    handle->periodNs = (periodUnits == Timer_PERIOD_HZ) ? 1000000000u / period
+                                                        : (uint64_t)period * 1000;
+    return Timer_STATUS_SUCCESS;
+}
+
+/*
+ *  ======== Timer_open ========
+ */
+Timer_Handle Timer_open(uint_least8_t index, Timer_Params *params)
+{
+    (void)index;
+    memset(&timer, 0, sizeof(timer));
+    timer.callback = params->timerCallback;
+    timer.threaded = threadedTimer;
+    return (Timer_setPeriod(&timer, params->periodUnits, params->period) == Timer_STATUS_SUCCESS)
+           ? &timer : NULL;
+}
+
+/*
+ *  ======== timerThread ========
+ *  Ticks at absolute deadlines, a period apart, until the timer stops.
+ */
+static void *timerThread(void *arg)
+{
+    Timer_Handle handle = arg;
+    struct timespec next;
+    int running = 1;
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (running)
+    {
+        uint64_t ns = (uint64_t)next.tv_nsec + handle->periodNs;
+
+        next.tv_sec += (time_t)(ns / 1000000000u);
+        next.tv_nsec = (long)(ns % 1000000000u);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) != 0)
+        {
+        }
+
+        pthread_mutex_lock(&interrupts);
+        ticksRun++;
+        handle->callback(handle, 0);
+        running = handle->running;
+        pthread_mutex_unlock(&interrupts);
+    }
+    return NULL;
+}
+
+/*
+ *  ======== Timer_start ========
+ *  Called with interrupts off.
+ */
+int32_t Timer_start(Timer_Handle handle)
+{
+    if (handle->running)
+    {
+        return Timer_STATUS_ERROR;
+    }
+    handle->running = 1;
+    if (handle->threaded && pthread_create(&handle->thread, NULL, timerThread, handle) != 0)
+    {
+        handle->running = 0;
+        return Timer_STATUS_ERROR;
+    }
+    return Timer_STATUS_SUCCESS;
+}
+
+/*
+ *  ======== Timer_stop ========
+ *  Called from the callback; a timer thread ends after it.
+ */
+void Timer_stop(Timer_Handle handle)
+{
+    handle->running = 0;
+}
+
+/*
+ *  ======== tick ========
+ *  One timer period by hand. Returns 0 if the timer is not running.
+ */
+static int tick(void)
+{
+    if (!timer.running)
+    {
+        return 0;
+    }
+    ticksRun++;
+    timer.callback(&timer, 0);
+    return 1;
+}
+
+/*
+ *  ======== counting ========
+ *  A table whose entry is its index, so each write shows the step.
+ */
+static uint32_t counting[MAX_WRITES];
+
+static void initCounting(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < MAX_WRITES; i++)
+    {
+        counting[i] = i;
+    }
+}
+
+/*
+ *  ======== checkSteps ========
+ *  Runs ticks ticks of periodUs with steps at rate, and checks that step
+ *  k is written at the first tick at or after k steps' time, and at most
+ *  one step per tick.
+ */
+static int checkSteps(uint32_t rate, uint32_t periodUs, uint32_t ticks, uint32_t expectedSteps)
+{
+    uint32_t k;
+
+    initCounting();
+    if (!waveform_init(0, rate) || !waveform_setUpdatePeriod(periodUs))
+    {
+        printf("  timer did not open\n");
+        return 0;
+    }
+    waveform_play(0, &led, counting, MAX_WRITES, WAVEFORM_LOOP);
+    while (ticksRun < ticks && tick())
+    {
+    }
+
+    if (led.writes != expectedSteps + 1)
+    {
+        printf("  %u steps in %u ticks, expected %u\n", led.writes - 1, ticks, expectedSteps);
+        return 0;
+    }
+    for (k = 1; k < led.writes; k++)
+    {
+        // First tick t with t * periodUs >= k * step, at least one per step
+        uint64_t stepNs = 1000000000u / rate;
+        uint64_t due = ((uint64_t)k * stepNs + (uint64_t)periodUs * 1000 - 1)
+                       / ((uint64_t)periodUs * 1000);
+
+        if (due < k)
+        {
+            due = k;
+        }
+        if (led.writeTicks[k] != due)
+        {
+            printf("  step %u at tick %u, expected %u\n", k, led.writeTicks[k], (unsigned int)due);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ *  ======== testSteps ========
+ */
+static int testSteps(void)
+{
+    // 1000 ticks of 3 ms, 3 s: 120 steps of 25 ms
+    return checkSteps(RATE_HZ, PERIOD_US, 1000, 1000 * PERIOD_US / STEP_US);
+}
+
+/*
+ *  ======== testFast ========
+ */
+static int testFast(void)
+{
+    // 1 ms steps on 3 ms ticks
+    return checkSteps(1000, PERIOD_US, 100, 100);
+}
+
+/*
+ *  ======== testDirect ========
+ */
+static int testDirect(void)
+{
+    initCounting();
+    if (!waveform_init(0, RATE_HZ))
+    {
+        return 0;
+    }
+    waveform_play(0, &led, counting, MAX_WRITES, WAVEFORM_LOOP);
+    while (ticksRun < 50 && tick())
+    {
+    }
+    return timer.periodNs == (uint64_t)STEP_US * 1000 && led.writes == 51
+           && led.writeTicks[50] == 50 && led.duty == 50;
+}
+
+/*
+ *  ======== testOneshot ========
+ */
+static int testOneshot(void)
+{
+    static const uint32_t table[] = { 10, 20, 30, 40, 50 };
+
+    if (!waveform_init(0, RATE_HZ))
+    {
+        return 0;
+    }
+    waveform_play(0, &led, table, 5, WAVEFORM_ONESHOT);
+    while (ticksRun < 100 && tick())
+    {
+    }
+    return ticksRun == 4 && !timer.running && led.writes == 5 && led.duty == 50
+           && waveform_isDone(0);
+}
+
+/*
+ *  ======== printTiming ========
+ */
+static void printTiming(const char *name, const WaveformTiming *t)
+{
+    if (t->intervals == 0)
+    {
+        printf("%-10s no intervals\n", name);
+        return;
+    }
+    printf("%-10s n=%-4u min %8.3f ms  max %8.3f ms  mean %9.4f ms  jitter %7.3f ms\n", name,
+           t->intervals, t->minCycles / (COUNTS_PER_US * 1000.0),
+           t->maxCycles / (COUNTS_PER_US * 1000.0),
+           (double)t->totalCycles / t->intervals / (COUNTS_PER_US * 1000.0),
+           (t->maxCycles - t->minCycles) / (COUNTS_PER_US * 1000.0));
+}
+
+/*
+ *  ======== timeUsleep ========
+ *  The SWEEP_USLEEP loop of pwmled2.c.
+ */
+static void timeUsleep(unsigned int steps)
+{
+    WaveformTiming t;
+    unsigned int step;
+
+    initCounting();
+    waveform_timingStart(&t);
+    for (step = 0; step <= steps; step++)
+    {
+        waveform_timingMark(&t);
+        PWM_setDuty(&led, counting[step % MAX_WRITES]);
+        usleep(STEP_US);
+    }
+    printTiming("usleep", &t);
+}
+
+/*
+ *  ======== timeEngine ========
+ *  Plays for steps steps, with ticks of periodUs (0: a tick per step) and
+ *  dithered if fractionBits is above 0.
+ */
+static void timeEngine(const char *name, unsigned int steps, uint32_t periodUs, uint8_t fractionBits)
+{
+    WaveformTiming t;
+
+    initCounting();
+    threadedTimer = 1;
+    if (!waveform_init(0, RATE_HZ) || !waveform_setUpdatePeriod(periodUs))
+    {
+        printf("%-10s timer did not open\n", name);
+        return;
+    }
+    waveform_setDither(0, fractionBits);
+    waveform_play(0, &led, counting, MAX_WRITES, WAVEFORM_LOOP);
+
+    // Look at how far it has got only now and then, as pwmled2.c does
+    while (1)
+    {
+        usleep(STEP_US);
+        waveform_getTiming(&t);
+        if (t.intervals >= steps * (periodUs ? (STEP_US + periodUs - 1) / periodUs : 1))
+        {
+            break;
+        }
+    }
+    waveform_stop(0);
+    pthread_join(timer.thread, NULL);
+    printTiming(name, &t);
+}
+
+/*
+ *  ======== run ========
+ *  Each check runs in a child process, as waveform.c keeps its state in
+ *  statics.
+ */
+static int run(const char *name, const char *description, int (*test)(void))
+{
+    int status;
+    pid_t child;
+
+    fflush(stdout);
+    child = fork();
+    if (child < 0)
+    {
+        perror("waveformcheck: fork");
+        exit(2);
+    }
+    if (child == 0)
+    {
+        exit(test() ? 0 : 1);
+    }
+    waitpid(child, &status, 0);
+
+    status = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    printf("%-10s %-40s %s\n", name, description, status ? "ok" : "FAILED");
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int steps = 80;
+    int ok = 1;
+
+    if (argc == 3 && strcmp(argv[1], "-n") == 0)
+    {
+        steps = (unsigned int)strtoul(argv[2], NULL, 0);
+    }
+    else if (argc != 1)
+    {
+        fprintf(stderr, "usage: waveformcheck [-n steps]\n");
+        return 2;
+    }
+
+    ok &= run("steps", "25 ms steps on 3 ms ticks", testSteps);
+    ok &= run("fast", "1 ms steps on 3 ms ticks", testFast);
+    ok &= run("direct", "a tick per step", testDirect);
+    ok &= run("oneshot", "five entries, then stop", testOneshot);
+
+    printf("\nUpdate intervals over %u steps of %d ms:\n", steps, STEP_US / 1000);
+    fflush(stdout);
+    timeUsleep(steps);
+    timeEngine("engine", steps, 0, 0);
+    timeEngine("dithered", steps, PERIOD_US, 4);
+    return ok ? 0 : 1;
+}
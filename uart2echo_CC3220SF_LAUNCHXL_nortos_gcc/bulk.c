@@ -0,0 +1,335 @@
+/*
+ *  ======== bulk.c ========
+ *
+ *  Sliding window bulk transfer protocol. See bulk.h.
+ */
+
+#include <string.h>
+
+#include "bulk.h"
+
+#define FLAG   0x7E
+#define ESCAPE 0x7D
+
+/*
+ *  ======== bulk_crc16 ========
+ *  CRC-16/CCITT-FALSE, four bits at a time to keep the table small.
+ */
+uint16_t bulk_crc16(uint16_t crc, const uint8_t *data, size_t length)
+{
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+    };
+
+    while (length-- > 0)
+    {
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (*data >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (*data & 0x0F)]);
+        data++;
+    }
+    return crc;
+}
+
+/*
+ *  ======== putByte ========
+ */
+static size_t putByte(uint8_t *out, size_t n, uint8_t byte)
+{
+    if (byte == FLAG || byte == ESCAPE)
+    {
+        out[n++] = ESCAPE;
+        byte ^= 0x20;
+    }
+    out[n++] = byte;
+    return n;
+}
+
+/*
+ *  ======== sendFrame ========
+ */
+static void sendFrame(const BulkPort *port, uint8_t type, uint8_t seq,
+                      const uint8_t *payload, size_t length)
+{
+    uint8_t out[BULK_MAX_ENCODED];
+    uint8_t header[2];
+    uint16_t crc;
+    size_t n = 0;
+    size_t i;
+
+    header[0] = type;
+    header[1] = seq;
+    crc = bulk_crc16(0xFFFF, header, 2);
+    crc = bulk_crc16(crc, payload, length);
+
+    out[n++] = FLAG;
+    n = putByte(out, n, type);
+    n = putByte(out, n, seq);
+    for (i = 0; i < length; i++)
+    {
+        n = putByte(out, n, payload[i]);
+    }
+    n = putByte(out, n, (uint8_t)(crc >> 8));
+    n = putByte(out, n, (uint8_t)crc);
+    out[n++] = FLAG;
+
+    port->write(port->arg, out, n);
+}
+
+/*
+ *  ======== decodeByte ========
+ *  Returns 1 when byte completes a frame with a good CRC; the frame is
+ *  then in d->buffer (d->length bytes including the CRC) until the caller
+ *  clears d->length.
+ */
+static int decodeByte(BulkDecoder *d, uint8_t byte, BulkStats *stats)
+{
+    if (byte == FLAG)
+    {
+        int good = 0;
+
+        if (d->overflow || (d->length > 0 && d->length < 4))
+        {
+            stats->crcErrors++;
+        }
+        else if (d->length >= 4)
+        {
+            uint16_t crc = (uint16_t)((d->buffer[d->length - 2] << 8) | d->buffer[d->length - 1]);
+
+            if (bulk_crc16(0xFFFF, d->buffer, d->length - 2) == crc)
+            {
+                good = 1;
+            }
+            else
+            {
+                stats->crcErrors++;
+            }
+        }
+        d->escape = 0;
+        d->overflow = 0;
+        if (!good)
+        {
+            d->length = 0;
+        }
+        return good;
+    }
+
+    if (d->overflow)
+    {
+        return 0;               // wait for the next flag
+    }
+    if (byte == ESCAPE)
+    {
+        d->escape = 1;
+        return 0;
+    }
+    if (d->escape)
+    {
+        byte ^= 0x20;
+        d->escape = 0;
+    }
+    if (d->length == sizeof(d->buffer))
+    {
+        d->overflow = 1;
+        return 0;
+    }
+    d->buffer[d->length++] = byte;
+    return 0;
+}
+
+/*
+ *  ======== bulk_receiverInit ========
+ */
+void bulk_receiverInit(BulkReceiver *rx, const BulkPort *port, BulkDeliverFxn deliver)
+{
+    memset(rx, 0, sizeof(*rx));
+    rx->port = *port;
+    rx->deliver = deliver;
+}
+
+/*
+ *  ======== bulk_receiverInput ========
+ */
+int bulk_receiverInput(BulkReceiver *rx, const uint8_t *data, size_t length)
+{
+    while (length-- > 0)
+    {
+        uint8_t type;
+        uint8_t seq;
+        size_t payloadLength;
+
+        if (!decodeByte(&rx->decoder, *data++, &rx->stats))
+        {
+            continue;
+        }
+
+        type = rx->decoder.buffer[0];
+        seq = rx->decoder.buffer[1];
+        payloadLength = rx->decoder.length - 4;
+        rx->decoder.length = 0;
+        rx->stats.framesReceived++;
+
+        if (type != BULK_DATA && type != BULK_DATA_END)
+        {
+            continue;
+        }
+
+        // Only the next frame in order is taken; anything else is a
+        // duplicate or follows a lost frame and will be sent again.
+        if (seq == rx->expected && !rx->finished)
+        {
+            if (rx->deliver != NULL && payloadLength > 0)
+            {
+                rx->deliver(rx->port.arg, rx->decoder.buffer + 2, payloadLength);
+            }
+            rx->stats.bytesDelivered += payloadLength;
+            rx->expected++;
+            if (type == BULK_DATA_END)
+            {
+                rx->finished = 1;
+            }
+        }
+
+        sendFrame(&rx->port, BULK_ACK, rx->expected, NULL, 0);
+        rx->stats.framesSent++;
+    }
+
+    return rx->finished;
+}
+
+/*
+ *  ======== bulk_senderInit ========
+ */
+void bulk_senderInit(BulkSender *tx, const BulkPort *port)
+{
+    memset(tx, 0, sizeof(*tx));
+    tx->port = *port;
+}
+
+/*
+ *  ======== bulk_senderOffer ========
+ */
+size_t bulk_senderOffer(BulkSender *tx, const uint8_t *data, size_t length, int last)
+{
+    size_t taken = 0;
+
+    while (!tx->ended && (uint8_t)(tx->next - tx->base) < BULK_WINDOW)
+    {
+        uint8_t slot = tx->next % BULK_WINDOW;
+        size_t chunk = length - taken;
+        int isLast;
+
+        if (chunk > BULK_MAX_PAYLOAD)
+        {
+            chunk = BULK_MAX_PAYLOAD;
+        }
+        isLast = last && (taken + chunk == length);
+        if (chunk == 0 && !isLast)
+        {
+            break;
+        }
+
+        memcpy(tx->payload[slot], data + taken, chunk);
+        tx->length[slot] = (uint8_t)chunk;
+        tx->last[slot] = (uint8_t)isLast;
+
+        if (tx->base == tx->next)
+        {
+            tx->timerStart = tx->port.now(tx->port.arg);
+        }
+        sendFrame(&tx->port, isLast ? BULK_DATA_END : BULK_DATA, tx->next,
+                  tx->payload[slot], chunk);
+        tx->stats.framesSent++;
+        tx->next++;
+        taken += chunk;
+
+        if (isLast)
+        {
+            tx->ended = 1;
+        }
+    }
+
+    return taken;
+}
+
+/*
+ *  ======== bulk_senderInput ========
+ */
+void bulk_senderInput(BulkSender *tx, const uint8_t *data, size_t length)
+{
+    while (length-- > 0)
+    {
+        uint8_t acked;
+
+        if (!decodeByte(&tx->decoder, *data++, &tx->stats))
+        {
+            continue;
+        }
+        tx->stats.framesReceived++;
+
+        if (tx->decoder.buffer[0] != BULK_ACK)
+        {
+            tx->decoder.length = 0;
+            continue;
+        }
+
+        // The ACK names the next frame the receiver wants, so everything
+        // before it has arrived. Ignore ACKs outside the window.
+        acked = (uint8_t)(tx->decoder.buffer[1] - tx->base);
+        tx->decoder.length = 0;
+        if (acked == 0 || acked > (uint8_t)(tx->next - tx->base))
+        {
+            continue;
+        }
+
+        while (acked-- > 0)
+        {
+            uint8_t slot = tx->base % BULK_WINDOW;
+
+            tx->stats.bytesDelivered += tx->length[slot];
+            if (tx->last[slot])
+            {
+                tx->finished = 1;
+            }
+            tx->base++;
+        }
+        tx->retries = 0;
+        tx->timerStart = tx->port.now(tx->port.arg);
+    }
+}
+
+/*
+ *  ======== bulk_senderPoll ========
+ */
+int bulk_senderPoll(BulkSender *tx)
+{
+    uint8_t seq;
+
+    if (tx->finished)
+    {
+        return 1;
+    }
+    if (tx->base == tx->next
+        || (uint32_t)(tx->port.now(tx->port.arg) - tx->timerStart) < BULK_TIMEOUT_MS)
+    {
+        return 0;
+    }
+    if (++tx->retries > BULK_MAX_RETRIES)
+    {
+        return -1;
+    }
+
+    // Go back N: resend every frame that has not been acknowledged.
+    for (seq = tx->base; seq != tx->next; seq++)
+    {
+        uint8_t slot = seq % BULK_WINDOW;
+
+        sendFrame(&tx->port, tx->last[slot] ? BULK_DATA_END : BULK_DATA, seq,
+                  tx->payload[slot], tx->length[slot]);
+        tx->stats.framesSent++;
+        tx->stats.retransmits++;
+    }
+    tx->timerStart = tx->port.now(tx->port.arg);
+
+    return 0;
+}
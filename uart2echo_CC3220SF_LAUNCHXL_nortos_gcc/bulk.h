@@ -0,0 +1,143 @@
+/*
+ *  ======== bulk.h ========
+ *
+ *  Lossless bulk transfer over a UART: numbered frames with a CRC, a
+ *  sliding window of frames in flight and cumulative acknowledgements
+ *  (go-back-N).
+ *
+ *  Each frame is HDLC style byte stuffed between 0x7E flags, so a
+ *  receiver resynchronizes on the next flag after any damage:
+ *
+ *      0x7E  type  seq  payload (0 - BULK_MAX_PAYLOAD)  crc16 (MSB first)  0x7E
+ *
+ *  0x7E and 0x7D inside a frame are sent as 0x7D followed by the byte
+ *  XOR 0x20. The CRC is CRC-16/CCITT-FALSE over type, seq and payload.
+ *
+ *  DATA frames carry the payload, DATA_END marks the last one. The
+ *  receiver answers every frame with ACK whose seq is the next sequence
+ *  number it expects. The sender resends everything not yet acknowledged
+ *  when the oldest frame has waited BULK_TIMEOUT_MS.
+ *
+ *  This file has no driver dependencies; the same code runs on the target
+ *  (uart2echo.c) and on the host (tools/bulkxfer.c).
+ */
+
+#ifndef BULK_H_
+#define BULK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BULK_MAX_PAYLOAD 64
+#define BULK_WINDOW      4          /* frames in flight, a power of two up to 64 */
+#define BULK_TIMEOUT_MS  100
+#define BULK_MAX_RETRIES 20         /* timeouts in a row before giving up */
+
+/* Window slots are picked by the 8-bit sequence number modulo the window,
+ * which stays in step across the wrap from 255 to 0 only if the window
+ * divides 256. 64 frames keep the sender's buffers to 4 KB. */
+#if (BULK_WINDOW & (BULK_WINDOW - 1)) || BULK_WINDOW < 1 || BULK_WINDOW > 64
+#error "BULK_WINDOW must be a power of two up to 64"
+#endif
+
+/* Largest encoded frame: two flags, every other byte escaped */
+#define BULK_MAX_ENCODED (2 + 2 * (2 + BULK_MAX_PAYLOAD + 2))
+
+enum BULK_FRAME_TYPES {BULK_DATA = 1, BULK_DATA_END = 2, BULK_ACK = 3};
+
+/* Where encoded frames go and, for the sender, what time it is */
+typedef struct {
+    void (*write)(void *arg, const uint8_t *data, size_t length);
+    uint32_t (*now)(void *arg);     // milliseconds; sender only
+    void *arg;
+} BulkPort;
+
+typedef struct {
+    uint32_t framesSent;
+    uint32_t retransmits;
+    uint32_t framesReceived;
+    uint32_t crcErrors;             // includes runts and oversized frames
+    uint32_t bytesDelivered;
+} BulkStats;
+
+/* Frame decoder state, one per direction */
+typedef struct {
+    uint8_t buffer[2 + BULK_MAX_PAYLOAD + 2];
+    uint8_t length;
+    uint8_t escape;
+    uint8_t overflow;
+} BulkDecoder;
+
+typedef void (*BulkDeliverFxn)(void *arg, const uint8_t *data, size_t length);
+
+typedef struct {
+    BulkPort port;
+    BulkDecoder decoder;
+    BulkDeliverFxn deliver;
+    uint8_t expected;               // next sequence number to accept
+    uint8_t finished;               // DATA_END has been delivered
+    BulkStats stats;
+} BulkReceiver;
+
+typedef struct {
+    BulkPort port;
+    BulkDecoder decoder;
+    uint8_t payload[BULK_WINDOW][BULK_MAX_PAYLOAD];
+    uint8_t length[BULK_WINDOW];
+    uint8_t last[BULK_WINDOW];
+    uint8_t base;                   // oldest unacknowledged sequence number
+    uint8_t next;                   // next sequence number to send
+    uint8_t ended;                  // DATA_END has been queued
+    uint8_t finished;               // DATA_END has been acknowledged
+    uint8_t retries;
+    uint32_t timerStart;
+    BulkStats stats;
+} BulkSender;
+
+/*
+ *  ======== bulk_receiverInit ========
+ *  deliver is called with each payload, in order and exactly once.
+ */
+void bulk_receiverInit(BulkReceiver *rx, const BulkPort *port, BulkDeliverFxn deliver);
+
+/*
+ *  ======== bulk_receiverInput ========
+ *  Feeds received bytes in; acknowledgements are written to the port.
+ *  Returns 1 once the whole transfer has been delivered.
+ */
+int bulk_receiverInput(BulkReceiver *rx, const uint8_t *data, size_t length);
+
+/*
+ *  ======== bulk_senderInit ========
+ */
+void bulk_senderInit(BulkSender *tx, const BulkPort *port);
+
+/*
+ *  ======== bulk_senderOffer ========
+ *  Sends as much of data as the window allows and returns the number of
+ *  bytes taken. With last set, the final byte taken is marked as the end
+ *  of the transfer (once all of data has been taken). An empty transfer
+ *  is a zero length offer with last set.
+ */
+size_t bulk_senderOffer(BulkSender *tx, const uint8_t *data, size_t length, int last);
+
+/*
+ *  ======== bulk_senderInput ========
+ *  Feeds bytes received from the other end (acknowledgements) in.
+ */
+void bulk_senderInput(BulkSender *tx, const uint8_t *data, size_t length);
+
+/*
+ *  ======== bulk_senderPoll ========
+ *  Resends on timeout. Returns 1 when the transfer is complete, -1 after
+ *  BULK_MAX_RETRIES timeouts without progress, otherwise 0.
+ */
+int bulk_senderPoll(BulkSender *tx);
+
+/*
+ *  ======== bulk_crc16 ========
+ *  CRC-16/CCITT-FALSE; start with crc = 0xFFFF.
+ */
+uint16_t bulk_crc16(uint16_t crc, const uint8_t *data, size_t length);
+
+#endif /* BULK_H_ */
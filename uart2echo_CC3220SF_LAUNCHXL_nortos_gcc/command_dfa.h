@@ -0,0 +1,72 @@
+/*
+ *  ======== command_dfa.h ========
+ *
+ *  DO NOT EDIT - generated by tools/cmdgen.c from commands.def.
+ *
+ *  state = commandDfaNext[state][commandDfaClass[byte]];
+ *  commandDfaMatch[state] is 0, or the command number + 1 in
+ *  commands.def order of the keyword that just ended.
+ */
+
+#ifndef COMMAND_DFA_H_
+#define COMMAND_DFA_H_
+
+#include <stdint.h>
+
+#define COMMAND_DFA_STATES  24
+#define COMMAND_DFA_CLASSES 15
+
+/* Keywords in commands.def and the sum of (number * length) over
+ * them, numbering from 1, to catch a stale table */
+#define COMMAND_DFA_KEYWORDS 7
+#define COMMAND_DFA_LENGTHS  105
+
+static const uint8_t commandDfaClass[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 6, 7, 0, 11, 13, 3, 0, 0, 0, 0, 10, 9, 0, 2, 1,
+    0, 0, 14, 4, 5, 8, 0, 0, 0, 12, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static const uint8_t commandDfaNext[COMMAND_DFA_STATES][COMMAND_DFA_CLASSES] = {
+    { 0, 1, 0, 0, 5, 0, 0, 10, 0, 0, 0, 14, 0, 0, 20 },
+    { 0, 1, 2, 3, 5, 0, 0, 10, 0, 0, 0, 14, 0, 0, 20 },
+    { 0, 1, 0, 0, 5, 0, 0, 10, 0, 0, 0, 14, 0, 0, 20 },
+    { 0, 1, 0, 4, 5, 0, 0, 10, 0, 0, 0, 14, 0, 0, 20 },
+    { 0, 1, 0, 0, 5, 0, 0, 10, 0, 0, 0, 14, 0, 0, 20 },
+    { 0, 1, 0, 0, 5, 6, 0, 10, 0, 0, 0, 14, 0, 18, 20 },
+    { 0, 1, 0, 0, 5, 0, 7, 10, 0, 0, 0, 14, 0, 0, 20 },
+    { 0, 1, 0, 0, 5, 8, 0, 10, 0, 0, 0, 14, 0, 0, 20 },
+    { 0, 1, 0, 0, 9, 0, 0, 10, 0, 0, 0, 14, 0, 0, 20 },
+    { 0, 1, 0, 0, 5, 6, 0, 10, 0, 0, 0, 14, 0, 18, 20 },
+    { 0, 1, 0, 0, 5, 0, 0, 10, 11, 0, 0, 14, 0, 0, 20 },
+    { 0, 1, 0, 0, 5, 0, 0, 10, 0, 12, 0, 14, 0, 0, 20 },
+    { 0, 1, 0, 0, 5, 0, 0, 10, 0, 0, 13, 14, 0, 0, 20 },
+    { 0, 1, 0, 0, 5, 0, 0, 10, 0, 0, 0, 14, 0, 0, 20 },
+    { 0, 1, 0, 0, 5, 0, 0, 10, 15, 0, 0, 14, 0, 0, 20 },
+    { 0, 1, 0, 0, 5, 16, 0, 10, 0, 0, 0, 14, 0, 0, 20 },
+    { 0, 1, 0, 0, 5, 0, 0, 10, 0, 0, 0, 14, 17, 0, 20 },
+    { 0, 1, 0, 0, 5, 0, 0, 10, 0, 0, 0, 14, 0, 0, 20 },
+    { 0, 1, 0, 0, 5, 19, 0, 10, 0, 0, 0, 14, 0, 0, 20 },
+    { 0, 1, 0, 0, 5, 0, 0, 10, 0, 0, 0, 14, 0, 0, 20 },
+    { 0, 1, 0, 0, 5, 0, 21, 10, 0, 0, 0, 14, 0, 0, 20 },
+    { 0, 1, 0, 0, 5, 22, 0, 10, 0, 0, 0, 14, 0, 0, 20 },
+    { 0, 1, 0, 0, 5, 0, 0, 10, 0, 0, 0, 14, 0, 23, 20 },
+    { 0, 1, 0, 0, 5, 0, 0, 10, 0, 0, 0, 14, 0, 0, 20 },
+};
+
+static const uint8_t commandDfaMatch[COMMAND_DFA_STATES] = { 0, 0, 1, 0, 2, 0, 0, 0, 0, 3, 0, 0, 0, 4, 0, 0, 0, 5, 0, 6, 0, 0, 0, 7 };
+
+#endif /* COMMAND_DFA_H_ */
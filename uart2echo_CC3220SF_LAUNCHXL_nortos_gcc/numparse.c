@@ -0,0 +1,123 @@
+/*
+ *  ======== numparse.c ========
+ *
+ *  Streaming numeric argument decoder. See numparse.h.
+ */
+
+#include "numparse.h"
+
+enum NUM_STATES {NUM_START, NUM_SIGN, NUM_INTEGER, NUM_FRACTION};
+
+static const uint32_t powersOf10[NUM_MAX_DECIMALS + 1] = { 1, 10, 100, 1000, 10000 };
+
+/*
+ *  ======== setSign ========
+ *  Returns 0 if no value of this sign is in range.
+ */
+static int setSign(NumParser *p, uint8_t negative)
+{
+    int64_t limit = negative ? -(int64_t)p->min : (int64_t)p->max;
+
+    p->negative = negative;
+    p->limit = (limit > 0) ? (uint32_t)limit : 0;
+    return limit >= 0;
+}
+
+/*
+ *  ======== num_start ========
+ */
+void num_start(NumParser *p, uint8_t decimals, int32_t min, int32_t max)
+{
+    if (decimals > NUM_MAX_DECIMALS)
+    {
+        decimals = NUM_MAX_DECIMALS;
+    }
+    p->min = min;
+    p->max = max;
+    p->value = 0;
+    p->scale = powersOf10[decimals];
+    p->decimals = decimals;
+    p->state = NUM_START;
+    p->negative = 0;
+    p->digits = 0;
+}
+
+/*
+ *  ======== num_feed ========
+ */
+enum NUM_RESULTS num_feed(NumParser *p, uint8_t byte, int32_t *value)
+{
+    if (byte >= '0' && byte <= '9')
+    {
+        uint64_t next;
+
+        if (p->state == NUM_START && !setSign(p, 0))
+        {
+            return NUM_ERROR;
+        }
+        if (p->state == NUM_FRACTION)
+        {
+            // Each fractional digit is worth a tenth of the one before.
+            p->scale /= 10;
+            if (p->scale == 0)
+            {
+                return NUM_ERROR;       // more digits than decimals
+            }
+            next = (uint64_t)p->value + (uint64_t)(byte - '0') * p->scale;
+        }
+        else
+        {
+            p->state = NUM_INTEGER;
+            next = (uint64_t)p->value * 10 + (uint64_t)(byte - '0') * p->scale;
+        }
+        if (next > p->limit)
+        {
+            return NUM_ERROR;           // out of range, however it ends
+        }
+        p->value = (uint32_t)next;
+        p->digits++;
+        return NUM_MORE;
+    }
+
+    switch (byte)
+    {
+        case ' ':
+            if (p->state == NUM_START)
+            {
+                return NUM_MORE;        // spaces before the number
+            }
+            // fall through
+        case '\r':
+        case '\n':
+            if (p->digits == 0)
+            {
+                return NUM_ERROR;
+            }
+            if (p->negative ? -(int64_t)p->value > p->max
+                            : (int64_t)p->value < p->min)
+            {
+                return NUM_ERROR;
+            }
+            *value = p->negative ? (int32_t)-(int64_t)p->value : (int32_t)p->value;
+            return NUM_DONE;
+
+        case '-':
+            if (p->state != NUM_START || !setSign(p, 1))
+            {
+                return NUM_ERROR;
+            }
+            p->state = NUM_SIGN;
+            return NUM_MORE;
+
+        case '.':
+            if (p->state != NUM_INTEGER || p->decimals == 0)
+            {
+                return NUM_ERROR;
+            }
+            p->state = NUM_FRACTION;
+            return NUM_MORE;
+
+        default:
+            return NUM_ERROR;
+    }
+}
@@ -0,0 +1,52 @@
+/*
+ *  ======== numparse.h ========
+ *
+ *  Streaming decoder for the numeric argument of a command ("DUTY 42",
+ *  "SET 21.5", "SET -3"). Bytes are fed in one at a time as they arrive,
+ *  so nothing has to hold the whole line:
+ *
+ *      [spaces] [-] digits [. digits] terminator
+ *
+ *  where the terminator is a space, CR or LF. The value is returned as a
+ *  fixed-point integer scaled by 10^decimals ("21.5" with 1 decimal is
+ *  215, "21" is 210). More fractional digits than decimals, a value
+ *  outside [min, max], a missing number or any other byte is an error;
+ *  the range is checked digit by digit, so long inputs cannot overflow.
+ */
+
+#ifndef NUMPARSE_H_
+#define NUMPARSE_H_
+
+#include <stdint.h>
+
+#define NUM_MAX_DECIMALS 4
+
+enum NUM_RESULTS {NUM_MORE, NUM_DONE, NUM_ERROR};
+
+typedef struct {
+    int32_t min;
+    int32_t max;
+    uint32_t value;             // magnitude so far, already scaled
+    uint32_t scale;             // what one unit of the next digit adds
+    uint32_t limit;             // largest magnitude the sign allows
+    uint8_t decimals;
+    uint8_t state;
+    uint8_t negative;
+    uint8_t digits;
+} NumParser;
+
+/*
+ *  ======== num_start ========
+ *  Starts a new number. min and max are scaled by 10^decimals as well.
+ */
+void num_start(NumParser *p, uint8_t decimals, int32_t min, int32_t max);
+
+/*
+ *  ======== num_feed ========
+ *  Returns NUM_MORE until the number ends, then NUM_DONE with the value
+ *  in *value, or NUM_ERROR. After either of those, call num_start()
+ *  before feeding more.
+ */
+enum NUM_RESULTS num_feed(NumParser *p, uint8_t byte, int32_t *value);
+
+#endif /* NUMPARSE_H_ */
@@ -38,11 +38,245 @@
 
 /* Driver Header files */
 #include <ti/drivers/GPIO.h>
+#include <ti/drivers/PWM.h>
 #include <ti/drivers/UART2.h>
 
 /* Driver configuration */
 #include "ti_drivers_config.h"
 
+/* Command recognizer generated from commands.def by tools/cmdgen.c */
+#include "command_dfa.h"
+
+/* Framed transfer protocol used by the BULK command */
+#include "bulk.h"
+
+/* Decoder for the numbers after DUTY, SET and RATE */
+#include "numparse.h"
+
+/* Line rate and size of the echo buffer. A read returns as soon as at
+ * least one byte has arrived, with up to ECHO_BUFFER_SIZE bytes. */
+#define ECHO_BAUD_RATE   115200
+#define ECHO_BUFFER_SIZE 64
+
+/* Pseudo GPIO indexes for the STATS, BULK and numeric commands in
+ * commands.def */
+#define ECHO_REPORT_STATS 0xFF
+#define ECHO_BULK_RECEIVE 0xFE
+#define ECHO_NUMERIC_ARG  0xFD
+
+/* Period of the LED PWM that DUTY sets */
+#define ECHO_PWM_PERIOD_US 1000
+
+/* Commands that take a number; the level column in commands.def picks
+ * the entry. Values are fixed point, scaled by 10^decimals. DUTY sets
+ * the brightness of the CONFIG_PWM_0 LED; SET and RATE are only parsed,
+ * stored and reported back, for an application to act on. */
+enum ECHO_ARGS {ARG_DUTY, ARG_SET, ARG_RATE, ECHO_NUM_ARGS};
+
+static const struct {
+    const char *name;
+    uint8_t decimals;
+    int32_t min;
+    int32_t max;
+} argumentSpecs[ECHO_NUM_ARGS] = {
+    { "DUTY", 0,    0,  100 },          // percent
+    { "SET",  1, -400, 1250 },          // degrees C, -40.0 to 125.0
+    { "RATE", 0,    1, 3600 },          // seconds
+};
+
+static int32_t argumentValues[ECHO_NUM_ARGS];
+
+/* BULK mode ends after this many ClockP ticks (1 ms by default) without
+ * input. The idle time after the last frame also lets a lost final ACK be
+ * answered again when the sender retries. */
+#define BULK_IDLE_TICKS 1000
+
+/* What each keyword in commands.def does, in the same order */
+static const struct {
+    uint_least8_t index;
+    unsigned int level;
+} commandActions[] = {
+#define COMMAND(name, keyword, index, level) { index, level },
+#include "commands.def"
+#undef COMMAND
+};
+
+/* command_dfa.h is generated from commands.def by hand. If it was made
+ * from a different list, the keyword count or the length checksum that
+ * tools/cmdgen.c wrote into it disagrees with commands.def and this
+ * array gets a negative size, which stops the build. */
+enum {
+#define COMMAND(name, keyword, index, level) COMMAND_NUMBER_##name,
+#include "commands.def"
+#undef COMMAND
+    ECHO_NUM_COMMANDS
+};
+
+typedef char commandDfaMatchesCommandsDef[(ECHO_NUM_COMMANDS == COMMAND_DFA_KEYWORDS
+    && (0
+#define COMMAND(name, keyword, index, level) + (COMMAND_NUMBER_##name + 1) * (sizeof(keyword) - 1)
+#include "commands.def"
+#undef COMMAND
+        ) == COMMAND_DFA_LENGTHS) ? 1 : -1];
+
+/* UART error and buffer counters, reported by the STATS command */
+static uint32_t rxHighWater = 0;     // most bytes waiting in the RX ring
+static uint32_t framingErrors = 0;
+
+/*
+ *  ======== putUint ========
+ *  Appends value in decimal and returns the new end of the buffer.
+ */
+static char *putUint(char *p, uint32_t value)
+{
+    char digits[10];
+    int count = 0;
+
+    do {
+        digits[count++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    while (count > 0) {
+        *p++ = digits[--count];
+    }
+    return p;
+}
+
+/*
+ *  ======== putString ========
+ */
+static char *putString(char *p, const char *text)
+{
+    while (*text) {
+        *p++ = *text++;
+    }
+    return p;
+}
+
+/*
+ *  ======== reportArgument ========
+ *  Writes "\r\nNAME=value\r\n" for a number that was accepted, with the
+ *  configured number of decimals, or "\r\nNAME ERR\r\n".
+ */
+static void reportArgument(UART2_Handle uart, unsigned int argument, int ok)
+{
+    char line[32];
+    char *p = line;
+    int32_t value = argumentValues[argument];
+    uint32_t magnitude = (value < 0) ? 0u - (uint32_t)value : (uint32_t)value;
+    uint32_t unit = 1;
+    uint8_t d;
+
+    p = putString(p, "\r\n");
+    p = putString(p, argumentSpecs[argument].name);
+    if (!ok) {
+        p = putString(p, " ERR\r\n");
+        UART2_write(uart, line, p - line, NULL);
+        return;
+    }
+
+    for (d = 0; d < argumentSpecs[argument].decimals; d++) {
+        unit *= 10;
+    }
+    *p++ = '=';
+    if (value < 0) {
+        *p++ = '-';
+    }
+    p = putUint(p, magnitude / unit);
+    if (unit > 1) {
+        *p++ = '.';
+        // Fraction with its leading zeros
+        for (unit /= 10; unit > 0; unit /= 10) {
+            *p++ = '0' + (magnitude / unit) % 10;
+        }
+    }
+    p = putString(p, "\r\n");
+
+    UART2_write(uart, line, p - line, NULL);
+}
+
+/*
+ *  ======== reportStats ========
+ *  Writes "\r\nOVR=n HWM=n FE=n\r\n": RX overruns counted by the driver,
+ *  RX ring high-water mark and framing errors.
+ */
+static void reportStats(UART2_Handle uart)
+{
+    char line[48];
+    char *p = line;
+
+    p = putString(p, "\r\nOVR=");
+    p = putUint(p, UART2_getOverrunCount(uart));
+    p = putString(p, " HWM=");
+    p = putUint(p, rxHighWater);
+    p = putString(p, " FE=");
+    p = putUint(p, framingErrors);
+    p = putString(p, "\r\n");
+
+    UART2_write(uart, line, p - line, NULL);
+}
+
+/*
+ *  ======== bulkWrite ========
+ */
+static void bulkWrite(void *arg, const uint8_t *data, size_t length)
+{
+    UART2_write((UART2_Handle)arg, data, length, NULL);
+}
+
+/*
+ *  ======== bulkDeliver ========
+ *  The received data is not stored; a running CRC lets the sender check
+ *  that it arrived intact.
+ */
+static uint16_t bulkCrc;
+
+static void bulkDeliver(void *arg, const uint8_t *data, size_t length)
+{
+    bulkCrc = bulk_crc16(bulkCrc, data, length);
+}
+
+/*
+ *  ======== bulkReceive ========
+ *  Receives one transfer (see bulk.h) and then writes
+ *  "\r\nBULK n CRC=xxxx ERR=n\r\n": bytes delivered, their CRC-16 and the
+ *  number of damaged frames. Returns to echoing when the line goes idle.
+ */
+static void bulkReceive(UART2_Handle uart)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    BulkReceiver rx;
+    BulkPort port = { bulkWrite, NULL, NULL };
+    uint8_t input[ECHO_BUFFER_SIZE];
+    size_t bytesRead;
+    char line[48];
+    char *p = line;
+    int shift;
+
+    port.arg = uart;
+    bulkCrc = 0xFFFF;
+    bulk_receiverInit(&rx, &port, bulkDeliver);
+
+    do {
+        bytesRead = 0;
+        UART2_readTimeout(uart, input, sizeof(input), &bytesRead, BULK_IDLE_TICKS);
+        bulk_receiverInput(&rx, input, bytesRead);
+    } while (bytesRead > 0);
+
+    p = putString(p, "\r\nBULK ");
+    p = putUint(p, rx.stats.bytesDelivered);
+    p = putString(p, " CRC=");
+    for (shift = 12; shift >= 0; shift -= 4) {
+        *p++ = hex[(bulkCrc >> shift) & 0x0F];
+    }
+    p = putString(p, " ERR=");
+    p = putUint(p, rx.stats.crcErrors);
+    p = putString(p, rx.finished ? "\r\n" : " INCOMPLETE\r\n");
+
+    UART2_write(uart, line, p - line, NULL);
+}
+
 /*
  *  ======== mainThread ========
  */
@@ -55,21 +289,43 @@
 
 void *mainThread(void *arg0)
 {
-    char input;
+    char input[ECHO_BUFFER_SIZE];
+    size_t i;
     const char echoPrompt[] = "Echoing characters:\r\n";
     UART2_Handle uart;
     UART2_Params uartParams;
     size_t bytesRead;
+    size_t echoed;
     size_t bytesWritten = 0;
-    // uint32_t status = UART2_STATUS_SUCCESS;
+    size_t waiting;
+    int_fast16_t status;
+    PWM_Handle pwm;
+    PWM_Params pwmParams;
 
     /* Call driver GPIO init functions */
     GPIO_init();
+    PWM_init();
 
     /* Configure the LED pin */
     GPIO_setConfig(CONFIG_GPIO_LED_0, GPIO_CFG_OUT_STD | GPIO_CFG_OUT_LOW);
 
+    /* The DUTY LED starts off */
+    PWM_Params_init(&pwmParams);
+    pwmParams.dutyUnits = PWM_DUTY_FRACTION;
+    pwmParams.dutyValue = 0;
+    pwmParams.periodUnits = PWM_PERIOD_US;
+    pwmParams.periodValue = ECHO_PWM_PERIOD_US;
+    pwm = PWM_open(CONFIG_PWM_0, &pwmParams);
+
+    if (pwm == NULL)
+    {
+        /* PWM_open() failed */
+        while (1) {}
+    }
+    PWM_start(pwm);
+
     /* Create a UART where the default read and write mode is BLOCKING
+        and reads return partial data (see readReturnMode below).
         Defaults values are: readMode = UART2_Mode_BLOCKING;
         writeMode = UART2_Mode_BLOCKING;
         readCallback = NULL;
@@ -82,7 +338,10 @@ void *mainThread(void *arg0)
         userArg = NULL;
     */
     UART2_Params_init(&uartParams);
-    uartParams.baudRate = 115200;
+    uartParams.baudRate = ECHO_BAUD_RATE;
+    /* Return from UART2_read() with whatever has arrived instead of
+       waiting for the whole buffer, so the echo stays interactive. */
+    uartParams.readReturnMode = UART2_ReadReturnMode_PARTIAL;
 
     /* open the UART */
     uart = UART2_open(CONFIG_UART2_0, &uartParams);
@@ -99,68 +358,96 @@ void *mainThread(void *arg0)
     /* display echo message */
     UART2_write(uart, echoPrompt, sizeof(echoPrompt), &bytesWritten);
 
-    // Enumerate all machine states
-    enum machineState {
-        STATE_RESET,
-        STATE_O, 
-        STATE_ON, 
-        STATE_OF, 
-        STATE_OFF
-}state;
-    
-    // initialize state to RESET
-    state = STATE_RESET;
-    
+    // Command recognizer state (see commands.def / command_dfa.h)
+    uint8_t state = 0;
+    uint8_t match;
+    int bulkRequested;
+
+    // Numeric argument being decoded, or -1 while looking for keywords
+    int argument = -1;
+    NumParser number;
+    int32_t value;
+    enum NUM_RESULTS result;
+
 
     /* Loop forever echoing. */
-         
+
         while(1) {
 
 
-            // Read input
-            UART2_read(uart, &input, 1, &bytesRead);
+            // Track how full the RX ring got while we were busy
+            waiting = UART2_getRxCount(uart);
+            if (waiting > rxHighWater) {
+                rxHighWater = waiting;
+            }
 
-            switch(state) {
-                case STATE_RESET:
-                    if (input == 'O') {
-                        state = STATE_O;
-                    }
-                    else{
-                        state = STATE_RESET;
-                    }
-                    break;
+            // Read whatever has arrived (at least one byte)
+            bytesRead = 0;
+            status = UART2_read(uart, input, sizeof(input), &bytesRead);
+            if (status == UART2_STATUS_EFRAMING) {
+                framingErrors++;
+            }
 
-                case STATE_O:
-                    if (input == 'N') {
-                        state = STATE_ON;
-                        GPIO_write(CONFIG_GPIO_LED_0, CONFIG_GPIO_LED_ON);
-                        state = STATE_RESET;
+            // Run the command recognizer over the whole chunk;
+            // one table lookup per byte. A reply follows the echo of
+            // the byte that asked for it, so the chunk is echoed up to
+            // there first; echoed counts what has gone out.
+            bulkRequested = 0;
+            echoed = 0;
+            for (i = 0; i < bytesRead; i++) {
+                if (argument >= 0) {
+                    // Digits go to the number decoder, not the recognizer.
+                    result = num_feed(&number, (uint8_t)input[i], &value);
+                    if (result == NUM_DONE) {
+                        argumentValues[argument] = value;
+                        if (argument == ARG_DUTY) {
+                            PWM_setDuty(pwm, (uint32_t)((uint64_t)PWM_DUTY_FRACTION_MAX
+                                                        * (uint32_t)value / 100));
+                        }
                     }
-                    else if (input == 'F') {
-                        state = STATE_OF;
-
-                    }else{
-                        state = STATE_RESET;
+                    if (result != NUM_MORE) {
+                        UART2_write(uart, input + echoed, i + 1 - echoed, &bytesWritten);
+                        echoed = i + 1;
+                        reportArgument(uart, argument, result == NUM_DONE);
+                        argument = -1;
                     }
-                    break;
+                    continue;
+                }
 
-                case STATE_OF:
-                    if (input == 'F') {
-                        state = STATE_OFF;
-                        GPIO_write(CONFIG_GPIO_LED_0, CONFIG_GPIO_LED_OFF);
-                        state = STATE_RESET;
-
-                    } else {
-                        state = STATE_RESET;
-                    }
-                    break;
+                state = commandDfaNext[state][commandDfaClass[(uint8_t)input[i]]];
+                match = commandDfaMatch[state];
+                if (match && commandActions[match - 1].index == ECHO_REPORT_STATS) {
+                    UART2_write(uart, input + echoed, i + 1 - echoed, &bytesWritten);
+                    echoed = i + 1;
+                    reportStats(uart);
+                }
+                else if (match && commandActions[match - 1].index == ECHO_BULK_RECEIVE) {
+                    // Anything after the keyword in this chunk is dropped;
+                    // the sender waits for the echo before framing.
+                    bulkRequested = 1;
+                    bytesRead = i + 1;
+                }
+                else if (match && commandActions[match - 1].index == ECHO_NUMERIC_ARG) {
+                    argument = commandActions[match - 1].level;
+                    num_start(&number, argumentSpecs[argument].decimals,
+                              argumentSpecs[argument].min, argumentSpecs[argument].max);
+                    state = 0;
+                }
+                else if (match) {
+                    GPIO_write(commandActions[match - 1].index, commandActions[match - 1].level);
+                }
+            }
 
 
+            // Echo the rest of the chunk back with one write
+            if (bytesRead > echoed) {
+                UART2_write(uart, input + echoed, bytesRead - echoed, &bytesWritten);
             }
 
-
-            // Echo input with each loop
-            UART2_write(uart, &input, 1, &bytesWritten);
+            if (bulkRequested) {
+                bulkReceive(uart);
+                state = 0;
+            }
 
  }
 }